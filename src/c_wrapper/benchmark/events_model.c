@@ -0,0 +1,72 @@
+#include "reference_fmu.h"
+
+/*!
+    Sawtooth oscillators with different rates that are reset when they reach 1, plus a sampling clock with time events.
+    Model Exchange only, measures the event handling of the solver.
+*/
+
+#define N_OSCILLATORS 8
+/*! The period of the time events. */
+#define SAMPLE_PERIOD 0.01
+/*! The index of the number of handled events in the reals. */
+#define EVENT_COUNT N_OSCILLATORS
+/*! The index of the time of the next time event in the reals. */
+#define NEXT_SAMPLE (N_OSCILLATORS + 1)
+
+static void initialize(fmi2Real reals[])
+{
+    for (size_t i = 0; i < N_OSCILLATORS; i++)
+    {
+        reals[i] = 0.0;
+    }
+    reals[EVENT_COUNT] = 0.0;
+    reals[NEXT_SAMPLE] = SAMPLE_PERIOD;
+}
+
+static void get_derivatives(fmi2Real time, const fmi2Real reals[], fmi2Real derivatives[])
+{
+    (void)time;
+    (void)reals;
+    for (size_t i = 0; i < N_OSCILLATORS; i++)
+    {
+        derivatives[i] = 10.0 * (fmi2Real)(i + 1);
+    }
+}
+
+static void get_event_indicators(fmi2Real time, const fmi2Real reals[], fmi2Real indicators[])
+{
+    (void)time;
+    for (size_t i = 0; i < N_OSCILLATORS; i++)
+    {
+        indicators[i] = 1.0 - reals[i];
+    }
+}
+
+static void update_discrete_states(fmi2Real time, fmi2Real reals[], fmi2EventInfo *event_info)
+{
+    for (size_t i = 0; i < N_OSCILLATORS; i++)
+    {
+        if (reals[i] >= 1.0 - 1e-9)
+        {
+            reals[i] -= 1.0;
+            reals[EVENT_COUNT] += 1.0;
+            event_info->valuesOfContinuousStatesChanged = fmi2True;
+        }
+    }
+    if (time >= reals[NEXT_SAMPLE] - 1e-12)
+    {
+        reals[NEXT_SAMPLE] += SAMPLE_PERIOD;
+        reals[EVENT_COUNT] += 1.0;
+    }
+    event_info->nextEventTimeDefined = fmi2True;
+    event_info->nextEventTime = reals[NEXT_SAMPLE];
+}
+
+const reference_model reference_model_definition = {
+    .n_reals = N_OSCILLATORS + 2,
+    .n_states = N_OSCILLATORS,
+    .n_event_indicators = N_OSCILLATORS,
+    .initialize = initialize,
+    .get_derivatives = get_derivatives,
+    .get_event_indicators = get_event_indicators,
+    .update_discrete_states = update_discrete_states};
@@ -0,0 +1,497 @@
+#include "fmi_wrapper.h"
+#include "me_solver.h"
+#include "system_functions.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*!
+    \brief Measures the overhead of the wrapper with the reference fmus that are built next to this executable.
+    Each benchmark runs its operation several times per repetition and prints the nanoseconds per operation of all
+    repetitions as one JSON object per line, so results of different builds can be compared by scripts.
+    Usage: fmi_wrapper_benchmark [--directory <reference fmus>] [--repetitions <n>] [--filter <part of the benchmark name>]
+*/
+
+#if !defined(REFERENCE_FMU_DIRECTORY)
+#define REFERENCE_FMU_DIRECTORY "."
+#endif
+#if !defined(REFERENCE_FMU_SUFFIX)
+#if defined(_WIN32)
+#define REFERENCE_FMU_SUFFIX ".dll"
+#else
+#define REFERENCE_FMU_SUFFIX ".so"
+#endif
+#endif
+
+/*! Runs the measured operation n times. */
+typedef void (*benchmark_body)(void *context, size_t n);
+/*! Runs after each repetition without being measured, e.g. to release the instances. May be NULL. */
+typedef void (*benchmark_cleanup)(void *context);
+
+typedef struct benchmark_case
+{
+    const char *name;
+    const char *fmu;
+    const char *variant;
+    /*! The number of values per operation, e.g. the vector length of get_real. */
+    size_t size;
+    /*! The number of operations per repetition. */
+    size_t n;
+    benchmark_body body;
+    benchmark_cleanup cleanup;
+    void *context;
+    /*! Optional JSON members that the body reports, e.g. the statistics of the solver. */
+    char counters[256];
+} benchmark_case;
+
+static const char *directory = REFERENCE_FMU_DIRECTORY;
+static size_t repetitions = 15;
+static const char *filter = NULL;
+
+static int compare_samples(const void *first, const void *second)
+{
+    double a = *(const double *)first;
+    double b = *(const double *)second;
+    return a < b ? -1 : a > b;
+}
+
+/*! Run the case, the first run is not measured to warm up the caches. */
+static void measure(benchmark_case *benchmark)
+{
+    if (filter != NULL && strstr(benchmark->name, filter) == NULL)
+    {
+        return;
+    }
+    double *samples = malloc(repetitions * sizeof(double));
+    if (samples == NULL)
+    {
+        return;
+    }
+    benchmark->body(benchmark->context, benchmark->n);
+    if (benchmark->cleanup != NULL)
+    {
+        benchmark->cleanup(benchmark->context);
+    }
+    for (size_t i = 0; i < repetitions; i++)
+    {
+        uint64_t start = getMonotonicTime();
+        benchmark->body(benchmark->context, benchmark->n);
+        samples[i] = (double)(getMonotonicTime() - start) / (double)benchmark->n;
+        if (benchmark->cleanup != NULL)
+        {
+            benchmark->cleanup(benchmark->context);
+        }
+    }
+    qsort(samples, repetitions, sizeof(double), compare_samples);
+    printf("{\"benchmark\":\"%s\",\"fmu\":\"%s\",\"variant\":\"%s\",\"size\":%lu,\"operations\":%lu,\"repetitions\":%lu,"
+           "\"median_ns\":%.1f,\"min_ns\":%.1f,\"max_ns\":%.1f",
+           benchmark->name, benchmark->fmu, benchmark->variant, (unsigned long)benchmark->size, (unsigned long)benchmark->n,
+           (unsigned long)repetitions, samples[repetitions / 2], samples[0], samples[repetitions - 1]);
+    if (benchmark->counters[0] != '\0')
+    {
+        printf(",%s", benchmark->counters);
+    }
+    printf("}\n");
+    fflush(stdout);
+    free(samples);
+}
+
+/*! The path of a reference fmu. \return A string allocated with malloc. */
+static char *reference_path(const char *fmu)
+{
+    size_t size = strlen(directory) + strlen(fmu) + strlen(REFERENCE_FMU_SUFFIX) + sizeof("/reference_");
+    char *path = malloc(size);
+    if (path != NULL)
+    {
+        snprintf(path, size, "%s/reference_%s%s", directory, fmu, REFERENCE_FMU_SUFFIX);
+    }
+    return path;
+}
+
+static fmu_binary *load_reference(const char *fmu)
+{
+    char *path = reference_path(fmu);
+    fmu_binary *binary = path != NULL ? load_binary(path) : NULL;
+    if (binary == NULL)
+    {
+        fprintf(stderr, "Failed to load the reference fmu %s from %s\n", fmu, directory);
+        exit(EXIT_FAILURE);
+    }
+    free(path);
+    return binary;
+}
+
+static void ignore_log(fmi2String instance_name, fmi2Status status, fmi2String category, fmi2String message)
+{
+    (void)instance_name;
+    (void)status;
+    (void)category;
+    (void)message;
+}
+
+/*! An initialized co-simulation instance. */
+static wrapped_fmu *create_slave(fmu_binary *binary, fmi2Boolean logging_on)
+{
+    wrapped_fmu *instance = instantiate_binary(binary, ignore_log, NULL, "benchmark", fmi2CoSimulation, "", "", fmi2False, logging_on);
+    if (instance == NULL)
+    {
+        fprintf(stderr, "Failed to instantiate the reference fmu\n");
+        exit(EXIT_FAILURE);
+    }
+    setup_experiment(instance, fmi2False, 0.0, 0.0, fmi2False, 0.0);
+    enter_initialization_mode(instance);
+    exit_initialization_mode(instance);
+    return instance;
+}
+
+/* Instantiation */
+
+#define MAX_INSTANCES 100
+
+typedef struct instantiate_context
+{
+    fmu_binary *binary;
+    fmi2Type fmu_type;
+    fmi2Boolean pooled;
+    wrapped_fmu *instances[MAX_INSTANCES];
+    size_t n_instances;
+} instantiate_context;
+
+static void instantiate_body(void *context, size_t n)
+{
+    instantiate_context *instantiation = context;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (instantiation->pooled)
+        {
+            instantiation->instances[i] = instantiate_pooled(instantiation->binary, NULL, NULL, "benchmark", instantiation->fmu_type, "", "", fmi2False, fmi2False);
+        }
+        else
+        {
+            instantiation->instances[i] = instantiate_binary(instantiation->binary, NULL, NULL, "benchmark", instantiation->fmu_type, "", "", fmi2False, fmi2False);
+        }
+    }
+    instantiation->n_instances = n;
+}
+
+static void free_instances(void *context)
+{
+    instantiate_context *instantiation = context;
+    for (size_t i = 0; i < instantiation->n_instances; i++)
+    {
+        if (instantiation->instances[i] != NULL)
+        {
+            free_instance(instantiation->instances[i]);
+        }
+    }
+    instantiation->n_instances = 0;
+}
+
+static void benchmark_instantiate(void)
+{
+    const char *fmus[] = {"trivial", "large", "stiff", "events"};
+    for (size_t i = 0; i < sizeof(fmus) / sizeof(fmus[0]); i++)
+    {
+        instantiate_context context = {.binary = load_reference(fmus[i])};
+        // The stiff and event fmus only support Model Exchange
+        context.fmu_type = i < 2 ? fmi2CoSimulation : fmi2ModelExchange;
+        for (int pooled = 0; pooled < 2; pooled++)
+        {
+            context.pooled = pooled;
+            benchmark_case benchmark = {.name = "instantiate", .fmu = fmus[i], .variant = pooled ? "pooled" : "heap", .size = 1,
+                                        .n = MAX_INSTANCES, .body = instantiate_body, .cleanup = free_instances, .context = &context};
+            measure(&benchmark);
+        }
+        free_binary(context.binary);
+    }
+}
+
+/* Getting and setting values */
+
+typedef struct values_context
+{
+    wrapped_fmu *instance;
+    fmi2ValueReference *vr;
+    fmi2Real *values;
+    size_t size;
+} values_context;
+
+static void get_real_body(void *context, size_t n)
+{
+    values_context *values = context;
+    for (size_t i = 0; i < n; i++)
+    {
+        get_real(values->instance, values->vr, values->size, values->values);
+    }
+}
+
+static void set_real_body(void *context, size_t n)
+{
+    values_context *values = context;
+    for (size_t i = 0; i < n; i++)
+    {
+        set_real(values->instance, values->vr, values->size, values->values);
+    }
+}
+
+static void benchmark_values(void)
+{
+    fmu_binary *binary = load_reference("large");
+    values_context context = {.instance = create_slave(binary, fmi2False)};
+    const size_t sizes[] = {1, 10, 100, 1000, 10000};
+    context.vr = malloc(10000 * sizeof(fmi2ValueReference));
+    context.values = calloc(10000, sizeof(fmi2Real));
+    if (context.vr == NULL || context.values == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < 10000; i++)
+    {
+        // Interleave the value references so the fmu does not read sequentially
+        context.vr[i] = (fmi2ValueReference)((i * 7919) % 10000);
+    }
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        context.size = sizes[i];
+        // About a million values per repetition
+        size_t n = 1000000 / sizes[i];
+        benchmark_case get = {.name = "get_real", .fmu = "large", .variant = "wrapper", .size = sizes[i],
+                              .n = n, .body = get_real_body, .context = &context};
+        measure(&get);
+        benchmark_case set = {.name = "set_real", .fmu = "large", .variant = "wrapper", .size = sizes[i],
+                              .n = n, .body = set_real_body, .context = &context};
+        measure(&set);
+    }
+    free(context.vr);
+    free(context.values);
+    free_instance(context.instance);
+    free_binary(binary);
+}
+
+/* Stepping */
+
+static void direct_logger(fmi2ComponentEnvironment environment, fmi2String instance_name, fmi2Status status, fmi2String category, fmi2String message, ...)
+{
+    (void)environment;
+    (void)instance_name;
+    (void)status;
+    (void)category;
+    (void)message;
+}
+
+typedef struct step_context
+{
+    wrapped_fmu *instance;
+    /*! The functions of the binary for calling it without the wrapper. */
+    fmi2DoStepTYPE *direct_do_step;
+    fmi2Component direct_component;
+    fmi2Real time;
+    /*! Drain the buffered log messages every n steps, 0 if the messages are not buffered. */
+    size_t drain_interval;
+} step_context;
+
+static void direct_do_step_body(void *context, size_t n)
+{
+    step_context *step = context;
+    for (size_t i = 0; i < n; i++)
+    {
+        step->direct_do_step(step->direct_component, step->time, 1e-3, fmi2True);
+        step->time += 1e-3;
+    }
+}
+
+static void do_step_body(void *context, size_t n)
+{
+    step_context *step = context;
+    log_record records[256];
+    for (size_t i = 0; i < n; i++)
+    {
+        do_step(step->instance, step->time, 1e-3, fmi2True);
+        step->time += 1e-3;
+        if (step->drain_interval > 0 && (i + 1) % step->drain_interval == 0)
+        {
+            while (drain_logs(step->instance, records, 256, NULL) == 256)
+            {
+            }
+        }
+    }
+}
+
+static void do_steps_body(void *context, size_t n)
+{
+    step_context *step = context;
+    do_steps(step->instance, step->time, 1e-3, n, fmi2True, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+    step->time += (fmi2Real)n * 1e-3;
+}
+
+static void benchmark_do_step(void)
+{
+    const size_t n = 1000000;
+    char *path = reference_path("trivial");
+    void *library = path != NULL ? loadSharedLibrary(path) : NULL;
+    free(path);
+    if (library == NULL)
+    {
+        fprintf(stderr, "Failed to load the reference fmu trivial from %s\n", directory);
+        exit(EXIT_FAILURE);
+    }
+    // Call the binary directly with the minimal callbacks, the baseline of the wrapper
+    fmi2InstantiateTYPE *direct_instantiate = (fmi2InstantiateTYPE *)getFunction(library, "fmi2Instantiate");
+    fmi2FreeInstanceTYPE *direct_free_instance = (fmi2FreeInstanceTYPE *)getFunction(library, "fmi2FreeInstance");
+    fmi2CallbackFunctions callbacks = {.logger = direct_logger, .allocateMemory = calloc, .freeMemory = free};
+    step_context context = {.direct_do_step = (fmi2DoStepTYPE *)getFunction(library, "fmi2DoStep")};
+    context.direct_component = direct_instantiate("benchmark", fmi2CoSimulation, "", "", &callbacks, fmi2False, fmi2False);
+    benchmark_case direct = {.name = "do_step", .fmu = "trivial", .variant = "direct", .size = 1,
+                             .n = n, .body = direct_do_step_body, .context = &context};
+    measure(&direct);
+    direct_free_instance(context.direct_component);
+    freeSharedLibrary(library);
+
+    fmu_binary *binary = load_reference("trivial");
+    context.instance = create_slave(binary, fmi2False);
+    benchmark_case wrapper = {.name = "do_step", .fmu = "trivial", .variant = "wrapper", .size = 1,
+                              .n = n, .body = do_step_body, .context = &context};
+    measure(&wrapper);
+    benchmark_case batch = {.name = "do_step", .fmu = "trivial", .variant = "do_steps", .size = 1,
+                            .n = n, .body = do_steps_body, .context = &context};
+    measure(&batch);
+    set_call_statistics(context.instance, fmi2True);
+    benchmark_case statistics = {.name = "do_step", .fmu = "trivial", .variant = "call_statistics", .size = 1,
+                                 .n = n, .body = do_step_body, .context = &context};
+    measure(&statistics);
+    free_instance(context.instance);
+    free_binary(binary);
+}
+
+/* Logging */
+
+static void benchmark_logging(void)
+{
+    const size_t n = 200000;
+    fmu_binary *binary = load_reference("trivial");
+    step_context context = {.instance = create_slave(binary, fmi2False)};
+    benchmark_case off = {.name = "logging", .fmu = "trivial", .variant = "off", .size = 1,
+                          .n = n, .body = do_step_body, .context = &context};
+    measure(&off);
+    set_debug_logging(context.instance, fmi2True, 0, NULL);
+    benchmark_case callback = {.name = "logging", .fmu = "trivial", .variant = "callback", .size = 1,
+                               .n = n, .body = do_step_body, .context = &context};
+    measure(&callback);
+    // The messages have the status fmi2OK
+    set_log_filter(context.instance, fmi2Warning, fmi2False, 0, NULL);
+    benchmark_case filtered = {.name = "logging", .fmu = "trivial", .variant = "filtered", .size = 1,
+                               .n = n, .body = do_step_body, .context = &context};
+    measure(&filtered);
+    set_log_filter(context.instance, fmi2OK, fmi2False, 0, NULL);
+    set_log_buffering(context.instance, 1024, 128);
+    context.drain_interval = 512;
+    benchmark_case buffered = {.name = "logging", .fmu = "trivial", .variant = "buffered", .size = 1,
+                               .n = n, .body = do_step_body, .context = &context};
+    measure(&buffered);
+    free_instance(context.instance);
+    free_binary(binary);
+}
+
+/* Model Exchange */
+
+typedef struct simulation_context
+{
+    fmu_binary *binary;
+    size_t n_states;
+    size_t n_event_indicators;
+    me_solver_options options;
+    fmi2Real stop_time;
+    fmi2Real communication_step_size;
+    me_solver_statistics statistics;
+} simulation_context;
+
+static void simulate_body(void *context, size_t n)
+{
+    simulation_context *simulation = context;
+    for (size_t i = 0; i < n; i++)
+    {
+        wrapped_fmu *instance = instantiate_binary(simulation->binary, NULL, NULL, "benchmark", fmi2ModelExchange, "", "", fmi2False, fmi2False);
+        me_solver *solver = instance != NULL ? create_me_solver(instance, simulation->n_states, simulation->n_event_indicators, &simulation->options) : NULL;
+        if (solver == NULL)
+        {
+            fprintf(stderr, "Failed to create the Model Exchange solver\n");
+            exit(EXIT_FAILURE);
+        }
+        setup_experiment(instance, fmi2False, 0.0, 0.0, fmi2True, simulation->stop_time);
+        enter_initialization_mode(instance);
+        exit_initialization_mode(instance);
+        fmi2Status status = me_solver_initialize(solver, 0.0);
+        size_t n_steps = (size_t)(simulation->stop_time / simulation->communication_step_size + 0.5);
+        for (size_t step = 0; step < n_steps && status == fmi2OK; step++)
+        {
+            status = me_solver_do_step(solver, (fmi2Real)step * simulation->communication_step_size, simulation->communication_step_size);
+        }
+        me_solver_get_statistics(solver, &simulation->statistics);
+        free_me_solver(solver);
+        free_instance(instance);
+    }
+}
+
+static void benchmark_model_exchange(void)
+{
+    const char *fmus[] = {"stiff", "events"};
+    const size_t n_states[] = {3, 8};
+    const size_t n_event_indicators[] = {0, 8};
+    const me_solver_method methods[] = {me_solver_bdf, me_solver_dormand_prince};
+    for (size_t i = 0; i < 2; i++)
+    {
+        simulation_context context = {.binary = load_reference(fmus[i]), .n_states = n_states[i], .n_event_indicators = n_event_indicators[i]};
+        context.options.method = methods[i];
+        context.options.step_size = 1e-3;
+        context.stop_time = 10.0;
+        context.communication_step_size = 0.1;
+        benchmark_case benchmark = {.name = "model_exchange", .fmu = fmus[i], .variant = methods[i] == me_solver_bdf ? "bdf" : "dormand_prince", .size = 1,
+                                    .n = 1, .body = simulate_body, .context = &context};
+        // Run once to report the statistics of the solver with the timings
+        if (filter == NULL || strstr(benchmark.name, filter) != NULL)
+        {
+            simulate_body(&context, 1);
+            snprintf(benchmark.counters, sizeof(benchmark.counters),
+                     "\"steps\":%lu,\"derivative_evaluations\":%lu,\"jacobian_evaluations\":%lu,\"state_events\":%lu,\"time_events\":%lu",
+                     (unsigned long)context.statistics.n_steps, (unsigned long)context.statistics.n_derivative_evaluations,
+                     (unsigned long)context.statistics.n_jacobian_evaluations, (unsigned long)context.statistics.n_state_events,
+                     (unsigned long)context.statistics.n_time_events);
+        }
+        measure(&benchmark);
+        free_binary(context.binary);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--directory") == 0)
+        {
+            directory = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--repetitions") == 0)
+        {
+            repetitions = (size_t)strtoul(argv[i + 1], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--filter") == 0)
+        {
+            filter = argv[i + 1];
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--directory <reference fmus>] [--repetitions <n>] [--filter <part of the benchmark name>]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (repetitions == 0)
+    {
+        repetitions = 1;
+    }
+    benchmark_instantiate();
+    benchmark_values();
+    benchmark_do_step();
+    benchmark_logging();
+    benchmark_model_exchange();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,28 @@
+#include "reference_fmu.h"
+
+/*! 10000 variables: the first half are inputs, the second half outputs that double them. Measures the get and set throughput. */
+
+#define N_INPUTS 5000
+
+static void initialize(fmi2Real reals[])
+{
+    for (size_t i = 0; i < 2 * N_INPUTS; i++)
+    {
+        reals[i] = (fmi2Real)i;
+    }
+}
+
+static void do_step(fmi2Real time, fmi2Real step_size, fmi2Real reals[])
+{
+    (void)time;
+    (void)step_size;
+    for (size_t i = 0; i < N_INPUTS; i++)
+    {
+        reals[N_INPUTS + i] = 2.0 * reals[i];
+    }
+}
+
+const reference_model reference_model_definition = {
+    .n_reals = 2 * N_INPUTS,
+    .initialize = initialize,
+    .do_step = do_step};
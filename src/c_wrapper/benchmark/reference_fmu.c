@@ -0,0 +1,275 @@
+#include "reference_fmu.h"
+#include <string.h>
+
+typedef struct reference_instance
+{
+    const reference_model *model;
+    fmi2CallbackFunctions callbacks;
+    /*! Allocated via the callbacks of the environment. */
+    char *instance_name;
+    fmi2Real *reals;
+    fmi2Boolean logging_on;
+    fmi2Real time;
+} reference_instance;
+
+/* Declare the exported functions with the types of the standard so the signatures are checked. */
+REFERENCE_EXPORT fmi2GetTypesPlatformTYPE fmi2GetTypesPlatform;
+REFERENCE_EXPORT fmi2GetVersionTYPE fmi2GetVersion;
+REFERENCE_EXPORT fmi2SetDebugLoggingTYPE fmi2SetDebugLogging;
+REFERENCE_EXPORT fmi2InstantiateTYPE fmi2Instantiate;
+REFERENCE_EXPORT fmi2FreeInstanceTYPE fmi2FreeInstance;
+REFERENCE_EXPORT fmi2SetupExperimentTYPE fmi2SetupExperiment;
+REFERENCE_EXPORT fmi2EnterInitializationModeTYPE fmi2EnterInitializationMode;
+REFERENCE_EXPORT fmi2ExitInitializationModeTYPE fmi2ExitInitializationMode;
+REFERENCE_EXPORT fmi2TerminateTYPE fmi2Terminate;
+REFERENCE_EXPORT fmi2ResetTYPE fmi2Reset;
+REFERENCE_EXPORT fmi2GetRealTYPE fmi2GetReal;
+REFERENCE_EXPORT fmi2SetRealTYPE fmi2SetReal;
+REFERENCE_EXPORT fmi2DoStepTYPE fmi2DoStep;
+REFERENCE_EXPORT fmi2EnterEventModeTYPE fmi2EnterEventMode;
+REFERENCE_EXPORT fmi2NewDiscreteStatesTYPE fmi2NewDiscreteStates;
+REFERENCE_EXPORT fmi2EnterContinuousTimeModeTYPE fmi2EnterContinuousTimeMode;
+REFERENCE_EXPORT fmi2CompletedIntegratorStepTYPE fmi2CompletedIntegratorStep;
+REFERENCE_EXPORT fmi2SetTimeTYPE fmi2SetTime;
+REFERENCE_EXPORT fmi2SetContinuousStatesTYPE fmi2SetContinuousStates;
+REFERENCE_EXPORT fmi2GetDerivativesTYPE fmi2GetDerivatives;
+REFERENCE_EXPORT fmi2GetEventIndicatorsTYPE fmi2GetEventIndicators;
+REFERENCE_EXPORT fmi2GetContinuousStatesTYPE fmi2GetContinuousStates;
+REFERENCE_EXPORT fmi2GetNominalsOfContinuousStatesTYPE fmi2GetNominalsOfContinuousStates;
+
+const char *fmi2GetTypesPlatform(void)
+{
+    return fmi2TypesPlatform;
+}
+
+const char *fmi2GetVersion(void)
+{
+    return "2.0";
+}
+
+fmi2Status fmi2SetDebugLogging(fmi2Component component, fmi2Boolean logging_on, size_t n_categories, const fmi2String categories[])
+{
+    (void)n_categories;
+    (void)categories;
+    ((reference_instance *)component)->logging_on = logging_on;
+    return fmi2OK;
+}
+
+fmi2Component fmi2Instantiate(fmi2String instance_name, fmi2Type fmu_type, fmi2String guid, fmi2String resource_location,
+                              const fmi2CallbackFunctions *functions, fmi2Boolean visible, fmi2Boolean logging_on)
+{
+    (void)guid;
+    (void)resource_location;
+    (void)visible;
+    const reference_model *model = &reference_model_definition;
+    if (fmu_type == fmi2CoSimulation && model->do_step == NULL)
+    {
+        return NULL;
+    }
+    reference_instance *instance = functions->allocateMemory(1, sizeof(reference_instance));
+    if (instance == NULL)
+    {
+        return NULL;
+    }
+    instance->model = model;
+    memcpy((void *)&instance->callbacks, functions, sizeof(fmi2CallbackFunctions));
+    instance->logging_on = logging_on;
+    instance->instance_name = functions->allocateMemory(strlen(instance_name) + 1, sizeof(char));
+    instance->reals = functions->allocateMemory(model->n_reals, sizeof(fmi2Real));
+    if (instance->instance_name == NULL || instance->reals == NULL)
+    {
+        fmi2FreeInstance(instance);
+        return NULL;
+    }
+    strcpy(instance->instance_name, instance_name);
+    model->initialize(instance->reals);
+    return instance;
+}
+
+void fmi2FreeInstance(fmi2Component component)
+{
+    reference_instance *instance = component;
+    instance->callbacks.freeMemory(instance->instance_name);
+    instance->callbacks.freeMemory(instance->reals);
+    instance->callbacks.freeMemory(instance);
+}
+
+fmi2Status fmi2SetupExperiment(fmi2Component component, fmi2Boolean tolerance_defined, fmi2Real tolerance, fmi2Real start_time,
+                               fmi2Boolean stop_time_defined, fmi2Real stop_time)
+{
+    (void)tolerance_defined;
+    (void)tolerance;
+    (void)stop_time_defined;
+    (void)stop_time;
+    ((reference_instance *)component)->time = start_time;
+    return fmi2OK;
+}
+
+fmi2Status fmi2EnterInitializationMode(fmi2Component component)
+{
+    (void)component;
+    return fmi2OK;
+}
+
+fmi2Status fmi2ExitInitializationMode(fmi2Component component)
+{
+    (void)component;
+    return fmi2OK;
+}
+
+fmi2Status fmi2Terminate(fmi2Component component)
+{
+    (void)component;
+    return fmi2OK;
+}
+
+fmi2Status fmi2Reset(fmi2Component component)
+{
+    reference_instance *instance = component;
+    instance->time = 0;
+    instance->model->initialize(instance->reals);
+    return fmi2OK;
+}
+
+fmi2Status fmi2GetReal(fmi2Component component, const fmi2ValueReference vr[], size_t nvr, fmi2Real value[])
+{
+    reference_instance *instance = component;
+    for (size_t i = 0; i < nvr; i++)
+    {
+        if (vr[i] >= instance->model->n_reals)
+        {
+            return fmi2Error;
+        }
+        value[i] = instance->reals[vr[i]];
+    }
+    return fmi2OK;
+}
+
+fmi2Status fmi2SetReal(fmi2Component component, const fmi2ValueReference vr[], size_t nvr, const fmi2Real value[])
+{
+    reference_instance *instance = component;
+    for (size_t i = 0; i < nvr; i++)
+    {
+        if (vr[i] >= instance->model->n_reals)
+        {
+            return fmi2Error;
+        }
+        instance->reals[vr[i]] = value[i];
+    }
+    return fmi2OK;
+}
+
+fmi2Status fmi2DoStep(fmi2Component component, fmi2Real current_communication_point, fmi2Real communication_step_size,
+                      fmi2Boolean no_set_fmu_state_prior_to_current_point)
+{
+    (void)no_set_fmu_state_prior_to_current_point;
+    reference_instance *instance = component;
+    instance->model->do_step(current_communication_point, communication_step_size, instance->reals);
+    instance->time = current_communication_point + communication_step_size;
+    if (instance->logging_on)
+    {
+        // A typical debug message, used to measure the cost of logging
+        instance->callbacks.logger(instance->callbacks.componentEnvironment, instance->instance_name, fmi2OK, "logStep",
+                                   "Completed the step from %g to %g", current_communication_point, instance->time);
+    }
+    return fmi2OK;
+}
+
+fmi2Status fmi2EnterEventMode(fmi2Component component)
+{
+    (void)component;
+    return fmi2OK;
+}
+
+fmi2Status fmi2NewDiscreteStates(fmi2Component component, fmi2EventInfo *event_info)
+{
+    reference_instance *instance = component;
+    memset(event_info, 0, sizeof(fmi2EventInfo));
+    if (instance->model->update_discrete_states != NULL)
+    {
+        instance->model->update_discrete_states(instance->time, instance->reals, event_info);
+    }
+    return fmi2OK;
+}
+
+fmi2Status fmi2EnterContinuousTimeMode(fmi2Component component)
+{
+    (void)component;
+    return fmi2OK;
+}
+
+fmi2Status fmi2CompletedIntegratorStep(fmi2Component component, fmi2Boolean no_set_fmu_state_prior_to_current_point,
+                                       fmi2Boolean *enter_event_mode, fmi2Boolean *terminate_simulation)
+{
+    (void)component;
+    (void)no_set_fmu_state_prior_to_current_point;
+    *enter_event_mode = fmi2False;
+    *terminate_simulation = fmi2False;
+    return fmi2OK;
+}
+
+fmi2Status fmi2SetTime(fmi2Component component, fmi2Real time)
+{
+    ((reference_instance *)component)->time = time;
+    return fmi2OK;
+}
+
+fmi2Status fmi2SetContinuousStates(fmi2Component component, const fmi2Real x[], size_t nx)
+{
+    reference_instance *instance = component;
+    if (nx != instance->model->n_states)
+    {
+        return fmi2Error;
+    }
+    memcpy(instance->reals, x, nx * sizeof(fmi2Real));
+    return fmi2OK;
+}
+
+fmi2Status fmi2GetDerivatives(fmi2Component component, fmi2Real derivatives[], size_t nx)
+{
+    reference_instance *instance = component;
+    if (nx != instance->model->n_states)
+    {
+        return fmi2Error;
+    }
+    if (nx > 0)
+    {
+        instance->model->get_derivatives(instance->time, instance->reals, derivatives);
+    }
+    return fmi2OK;
+}
+
+fmi2Status fmi2GetEventIndicators(fmi2Component component, fmi2Real event_indicators[], size_t ni)
+{
+    reference_instance *instance = component;
+    if (ni != instance->model->n_event_indicators)
+    {
+        return fmi2Error;
+    }
+    if (ni > 0)
+    {
+        instance->model->get_event_indicators(instance->time, instance->reals, event_indicators);
+    }
+    return fmi2OK;
+}
+
+fmi2Status fmi2GetContinuousStates(fmi2Component component, fmi2Real x[], size_t nx)
+{
+    reference_instance *instance = component;
+    if (nx != instance->model->n_states)
+    {
+        return fmi2Error;
+    }
+    memcpy(x, instance->reals, nx * sizeof(fmi2Real));
+    return fmi2OK;
+}
+
+fmi2Status fmi2GetNominalsOfContinuousStates(fmi2Component component, fmi2Real x_nominal[], size_t nx)
+{
+    (void)component;
+    for (size_t i = 0; i < nx; i++)
+    {
+        x_nominal[i] = 1.0;
+    }
+    return fmi2OK;
+}
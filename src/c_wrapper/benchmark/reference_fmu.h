@@ -0,0 +1,39 @@
+#pragma once
+#include "fmi2FunctionTypes.h"
+#include <stddef.h>
+
+/*!
+    \brief The shared implementation of the fmi2 functions of the reference fmus of the benchmark.
+    Each reference fmu is this file linked with one model that defines reference_model_definition.
+    All variables are reals, their value references are their indices. The continuous states come first.
+*/
+
+/* Definition of macro to export the fmi2 functions. */
+#if defined _WIN32 || defined __CYGWIN__
+#define REFERENCE_EXPORT __declspec(dllexport)
+#elif __GNUC__ >= 4
+#define REFERENCE_EXPORT __attribute__((visibility("default")))
+#else
+#define REFERENCE_EXPORT
+#endif
+
+/*! The equations of a reference model. The functions get all reals of the instance, the models keep their discrete state there too. */
+typedef struct reference_model
+{
+    size_t n_reals;
+    size_t n_states;
+    size_t n_event_indicators;
+    /*! Set the start values. */
+    void (*initialize)(fmi2Real reals[]);
+    /*! The co-simulation step. NULL if the model only supports Model Exchange. */
+    void (*do_step)(fmi2Real time, fmi2Real step_size, fmi2Real reals[]);
+    /*! May be NULL for models without states. */
+    void (*get_derivatives)(fmi2Real time, const fmi2Real reals[], fmi2Real derivatives[]);
+    /*! May be NULL for models without event indicators. */
+    void (*get_event_indicators)(fmi2Real time, const fmi2Real reals[], fmi2Real indicators[]);
+    /*! Handle the events at the time and request the next time event. May be NULL for models without events. */
+    void (*update_discrete_states)(fmi2Real time, fmi2Real reals[], fmi2EventInfo *event_info);
+} reference_model;
+
+/*! Defined by the model. */
+extern const reference_model reference_model_definition;
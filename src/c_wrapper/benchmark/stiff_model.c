@@ -0,0 +1,30 @@
+#include "reference_fmu.h"
+
+/*!
+    The chemical reaction of Robertson, a classic stiff problem whose rate constants span nine orders of magnitude.
+    Model Exchange only, measures the implicit solver.
+*/
+
+static void initialize(fmi2Real reals[])
+{
+    reals[0] = 1.0;
+    reals[1] = 0.0;
+    reals[2] = 0.0;
+}
+
+static void get_derivatives(fmi2Real time, const fmi2Real reals[], fmi2Real derivatives[])
+{
+    (void)time;
+    fmi2Real slow = 0.04 * reals[0];
+    fmi2Real medium = 1.0e4 * reals[1] * reals[2];
+    fmi2Real fast = 3.0e7 * reals[1] * reals[1];
+    derivatives[0] = -slow + medium;
+    derivatives[1] = slow - medium - fast;
+    derivatives[2] = fast;
+}
+
+const reference_model reference_model_definition = {
+    .n_reals = 3,
+    .n_states = 3,
+    .initialize = initialize,
+    .get_derivatives = get_derivatives};
@@ -0,0 +1,21 @@
+#include "reference_fmu.h"
+
+/*! The smallest possible model: the output follows the input. Measures the fixed cost per call. */
+
+static void initialize(fmi2Real reals[])
+{
+    reals[0] = 0.0;
+    reals[1] = 0.0;
+}
+
+static void do_step(fmi2Real time, fmi2Real step_size, fmi2Real reals[])
+{
+    (void)time;
+    (void)step_size;
+    reals[1] = reals[0];
+}
+
+const reference_model reference_model_definition = {
+    .n_reals = 2,
+    .initialize = initialize,
+    .do_step = do_step};
@@ -0,0 +1,123 @@
+#include "call_statistics.h"
+
+/*! Each power of two is split into 2^SUB_BUCKET_BITS linear buckets. */
+#define SUB_BUCKET_BITS 3
+#define SUB_BUCKETS (1 << SUB_BUCKET_BITS)
+
+/*! Indexed by fmu_function. */
+static const char *const FUNCTION_NAMES[fmu_function_count] = {
+    "fmi2SetDebugLogging",
+    "fmi2SetupExperiment",
+    "fmi2EnterInitializationMode",
+    "fmi2ExitInitializationMode",
+    "fmi2Terminate",
+    "fmi2Reset",
+    "fmi2GetReal",
+    "fmi2GetInteger",
+    "fmi2GetBoolean",
+    "fmi2GetString",
+    "fmi2SetReal",
+    "fmi2SetInteger",
+    "fmi2SetBoolean",
+    "fmi2SetString",
+    "fmi2GetFMUstate",
+    "fmi2SetFMUstate",
+    "fmi2FreeFMUstate",
+    "fmi2SerializedFMUstateSize",
+    "fmi2SerializeFMUstate",
+    "fmi2DeSerializeFMUstate",
+    "fmi2GetDirectionalDerivative",
+    "fmi2EnterEventMode",
+    "fmi2NewDiscreteStates",
+    "fmi2EnterContinuousTimeMode",
+    "fmi2CompletedIntegratorStep",
+    "fmi2SetTime",
+    "fmi2SetContinuousStates",
+    "fmi2GetDerivatives",
+    "fmi2GetEventIndicators",
+    "fmi2GetContinuousStates",
+    "fmi2GetNominalsOfContinuousStates",
+    "fmi2SetRealInputDerivatives",
+    "fmi2GetRealOutputDerivatives",
+    "fmi2DoStep",
+    "fmi2CancelStep",
+    "fmi2GetStatus",
+    "fmi2GetRealStatus",
+    "fmi2GetIntegerStatus",
+    "fmi2GetBooleanStatus",
+    "fmi2GetStringStatus"};
+
+size_t get_latency_bucket(uint64_t latency_ns)
+{
+    if (latency_ns < SUB_BUCKETS)
+    {
+        return (size_t)latency_ns;
+    }
+    // The position of the highest bit selects the power of two, the next bits the linear bucket within it
+    unsigned int exponent = SUB_BUCKET_BITS;
+    while (exponent < 63 && (latency_ns >> (exponent + 1)) != 0)
+    {
+        exponent++;
+    }
+    size_t bucket = (size_t)(exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + (size_t)((latency_ns >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+    return bucket < LATENCY_HISTOGRAM_BUCKETS ? bucket : LATENCY_HISTOGRAM_BUCKETS - 1;
+}
+
+void record_call(call_statistics *statistics, uint64_t latency_ns)
+{
+    if (statistics->n_calls == 0 || latency_ns < statistics->min_ns)
+    {
+        statistics->min_ns = latency_ns;
+    }
+    if (latency_ns > statistics->max_ns)
+    {
+        statistics->max_ns = latency_ns;
+    }
+    statistics->n_calls++;
+    statistics->total_ns += latency_ns;
+    statistics->histogram[get_latency_bucket(latency_ns)]++;
+}
+
+PUBLIC_EXPORT const char *get_fmu_function_name(fmu_function function)
+{
+    if ((size_t)function >= fmu_function_count)
+    {
+        return NULL;
+    }
+    return FUNCTION_NAMES[function];
+}
+
+PUBLIC_EXPORT uint64_t get_latency_bucket_lower_bound(size_t bucket)
+{
+    if (bucket < SUB_BUCKETS)
+    {
+        return bucket;
+    }
+    if (bucket >= LATENCY_HISTOGRAM_BUCKETS)
+    {
+        bucket = LATENCY_HISTOGRAM_BUCKETS - 1;
+    }
+    size_t group = bucket / SUB_BUCKETS;
+    return (uint64_t)(SUB_BUCKETS + bucket % SUB_BUCKETS) << (group - 1);
+}
+
+PUBLIC_EXPORT uint64_t get_latency_percentile(const call_statistics *statistics, double percentile)
+{
+    if (statistics->n_calls == 0)
+    {
+        return 0;
+    }
+    // The rank of the call that the percentile refers to, at least the first one
+    double rank = percentile / 100.0 * (double)statistics->n_calls;
+    uint64_t count = 0;
+    for (size_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS - 1; i++)
+    {
+        count += statistics->histogram[i];
+        if (count > 0 && (double)count >= rank)
+        {
+            uint64_t upper_bound = get_latency_bucket_lower_bound(i + 1) - 1;
+            return upper_bound < statistics->max_ns ? upper_bound : statistics->max_ns;
+        }
+    }
+    return statistics->max_ns;
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include "fmi_wrapper.h"
+
+/*!
+    \brief Recording of the latency histograms of the call statistics, see set_call_statistics.
+    The histograms are not synchronized, the standard forbids concurrent calls of an instance.
+*/
+
+/*! Count a call with the latency in nanoseconds. */
+void record_call(call_statistics *statistics, uint64_t latency_ns);
+/*! The bucket of the histogram that counts the latency. */
+size_t get_latency_bucket(uint64_t latency_ns);
@@ -0,0 +1,485 @@
+#include "cosim_master.h"
+#include "system_functions.h"
+#include <stdlib.h>
+
+/*! The buffers of the connected values are grouped by type, these are their indices. */
+#define COSIM_REAL 0
+#define COSIM_INTEGER 1
+#define COSIM_BOOLEAN 2
+#define COSIM_TYPES 3
+/*! Iterations the threads spin before they sleep, the steps of small fmus are shorter than waking a thread. */
+#define COSIM_SPIN_COUNT 20000
+
+typedef struct cosim_node
+{
+    wrapped_fmu *instance;
+    signal_group *outputs;
+    signal_group *inputs;
+    /*! The ranges of the values of the instance in the buffers of each type. */
+    size_t output_offset[COSIM_TYPES];
+    size_t n_outputs[COSIM_TYPES];
+    size_t input_offset[COSIM_TYPES];
+    size_t n_inputs[COSIM_TYPES];
+    fmi2Status status;
+} cosim_node;
+
+/*! One end of a connection, sorted by type, instance and value reference to group the buffers. */
+typedef struct cosim_endpoint
+{
+    size_t type;
+    size_t instance;
+    fmi2ValueReference vr;
+    size_t connection;
+} cosim_endpoint;
+
+struct cosim_master
+{
+    cosim_scheme scheme;
+    size_t n_nodes;
+    cosim_node *nodes;
+    size_t n_outputs[COSIM_TYPES];
+    size_t n_inputs[COSIM_TYPES];
+    fmi2Real *real_outputs;
+    fmi2Real *real_inputs;
+    fmi2Integer *integer_outputs;
+    fmi2Integer *integer_inputs;
+    fmi2Boolean *boolean_outputs;
+    fmi2Boolean *boolean_inputs;
+    /*! For each input the index of the connected output, the inputs of all types one after another. */
+    size_t *sources;
+    /*! The index of the first input of each type in sources. */
+    size_t input_base[COSIM_TYPES];
+    /*! The arguments of the running step. */
+    fmi2Real time;
+    fmi2Real step_size;
+    /*! The threads of the jacobi scheme besides the calling thread. */
+    size_t n_threads;
+    system_thread *threads;
+    system_mutex mutex;
+    system_condition start_condition;
+    system_condition done_condition;
+    bool synchronized;
+    /*! Incremented for each parallel step, the threads wait for it to change. */
+    volatile size_t generation;
+    /*! The next instance to be taken by a thread. */
+    volatile size_t next_node;
+    volatile size_t n_done;
+    volatile size_t stopping;
+};
+
+/*! Returns the more severe of both status values. */
+static fmi2Status worst_status(fmi2Status first, fmi2Status second)
+{
+    return first > second ? first : second;
+}
+
+static bool get_type_index(variable_type type, size_t *index)
+{
+    switch (type)
+    {
+    case variable_real:
+        *index = COSIM_REAL;
+        return true;
+    case variable_integer:
+    case variable_enumeration:
+        *index = COSIM_INTEGER;
+        return true;
+    case variable_boolean:
+        *index = COSIM_BOOLEAN;
+        return true;
+    default:
+        return false;
+    }
+}
+
+static int compare_endpoints(const void *first, const void *second)
+{
+    const cosim_endpoint *a = first;
+    const cosim_endpoint *b = second;
+    if (a->type != b->type)
+    {
+        return a->type < b->type ? -1 : 1;
+    }
+    if (a->instance != b->instance)
+    {
+        return a->instance < b->instance ? -1 : 1;
+    }
+    return a->vr < b->vr ? -1 : a->vr > b->vr;
+}
+
+/*! Number the distinct outputs and the inputs, allocate the buffers and register the signal groups of the instances. */
+static bool connect_instances(cosim_master *master, const cosim_connection connections[], size_t n_connections)
+{
+    // Allocate at least one element so NULL always means out of memory
+    size_t n = n_connections > 0 ? n_connections : 1;
+    cosim_endpoint *outputs = malloc(n * sizeof(cosim_endpoint));
+    cosim_endpoint *inputs = malloc(n * sizeof(cosim_endpoint));
+    size_t *output_index = malloc(n * sizeof(size_t));
+    fmi2ValueReference *output_vr = malloc(n * sizeof(fmi2ValueReference));
+    fmi2ValueReference *input_vr = malloc(n * sizeof(fmi2ValueReference));
+    master->sources = malloc(n * sizeof(size_t));
+    bool valid = outputs != NULL && inputs != NULL && output_index != NULL && output_vr != NULL && input_vr != NULL && master->sources != NULL;
+    for (size_t i = 0; i < n_connections && valid; i++)
+    {
+        const cosim_connection *connection = &connections[i];
+        size_t type = 0;
+        valid = get_type_index(connection->type, &type) && connection->source_instance < master->n_nodes && connection->target_instance < master->n_nodes;
+        if (!valid)
+        {
+            break;
+        }
+        cosim_endpoint output = {type, connection->source_instance, connection->source_vr, i};
+        cosim_endpoint input = {type, connection->target_instance, connection->target_vr, i};
+        outputs[i] = output;
+        inputs[i] = input;
+    }
+    if (valid)
+    {
+        qsort(outputs, n_connections, sizeof(cosim_endpoint), compare_endpoints);
+        qsort(inputs, n_connections, sizeof(cosim_endpoint), compare_endpoints);
+    }
+    // An output that is connected to several inputs is read once
+    size_t n_distinct = 0;
+    for (size_t i = 0; i < n_connections && valid; i++)
+    {
+        const cosim_endpoint *output = &outputs[i];
+        if (i == 0 || compare_endpoints(&outputs[i - 1], output) != 0)
+        {
+            output_vr[n_distinct++] = output->vr;
+            master->nodes[output->instance].n_outputs[output->type]++;
+            master->n_outputs[output->type]++;
+        }
+        output_index[output->connection] = master->n_outputs[output->type] - 1;
+    }
+    for (size_t i = 0; i < n_connections && valid; i++)
+    {
+        const cosim_endpoint *input = &inputs[i];
+        // An input can only get its value from one output
+        valid = i == 0 || compare_endpoints(&inputs[i - 1], input) != 0;
+        input_vr[i] = input->vr;
+        master->sources[i] = output_index[input->connection];
+        master->nodes[input->instance].n_inputs[input->type]++;
+        master->n_inputs[input->type]++;
+    }
+    if (valid)
+    {
+        master->real_outputs = calloc(master->n_outputs[COSIM_REAL] + 1, sizeof(fmi2Real));
+        master->real_inputs = calloc(master->n_inputs[COSIM_REAL] + 1, sizeof(fmi2Real));
+        master->integer_outputs = calloc(master->n_outputs[COSIM_INTEGER] + 1, sizeof(fmi2Integer));
+        master->integer_inputs = calloc(master->n_inputs[COSIM_INTEGER] + 1, sizeof(fmi2Integer));
+        master->boolean_outputs = calloc(master->n_outputs[COSIM_BOOLEAN] + 1, sizeof(fmi2Boolean));
+        master->boolean_inputs = calloc(master->n_inputs[COSIM_BOOLEAN] + 1, sizeof(fmi2Boolean));
+        valid = master->real_outputs != NULL && master->real_inputs != NULL && master->integer_outputs != NULL &&
+                master->integer_inputs != NULL && master->boolean_outputs != NULL && master->boolean_inputs != NULL;
+    }
+    // The endpoints are sorted by type first, so the value references of each type follow each other
+    size_t output_base[COSIM_TYPES];
+    size_t output_offset[COSIM_TYPES] = {0};
+    size_t input_offset[COSIM_TYPES] = {0};
+    for (size_t type = 0; type < COSIM_TYPES; type++)
+    {
+        output_base[type] = type > 0 ? output_base[type - 1] + master->n_outputs[type - 1] : 0;
+        master->input_base[type] = type > 0 ? master->input_base[type - 1] + master->n_inputs[type - 1] : 0;
+    }
+    for (size_t i = 0; i < master->n_nodes && valid; i++)
+    {
+        cosim_node *node = &master->nodes[i];
+        for (size_t type = 0; type < COSIM_TYPES; type++)
+        {
+            node->output_offset[type] = output_offset[type];
+            node->input_offset[type] = input_offset[type];
+            output_offset[type] += node->n_outputs[type];
+            input_offset[type] += node->n_inputs[type];
+        }
+        node->outputs = create_signal_group(node->n_outputs[COSIM_REAL], output_vr + output_base[COSIM_REAL] + node->output_offset[COSIM_REAL],
+                                            node->n_outputs[COSIM_INTEGER], output_vr + output_base[COSIM_INTEGER] + node->output_offset[COSIM_INTEGER],
+                                            node->n_outputs[COSIM_BOOLEAN], output_vr + output_base[COSIM_BOOLEAN] + node->output_offset[COSIM_BOOLEAN]);
+        node->inputs = create_signal_group(node->n_inputs[COSIM_REAL], input_vr + master->input_base[COSIM_REAL] + node->input_offset[COSIM_REAL],
+                                           node->n_inputs[COSIM_INTEGER], input_vr + master->input_base[COSIM_INTEGER] + node->input_offset[COSIM_INTEGER],
+                                           node->n_inputs[COSIM_BOOLEAN], input_vr + master->input_base[COSIM_BOOLEAN] + node->input_offset[COSIM_BOOLEAN]);
+        valid = node->outputs != NULL && node->inputs != NULL;
+    }
+    free(outputs);
+    free(inputs);
+    free(output_index);
+    free(output_vr);
+    free(input_vr);
+    return valid;
+}
+
+/*! Copy the connected outputs into the input buffers of the instance. */
+static void copy_inputs(cosim_master *master, const cosim_node *node)
+{
+    const size_t *sources = master->sources + master->input_base[COSIM_REAL];
+    for (size_t i = node->input_offset[COSIM_REAL]; i < node->input_offset[COSIM_REAL] + node->n_inputs[COSIM_REAL]; i++)
+    {
+        master->real_inputs[i] = master->real_outputs[sources[i]];
+    }
+    sources = master->sources + master->input_base[COSIM_INTEGER];
+    for (size_t i = node->input_offset[COSIM_INTEGER]; i < node->input_offset[COSIM_INTEGER] + node->n_inputs[COSIM_INTEGER]; i++)
+    {
+        master->integer_inputs[i] = master->integer_outputs[sources[i]];
+    }
+    sources = master->sources + master->input_base[COSIM_BOOLEAN];
+    for (size_t i = node->input_offset[COSIM_BOOLEAN]; i < node->input_offset[COSIM_BOOLEAN] + node->n_inputs[COSIM_BOOLEAN]; i++)
+    {
+        master->boolean_inputs[i] = master->boolean_outputs[sources[i]];
+    }
+}
+
+static fmi2Status read_node_outputs(cosim_master *master, cosim_node *node)
+{
+    return group_get(node->instance, node->outputs, master->real_outputs + node->output_offset[COSIM_REAL],
+                     master->integer_outputs + node->output_offset[COSIM_INTEGER], master->boolean_outputs + node->output_offset[COSIM_BOOLEAN]);
+}
+
+/*! Set the inputs, step and read the outputs of the instance. The inputs must have been copied before. */
+static void step_node(cosim_master *master, cosim_node *node)
+{
+    fmi2Status status = group_set(node->instance, node->inputs, master->real_inputs + node->input_offset[COSIM_REAL],
+                                  master->integer_inputs + node->input_offset[COSIM_INTEGER], master->boolean_inputs + node->input_offset[COSIM_BOOLEAN]);
+    if (status <= fmi2Warning)
+    {
+        status = worst_status(status, do_step(node->instance, master->time, master->step_size, fmi2True));
+    }
+    if (status <= fmi2Warning)
+    {
+        status = worst_status(status, read_node_outputs(master, node));
+    }
+    node->status = status;
+}
+
+/*! Take instances of the running parallel step until all have been taken. */
+static void step_parallel_nodes(cosim_master *master)
+{
+    size_t index;
+    while ((index = atomicIncrement(&master->next_node) - 1) < master->n_nodes)
+    {
+        step_node(master, &master->nodes[index]);
+        if (atomicIncrement(&master->n_done) == master->n_nodes)
+        {
+            lockMutex(&master->mutex);
+            broadcastCondition(&master->done_condition);
+            unlockMutex(&master->mutex);
+        }
+    }
+}
+
+static void run_thread(void *argument)
+{
+    cosim_master *master = argument;
+    size_t generation = 0;
+    while (true)
+    {
+        for (size_t i = 0; i < COSIM_SPIN_COUNT && atomicLoad(&master->generation) == generation && !atomicLoad(&master->stopping); i++)
+        {
+        }
+        lockMutex(&master->mutex);
+        while (master->generation == generation && !master->stopping)
+        {
+            waitCondition(&master->start_condition, &master->mutex);
+        }
+        generation = master->generation;
+        bool stopping = master->stopping;
+        unlockMutex(&master->mutex);
+        if (stopping)
+        {
+            return;
+        }
+        step_parallel_nodes(master);
+    }
+}
+
+/*! Start the threads of the jacobi scheme, the master works with a single thread if they can not be started. */
+static void start_threads(cosim_master *master, size_t n_threads)
+{
+    if (n_threads == 0)
+    {
+        n_threads = getProcessorCount();
+    }
+    if (n_threads > master->n_nodes)
+    {
+        n_threads = master->n_nodes;
+    }
+    if (master->scheme != cosim_jacobi || n_threads < 2)
+    {
+        return;
+    }
+    master->threads = calloc(n_threads - 1, sizeof(system_thread));
+    if (master->threads == NULL)
+    {
+        return;
+    }
+    initMutex(&master->mutex);
+    initCondition(&master->start_condition);
+    initCondition(&master->done_condition);
+    master->synchronized = true;
+    while (master->n_threads < n_threads - 1 && createThread(&master->threads[master->n_threads], run_thread, master) == 0)
+    {
+        master->n_threads++;
+    }
+}
+
+PUBLIC_EXPORT cosim_master *create_cosim_master(wrapped_fmu *const instances[], size_t n_instances, const cosim_connection connections[],
+                                                size_t n_connections, cosim_scheme scheme, size_t n_threads)
+{
+    if (n_instances == 0 || instances == NULL || (n_connections > 0 && connections == NULL) || (scheme != cosim_gauss_seidel && scheme != cosim_jacobi))
+    {
+        return NULL;
+    }
+    for (size_t i = 0; i < n_instances; i++)
+    {
+        if (instances[i] == NULL)
+        {
+            return NULL;
+        }
+    }
+    cosim_master *master = calloc(1, sizeof(cosim_master));
+    if (master == NULL)
+    {
+        return NULL;
+    }
+    master->scheme = scheme;
+    master->n_nodes = n_instances;
+    master->nodes = calloc(n_instances, sizeof(cosim_node));
+    if (master->nodes == NULL || !connect_instances(master, connections, n_connections))
+    {
+        free_cosim_master(master);
+        return NULL;
+    }
+    for (size_t i = 0; i < n_instances; i++)
+    {
+        master->nodes[i].instance = instances[i];
+        master->nodes[i].status = fmi2OK;
+    }
+    if (cosim_master_read_outputs(master) > fmi2Warning)
+    {
+        free_cosim_master(master);
+        return NULL;
+    }
+    start_threads(master, n_threads);
+    return master;
+}
+
+PUBLIC_EXPORT void free_cosim_master(cosim_master *master)
+{
+    if (master == NULL)
+    {
+        return;
+    }
+    if (master->synchronized)
+    {
+        lockMutex(&master->mutex);
+        atomicStore(&master->stopping, 1);
+        broadcastCondition(&master->start_condition);
+        unlockMutex(&master->mutex);
+        for (size_t i = 0; i < master->n_threads; i++)
+        {
+            joinThread(master->threads[i]);
+        }
+        destroyCondition(&master->start_condition);
+        destroyCondition(&master->done_condition);
+        destroyMutex(&master->mutex);
+    }
+    if (master->nodes != NULL)
+    {
+        for (size_t i = 0; i < master->n_nodes; i++)
+        {
+            free_signal_group(master->nodes[i].outputs);
+            free_signal_group(master->nodes[i].inputs);
+        }
+    }
+    free(master->threads);
+    free(master->nodes);
+    free(master->sources);
+    free(master->real_outputs);
+    free(master->real_inputs);
+    free(master->integer_outputs);
+    free(master->integer_inputs);
+    free(master->boolean_outputs);
+    free(master->boolean_inputs);
+    free(master);
+}
+
+PUBLIC_EXPORT fmi2Status cosim_master_read_outputs(cosim_master *master)
+{
+    fmi2Status result = fmi2OK;
+    for (size_t i = 0; i < master->n_nodes; i++)
+    {
+        cosim_node *node = &master->nodes[i];
+        node->status = read_node_outputs(master, node);
+        result = worst_status(result, node->status);
+    }
+    return result;
+}
+
+PUBLIC_EXPORT fmi2Status cosim_master_do_step(cosim_master *master, fmi2Real current_communication_point, fmi2Real communication_step_size)
+{
+    master->time = current_communication_point;
+    master->step_size = communication_step_size;
+    fmi2Status result = fmi2OK;
+    if (master->scheme == cosim_gauss_seidel)
+    {
+        for (size_t i = 0; i < master->n_nodes && result <= fmi2Warning; i++)
+        {
+            copy_inputs(master, &master->nodes[i]);
+            step_node(master, &master->nodes[i]);
+            result = worst_status(result, master->nodes[i].status);
+        }
+        return result;
+    }
+    // All inputs get the outputs of the previous step, so they are copied before any instance writes new outputs
+    for (size_t i = 0; i < master->n_nodes; i++)
+    {
+        copy_inputs(master, &master->nodes[i]);
+    }
+    atomicStore(&master->n_done, 0);
+    atomicStore(&master->next_node, 0);
+    if (master->n_threads > 0)
+    {
+        lockMutex(&master->mutex);
+        atomicStore(&master->generation, master->generation + 1);
+        broadcastCondition(&master->start_condition);
+        unlockMutex(&master->mutex);
+    }
+    // The calling thread takes instances as well
+    step_parallel_nodes(master);
+    if (master->n_threads > 0)
+    {
+        for (size_t i = 0; i < COSIM_SPIN_COUNT && atomicLoad(&master->n_done) < master->n_nodes; i++)
+        {
+        }
+        lockMutex(&master->mutex);
+        while (atomicLoad(&master->n_done) < master->n_nodes)
+        {
+            waitCondition(&master->done_condition, &master->mutex);
+        }
+        unlockMutex(&master->mutex);
+    }
+    for (size_t i = 0; i < master->n_nodes; i++)
+    {
+        result = worst_status(result, master->nodes[i].status);
+    }
+    return result;
+}
+
+PUBLIC_EXPORT fmi2Status cosim_master_do_steps(cosim_master *master, fmi2Real start_time, fmi2Real step_size, size_t n_steps, size_t *n_steps_done)
+{
+    fmi2Status result = fmi2OK;
+    size_t step = 0;
+    for (; step < n_steps && result <= fmi2Warning; step++)
+    {
+        result = worst_status(result, cosim_master_do_step(master, start_time + step * step_size, step_size));
+    }
+    if (n_steps_done != NULL)
+    {
+        // The failed step is not completed
+        *n_steps_done = result <= fmi2Warning ? step : step - 1;
+    }
+    return result;
+}
+
+PUBLIC_EXPORT fmi2Status cosim_master_get_instance_status(const cosim_master *master, size_t instance)
+{
+    return instance < master->n_nodes ? master->nodes[instance].status : fmi2Fatal;
+}
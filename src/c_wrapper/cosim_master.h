@@ -0,0 +1,62 @@
+#pragma once
+#include "fmi_wrapper.h"
+#include "model_description.h"
+
+/*!
+    \brief Couple co-simulation instances by connecting outputs to inputs and step them together.
+    The connected values are moved through buffers grouped by type, so each macro step calls one group_set of the
+    inputs, do_step and one group_get of the outputs per instance. The jacobi scheme steps the instances on a pool
+    of threads, so a macro step takes about as long as the slowest instance.
+*/
+
+typedef enum cosim_scheme
+{
+    /*! Step the instances one after another in their order, each gets the outputs of its predecessors of the same step. */
+    cosim_gauss_seidel,
+    /*! Step all instances in parallel, each gets the outputs of the previous step. */
+    cosim_jacobi
+} cosim_scheme;
+
+/*! Connects an output of one instance to an input of another instance or of the same instance. */
+typedef struct cosim_connection
+{
+    /*! The index of the instance in the array passed to create_cosim_master. */
+    size_t source_instance;
+    fmi2ValueReference source_vr;
+    size_t target_instance;
+    fmi2ValueReference target_vr;
+    /*! Strings are not supported, enumerations are exchanged as integers. */
+    variable_type type;
+} cosim_connection;
+
+typedef struct cosim_master cosim_master;
+
+/*!
+    \brief Create a master for initialized co-simulation instances and read their connected outputs.
+    The instances stay owned by the caller and must be freed after the master. With the jacobi scheme the instances
+    are stepped and their callbacks are called from the threads of the master.
+    \param n_threads The threads of the jacobi scheme including the calling thread. 0 uses one per processor.
+    The number is limited to the number of instances. Ignored by gauss_seidel.
+    \return NULL if a connection is invalid, an input is connected twice, reading the outputs failed or the resources
+    could not be allocated.
+*/
+PUBLIC_EXPORT cosim_master *create_cosim_master(wrapped_fmu *const instances[], size_t n_instances, const cosim_connection connections[],
+                                                size_t n_connections, cosim_scheme scheme, size_t n_threads);
+/*! \brief Stop the threads and release the master, the instances are not freed. */
+PUBLIC_EXPORT void free_cosim_master(cosim_master *master);
+/*! \brief Read the connected outputs of all instances again, e.g. after the caller has set values between the steps. */
+PUBLIC_EXPORT fmi2Status cosim_master_read_outputs(cosim_master *master);
+/*!
+    \brief Set the inputs from the connected outputs and step all instances once.
+    gauss_seidel stops at the first instance that returns an error, jacobi steps all instances.
+    \return The most severe status of all calls.
+*/
+PUBLIC_EXPORT fmi2Status cosim_master_do_step(cosim_master *master, fmi2Real current_communication_point, fmi2Real communication_step_size);
+/*!
+    \brief Do n_steps macro steps with a fixed step size, stops after the first step that returns an error.
+    \param n_steps_done Receives the number of completed steps. May be NULL.
+    \return The most severe status of all the calls.
+*/
+PUBLIC_EXPORT fmi2Status cosim_master_do_steps(cosim_master *master, fmi2Real start_time, fmi2Real step_size, size_t n_steps, size_t *n_steps_done);
+/*! \brief The most severe status of the calls of the instance in the last step, fmi2Fatal if the index is invalid. */
+PUBLIC_EXPORT fmi2Status cosim_master_get_instance_status(const cosim_master *master, size_t instance);
@@ -0,0 +1,276 @@
+#include "ensemble.h"
+#include "system_functions.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*! The runs a worker has not started yet. Owners take from the front, thieves split off the back. */
+typedef struct run_queue
+{
+    system_mutex mutex;
+    size_t begin;
+    size_t end;
+} run_queue;
+
+typedef struct ensemble_context
+{
+    const ensemble_spec *spec;
+    fmu_binary *binary;
+    /*! The outputs of the spec, NULL if there are none. */
+    signal_group *outputs;
+    size_t n_workers;
+    run_queue *queues;
+} ensemble_context;
+
+typedef struct ensemble_worker
+{
+    ensemble_context *context;
+    size_t id;
+    /*! Kept between runs if reset_instances is set. */
+    wrapped_fmu *instance;
+    fmi2Status status;
+} ensemble_worker;
+
+/*! Returns the more severe of both status values. */
+static fmi2Status worst_status(fmi2Status first, fmi2Status second)
+{
+    return first > second ? first : second;
+}
+
+/*! Take the next run of the worker's own queue or steal half of the remaining runs of another worker. */
+static bool take_run(ensemble_context *context, size_t id, size_t *run)
+{
+    run_queue *own = &context->queues[id];
+    lockMutex(&own->mutex);
+    bool found = own->begin < own->end;
+    if (found)
+    {
+        *run = own->begin++;
+    }
+    unlockMutex(&own->mutex);
+    // Try the victims in order starting after the own queue to spread the thieves
+    for (size_t offset = 1; offset < context->n_workers && !found; offset++)
+    {
+        run_queue *victim = &context->queues[(id + offset) % context->n_workers];
+        lockMutex(&victim->mutex);
+        size_t remaining = victim->end - victim->begin;
+        size_t stolen_begin = victim->end - (remaining + 1) / 2;
+        size_t stolen_end = victim->end;
+        victim->end = stolen_begin;
+        unlockMutex(&victim->mutex);
+        if (remaining > 0)
+        {
+            *run = stolen_begin;
+            lockMutex(&own->mutex);
+            own->begin = stolen_begin + 1;
+            own->end = stolen_end;
+            unlockMutex(&own->mutex);
+            found = true;
+        }
+    }
+    return found;
+}
+
+/*! Provide an initialized instance, either reset the one of the worker or instantiate a new one. */
+static wrapped_fmu *prepare_instance(ensemble_worker *worker, size_t run)
+{
+    const ensemble_spec *spec = worker->context->spec;
+    if (worker->instance != NULL && (!spec->reset_instances || reset(worker->instance) > fmi2Warning))
+    {
+        free_instance(worker->instance);
+        worker->instance = NULL;
+    }
+    if (worker->instance == NULL)
+    {
+        char name[256];
+        snprintf(name, sizeof(name), "%s_%lu", spec->instance_name != NULL ? spec->instance_name : "run", (unsigned long)run);
+        if (spec->pooled_memory)
+        {
+            worker->instance = instantiate_pooled(worker->context->binary, spec->log, NULL, name, fmi2CoSimulation,
+                                                  spec->fmu->description->guid, spec->fmu->resource_location, fmi2False, spec->logging_on);
+        }
+        else
+        {
+            worker->instance = instantiate_binary(worker->context->binary, spec->log, NULL, name, fmi2CoSimulation,
+                                                  spec->fmu->description->guid, spec->fmu->resource_location, fmi2False, spec->logging_on);
+        }
+    }
+    return worker->instance;
+}
+
+/*! Initialize and simulate a single run. */
+static fmi2Status simulate_run(ensemble_worker *worker, size_t run, size_t *n_steps_done)
+{
+    const ensemble_spec *spec = worker->context->spec;
+    *n_steps_done = 0;
+    wrapped_fmu *instance = prepare_instance(worker, run);
+    if (instance == NULL)
+    {
+        return fmi2Fatal;
+    }
+    size_t n_steps = spec->run_steps != NULL && spec->run_steps[run] < spec->n_steps ? spec->run_steps[run] : spec->n_steps;
+    fmi2Status status = setup_experiment(instance, fmi2False, 0, spec->start_time, fmi2True, spec->start_time + n_steps * spec->step_size);
+    if (status <= fmi2Warning && spec->n_parameters > 0)
+    {
+        status = worst_status(status, set_real(instance, spec->parameter_vr, spec->n_parameters, spec->parameters + run * spec->n_parameters));
+    }
+    if (status <= fmi2Warning)
+    {
+        status = worst_status(status, enter_initialization_mode(instance));
+    }
+    if (status <= fmi2Warning)
+    {
+        status = worst_status(status, exit_initialization_mode(instance));
+    }
+    bool initialized = status <= fmi2Warning;
+    if (initialized)
+    {
+        fmi2Real *outputs = spec->n_outputs > 0 ? spec->outputs + run * spec->n_steps * spec->n_outputs : NULL;
+        status = worst_status(status, do_steps(instance, spec->start_time, spec->step_size, n_steps, fmi2True, NULL, NULL, NULL, NULL,
+                                               worker->context->outputs, outputs, NULL, NULL, n_steps_done));
+    }
+    // Terminate is not allowed after errors
+    if (initialized && status <= fmi2Discard)
+    {
+        status = worst_status(status, terminate(instance));
+    }
+    // Instances in an undefined state can not be reset
+    if (!spec->reset_instances || status > fmi2Warning)
+    {
+        free_instance(instance);
+        worker->instance = NULL;
+    }
+    return status;
+}
+
+static void run_worker(void *argument)
+{
+    ensemble_worker *worker = argument;
+    const ensemble_spec *spec = worker->context->spec;
+    size_t run;
+    while (take_run(worker->context, worker->id, &run))
+    {
+        size_t n_steps_done;
+        fmi2Status status = simulate_run(worker, run, &n_steps_done);
+        worker->status = worst_status(worker->status, status);
+        if (spec->run_status != NULL)
+        {
+            spec->run_status[run] = status;
+        }
+        if (spec->run_steps_done != NULL)
+        {
+            spec->run_steps_done[run] = n_steps_done;
+        }
+    }
+    if (worker->instance != NULL)
+    {
+        free_instance(worker->instance);
+        worker->instance = NULL;
+    }
+}
+
+PUBLIC_EXPORT fmi2Boolean ensemble_needs_process_sharding(const fmu_archive *fmu)
+{
+    return fmu->description->co_simulation.can_be_instantiated_only_once_per_process;
+}
+
+PUBLIC_EXPORT fmi2Status run_ensemble(const ensemble_spec *spec, size_t n_threads)
+{
+    if (spec->fmu == NULL || (spec->n_parameters > 0 && (spec->parameter_vr == NULL || spec->parameters == NULL)) ||
+        (spec->n_outputs > 0 && (spec->output_vr == NULL || spec->outputs == NULL)) ||
+        (spec->n_shards > 1 && spec->shard_index >= spec->n_shards))
+    {
+        return fmi2Fatal;
+    }
+    // The block of runs of this shard
+    size_t first_run = 0;
+    size_t end_run = spec->n_runs;
+    if (spec->n_shards > 1)
+    {
+        first_run = spec->n_runs * spec->shard_index / spec->n_shards;
+        end_run = spec->n_runs * (spec->shard_index + 1) / spec->n_shards;
+    }
+    if (first_run == end_run)
+    {
+        return fmi2OK;
+    }
+    ensemble_context context = {0};
+    context.spec = spec;
+    bool single_instance = ensemble_needs_process_sharding(spec->fmu);
+    if (single_instance && spec->host_executable != NULL)
+    {
+        char *path = get_fmu_binary_path(spec->fmu, fmi2CoSimulation);
+        context.binary = path != NULL ? load_binary_out_of_process(spec->host_executable, path) : NULL;
+        free_fmu_string(path);
+    }
+    else
+    {
+        context.binary = load_fmu_binary(spec->fmu, fmi2CoSimulation);
+    }
+    if (context.binary == NULL)
+    {
+        return fmi2Fatal;
+    }
+    context.n_workers = n_threads > 0 ? n_threads : getProcessorCount();
+    if (single_instance && spec->host_executable == NULL)
+    {
+        context.n_workers = 1;
+    }
+    if (context.n_workers > end_run - first_run)
+    {
+        context.n_workers = end_run - first_run;
+    }
+    context.queues = calloc(context.n_workers, sizeof(run_queue));
+    ensemble_worker *workers = calloc(context.n_workers, sizeof(ensemble_worker));
+    system_thread *threads = calloc(context.n_workers, sizeof(system_thread));
+    if (spec->n_outputs > 0)
+    {
+        context.outputs = create_signal_group(spec->n_outputs, spec->output_vr, 0, NULL, 0, NULL);
+    }
+    if (context.queues == NULL || workers == NULL || threads == NULL || (spec->n_outputs > 0 && context.outputs == NULL))
+    {
+        free_signal_group(context.outputs);
+        free(context.queues);
+        free(workers);
+        free(threads);
+        free_binary(context.binary);
+        return fmi2Fatal;
+    }
+    // Start with contiguous blocks, stealing balances runs of different length
+    size_t n_runs = end_run - first_run;
+    for (size_t i = 0; i < context.n_workers; i++)
+    {
+        initMutex(&context.queues[i].mutex);
+        context.queues[i].begin = first_run + n_runs * i / context.n_workers;
+        context.queues[i].end = first_run + n_runs * (i + 1) / context.n_workers;
+        workers[i].context = &context;
+        workers[i].id = i;
+        workers[i].status = fmi2OK;
+    }
+    // The calling thread works as the first worker
+    size_t n_started = 1;
+    for (; n_started < context.n_workers; n_started++)
+    {
+        if (createThread(&threads[n_started], run_worker, &workers[n_started]) != 0)
+        {
+            // The started workers steal the runs of the missing ones
+            break;
+        }
+    }
+    run_worker(&workers[0]);
+    fmi2Status result = workers[0].status;
+    for (size_t i = 1; i < n_started; i++)
+    {
+        joinThread(threads[i]);
+        result = worst_status(result, workers[i].status);
+    }
+    for (size_t i = 0; i < context.n_workers; i++)
+    {
+        destroyMutex(&context.queues[i].mutex);
+    }
+    free_signal_group(context.outputs);
+    free(context.queues);
+    free(workers);
+    free(threads);
+    free_binary(context.binary);
+    return result;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "fmi_wrapper.h"
+#include "fmu_archive.h"
+
+/*!
+    \brief Run many co-simulations of one fmu in parallel, e.g. for parameter sweeps and Monte Carlo studies.
+    Each run instantiates the fmu, sets its row of the parameter matrix, initializes and simulates with a fixed step size.
+    The runs are distributed over a pool of worker threads that steal runs from each other when they run out of work.
+*/
+
+/*! Describes the runs of an ensemble and where the results go. All arrays are owned by the caller. */
+typedef struct ensemble_spec
+{
+    /*! The extracted fmu, it must provide the CoSimulation interface. */
+    const fmu_archive *fmu;
+    /*! The instances are named instance_name_<run>. */
+    fmi2String instance_name;
+    /*! Called from the worker threads, so it must be thread-safe. May be NULL. */
+    log_t log;
+    fmi2Boolean logging_on;
+    fmi2Real start_time;
+    fmi2Real step_size;
+    /*! The number of steps of each run and the number of rows of its output block. */
+    size_t n_steps;
+    /*! Optional individual number of steps for each run, limited to n_steps. May be NULL. */
+    const size_t *run_steps;
+    size_t n_runs;
+    /*! The real parameters that are set before the initialization. */
+    size_t n_parameters;
+    const fmi2ValueReference *parameter_vr;
+    /*! Row-major matrix with n_runs rows and n_parameters columns. */
+    const fmi2Real *parameters;
+    /*! The real outputs that are read after each step. */
+    size_t n_outputs;
+    const fmi2ValueReference *output_vr;
+    /*! Receives the outputs: for each run a block of n_steps rows and n_outputs columns. */
+    fmi2Real *outputs;
+    /*! Receives the most severe status of each run. May be NULL. */
+    fmi2Status *run_status;
+    /*! Receives the number of completed steps of each run. May be NULL. */
+    size_t *run_steps_done;
+    /*! Keep one instance per worker and call reset between runs instead of instantiating each run. */
+    fmi2Boolean reset_instances;
+    /*!
+        Process level sharding: only the runs of this shard are simulated.
+        The runs are split into n_shards contiguous blocks, 0 or 1 shards run everything.
+    */
+    size_t shard_index;
+    size_t n_shards;
+    /*! Allocate the memory of each instance from its own pool, see instantiate_pooled. Not used for instances in a host process. */
+    fmi2Boolean pooled_memory;
+    /*!
+        The path of the fmi_wrapper_host executable. If set, fmus that can only be instantiated once per process are loaded
+        via load_binary_out_of_process, so every instance runs in its own host and all worker threads are used.
+        Set reset_instances to keep the host of each worker between runs. NULL simulates such fmus on a single thread.
+        Other fmus are always simulated in the calling process.
+    */
+    fmi2String host_executable;
+} ensemble_spec;
+
+/*!
+    \brief Check if the fmu can not be instantiated more than once per process.
+    run_ensemble simulates such fmus in host processes if ensemble_spec.host_executable is set, otherwise on a single thread.
+*/
+PUBLIC_EXPORT fmi2Boolean ensemble_needs_process_sharding(const fmu_archive *fmu);
+/*!
+    \brief Simulate all runs of the spec, or of its shard.
+    \param n_threads The number of worker threads. 0 uses one per processor.
+    \return The most severe status of all runs. fmi2Fatal if the binary could not be loaded or the spec is invalid.
+*/
+PUBLIC_EXPORT fmi2Status run_ensemble(const ensemble_spec *spec, size_t n_threads);
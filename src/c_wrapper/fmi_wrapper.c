@@ -1,5 +1,11 @@
 #include "fmi_wrapper.h"
 #include "system_functions.h"
+#include "log_ring.h"
+#include "recorder.h"
+#include "remote_fmu.h"
+#include "instance_allocator.h"
+#include "call_statistics.h"
+#include "trace.h"
 #include "fmi2FunctionTypes.h"
 #include <stdlib.h>
 #include <stdio.h>
@@ -7,18 +13,18 @@
 #include <stdarg.h>
 #include <string.h>
 
-struct wrapped_fmu
+struct fmu_binary
 {
-    /*! The handle to the shared library. */
+    /*! The resolved path of the binary, used as key of the library cache. */
+    char *path;
+    /*! The handle to the shared library. NULL if the binary is loaded by a host process. */
     void *shared_library_handle;
-    /*! The component returned when instantiating the fmu. */
-    fmi2Component component;
-    /*! Store the callback functions because some fmus just store the pointer to the struct */
-    fmi2CallbackFunctions *callback_functions;
-    /*! Callback to forward logs from the fmu to the calling enviroment. */
-    log_t log;
-    /*! Callback to forward the step finished even from the fmu to the calling enviroment. */
-    step_finished_t step_finished;
+    /*! The fmi_wrapper_host executable that runs the instances of the binary. NULL if the binary is loaded in process. */
+    char *host_path;
+    /*! Number of load_binary calls and instances that have not released the binary yet. Guarded by the library cache mutex. */
+    size_t ref_count;
+    /*! Next binary in the library cache. */
+    fmu_binary *next;
 
     /* **************************************************
     Common Functions
@@ -101,6 +107,174 @@ struct wrapped_fmu
     fmi2GetStringStatusTYPE *get_string_status;
 };
 
+struct wrapped_fmu
+{
+    /*! The binary that provides the fmu functions. */
+    fmu_binary *binary;
+    /*! The component returned when instantiating the fmu. */
+    fmi2Component component;
+    /*! Store the callback functions because some fmus just store the pointer to the struct */
+    fmi2CallbackFunctions *callback_functions;
+    /*! Callback to forward logs from the fmu to the calling enviroment. */
+    log_t log;
+    /*! Callback to forward the step finished even from the fmu to the calling enviroment. */
+    step_finished_t step_finished;
+    /*! Reusable buffer for formatting the log messages. */
+    char *log_buffer;
+    /*! Allocated size of the log buffer. */
+    size_t log_buffer_size;
+    /*! Buffers the log messages until the enviroment drains them. NULL if the messages are forwarded synchronously. */
+    log_ring *log_ring;
+    /*! Log messages with a less severe status are discarded. */
+    fmi2Status log_min_status;
+    /*! Discard the listed categories instead of keeping only them. */
+    bool log_deny_categories;
+    /*! The categories of the log filter. */
+    char **log_categories;
+    size_t n_log_categories;
+    /*! Copy of the name passed to instantiate. */
+    char *instance_name;
+    /*! The fmu states of the checkpoint slots, NULL until a slot is saved the first time. */
+    fmi2FMUstate *checkpoint_states;
+    /*! Marks the slots that hold a checkpoint. */
+    bool *checkpoint_used;
+    /*! Stack of the unused slots, so saving and releasing a checkpoint is O(1). */
+    size_t *free_checkpoints;
+    size_t n_free_checkpoints;
+    size_t n_checkpoints;
+    /*! The memory pool of the fmu, NULL if it allocates from the heap. */
+    instance_allocator *allocator;
+    /*! The pool that was active on the calling thread before the current call into the fmu. */
+    instance_allocator *outer_allocator;
+    /*! The statistics of each fmu_function, NULL if they are not recorded. */
+    call_statistics *call_statistics;
+    /*! The monotonic time when the current call into the fmu started. */
+    uint64_t call_start_ns;
+    /*! Record trace events while a trace session is running. */
+    bool tracing;
+    /*! The simulation time of the trace events and recordings: the start time, the communication point during a step and its end after the step, or the time set by set_time. */
+    fmi2Real simulation_time;
+    /*! Samples the signals after each step, see start_recording. NULL if not recording. */
+    recorder *recorder;
+};
+
+/*! A fixed set of value references, stored in the same allocation. */
+struct signal_group
+{
+    size_t n_real;
+    size_t n_integer;
+    size_t n_boolean;
+    fmi2ValueReference *real_vr;
+    fmi2ValueReference *integer_vr;
+    fmi2ValueReference *boolean_vr;
+};
+
+/*! Process wide cache of the loaded binaries so each binary is loaded and resolved only once. */
+static fmu_binary *library_cache = NULL;
+/*! Guards the library cache and the reference counts of the binaries. */
+static system_mutex library_cache_mutex = SYSTEM_MUTEX_INITIALIZER;
+
+/*! Initial size of the log buffer, large enough for most messages. */
+#define LOG_BUFFER_INITIAL_SIZE 256
+
+/*!
+Ensure that the log buffer of the wrapper can hold at least size chars.
+The buffer grows geometrically and is never shrunk, so steady-state logging does not allocate.
+\return false if the memory could not be allocated. The old buffer stays valid in this case.
+*/
+static bool reserve_log_buffer(wrapped_fmu *wrapper, size_t size)
+{
+    if (size <= wrapper->log_buffer_size)
+    {
+        return true;
+    }
+    size_t new_size = wrapper->log_buffer_size > 0 ? wrapper->log_buffer_size : LOG_BUFFER_INITIAL_SIZE;
+    while (new_size < size)
+    {
+        new_size *= 2;
+    }
+    char *new_buffer = realloc(wrapper->log_buffer, new_size);
+    if (new_buffer == NULL)
+    {
+        return false;
+    }
+    wrapper->log_buffer = new_buffer;
+    wrapper->log_buffer_size = new_size;
+    return true;
+}
+
+/*!
+Apply the variadic arguments to the format string using the reusable log buffer of the wrapper.
+The arguments are only formatted a second time if the buffer had to grow.
+\return The formatted message which stays valid until the next log message of this wrapper.
+*/
+static const char *format_log_message(wrapped_fmu *wrapper, fmi2String message, va_list args)
+{
+    va_list retry_args;
+    va_copy(retry_args, args);
+    // Get the size of the string and write it if it fits
+    int needed_size = vsnprintf(wrapper->log_buffer, wrapper->log_buffer_size, message, args);
+    const char *result = wrapper->log_buffer;
+    if (needed_size < 0)
+    {
+        // Invalid format string, forward it unformatted
+        result = message;
+    }
+    else if ((size_t)needed_size >= wrapper->log_buffer_size)
+    {
+        // + 1 for the \0 char
+        if (reserve_log_buffer(wrapper, (size_t)needed_size + 1))
+        {
+            vsnprintf(wrapper->log_buffer, wrapper->log_buffer_size, message, retry_args);
+            result = wrapper->log_buffer;
+        }
+        else if (wrapper->log_buffer_size == 0)
+        {
+            // No memory at all, forward it unformatted
+            result = message;
+        }
+        // Otherwise the truncated message is forwarded
+    }
+    va_end(retry_args);
+    return result;
+}
+
+/*! Check the log filter of the wrapper, this is done before formatting the message. */
+static bool is_log_accepted(const wrapped_fmu *wrapper, fmi2Status status, fmi2String category)
+{
+    if (status < wrapper->log_min_status)
+    {
+        return false;
+    }
+    if (wrapper->n_log_categories == 0)
+    {
+        return true;
+    }
+    bool listed = false;
+    if (category != NULL)
+    {
+        for (size_t i = 0; i < wrapper->n_log_categories && !listed; i++)
+        {
+            listed = strcmp(wrapper->log_categories[i], category) == 0;
+        }
+    }
+    return listed != wrapper->log_deny_categories;
+}
+
+/*! Release the categories of the log filter. */
+static void free_log_categories(char **categories, size_t n_categories)
+{
+    if (categories == NULL)
+    {
+        return;
+    }
+    for (size_t i = 0; i < n_categories; i++)
+    {
+        free(categories[i]);
+    }
+    free(categories);
+}
+
 /*!
 Implementation of the logger callback that is passed to the fmu.
 This function calls the logCallback of the wrapper.
@@ -108,18 +282,38 @@ This function calls the logCallback of the wrapper.
 static void fmuLogCallback(fmi2ComponentEnvironment component_environment, fmi2String instance_name, fmi2Status status, fmi2String category, fmi2String message, ...)
 {
     wrapped_fmu *wrapper = (wrapped_fmu*)component_environment;
+    bool traced = wrapper->tracing && is_trace_active();
+    if ((wrapper->log == NULL && wrapper->log_ring == NULL && !traced) || !is_log_accepted(wrapper, status, category))
+    {
+        return;
+    }
     // fmi2standard: The message is to be used like sprintf.
     // For simplification apply the variadic arguments to the format string and call enviromentLog with this single string
     va_list args;
     va_start(args, message);
-    // Get the size of the string + 1 for the \0 char.
-    int needed_size = vsnprintf(NULL, 0, message, args) + 1;
-    // Create and read into buffer with size + 1 (for \0 character)
-    char *buffer = malloc(needed_size);
-    vsnprintf(buffer, needed_size, message, args);
-    wrapper->log(instance_name, status, category, buffer);
-    free(buffer);
+    if (traced)
+    {
+        va_list trace_args;
+        va_copy(trace_args, args);
+        trace_event(TRACE_INSTANT, "log", wrapper->instance_name, wrapper->simulation_time, status, category,
+                    format_log_message(wrapper, message, trace_args));
+        va_end(trace_args);
+    }
+    if (wrapper->log == NULL && wrapper->log_ring == NULL)
+    {
+        va_end(args);
+        return;
+    }
+    if (wrapper->log_ring != NULL)
+    {
+        // Format directly into the ring, the enviroment drains it later
+        push_log(wrapper->log_ring, instance_name, status, category, message, args);
+        va_end(args);
+        return;
+    }
+    const char *formatted = format_log_message(wrapper, message, args);
     va_end(args);
+    wrapper->log(instance_name, status, category, formatted);
 }
 
 /*!
@@ -129,116 +323,438 @@ This function calls the stepFinishedCallback of the wrapper.
 static void fmuStepFinished(fmi2ComponentEnvironment component_environment, fmi2Status status)
 {
     wrapped_fmu *wrapper = (wrapped_fmu*)component_environment;
-    wrapper->step_finished(status);
+    if (wrapper->tracing && is_trace_active())
+    {
+        trace_event(TRACE_INSTANT, "stepFinished", wrapper->instance_name, wrapper->simulation_time, status, NULL, NULL);
+    }
+    if (wrapper->step_finished != NULL)
+    {
+        wrapper->step_finished(status);
+    }
 }
 
-/*! 
-Load the functions from the binary into a wrapper struct.
-This is typically the first function you would want to call.
+/*!
+Load all the fmi2 functions from the shared library of the binary.
+Functions that are not provided by the binary are set to NULL.
 */
-wrapped_fmu *create_wrapper(const char *file_name, log_t log_callback, step_finished_t step_finished_callback)
+static void load_functions(fmu_binary *binary)
 {
-    // Create the wrapper struct
-    wrapped_fmu *wrapper = malloc(sizeof(wrapped_fmu));
-    wrapper->shared_library_handle = loadSharedLibrary(file_name);
-    if (wrapper->shared_library_handle == NULL)
-    {
-        // Failed to load the library.
-        return NULL;
-    }
-    wrapper->log = log_callback;
-    wrapper->step_finished = step_finished_callback;
-    // Load all the funcions
     /* Inquire version numbers of header files */
-    wrapper->get_types_platform = getFunction(wrapper->shared_library_handle, "fmi2GetTypesPlatform");
-    wrapper->get_version = getFunction(wrapper->shared_library_handle, "fmi2GetVersion");
-    wrapper->set_debug_logging = getFunction(wrapper->shared_library_handle, "fmi2SetDebugLogging");
+    binary->get_types_platform = getFunction(binary->shared_library_handle, "fmi2GetTypesPlatform");
+    binary->get_version = getFunction(binary->shared_library_handle, "fmi2GetVersion");
+    binary->set_debug_logging = getFunction(binary->shared_library_handle, "fmi2SetDebugLogging");
     /* Creation and destruction of FMU instances */
-    wrapper->instantiate = getFunction(wrapper->shared_library_handle, "fmi2Instantiate");
-    wrapper->free_instance = getFunction(wrapper->shared_library_handle, "fmi2FreeInstance");
+    binary->instantiate = getFunction(binary->shared_library_handle, "fmi2Instantiate");
+    binary->free_instance = getFunction(binary->shared_library_handle, "fmi2FreeInstance");
+    /* Enter and exit initialization mode, terminate and reset */
+    binary->setup_experiment = getFunction(binary->shared_library_handle, "fmi2SetupExperiment");
+    binary->enter_initialization_mode = getFunction(binary->shared_library_handle, "fmi2EnterInitializationMode");
+    binary->exit_initialization_mode = getFunction(binary->shared_library_handle, "fmi2ExitInitializationMode");
+    binary->terminate = getFunction(binary->shared_library_handle, "fmi2Terminate");
+    binary->reset = getFunction(binary->shared_library_handle, "fmi2Reset");
+    /* Getting and setting variables values */
+    binary->get_real = getFunction(binary->shared_library_handle, "fmi2GetReal");
+    binary->get_integer = getFunction(binary->shared_library_handle, "fmi2GetInteger");
+    binary->get_boolean = getFunction(binary->shared_library_handle, "fmi2GetBoolean");
+    binary->get_string = getFunction(binary->shared_library_handle, "fmi2GetString");
+
+    binary->set_real = getFunction(binary->shared_library_handle, "fmi2SetReal");
+    binary->set_integer = getFunction(binary->shared_library_handle, "fmi2SetInteger");
+    binary->set_boolean = getFunction(binary->shared_library_handle, "fmi2SetBoolean");
+    binary->set_string = getFunction(binary->shared_library_handle, "fmi2SetString");
+    /* Getting and setting the internal FMU state */
+    binary->get_fmu_state = getFunction(binary->shared_library_handle, "fmi2GetFMUstate");
+    binary->set_fmu_state = getFunction(binary->shared_library_handle, "fmi2SetFMUstate");
+    binary->free_fmu_state = getFunction(binary->shared_library_handle, "fmi2FreeFMUstate");
+    binary->serialized_fmu_state_size = getFunction(binary->shared_library_handle, "fmi2SerializedFMUstateSize");
+    binary->serialize_fmu_state = getFunction(binary->shared_library_handle, "fmi2SerializeFMUstate");
+    binary->deserialize_fmu_state = getFunction(binary->shared_library_handle, "fmi2DeSerializeFMUstate");
+    /* Getting partial derivatives */
+    binary->get_directional_derivative = getFunction(binary->shared_library_handle, "fmi2GetDirectionalDerivative");
+    /* Enter and exit the different modes */
+    binary->enter_event_mode = getFunction(binary->shared_library_handle, "fmi2EnterEventMode");
+    binary->new_discrete_states = getFunction(binary->shared_library_handle, "fmi2NewDiscreteStates");
+    binary->enter_continuous_time_mode = getFunction(binary->shared_library_handle, "fmi2EnterContinuousTimeMode");
+    binary->completed_integrator_step = getFunction(binary->shared_library_handle, "fmi2CompletedIntegratorStep");
+    /* Providing independent variables and re-initialization of caching */
+    binary->set_time = getFunction(binary->shared_library_handle, "fmi2SetTime");
+    binary->set_continuous_states = getFunction(binary->shared_library_handle, "fmi2SetContinuousStates");
+    /* Evaluation of the model equations */
+    binary->get_derivatives = getFunction(binary->shared_library_handle, "fmi2GetDerivatives");
+    binary->get_event_indicators = getFunction(binary->shared_library_handle, "fmi2GetEventIndicators");
+    binary->get_continuous_states = getFunction(binary->shared_library_handle, "fmi2GetContinuousStates");
+    binary->get_nominals_of_continuous_states = getFunction(binary->shared_library_handle, "fmi2GetNominalsOfContinuousStates");
+    /* Simulating the slave */
+    binary->set_real_input_derivatives = getFunction(binary->shared_library_handle, "fmi2SetRealInputDerivatives");
+    binary->get_real_output_derivatives = getFunction(binary->shared_library_handle, "fmi2GetRealOutputDerivatives");
+
+    binary->do_step = getFunction(binary->shared_library_handle, "fmi2DoStep");
+    binary->cancel_step = getFunction(binary->shared_library_handle, "fmi2CancelStep");
+    /* Inquire slave status */
+    binary->get_status = getFunction(binary->shared_library_handle, "fmi2GetStatus");
+    binary->get_real_status = getFunction(binary->shared_library_handle, "fmi2GetRealStatus");
+    binary->get_integer_status = getFunction(binary->shared_library_handle, "fmi2GetIntegerStatus");
+    binary->get_boolean_status = getFunction(binary->shared_library_handle, "fmi2GetBooleanStatus");
+    binary->get_string_status = getFunction(binary->shared_library_handle, "fmi2GetStringStatus");
+}
+
+/*! Use the proxies that forward the calls to the host process. */
+static void load_remote_functions(fmu_binary *binary)
+{
+    /* Inquire version numbers of header files */
+    binary->get_types_platform = remote_get_types_platform;
+    binary->get_version = remote_get_version;
+    binary->set_debug_logging = remote_set_debug_logging;
+    /* Creation and destruction of FMU instances, instantiate_binary calls instantiate_remote */
+    binary->instantiate = NULL;
+    binary->free_instance = remote_free_instance;
     /* Enter and exit initialization mode, terminate and reset */
-    wrapper->setup_experiment = getFunction(wrapper->shared_library_handle, "fmi2SetupExperiment");
-    wrapper->enter_initialization_mode = getFunction(wrapper->shared_library_handle, "fmi2EnterInitializationMode");
-    wrapper->exit_initialization_mode = getFunction(wrapper->shared_library_handle, "fmi2ExitInitializationMode");
-    wrapper->terminate = getFunction(wrapper->shared_library_handle, "fmi2Terminate");
-    wrapper->reset = getFunction(wrapper->shared_library_handle, "fmi2Reset");
+    binary->setup_experiment = remote_setup_experiment;
+    binary->enter_initialization_mode = remote_enter_initialization_mode;
+    binary->exit_initialization_mode = remote_exit_initialization_mode;
+    binary->terminate = remote_terminate;
+    binary->reset = remote_reset;
     /* Getting and setting variables values */
-    wrapper->get_real = getFunction(wrapper->shared_library_handle, "fmi2GetReal");
-    wrapper->get_integer = getFunction(wrapper->shared_library_handle, "fmi2GetInteger");
-    wrapper->get_boolean = getFunction(wrapper->shared_library_handle, "fmi2GetBoolean");
-    wrapper->get_string = getFunction(wrapper->shared_library_handle, "fmi2GetString");
-
-    wrapper->set_real = getFunction(wrapper->shared_library_handle, "fmi2SetReal");
-    wrapper->set_integer = getFunction(wrapper->shared_library_handle, "fmi2SetInteger");
-    wrapper->set_boolean = getFunction(wrapper->shared_library_handle, "fmi2SetBoolean");
-    wrapper->set_string = getFunction(wrapper->shared_library_handle, "fmi2SetString");
+    binary->get_real = remote_get_real;
+    binary->get_integer = remote_get_integer;
+    binary->get_boolean = remote_get_boolean;
+    binary->get_string = remote_get_string;
+
+    binary->set_real = remote_set_real;
+    binary->set_integer = remote_set_integer;
+    binary->set_boolean = remote_set_boolean;
+    binary->set_string = remote_set_string;
     /* Getting and setting the internal FMU state */
-    wrapper->get_fmu_state = getFunction(wrapper->shared_library_handle, "fmi2GetFMUstate");
-    wrapper->set_fmu_state = getFunction(wrapper->shared_library_handle, "fmi2SetFMUstate");
-    wrapper->free_fmu_state = getFunction(wrapper->shared_library_handle, "fmi2FreeFMUstate");
-    wrapper->serialized_fmu_state_size = getFunction(wrapper->shared_library_handle, "SerializedFMUstateSize");
-    wrapper->serialize_fmu_state = getFunction(wrapper->shared_library_handle, "fmi2SerializeFMUstate");
-    wrapper->deserialize_fmu_state = getFunction(wrapper->shared_library_handle, "fmi2DeSerializeFMUstate");
+    binary->get_fmu_state = remote_get_fmu_state;
+    binary->set_fmu_state = remote_set_fmu_state;
+    binary->free_fmu_state = remote_free_fmu_state;
+    binary->serialized_fmu_state_size = remote_serialized_fmu_state_size;
+    binary->serialize_fmu_state = remote_serialize_fmu_state;
+    binary->deserialize_fmu_state = remote_deserialize_fmu_state;
     /* Getting partial derivatives */
-    wrapper->get_directional_derivative = getFunction(wrapper->shared_library_handle, "fmi2GetDirectionalDerivative");
+    binary->get_directional_derivative = remote_get_directional_derivative;
     /* Enter and exit the different modes */
-    wrapper->enter_event_mode = getFunction(wrapper->shared_library_handle, "fmi2EnterEventMode");
-    wrapper->new_discrete_states = getFunction(wrapper->shared_library_handle, "fmi2NewDiscreteStates");
-    wrapper->enter_continuous_time_mode = getFunction(wrapper->shared_library_handle, "fmi2EnterContinuousTimeMode");
-    wrapper->completed_integrator_step = getFunction(wrapper->shared_library_handle, "fmi2CompletedIntegratorStep");
+    binary->enter_event_mode = remote_enter_event_mode;
+    binary->new_discrete_states = remote_new_discrete_states;
+    binary->enter_continuous_time_mode = remote_enter_continuous_time_mode;
+    binary->completed_integrator_step = remote_completed_integrator_step;
     /* Providing independent variables and re-initialization of caching */
-    wrapper->set_time = getFunction(wrapper->shared_library_handle, "fmi2SetTime");
-    wrapper->set_continuous_states = getFunction(wrapper->shared_library_handle, "fmi2SetContinuousStates");
+    binary->set_time = remote_set_time;
+    binary->set_continuous_states = remote_set_continuous_states;
     /* Evaluation of the model equations */
-    wrapper->get_derivatives = getFunction(wrapper->shared_library_handle, "fmi2GetDerivatives");
-    wrapper->get_event_indicators = getFunction(wrapper->shared_library_handle, "fmi2GetEventIndicators");
-    wrapper->get_continuous_states = getFunction(wrapper->shared_library_handle, "fmi2GetContinuousStates");
-    wrapper->get_nominals_of_continuous_states = getFunction(wrapper->shared_library_handle, "fmi2GetNominalsOfContinuousStates");
+    binary->get_derivatives = remote_get_derivatives;
+    binary->get_event_indicators = remote_get_event_indicators;
+    binary->get_continuous_states = remote_get_continuous_states;
+    binary->get_nominals_of_continuous_states = remote_get_nominals_of_continuous_states;
     /* Simulating the slave */
-    wrapper->set_real_input_derivatives = getFunction(wrapper->shared_library_handle, "fmi2SetRealInputDerivatives");
-    wrapper->get_real_output_derivatives = getFunction(wrapper->shared_library_handle, "fmi2GetRealOutputDerivatives");
+    binary->set_real_input_derivatives = remote_set_real_input_derivatives;
+    binary->get_real_output_derivatives = remote_get_real_output_derivatives;
 
-    wrapper->do_step = getFunction(wrapper->shared_library_handle, "fmi2DoStep");
-    wrapper->cancel_step = getFunction(wrapper->shared_library_handle, "fmi2CancelStep");
+    binary->do_step = remote_do_step;
+    binary->cancel_step = remote_cancel_step;
     /* Inquire slave status */
-    wrapper->get_status = getFunction(wrapper->shared_library_handle, "fmi2GetStatus");
-    wrapper->get_real_status = getFunction(wrapper->shared_library_handle, "fmi2GetRealStatus");
-    wrapper->get_integer_status = getFunction(wrapper->shared_library_handle, "fmi2GetIntegerStatus");
-    wrapper->get_boolean_status = getFunction(wrapper->shared_library_handle, "fmi2GetBooleanStatus");
-    wrapper->get_string_status = getFunction(wrapper->shared_library_handle, "fmi2GetStringStatus");
+    binary->get_status = remote_get_status;
+    binary->get_real_status = remote_get_real_status;
+    binary->get_integer_status = remote_get_integer_status;
+    binary->get_boolean_status = remote_get_boolean_status;
+    binary->get_string_status = remote_get_string_status;
+}
+
+/*!
+Find the binary in the library cache and acquire a reference to it.
+Must be called with the library cache mutex held.
+*/
+static fmu_binary *find_cached_binary(const char *path)
+{
+    for (fmu_binary *binary = library_cache; binary != NULL; binary = binary->next)
+    {
+        if (strcmp(binary->path, path) == 0)
+        {
+            binary->ref_count++;
+            return binary;
+        }
+    }
+    return NULL;
+}
+
+PUBLIC_EXPORT fmu_binary *load_binary(const char *file_name)
+{
+    char *path = resolvePath(file_name);
+    if (path == NULL)
+    {
+        // The file does not exist.
+        return NULL;
+    }
+    lockMutex(&library_cache_mutex);
+    fmu_binary *binary = find_cached_binary(path);
+    if (binary != NULL)
+    {
+        unlockMutex(&library_cache_mutex);
+        free(path);
+        return binary;
+    }
+    // Load the library and resolve the functions once for all instances
+    binary = calloc(1, sizeof(fmu_binary));
+    if (binary == NULL)
+    {
+        unlockMutex(&library_cache_mutex);
+        free(path);
+        return NULL;
+    }
+    binary->shared_library_handle = loadSharedLibrary(path);
+    if (binary->shared_library_handle == NULL)
+    {
+        // Failed to load the library.
+        unlockMutex(&library_cache_mutex);
+        free(binary);
+        free(path);
+        return NULL;
+    }
+    binary->path = path;
+    binary->ref_count = 1;
+    load_functions(binary);
+    binary->next = library_cache;
+    library_cache = binary;
+    unlockMutex(&library_cache_mutex);
+    return binary;
+}
+
+PUBLIC_EXPORT fmu_binary *load_binary_out_of_process(const char *host_executable, const char *file_name)
+{
+    char *path = resolvePath(file_name);
+    char *host_path = resolvePath(host_executable);
+    fmu_binary *binary = path != NULL && host_path != NULL ? calloc(1, sizeof(fmu_binary)) : NULL;
+    if (binary == NULL)
+    {
+        free(path);
+        free(host_path);
+        return NULL;
+    }
+    // Not added to the library cache, each instance starts its own host
+    binary->path = path;
+    binary->host_path = host_path;
+    binary->ref_count = 1;
+    load_remote_functions(binary);
+    return binary;
+}
+
+PUBLIC_EXPORT void free_binary(fmu_binary *binary)
+{
+    if (binary == NULL)
+    {
+        return;
+    }
+    lockMutex(&library_cache_mutex);
+    if (--binary->ref_count > 0)
+    {
+        unlockMutex(&library_cache_mutex);
+        return;
+    }
+    // Last reference released, remove the binary from the cache
+    for (fmu_binary **current = &library_cache; *current != NULL; current = &(*current)->next)
+    {
+        if (*current == binary)
+        {
+            *current = binary->next;
+            break;
+        }
+    }
+    unlockMutex(&library_cache_mutex);
+    if (binary->shared_library_handle != NULL)
+    {
+        freeSharedLibrary(binary->shared_library_handle);
+    }
+    free(binary->host_path);
+    free(binary->path);
+    free(binary);
+}
+
+/*! 
+Create a wrapper struct that uses the functions of the binary.
+The wrapper acquires its own reference to the binary.
+*/
+static wrapped_fmu *create_wrapper(fmu_binary *binary, log_t log_callback, step_finished_t step_finished_callback)
+{
+    // Create the wrapper struct
+    wrapped_fmu *wrapper = calloc(1, sizeof(wrapped_fmu));
+    if (wrapper == NULL)
+    {
+        return NULL;
+    }
+    lockMutex(&library_cache_mutex);
+    binary->ref_count++;
+    unlockMutex(&library_cache_mutex);
+    wrapper->binary = binary;
+    wrapper->log = log_callback;
+    wrapper->step_finished = step_finished_callback;
+    // Preallocate the log buffer so typical messages are formatted without allocating
+    reserve_log_buffer(wrapper, LOG_BUFFER_INITIAL_SIZE);
     return wrapper;
 }
 
-/*! Free the handle and memory of the wrapper. */
-void free_wrapper(wrapped_fmu *wrapper)
+/*! Release the binary and memory of the wrapper. */
+static void free_wrapper(wrapped_fmu *wrapper)
 {
-    freeSharedLibrary(wrapper->shared_library_handle);
+    free_binary(wrapper->binary);
+    free(wrapper->instance_name);
+    free(wrapper->checkpoint_states);
+    free(wrapper->checkpoint_used);
+    free(wrapper->free_checkpoints);
     free(wrapper->callback_functions);
+    free(wrapper->log_buffer);
+    free_log_ring(wrapper->log_ring);
+    free_log_categories(wrapper->log_categories, wrapper->n_log_categories);
+    // Releases the memory that the fmu did not free
+    free_instance_allocator(wrapper->allocator);
+    free(wrapper->call_statistics);
+    if (wrapper->recorder != NULL)
+    {
+        close_recorder(wrapper->recorder);
+    }
     free(wrapper);
 }
 
+/*! Returns the more severe of both status values. The fmi2Status enum is ordered by severity except for fmi2Pending. */
+static fmi2Status worst_status(fmi2Status first, fmi2Status second)
+{
+    return first > second ? first : second;
+}
+
+/*! Only fmi2OK and fmi2Warning allow to continue the simulation. */
+static bool can_continue(fmi2Status status)
+{
+    return status == fmi2OK || status == fmi2Warning;
+}
+
+/*! Prepare the calling thread for a call into the fmu, see CALL_FMU. */
+static void begin_fmu_call(wrapped_fmu *wrapper, fmu_function function)
+{
+    if (wrapper->tracing && is_trace_active())
+    {
+        trace_event(TRACE_BEGIN, get_fmu_function_name(function), wrapper->instance_name, wrapper->simulation_time, -1, NULL, NULL);
+    }
+    if (wrapper->allocator != NULL)
+    {
+        wrapper->outer_allocator = activate_instance_allocator(wrapper->allocator);
+    }
+    if (wrapper->call_statistics != NULL)
+    {
+        wrapper->call_start_ns = getMonotonicTime();
+    }
+}
+
+/*! Restore the calling thread after a call into the fmu, record the call and pass its status through. */
+static fmi2Status end_fmu_call(wrapped_fmu *wrapper, fmu_function function, fmi2Status status)
+{
+    if (wrapper->call_statistics != NULL)
+    {
+        record_call(&wrapper->call_statistics[function], getMonotonicTime() - wrapper->call_start_ns);
+    }
+    if (wrapper->allocator != NULL)
+    {
+        activate_instance_allocator(wrapper->outer_allocator);
+    }
+    if (wrapper->tracing && is_trace_active())
+    {
+        trace_event(TRACE_END, get_fmu_function_name(function), wrapper->instance_name, wrapper->simulation_time, status, NULL, NULL);
+    }
+    return status;
+}
+
+/*!
+Call a function of the binary with the arguments in parentheses, e.g. CALL_FMU(wrapper, do_step, (wrapper->component, t, h, fmi2True)).
+Every call of the fmu that may use its callbacks goes through this macro. The function name selects the fmu_function of the statistics.
+*/
+#define CALL_FMU(wrapper, function, arguments) \
+    (begin_fmu_call((wrapper), fmu_function_##function), end_fmu_call((wrapper), fmu_function_##function, (wrapper)->binary->function arguments))
+
+/*! Report an error of the wrapper itself through the log callback of the instance. */
+static void log_wrapper_error(wrapped_fmu *wrapper, fmi2String message)
+{
+    fmuLogCallback(wrapper, wrapper->instance_name, fmi2Error, "logStatusError", "%s", message);
+}
+
+/*! Free the fmu states of all checkpoint slots and the pool itself. */
+static void free_checkpoint_states(wrapped_fmu *wrapper)
+{
+    for (size_t i = 0; i < wrapper->n_checkpoints; i++)
+    {
+        if (wrapper->checkpoint_states[i] != NULL)
+        {
+            CALL_FMU(wrapper, free_fmu_state, (wrapper->component, &wrapper->checkpoint_states[i]));
+        }
+    }
+    free(wrapper->checkpoint_states);
+    free(wrapper->checkpoint_used);
+    free(wrapper->free_checkpoints);
+    wrapper->checkpoint_states = NULL;
+    wrapper->checkpoint_used = NULL;
+    wrapper->free_checkpoints = NULL;
+    wrapper->n_free_checkpoints = 0;
+    wrapper->n_checkpoints = 0;
+}
+
 /* Creation and destruction of FMU instances and setting debug status */
 
-PUBLIC_EXPORT wrapped_fmu *instantiate(const char *file_name, log_t log, step_finished_t step_finished,
-                                       fmi2String instance_name, fmi2Type fmu_type, fmi2String guid, fmi2String resource_location, fmi2Boolean visible, fmi2Boolean logging_on)
+/*!
+Create the wrapper and instantiate the fmu.
+\param pooled Pass the callbacks of a new memory pool instead of calloc and free.
+*/
+static wrapped_fmu *instantiate_wrapper(fmu_binary *binary, log_t log, step_finished_t step_finished, bool pooled,
+                                        fmi2String instance_name, fmi2Type fmu_type, fmi2String guid, fmi2String resource_location, fmi2Boolean visible, fmi2Boolean logging_on)
 {
-    // Load the functions from the binary
-    wrapped_fmu *wrapper = create_wrapper(file_name, log, step_finished);
+    if (binary == NULL)
+    {
+        return NULL;
+    }
+    wrapped_fmu *wrapper = create_wrapper(binary, log, step_finished);
     if (wrapper == NULL)
     {
         return NULL;
     }
     // Supply static callback functions and the wrapper. The wrapper contains the callbacks of the enviroment.
     wrapper->callback_functions = malloc(sizeof(fmi2CallbackFunctions));
+    if (wrapper->callback_functions == NULL)
+    {
+        free_wrapper(wrapper);
+        return NULL;
+    }
+    // The host process allocates the memory of remote instances
+    if (pooled && binary->host_path == NULL)
+    {
+        wrapper->allocator = create_instance_allocator();
+        if (wrapper->allocator == NULL)
+        {
+            free_wrapper(wrapper);
+            return NULL;
+        }
+    }
     fmi2CallbackFunctions callbacks = {
         .logger = fmuLogCallback,
-        .allocateMemory = calloc,
-        .freeMemory = free,
+        .allocateMemory = wrapper->allocator != NULL ? pool_allocate : calloc,
+        .freeMemory = wrapper->allocator != NULL ? pool_free : free,
         .stepFinished = fmuStepFinished,
         .componentEnvironment = wrapper };
     memcpy(wrapper->callback_functions, &callbacks, sizeof(*wrapper->callback_functions));
+    wrapper->instance_name = malloc(strlen(instance_name) + 1);
+    if (wrapper->instance_name == NULL)
+    {
+        free_wrapper(wrapper);
+        return NULL;
+    }
+    strcpy(wrapper->instance_name, instance_name);
     // Instantiate the fmu
-    wrapper->component = wrapper->instantiate(instance_name, fmu_type, guid, resource_location, wrapper->callback_functions, visible, logging_on);
+    if (binary->host_path != NULL)
+    {
+        wrapper->component = instantiate_remote(binary->host_path, binary->path, instance_name, fmu_type, guid, resource_location,
+                                                wrapper->callback_functions, visible, logging_on);
+    }
+    else
+    {
+        instance_allocator *outer_allocator = activate_instance_allocator(wrapper->allocator);
+        wrapper->component = binary->instantiate(instance_name, fmu_type, guid, resource_location, wrapper->callback_functions, visible, logging_on);
+        activate_instance_allocator(outer_allocator);
+    }
     if (wrapper->component == NULL)
     {
         // Failed, release the wrapper
@@ -248,122 +764,458 @@ PUBLIC_EXPORT wrapped_fmu *instantiate(const char *file_name, log_t log, step_fi
     return wrapper;
 }
 
+PUBLIC_EXPORT wrapped_fmu *instantiate_binary(fmu_binary *binary, log_t log, step_finished_t step_finished,
+                                              fmi2String instance_name, fmi2Type fmu_type, fmi2String guid, fmi2String resource_location, fmi2Boolean visible, fmi2Boolean logging_on)
+{
+    return instantiate_wrapper(binary, log, step_finished, false, instance_name, fmu_type, guid, resource_location, visible, logging_on);
+}
+
+PUBLIC_EXPORT wrapped_fmu *instantiate_pooled(fmu_binary *binary, log_t log, step_finished_t step_finished,
+                                              fmi2String instance_name, fmi2Type fmu_type, fmi2String guid, fmi2String resource_location, fmi2Boolean visible, fmi2Boolean logging_on)
+{
+    return instantiate_wrapper(binary, log, step_finished, true, instance_name, fmu_type, guid, resource_location, visible, logging_on);
+}
+
+PUBLIC_EXPORT wrapped_fmu *instantiate(const char *file_name, log_t log, step_finished_t step_finished,
+                                       fmi2String instance_name, fmi2Type fmu_type, fmi2String guid, fmi2String resource_location, fmi2Boolean visible, fmi2Boolean logging_on)
+{
+    // Load the functions from the binary or reuse the cached ones
+    fmu_binary *binary = load_binary(file_name);
+    if (binary == NULL)
+    {
+        return NULL;
+    }
+    wrapped_fmu *wrapper = instantiate_binary(binary, log, step_finished, instance_name, fmu_type, guid, resource_location, visible, logging_on);
+    // The instance holds its own reference
+    free_binary(binary);
+    return wrapper;
+}
+
 PUBLIC_EXPORT void free_instance(wrapped_fmu *wrapper)
 {
-    wrapper->free_instance(wrapper->component);
+    // The fmu states belong to the component
+    free_checkpoint_states(wrapper);
+    instance_allocator *outer_allocator = activate_instance_allocator(wrapper->allocator);
+    wrapper->binary->free_instance(wrapper->component);
+    activate_instance_allocator(outer_allocator);
+    if (wrapper->tracing && is_trace_active())
+    {
+        // The buffered events reference the instance name
+        flush_trace();
+    }
     free_wrapper(wrapper);
 }
 
+PUBLIC_EXPORT fmi2Status get_allocation_statistics(wrapped_fmu *wrapper, allocation_statistics *statistics)
+{
+    if (wrapper->allocator == NULL)
+    {
+        return fmi2Error;
+    }
+    get_instance_allocator_statistics(wrapper->allocator, statistics);
+    return fmi2OK;
+}
+
+PUBLIC_EXPORT fmi2Status set_call_statistics(wrapped_fmu *wrapper, fmi2Boolean enabled)
+{
+    call_statistics *statistics = NULL;
+    if (enabled)
+    {
+        statistics = calloc(fmu_function_count, sizeof(call_statistics));
+        if (statistics == NULL)
+        {
+            return fmi2Error;
+        }
+    }
+    free(wrapper->call_statistics);
+    wrapper->call_statistics = statistics;
+    return fmi2OK;
+}
+
+PUBLIC_EXPORT fmi2Status get_call_statistics(wrapped_fmu *wrapper, fmu_function function, call_statistics *statistics, fmi2Boolean reset)
+{
+    if (wrapper->call_statistics == NULL || (size_t)function >= fmu_function_count)
+    {
+        return fmi2Error;
+    }
+    *statistics = wrapper->call_statistics[function];
+    if (reset)
+    {
+        memset(&wrapper->call_statistics[function], 0, sizeof(call_statistics));
+    }
+    return fmi2OK;
+}
+
+PUBLIC_EXPORT fmi2Status set_tracing(wrapped_fmu *wrapper, fmi2Boolean enabled)
+{
+    if (!enabled && wrapper->tracing && is_trace_active())
+    {
+        // Events that are written after free_instance must not reference the instance name
+        flush_trace();
+    }
+    wrapper->tracing = enabled;
+    return fmi2OK;
+}
+
+PUBLIC_EXPORT fmi2Status start_recording(wrapped_fmu *wrapper, const char *file_name, const signal_group *signals, const recorder_options *options)
+{
+    if (wrapper->recorder != NULL)
+    {
+        return fmi2Error;
+    }
+    recorder *recorder = create_recorder(file_name, signals->n_real, signals->real_vr, signals->n_integer, signals->integer_vr,
+                                         signals->n_boolean, signals->boolean_vr, options);
+    if (recorder == NULL)
+    {
+        return fmi2Error;
+    }
+    record_sample(recorder, wrapper, wrapper->simulation_time);
+    wrapper->recorder = recorder;
+    return fmi2OK;
+}
+
+PUBLIC_EXPORT fmi2Status stop_recording(wrapped_fmu *wrapper)
+{
+    if (wrapper->recorder == NULL)
+    {
+        return fmi2Error;
+    }
+    fmi2Status status = close_recorder(wrapper->recorder);
+    wrapper->recorder = NULL;
+    return status;
+}
+
 /* Inquire version numbers of header files and setting logging status */
 
 PUBLIC_EXPORT const char *get_types_platform(wrapped_fmu *wrapper)
 {
-    return wrapper->get_types_platform();
+    return wrapper->binary->get_types_platform();
 }
 
 PUBLIC_EXPORT const char *get_version(wrapped_fmu *wrapper)
 {
-    return wrapper->get_version();
+    return wrapper->binary->get_version();
 }
 
 PUBLIC_EXPORT fmi2Status set_debug_logging(wrapped_fmu *wrapper, fmi2Boolean logging_on, size_t n_categories, fmi2String categories[])
 {
-    return wrapper->set_debug_logging(wrapper->component, logging_on, n_categories, categories);
+    return CALL_FMU(wrapper, set_debug_logging, (wrapper->component, logging_on, n_categories, categories));
+}
+
+PUBLIC_EXPORT fmi2Status set_log_filter(wrapped_fmu *wrapper, fmi2Status min_status, fmi2Boolean deny_categories, size_t n_categories, const fmi2String categories[])
+{
+    // Copy the categories so the enviroment may release its strings
+    char **copies = NULL;
+    if (n_categories > 0)
+    {
+        copies = calloc(n_categories, sizeof(char *));
+        if (copies == NULL)
+        {
+            return fmi2Error;
+        }
+        for (size_t i = 0; i < n_categories; i++)
+        {
+            copies[i] = malloc(strlen(categories[i]) + 1);
+            if (copies[i] == NULL)
+            {
+                free_log_categories(copies, n_categories);
+                return fmi2Error;
+            }
+            strcpy(copies[i], categories[i]);
+        }
+    }
+    free_log_categories(wrapper->log_categories, wrapper->n_log_categories);
+    wrapper->log_categories = copies;
+    wrapper->n_log_categories = n_categories;
+    wrapper->log_deny_categories = deny_categories;
+    wrapper->log_min_status = min_status;
+    return fmi2OK;
+}
+
+PUBLIC_EXPORT fmi2Status set_log_buffering(wrapped_fmu *wrapper, size_t capacity, size_t record_size)
+{
+    log_ring *ring = NULL;
+    if (capacity > 0)
+    {
+        ring = create_log_ring(capacity, record_size);
+        if (ring == NULL)
+        {
+            return fmi2Error;
+        }
+    }
+    free_log_ring(wrapper->log_ring);
+    wrapper->log_ring = ring;
+    return fmi2OK;
+}
+
+PUBLIC_EXPORT size_t drain_logs(wrapped_fmu *wrapper, log_record records[], size_t max_records, size_t *n_dropped)
+{
+    if (wrapper->log_ring == NULL)
+    {
+        if (n_dropped != NULL)
+        {
+            *n_dropped = 0;
+        }
+        return 0;
+    }
+    return drain_log_ring(wrapper->log_ring, records, max_records, n_dropped);
 }
 
 /* Enter and exit initialization mode, terminate and reset */
 
 PUBLIC_EXPORT fmi2Status setup_experiment(wrapped_fmu *wrapper, fmi2Boolean tolerance_defined, fmi2Real tolerance, fmi2Real start_time, fmi2Boolean stop_time_defined, fmi2Real stop_time)
 {
-    return wrapper->setup_experiment(wrapper->component, tolerance_defined, tolerance, start_time, stop_time_defined, stop_time);
+    wrapper->simulation_time = start_time;
+    return CALL_FMU(wrapper, setup_experiment, (wrapper->component, tolerance_defined, tolerance, start_time, stop_time_defined, stop_time));
 }
 
 PUBLIC_EXPORT fmi2Status enter_initialization_mode(wrapped_fmu *wrapper)
 {
-    return wrapper->enter_initialization_mode(wrapper->component);
+    return CALL_FMU(wrapper, enter_initialization_mode, (wrapper->component));
 }
 
 PUBLIC_EXPORT fmi2Status exit_initialization_mode(wrapped_fmu *wrapper)
 {
-    return wrapper->exit_initialization_mode(wrapper->component);
+    return CALL_FMU(wrapper, exit_initialization_mode, (wrapper->component));
 }
 
 PUBLIC_EXPORT fmi2Status terminate(wrapped_fmu *wrapper)
 {
-    return wrapper->terminate(wrapper->component);
+    return CALL_FMU(wrapper, terminate, (wrapper->component));
 }
 
 PUBLIC_EXPORT fmi2Status reset(wrapped_fmu *wrapper)
 {
-    return wrapper->reset(wrapper->component);
+    return CALL_FMU(wrapper, reset, (wrapper->component));
 }
 
 /* Getting and setting variable values */
 PUBLIC_EXPORT fmi2Status get_real(wrapped_fmu *wrapper, const fmi2ValueReference vr[], size_t nvr, fmi2Real value[])
 {
-    return wrapper->get_real(wrapper->component, vr, nvr, value);
+    return CALL_FMU(wrapper, get_real, (wrapper->component, vr, nvr, value));
 }
 
 PUBLIC_EXPORT fmi2Status get_integer(wrapped_fmu *wrapper, const fmi2ValueReference vr[], size_t nvr, fmi2Integer value[])
 {
-    return wrapper->get_integer(wrapper->component, vr, nvr, value);
+    return CALL_FMU(wrapper, get_integer, (wrapper->component, vr, nvr, value));
 }
 
 PUBLIC_EXPORT fmi2Status get_boolean(wrapped_fmu *wrapper, const fmi2ValueReference vr[], size_t nvr, fmi2Boolean value[])
 {
-    return wrapper->get_boolean(wrapper->component, vr, nvr, value);
+    return CALL_FMU(wrapper, get_boolean, (wrapper->component, vr, nvr, value));
 }
 
 PUBLIC_EXPORT fmi2Status get_string(wrapped_fmu *wrapper, const fmi2ValueReference vr[], size_t nvr, fmi2String value[])
 {
-    return wrapper->get_string(wrapper->component, vr, nvr, value);
+    return CALL_FMU(wrapper, get_string, (wrapper->component, vr, nvr, value));
 }
 
 PUBLIC_EXPORT fmi2Status set_real(wrapped_fmu *wrapper, const fmi2ValueReference vr[], size_t nvr, const fmi2Real value[])
 {
-    return wrapper->set_real(wrapper->component, vr, nvr, value);
+    return CALL_FMU(wrapper, set_real, (wrapper->component, vr, nvr, value));
 }
 
 PUBLIC_EXPORT fmi2Status set_integer(wrapped_fmu *wrapper, const fmi2ValueReference vr[], size_t nvr, const fmi2Integer value[])
 {
-    return wrapper->set_integer(wrapper->component, vr, nvr, value);
+    return CALL_FMU(wrapper, set_integer, (wrapper->component, vr, nvr, value));
 }
 
 PUBLIC_EXPORT fmi2Status set_boolean(wrapped_fmu *wrapper, const fmi2ValueReference vr[], size_t nvr, const fmi2Boolean value[])
 {
-    return wrapper->set_boolean(wrapper->component, vr, nvr, value);
+    return CALL_FMU(wrapper, set_boolean, (wrapper->component, vr, nvr, value));
 }
 
 PUBLIC_EXPORT fmi2Status set_string(wrapped_fmu *wrapper, const fmi2ValueReference vr[], size_t nvr, const fmi2String value[])
 {
-    return wrapper->set_string(wrapper->component, vr, nvr, value);
+    return CALL_FMU(wrapper, set_string, (wrapper->component, vr, nvr, value));
+}
+
+PUBLIC_EXPORT signal_group *create_signal_group(size_t n_real, const fmi2ValueReference real_vr[],
+                                               size_t n_integer, const fmi2ValueReference integer_vr[],
+                                               size_t n_boolean, const fmi2ValueReference boolean_vr[])
+{
+    signal_group *group = malloc(sizeof(signal_group) + (n_real + n_integer + n_boolean) * sizeof(fmi2ValueReference));
+    if (group == NULL)
+    {
+        return NULL;
+    }
+    group->n_real = n_real;
+    group->n_integer = n_integer;
+    group->n_boolean = n_boolean;
+    group->real_vr = (fmi2ValueReference *)(group + 1);
+    group->integer_vr = group->real_vr + n_real;
+    group->boolean_vr = group->integer_vr + n_integer;
+    if (n_real > 0)
+    {
+        memcpy(group->real_vr, real_vr, n_real * sizeof(fmi2ValueReference));
+    }
+    if (n_integer > 0)
+    {
+        memcpy(group->integer_vr, integer_vr, n_integer * sizeof(fmi2ValueReference));
+    }
+    if (n_boolean > 0)
+    {
+        memcpy(group->boolean_vr, boolean_vr, n_boolean * sizeof(fmi2ValueReference));
+    }
+    return group;
+}
+
+PUBLIC_EXPORT void free_signal_group(signal_group *group)
+{
+    free(group);
+}
+
+PUBLIC_EXPORT fmi2Status group_get(wrapped_fmu *wrapper, const signal_group *group, fmi2Real real_values[], fmi2Integer integer_values[], fmi2Boolean boolean_values[])
+{
+    fmi2Status result = fmi2OK;
+    if (group->n_real > 0)
+    {
+        result = worst_status(result, CALL_FMU(wrapper, get_real, (wrapper->component, group->real_vr, group->n_real, real_values)));
+    }
+    if (group->n_integer > 0 && can_continue(result))
+    {
+        result = worst_status(result, CALL_FMU(wrapper, get_integer, (wrapper->component, group->integer_vr, group->n_integer, integer_values)));
+    }
+    if (group->n_boolean > 0 && can_continue(result))
+    {
+        result = worst_status(result, CALL_FMU(wrapper, get_boolean, (wrapper->component, group->boolean_vr, group->n_boolean, boolean_values)));
+    }
+    return result;
+}
+
+PUBLIC_EXPORT fmi2Status group_set(wrapped_fmu *wrapper, const signal_group *group, const fmi2Real real_values[], const fmi2Integer integer_values[], const fmi2Boolean boolean_values[])
+{
+    fmi2Status result = fmi2OK;
+    if (group->n_real > 0)
+    {
+        result = worst_status(result, CALL_FMU(wrapper, set_real, (wrapper->component, group->real_vr, group->n_real, real_values)));
+    }
+    if (group->n_integer > 0 && can_continue(result))
+    {
+        result = worst_status(result, CALL_FMU(wrapper, set_integer, (wrapper->component, group->integer_vr, group->n_integer, integer_values)));
+    }
+    if (group->n_boolean > 0 && can_continue(result))
+    {
+        result = worst_status(result, CALL_FMU(wrapper, set_boolean, (wrapper->component, group->boolean_vr, group->n_boolean, boolean_values)));
+    }
+    return result;
 }
 
 /* Getting and setting the internal FMU state */
 PUBLIC_EXPORT fmi2Status get_fmu_state(wrapped_fmu *wrapper, fmi2FMUstate *fmu_state)
 {
-    return wrapper->get_fmu_state(wrapper->component, fmu_state);
+    return CALL_FMU(wrapper, get_fmu_state, (wrapper->component, fmu_state));
 }
 PUBLIC_EXPORT fmi2Status set_fmu_state(wrapped_fmu *wrapper, fmi2FMUstate fmu_state)
 {
-    return wrapper->set_fmu_state(wrapper->component, fmu_state);
+    return CALL_FMU(wrapper, set_fmu_state, (wrapper->component, fmu_state));
 }
 PUBLIC_EXPORT fmi2Status free_fmu_state(wrapped_fmu *wrapper, fmi2FMUstate *fmu_state)
 {
-    return wrapper->free_fmu_state(wrapper->component, fmu_state);
+    return CALL_FMU(wrapper, free_fmu_state, (wrapper->component, fmu_state));
 }
+PUBLIC_EXPORT fmi2Status set_checkpoint_capacity(wrapped_fmu *wrapper, size_t n_slots, fmi2Boolean can_get_and_set_fmu_state)
+{
+    if (n_slots > 0 && !can_get_and_set_fmu_state)
+    {
+        log_wrapper_error(wrapper, "Checkpoints are not available, the model description does not set canGetAndSetFMUstate");
+        return fmi2Error;
+    }
+    if (n_slots > 0 && (wrapper->binary->get_fmu_state == NULL || wrapper->binary->set_fmu_state == NULL || wrapper->binary->free_fmu_state == NULL))
+    {
+        log_wrapper_error(wrapper, "Checkpoints are not available, the binary does not export fmi2GetFMUstate, fmi2SetFMUstate and fmi2FreeFMUstate");
+        return fmi2Error;
+    }
+    fmi2FMUstate *states = NULL;
+    bool *used = NULL;
+    size_t *free_slots = NULL;
+    if (n_slots > 0)
+    {
+        states = calloc(n_slots, sizeof(fmi2FMUstate));
+        used = calloc(n_slots, sizeof(bool));
+        free_slots = calloc(n_slots, sizeof(size_t));
+        if (states == NULL || used == NULL || free_slots == NULL)
+        {
+            free(states);
+            free(used);
+            free(free_slots);
+            return fmi2Error;
+        }
+    }
+    free_checkpoint_states(wrapper);
+    wrapper->checkpoint_states = states;
+    wrapper->checkpoint_used = used;
+    wrapper->free_checkpoints = free_slots;
+    wrapper->n_checkpoints = n_slots;
+    wrapper->n_free_checkpoints = n_slots;
+    // Hand out the low slots first
+    for (size_t i = 0; i < n_slots; i++)
+    {
+        free_slots[i] = n_slots - 1 - i;
+    }
+    return fmi2OK;
+}
+
+PUBLIC_EXPORT fmi2Status save_checkpoint(wrapped_fmu *wrapper, size_t *slot)
+{
+    if (wrapper->n_free_checkpoints == 0)
+    {
+        log_wrapper_error(wrapper, wrapper->n_checkpoints > 0 ? "All checkpoint slots are in use" : "No checkpoint slots, call set_checkpoint_capacity first");
+        return fmi2Error;
+    }
+    size_t free_slot = wrapper->free_checkpoints[wrapper->n_free_checkpoints - 1];
+    // An existing state of a recycled slot is overwritten in place
+    fmi2Status status = CALL_FMU(wrapper, get_fmu_state, (wrapper->component, &wrapper->checkpoint_states[free_slot]));
+    if (can_continue(status))
+    {
+        wrapper->n_free_checkpoints--;
+        wrapper->checkpoint_used[free_slot] = true;
+        *slot = free_slot;
+    }
+    return status;
+}
+
+PUBLIC_EXPORT fmi2Status update_checkpoint(wrapped_fmu *wrapper, size_t slot)
+{
+    if (slot >= wrapper->n_checkpoints || !wrapper->checkpoint_used[slot])
+    {
+        return fmi2Error;
+    }
+    return CALL_FMU(wrapper, get_fmu_state, (wrapper->component, &wrapper->checkpoint_states[slot]));
+}
+
+PUBLIC_EXPORT fmi2Status restore_checkpoint(wrapped_fmu *wrapper, size_t slot)
+{
+    if (slot >= wrapper->n_checkpoints || !wrapper->checkpoint_used[slot])
+    {
+        return fmi2Error;
+    }
+    return CALL_FMU(wrapper, set_fmu_state, (wrapper->component, wrapper->checkpoint_states[slot]));
+}
+
+PUBLIC_EXPORT fmi2Status release_checkpoint(wrapped_fmu *wrapper, size_t slot)
+{
+    if (slot >= wrapper->n_checkpoints || !wrapper->checkpoint_used[slot])
+    {
+        return fmi2Error;
+    }
+    wrapper->checkpoint_used[slot] = false;
+    wrapper->free_checkpoints[wrapper->n_free_checkpoints++] = slot;
+    return fmi2OK;
+}
+
 PUBLIC_EXPORT fmi2Status serialized_fmu_state_size(wrapped_fmu *wrapper, fmi2FMUstate fmu_state, size_t *size)
 {
-    return wrapper->serialized_fmu_state_size(wrapper->component, fmu_state, size);
+    return CALL_FMU(wrapper, serialized_fmu_state_size, (wrapper->component, fmu_state, size));
 }
 PUBLIC_EXPORT fmi2Status serialize_fmu_state(wrapped_fmu *wrapper, fmi2FMUstate fmu_state, fmi2Byte serialized_state[], size_t size)
 {
-    return wrapper->serialize_fmu_state(wrapper->component, fmu_state, serialized_state, size);
+    return CALL_FMU(wrapper, serialize_fmu_state, (wrapper->component, fmu_state, serialized_state, size));
 }
 
 PUBLIC_EXPORT fmi2Status deserialize_fmu_state(wrapped_fmu *wrapper, const fmi2Byte serialized_state[], size_t size, fmi2FMUstate *fmu_state)
 {
-    return wrapper->deserialize_fmu_state(wrapper->component, serialized_state, size, fmu_state);
+    return CALL_FMU(wrapper, deserialize_fmu_state, (wrapper->component, serialized_state, size, fmu_state));
 }
 
 /* Getting partial derivatives */
@@ -371,7 +1223,7 @@ PUBLIC_EXPORT fmi2Status get_directional_derivative(wrapped_fmu *wrapper, const
                                                     const fmi2ValueReference v_known_ref[], size_t n_known,
                                                     const fmi2Real dv_known[], fmi2Real dv_unknown[])
 {
-    return wrapper->get_directional_derivative(wrapper->component, v_unknown_ref, n_unknown, v_known_ref, n_known, dv_known, dv_unknown);
+    return CALL_FMU(wrapper, get_directional_derivative, (wrapper->component, v_unknown_ref, n_unknown, v_known_ref, n_known, dv_known, dv_unknown));
 }
 
 /* **************************************************
@@ -381,57 +1233,58 @@ Typess for Functions for FMI2 for Model Exchange
 /* Enter and exit the different modes */
 PUBLIC_EXPORT fmi2Status enter_event_mode(wrapped_fmu *wrapper)
 {
-    return wrapper->enter_event_mode(wrapper->component);
+    return CALL_FMU(wrapper, enter_event_mode, (wrapper->component));
 }
 
 PUBLIC_EXPORT fmi2Status new_discrete_states(wrapped_fmu *wrapper, fmi2EventInfo *fmi2eventInfo)
 {
     // The struct is a pain to marshal so provide it here and update the reference values.
     fmi2EventInfo info = { 0 };
-    return wrapper->new_discrete_states(wrapper->component, fmi2eventInfo);
+    return CALL_FMU(wrapper, new_discrete_states, (wrapper->component, fmi2eventInfo));
 }
 
 PUBLIC_EXPORT fmi2Status enter_continuous_time_mode(wrapped_fmu *wrapper)
 {
-    return wrapper->enter_continuous_time_mode(wrapper->component);
+    return CALL_FMU(wrapper, enter_continuous_time_mode, (wrapper->component));
 }
 
 PUBLIC_EXPORT fmi2Status completed_integrator_step(wrapped_fmu *wrapper, fmi2Boolean no_set_fmu_state_prior_to_current_point, fmi2Boolean *enter_event_mode, fmi2Boolean *terminate_simulation)
 {
-    fmi2Status result = wrapper->completed_integrator_step(wrapper->component, no_set_fmu_state_prior_to_current_point, enter_event_mode, terminate_simulation);
+    fmi2Status result = CALL_FMU(wrapper, completed_integrator_step, (wrapper->component, no_set_fmu_state_prior_to_current_point, enter_event_mode, terminate_simulation));
     return result;
 }
 
 /* Providing independent variables and re-initialization of caching */
 PUBLIC_EXPORT fmi2Status set_time(wrapped_fmu *wrapper, fmi2Real time)
 {
-    return wrapper->set_time(wrapper->component, time);
+    wrapper->simulation_time = time;
+    return CALL_FMU(wrapper, set_time, (wrapper->component, time));
 }
 
 PUBLIC_EXPORT fmi2Status set_continuous_states(wrapped_fmu *wrapper, const fmi2Real x[], size_t nx)
 {
-    return wrapper->set_continuous_states(wrapper->component, x, nx);
+    return CALL_FMU(wrapper, set_continuous_states, (wrapper->component, x, nx));
 }
 
 /* Evaluation of the model equations */
 PUBLIC_EXPORT fmi2Status get_derivatives(wrapped_fmu *wrapper, fmi2Real derivatives[], size_t nx)
 {
-    return wrapper->get_derivatives(wrapper->component, derivatives, nx);
+    return CALL_FMU(wrapper, get_derivatives, (wrapper->component, derivatives, nx));
 }
 
 PUBLIC_EXPORT fmi2Status get_event_indicators(wrapped_fmu *wrapper, fmi2Real eventIndicators[], size_t ni)
 {
-    return wrapper->get_event_indicators(wrapper->component, eventIndicators, ni);
+    return CALL_FMU(wrapper, get_event_indicators, (wrapper->component, eventIndicators, ni));
 }
 
 PUBLIC_EXPORT fmi2Status get_continuous_states(wrapped_fmu *wrapper, fmi2Real x[], size_t nx)
 {
-    return wrapper->get_continuous_states(wrapper->component, x, nx);
+    return CALL_FMU(wrapper, get_continuous_states, (wrapper->component, x, nx));
 }
 
 PUBLIC_EXPORT fmi2Status get_nominals_of_continuous_states(wrapped_fmu *wrapper, fmi2Real x_nominal[], size_t nx)
 {
-    return wrapper->get_nominals_of_continuous_states(wrapper->component, x_nominal, nx);
+    return CALL_FMU(wrapper, get_nominals_of_continuous_states, (wrapper->component, x_nominal, nx));
 }
 
 /* **************************************************
@@ -441,47 +1294,114 @@ Types for Functions for FMI2 for Co-Simulation
 /* Simulating the slave */
 PUBLIC_EXPORT fmi2Status set_real_input_derivatives(wrapped_fmu *wrapper, const fmi2ValueReference vr[], size_t nvr, const fmi2Integer order[], const fmi2Real value[])
 {
-    return wrapper->set_real_input_derivatives(wrapper->component, vr, nvr, order, value);
+    return CALL_FMU(wrapper, set_real_input_derivatives, (wrapper->component, vr, nvr, order, value));
 }
 
 PUBLIC_EXPORT fmi2Status get_real_output_derivatives(wrapped_fmu *wrapper, const fmi2ValueReference vr[], size_t nvr, const fmi2Integer order[], fmi2Real value[])
 {
-    return wrapper->get_real_output_derivatives(wrapper->component, vr, nvr, order, value);
+    return CALL_FMU(wrapper, get_real_output_derivatives, (wrapper->component, vr, nvr, order, value));
 }
 
 PUBLIC_EXPORT fmi2Status do_step(wrapped_fmu *wrapper, fmi2Real current_communication_point, fmi2Real communication_step_size, fmi2Boolean no_set_fmu_state_prior_to_current_point)
 {
-    return wrapper->do_step(wrapper->component, current_communication_point, communication_step_size, no_set_fmu_state_prior_to_current_point);
+    wrapper->simulation_time = current_communication_point;
+    fmi2Status status = CALL_FMU(wrapper, do_step, (wrapper->component, current_communication_point, communication_step_size, no_set_fmu_state_prior_to_current_point));
+    if (can_continue(status))
+    {
+        wrapper->simulation_time = current_communication_point + communication_step_size;
+        if (wrapper->recorder != NULL)
+        {
+            record_step(wrapper->recorder, wrapper, wrapper->simulation_time);
+        }
+    }
+    return status;
 }
 
 PUBLIC_EXPORT fmi2Status cancel_step(wrapped_fmu *wrapper)
 {
-    return wrapper->cancel_step(wrapper->component);
+    return CALL_FMU(wrapper, cancel_step, (wrapper->component));
+}
+
+/*! The row of a step in a row-major matrix, NULL for matrices without columns so they may be NULL themselves. */
+#define MATRIX_ROW(matrix, n_columns, step) ((n_columns) > 0 ? (matrix) + (step) * (n_columns) : NULL)
+
+PUBLIC_EXPORT fmi2Status do_steps(wrapped_fmu *wrapper, fmi2Real start_time, fmi2Real step_size, size_t n_steps,
+                                  fmi2Boolean no_set_fmu_state_prior_to_current_point,
+                                  const signal_group *inputs, const fmi2Real real_inputs[], const fmi2Integer integer_inputs[],
+                                  const fmi2Boolean boolean_inputs[],
+                                  const signal_group *outputs, fmi2Real real_outputs[], fmi2Integer integer_outputs[],
+                                  fmi2Boolean boolean_outputs[],
+                                  size_t *n_steps_done)
+{
+    fmi2Status result = fmi2OK;
+    size_t step = 0;
+    for (; step < n_steps; step++)
+    {
+        if (inputs != NULL)
+        {
+            result = worst_status(result, group_set(wrapper, inputs, MATRIX_ROW(real_inputs, inputs->n_real, step),
+                                                    MATRIX_ROW(integer_inputs, inputs->n_integer, step),
+                                                    MATRIX_ROW(boolean_inputs, inputs->n_boolean, step)));
+            if (!can_continue(result))
+            {
+                break;
+            }
+        }
+        // Multiply instead of accumulating to avoid drifting communication points
+        wrapper->simulation_time = start_time + step * step_size;
+        fmi2Status status = CALL_FMU(wrapper, do_step, (wrapper->component, wrapper->simulation_time, step_size, no_set_fmu_state_prior_to_current_point));
+        result = worst_status(result, status);
+        if (!can_continue(status))
+        {
+            break;
+        }
+        wrapper->simulation_time = start_time + (step + 1) * step_size;
+        if (wrapper->recorder != NULL)
+        {
+            record_step(wrapper->recorder, wrapper, wrapper->simulation_time);
+        }
+        if (outputs != NULL)
+        {
+            result = worst_status(result, group_get(wrapper, outputs, MATRIX_ROW(real_outputs, outputs->n_real, step),
+                                                    MATRIX_ROW(integer_outputs, outputs->n_integer, step),
+                                                    MATRIX_ROW(boolean_outputs, outputs->n_boolean, step)));
+            // The step is not counted as done if its row of outputs is incomplete
+            if (!can_continue(result))
+            {
+                break;
+            }
+        }
+    }
+    if (n_steps_done != NULL)
+    {
+        *n_steps_done = step;
+    }
+    return result;
 }
 
 /* Inquire slave status */
 PUBLIC_EXPORT fmi2Status get_status(wrapped_fmu *wrapper, const fmi2StatusKind status_kind, fmi2Status *value)
 {
     // Pass in the original enum and then cast it to int
-    fmi2Status result = wrapper->get_status(wrapper->component, status_kind, value);
+    fmi2Status result = CALL_FMU(wrapper, get_status, (wrapper->component, status_kind, value));
     return result;
 }
 
 PUBLIC_EXPORT fmi2Status get_real_status(wrapped_fmu *wrapper, const fmi2StatusKind status_kind, fmi2Real *value)
 {
-    return wrapper->get_real_status(wrapper->component, status_kind, value);
+    return CALL_FMU(wrapper, get_real_status, (wrapper->component, status_kind, value));
 }
 
 PUBLIC_EXPORT fmi2Status get_integer_status(wrapped_fmu *wrapper, const fmi2StatusKind status_kind, fmi2Integer *value)
 {
-    return wrapper->get_integer_status(wrapper->component, status_kind, value);
+    return CALL_FMU(wrapper, get_integer_status, (wrapper->component, status_kind, value));
 }
 
 PUBLIC_EXPORT fmi2Status get_boolean_status(wrapped_fmu *wrapper, const fmi2StatusKind status_kind, fmi2Boolean *value)
 {
-    return wrapper->get_boolean_status(wrapper->component, status_kind, value);
+    return CALL_FMU(wrapper, get_boolean_status, (wrapper->component, status_kind, value));
 }
 PUBLIC_EXPORT fmi2Status get_string_status(wrapped_fmu *wrapper, const fmi2StatusKind status_kind, fmi2String *value)
 {
-    return wrapper->get_string_status(wrapper->component, status_kind, value);
+    return CALL_FMU(wrapper, get_string_status, (wrapper->component, status_kind, value));
 }
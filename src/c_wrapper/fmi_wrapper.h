@@ -2,6 +2,7 @@
 #include "fmi2FunctionTypes.h"
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 /*!
     \brief A wrapper to simplify using fmus in other languages. The API is supposed to stay as close the fmi2 standard API as possible.
@@ -27,21 +28,240 @@
 #define PUBLIC_EXPORT
 #endif
 
-/*! The state struct that contains enviroment callbacks and the fmu functions. */
+/*! The state struct that contains enviroment callbacks and the fmu instance. */
 typedef struct wrapped_fmu wrapped_fmu;
+/*! A loaded binary with the resolved fmu functions. Shared by all instances created from it. */
+typedef struct fmu_binary fmu_binary;
 
 /*! A simplified log callback for the fmu. */
 typedef void (*log_t)(fmi2String instance_name, fmi2Status status, fmi2String category, fmi2String message);
 /*! A simplified stepFinished callback for the fmu. */
 typedef void (*step_finished_t)(fmi2Status status);
+/*! A set of value references registered once and used for repeated get and set calls, see create_signal_group. */
+typedef struct signal_group signal_group;
+/*! A log message buffered by the wrapper, see set_log_buffering. The strings stay valid until the next call of drain_logs. */
+typedef struct log_record
+{
+    fmi2String instance_name;
+    fmi2Status status;
+    fmi2String category;
+    fmi2String message;
+} log_record;
+/*! The memory that a pooled instance requested via allocateMemory, see instantiate_pooled. */
+typedef struct allocation_statistics
+{
+    size_t n_allocations;
+    size_t n_frees;
+    /*! The sum of all requested sizes. */
+    size_t bytes_allocated;
+    /*! The requested sizes of the blocks that have not been freed yet. */
+    size_t bytes_in_use;
+    size_t peak_bytes_in_use;
+    /*! The memory that the pool holds, including the free blocks and the bookkeeping. */
+    size_t bytes_reserved;
+} allocation_statistics;
+/*! The fmi2 functions that the call statistics are recorded for, see set_call_statistics. */
+typedef enum fmu_function
+{
+    fmu_function_set_debug_logging,
+    fmu_function_setup_experiment,
+    fmu_function_enter_initialization_mode,
+    fmu_function_exit_initialization_mode,
+    fmu_function_terminate,
+    fmu_function_reset,
+    fmu_function_get_real,
+    fmu_function_get_integer,
+    fmu_function_get_boolean,
+    fmu_function_get_string,
+    fmu_function_set_real,
+    fmu_function_set_integer,
+    fmu_function_set_boolean,
+    fmu_function_set_string,
+    fmu_function_get_fmu_state,
+    fmu_function_set_fmu_state,
+    fmu_function_free_fmu_state,
+    fmu_function_serialized_fmu_state_size,
+    fmu_function_serialize_fmu_state,
+    fmu_function_deserialize_fmu_state,
+    fmu_function_get_directional_derivative,
+    fmu_function_enter_event_mode,
+    fmu_function_new_discrete_states,
+    fmu_function_enter_continuous_time_mode,
+    fmu_function_completed_integrator_step,
+    fmu_function_set_time,
+    fmu_function_set_continuous_states,
+    fmu_function_get_derivatives,
+    fmu_function_get_event_indicators,
+    fmu_function_get_continuous_states,
+    fmu_function_get_nominals_of_continuous_states,
+    fmu_function_set_real_input_derivatives,
+    fmu_function_get_real_output_derivatives,
+    fmu_function_do_step,
+    fmu_function_cancel_step,
+    fmu_function_get_status,
+    fmu_function_get_real_status,
+    fmu_function_get_integer_status,
+    fmu_function_get_boolean_status,
+    fmu_function_get_string_status,
+    /*! The number of functions, not a function. */
+    fmu_function_count
+} fmu_function;
+/*! The number of buckets of the latency histograms, see get_latency_bucket_lower_bound. */
+#define LATENCY_HISTOGRAM_BUCKETS 304
+/*! The calls of one fmi2 function, the latencies are measured in nanoseconds. */
+typedef struct call_statistics
+{
+    uint64_t n_calls;
+    uint64_t total_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    /*!
+        Log-linear buckets like in HDR histograms: each power of two is split into 8 buckets,
+        so a bucket is at most 12.5% wider than its lower bound. Latencies beyond 2^40 ns are counted in the last bucket.
+    */
+    uint64_t histogram[LATENCY_HISTOGRAM_BUCKETS];
+} call_statistics;
+
+/* Loading and releasing FMU binaries */
+
+/*!
+    \brief Load the binary of a fmu and resolve its functions.
+    The binaries are cached process wide by their resolved path, so loading the same binary again only increments a reference count.
+    The call is thread-safe.
+    \param file_name The filename of the binary. Can be a relative or ideally a full path.
+    \return A handle to the binary that can be passed to instantiate_binary. Returns NULL if it failed.
+*/
+PUBLIC_EXPORT fmu_binary *load_binary(const char *file_name);
+/*!
+    \brief Loads the binary in a separate fmi_wrapper_host process for each instance instead of the calling process.
+    A crashing fmu only terminates its host, the calls of the instance return fmi2Fatal afterwards.
+    The calls are forwarded through shared memory, log messages are forwarded to the log callback of the instance.
+    The asynchronous doStep is not supported, the step finished callback is never called.
+    \param host_executable The path of the fmi_wrapper_host executable.
+    \param file_name The filename of the binary that the host loads.
+    \return A handle to the binary that can be passed to instantiate_binary. Returns NULL if one of the files does not exist.
+*/
+PUBLIC_EXPORT fmu_binary *load_binary_out_of_process(const char *host_executable, const char *file_name);
+/*!
+    \brief Releases the reference acquired by load_binary. The library is unloaded when no instance uses it anymore.
+    \param binary Pointer returned by load_binary or load_binary_out_of_process.
+*/
+PUBLIC_EXPORT void free_binary(fmu_binary *binary);
 
 /* Creation and destruction of FMU instances and setting debug status */
 
+/*!
+    \brief Create a instance of a fmu from a binary loaded by load_binary.
+    The instance holds its own reference to the binary, so the binary may be released before the instance.
+    \param binary The binary returned by load_binary or load_binary_out_of_process.
+    \param other The other parameters match the ones of instantiate.
+    \return A pointer to a component that wraps the fmu functions. Returns NULL if it failed.
+*/
+PUBLIC_EXPORT wrapped_fmu *instantiate_binary(fmu_binary *binary, log_t log, step_finished_t step_finished,
+                                              fmi2String instance_name, fmi2Type fmu_type, fmi2String guid, fmi2String resource_location, fmi2Boolean visible, fmi2Boolean logging_on);
+/*!
+    \brief Like instantiate_binary, but the memory that the fmu allocates via the callbacks comes from a pool of the instance.
+    Small blocks are recycled via free lists per size class, which suits fmus that allocate and free in every step.
+    All memory of the pool is released at once by free_instance, including blocks that the fmu did not free.
+    Out-of-process binaries allocate in the host process, the pool is not used for them.
+    \return A pointer to a component that wraps the fmu functions. Returns NULL if it failed.
+*/
+PUBLIC_EXPORT wrapped_fmu *instantiate_pooled(fmu_binary *binary, log_t log, step_finished_t step_finished,
+                                              fmi2String instance_name, fmi2Type fmu_type, fmi2String guid, fmi2String resource_location, fmi2Boolean visible, fmi2Boolean logging_on);
+/*!
+    \brief Get the counters of the memory pool of an instance created by instantiate_pooled.
+    \return fmi2Error if the instance does not use a pool.
+*/
+PUBLIC_EXPORT fmi2Status get_allocation_statistics(wrapped_fmu *wrapper, allocation_statistics *statistics);
+
+/* Call statistics */
+
+/*!
+    \brief Measure the calls into the fmu: the number of calls and a latency histogram per fmi2 function.
+    The latencies include the log and step finished callbacks and for out-of-process binaries the communication with the host.
+    Must not be called while the fmu is executing a function.
+    \param enabled Enabling starts with empty statistics, disabling discards them.
+    \return fmi2Error if the statistics could not be allocated.
+*/
+PUBLIC_EXPORT fmi2Status set_call_statistics(wrapped_fmu *wrapper, fmi2Boolean enabled);
+/*!
+    \brief Copy the statistics of one function.
+    \param reset Start over after copying, so consecutive snapshots do not overlap.
+    \return fmi2Error if the call statistics are not enabled or the function is out of range.
+*/
+PUBLIC_EXPORT fmi2Status get_call_statistics(wrapped_fmu *wrapper, fmu_function function, call_statistics *statistics, fmi2Boolean reset);
+/*! \brief The fmi2 name of the function, e.g. "fmi2DoStep". NULL if the function is out of range. */
+PUBLIC_EXPORT const char *get_fmu_function_name(fmu_function function);
+/*! \brief The smallest latency in nanoseconds that is counted in the bucket of the histogram. */
+PUBLIC_EXPORT uint64_t get_latency_bucket_lower_bound(size_t bucket);
+/*!
+    \brief Estimate a percentile of the latencies from the histogram.
+    \param percentile Between 0 and 100, e.g. 99 for the latency that 99% of the calls did not exceed.
+    \return The upper bound of the bucket that contains the percentile, limited to max_ns. 0 if there were no calls.
+*/
+PUBLIC_EXPORT uint64_t get_latency_percentile(const call_statistics *statistics, double percentile);
+
+/* Tracing */
+
+/*!
+    \brief Start a process wide trace session that writes Chrome trace JSON, which also loads in Perfetto.
+    The instances enabled by set_tracing record begin and end events of their fmi2 calls and instant events of their
+    log messages and step finished callbacks, tagged with the instance name and the simulation time.
+    Each thread buffers its events without locks, they are written by flush_trace, free_instance and stop_trace.
+    \param file_name The file is overwritten.
+    \param events_per_thread The capacity of the buffer of each thread, rounded up to the next power of two.
+    Events are dropped when a buffer is full.
+    \return fmi2Error if a session is running already or the file could not be created.
+*/
+PUBLIC_EXPORT fmi2Status start_trace(const char *file_name, size_t events_per_thread);
+/*!
+    \brief Write the buffered events of all threads to the file, may be called while the instances are running.
+    \return fmi2Warning if events have been dropped since the last flush, fmi2Error if no session is running or writing failed.
+*/
+PUBLIC_EXPORT fmi2Status flush_trace(void);
+/*!
+    \brief Flush the events, complete and close the file.
+    Must not be called while a traced instance is executing a function.
+    \return fmi2Warning if events have been dropped during the session, fmi2Error if no session is running or writing failed.
+*/
+PUBLIC_EXPORT fmi2Status stop_trace(void);
+/*! \brief Record trace events for the instance while a trace session is running, see start_trace. */
+PUBLIC_EXPORT fmi2Status set_tracing(wrapped_fmu *wrapper, fmi2Boolean enabled);
+
+/* Recording */
+
+/*! Options of start_recording, zero selects the default of a value. */
+typedef struct recorder_options
+{
+    /*! Record every n-th step. Defaults to 1. */
+    size_t decimation;
+    /*! The samples that are buffered before they are written as block. A crash loses the unwritten samples. Defaults to 1024. */
+    size_t samples_per_block;
+    /*! Store each value as XOR with its predecessor, columns that do not shrink stay raw. */
+    fmi2Boolean compress;
+} recorder_options;
+
+/*!
+    \brief Record the signals of the group after each step into a columnar memory mapped file, see open_recording.
+    Records the current values immediately and then the values after each completed do_step or step of do_steps.
+    Integers and booleans are recorded as doubles. The group is copied.
+    \param file_name The file is overwritten.
+    \param options May be NULL for the defaults.
+    \return fmi2Error if the instance is recording already, the file could not be created or the first sample could not be read.
+*/
+PUBLIC_EXPORT fmi2Status start_recording(wrapped_fmu *wrapper, const char *file_name, const signal_group *signals, const recorder_options *options);
+/*!
+    \brief Write the buffered samples and close the file, free_instance stops the recording as well.
+    \return fmi2Error if samples have been lost because reading the signals or writing the file failed, or the instance is not recording.
+*/
+PUBLIC_EXPORT fmi2Status stop_recording(wrapped_fmu *wrapper);
+
 /*!
     \brief Create a instance of a fmu that uses the simplified callbacks.
+    Shorthand for load_binary, instantiate_binary and free_binary.
     \param fileName The filename of the binary. Can be a relative or ideally a full path.
-    \param logCallback This function will be called when the fmu logs.
-    \param stepFinishedCallback This function will be called when a simulation step has finished.
+    \param logCallback This function will be called when the fmu logs. May be NULL.
+    \param stepFinishedCallback This function will be called when a simulation step has finished. May be NULL.
     \param other These parameters match the ones from the fmi2 standard.
     \return A pointer to a component that wraps the fmu functions. Pass this pointer to the fmi2 function calls. Returns NULL if it failed.
 */
@@ -49,10 +269,37 @@ PUBLIC_EXPORT wrapped_fmu *instantiate(const char *file_name, log_t log, step_fi
                                        fmi2String instance_name, fmi2Type fmu_type, fmi2String guid, fmi2String resource_location, fmi2Boolean visible, fmi2Boolean logging_on);
 /*!
     \brief Releases the underlying fmu instance and the wrapper.
-    \param wrapper Pointer returned by create_wrapper.
+    \param wrapper Pointer returned by instantiate, instantiate_binary or instantiate_pooled.
 */
 PUBLIC_EXPORT void free_instance(wrapped_fmu *wrapper);
 PUBLIC_EXPORT fmi2Status set_debug_logging(wrapped_fmu *wrapper, fmi2Boolean logging_on, size_t n_categories, fmi2String categories[]);
+/*!
+    \brief Discard log messages of the fmu before they are formatted, for fmus that ignore set_debug_logging.
+    The log callback of the wrapper reads the filter, so it must not be called while the fmu is executing a function.
+    \param min_status Messages with a less severe status are discarded. Pass fmi2OK to keep all.
+    \param deny_categories If false only messages of the listed categories are kept, otherwise messages of the listed categories are discarded.
+    \param n_categories The number of categories. Pass 0 to keep messages of all categories.
+    \param categories The categories are copied.
+    \return fmi2Error if the categories could not be copied. The previous filter stays active in this case.
+*/
+PUBLIC_EXPORT fmi2Status set_log_filter(wrapped_fmu *wrapper, fmi2Status min_status, fmi2Boolean deny_categories, size_t n_categories, const fmi2String categories[]);
+/*!
+    \brief Buffer the log messages of the fmu instead of calling the log callback synchronously.
+    The messages are written to a lock-free ring buffer and must be fetched via drain_logs. Messages are dropped when the buffer is full.
+    Must not be called while the fmu is executing a function.
+    \param capacity The maximum number of buffered messages. Pass 0 to disable buffering and forward the messages to the log callback again.
+    \param record_size The maximum number of chars per message including instance name and category. Longer messages are truncated.
+    \return fmi2Error if the buffer could not be allocated.
+*/
+PUBLIC_EXPORT fmi2Status set_log_buffering(wrapped_fmu *wrapper, size_t capacity, size_t record_size);
+/*!
+    \brief Fetch the oldest buffered log messages. May be called from another thread than the one simulating the fmu.
+    The records returned by the previous call are released, so copy the strings before calling drain_logs again.
+    \param records Receives up to max_records records.
+    \param n_dropped Receives the number of messages dropped since the last call. May be NULL.
+    \return The number of records written. 0 if buffering is disabled.
+*/
+PUBLIC_EXPORT size_t drain_logs(wrapped_fmu *wrapper, log_record records[], size_t max_records, size_t *n_dropped);
 
 /* Inquire version numbers of header files and setting logging status */
 PUBLIC_EXPORT const char *get_types_platform(wrapped_fmu *wrapper);
@@ -76,10 +323,52 @@ PUBLIC_EXPORT fmi2Status set_integer(wrapped_fmu *wrapper, const fmi2ValueRefere
 PUBLIC_EXPORT fmi2Status set_boolean(wrapped_fmu *wrapper, const fmi2ValueReference vr[], size_t nvr, const fmi2Boolean value[]);
 PUBLIC_EXPORT fmi2Status set_string(wrapped_fmu *wrapper, const fmi2ValueReference vr[], size_t nvr, const fmi2String value[]);
 
+/*!
+    \brief Register value references of mixed types for repeated access via group_get and group_set.
+    The value references are copied, so the arrays of the caller are only needed during this call.
+    A group is not bound to an instance and can be used with every instance of the same fmu.
+    \param n_real The number of real value references, may be 0. The other counts work the same.
+    \return NULL if the memory could not be allocated. Release it via free_signal_group.
+*/
+PUBLIC_EXPORT signal_group *create_signal_group(size_t n_real, const fmi2ValueReference real_vr[],
+                                               size_t n_integer, const fmi2ValueReference integer_vr[],
+                                               size_t n_boolean, const fmi2ValueReference boolean_vr[]);
+PUBLIC_EXPORT void free_signal_group(signal_group *group);
+/*!
+    \brief Get all values of the group in one call. Each buffer receives the values in the order of the registered value references.
+    Buffers of types without members may be NULL. Stops after the first call that returns fmi2Error or worse.
+    \return The most severe status of the calls.
+*/
+PUBLIC_EXPORT fmi2Status group_get(wrapped_fmu *wrapper, const signal_group *group, fmi2Real real_values[], fmi2Integer integer_values[], fmi2Boolean boolean_values[]);
+/*! \brief Set all values of the group in one call, see group_get. */
+PUBLIC_EXPORT fmi2Status group_set(wrapped_fmu *wrapper, const signal_group *group, const fmi2Real real_values[], const fmi2Integer integer_values[], const fmi2Boolean boolean_values[]);
+
 /* Getting and setting the internal FMU state */
 PUBLIC_EXPORT fmi2Status get_fmu_state(wrapped_fmu *wrapper, fmi2FMUstate *fmu_state);
 PUBLIC_EXPORT fmi2Status set_fmu_state(wrapped_fmu *wrapper, fmi2FMUstate fmu_state);
 PUBLIC_EXPORT fmi2Status free_fmu_state(wrapped_fmu *wrapper, fmi2FMUstate *fmu_state);
+/*!
+    \brief Keep a bounded pool of fmu states on the instance, so a master can roll back steps via save_checkpoint and restore_checkpoint.
+    The fmu state of a slot is allocated by its first save and overwritten in place when the slot is reused.
+    The states are freed via free_fmu_state when the capacity is changed or the instance is freed, existing checkpoints are discarded.
+    \param n_slots The maximum number of checkpoints. Pass 0 to free all checkpoints.
+    \param can_get_and_set_fmu_state The canGetAndSetFMUstate attribute of the model description.
+    \return fmi2Error if the fmu can not get and set its state, the reason is logged with the category logStatusError.
+    Also fmi2Error if the memory could not be allocated, the previous pool stays active in this case.
+*/
+PUBLIC_EXPORT fmi2Status set_checkpoint_capacity(wrapped_fmu *wrapper, size_t n_slots, fmi2Boolean can_get_and_set_fmu_state);
+/*!
+    \brief Save the current state of the fmu in a free slot.
+    \param slot Receives the id of the slot, it stays valid until release_checkpoint.
+    \return fmi2Error if all slots are in use.
+*/
+PUBLIC_EXPORT fmi2Status save_checkpoint(wrapped_fmu *wrapper, size_t *slot);
+/*! \brief Overwrite a saved checkpoint with the current state, e.g. to move the rollback point forward after an accepted step. */
+PUBLIC_EXPORT fmi2Status update_checkpoint(wrapped_fmu *wrapper, size_t slot);
+/*! \brief Roll the fmu back to a saved checkpoint. The checkpoint stays valid, so it can be restored repeatedly. */
+PUBLIC_EXPORT fmi2Status restore_checkpoint(wrapped_fmu *wrapper, size_t slot);
+/*! \brief Return the slot to the pool. Its fmu state is kept for the next save_checkpoint. */
+PUBLIC_EXPORT fmi2Status release_checkpoint(wrapped_fmu *wrapper, size_t slot);
 PUBLIC_EXPORT fmi2Status serialized_fmu_state_size(wrapped_fmu *wrapper, fmi2FMUstate fmu_state, size_t *size);
 PUBLIC_EXPORT fmi2Status serialize_fmu_state(wrapped_fmu *wrapper, fmi2FMUstate fmu_state, fmi2Byte serialized_state[], size_t size);
 PUBLIC_EXPORT fmi2Status deserialize_fmu_state(wrapped_fmu *wrapper, const fmi2Byte serialized_state[], size_t size, fmi2FMUstate *fmu_state);
@@ -120,6 +409,31 @@ PUBLIC_EXPORT fmi2Status get_real_output_derivatives(wrapped_fmu *wrapper, const
 PUBLIC_EXPORT fmi2Status do_step(wrapped_fmu *wrapper, fmi2Real current_communication_point, fmi2Real communication_step_size, fmi2Boolean no_set_fmu_state_prior_to_current_point);
 PUBLIC_EXPORT fmi2Status cancel_step(wrapped_fmu *wrapper);
 
+/*!
+    \brief Run multiple communication steps in one call to avoid one call from the calling enviroment per step.
+    Each step k sets the inputs of row k via group_set, calls do_step at start_time + k * step_size and reads the outputs
+    into row k via group_get. The loop stops early if a call does not return fmi2OK or fmi2Warning.
+    \param start_time The communication point of the first step.
+    \param step_size The communication step size of every step.
+    \param n_steps The number of steps to simulate.
+    \param no_set_fmu_state_prior_to_current_point Passed to every do_step, see do_step.
+    \param inputs The signals which are set before each step. May be NULL.
+    \param real_inputs Row-major matrix with n_steps rows and a column for each real input. The integer and boolean inputs
+    work the same. Matrices of types without inputs may be NULL.
+    \param outputs The signals which are read after each step. May be NULL.
+    \param real_outputs Row-major matrix with n_steps rows and a column for each real output which receives the outputs.
+    The integer and boolean outputs work the same. Matrices of types without outputs may be NULL.
+    \param n_steps_done Receives the number of completed steps whose outputs have been read. May be NULL.
+    \return The most severe status of all the calls.
+*/
+PUBLIC_EXPORT fmi2Status do_steps(wrapped_fmu *wrapper, fmi2Real start_time, fmi2Real step_size, size_t n_steps,
+                                  fmi2Boolean no_set_fmu_state_prior_to_current_point,
+                                  const signal_group *inputs, const fmi2Real real_inputs[], const fmi2Integer integer_inputs[],
+                                  const fmi2Boolean boolean_inputs[],
+                                  const signal_group *outputs, fmi2Real real_outputs[], fmi2Integer integer_outputs[],
+                                  fmi2Boolean boolean_outputs[],
+                                  size_t *n_steps_done);
+
 /* Inquire slave status */
 PUBLIC_EXPORT fmi2Status get_status(wrapped_fmu *wrapper, const fmi2StatusKind status_kind, fmi2Status *value);
 PUBLIC_EXPORT fmi2Status get_real_status(wrapped_fmu *wrapper, const fmi2StatusKind status_kind, fmi2Real *value);
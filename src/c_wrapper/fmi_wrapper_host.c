@@ -0,0 +1,431 @@
+/*!
+    \brief Runs one fmu instance on behalf of a client process, see load_binary_out_of_process.
+    Usage: fmi_wrapper_host <channel name> <client process id>
+    The host exits after the instance has been freed or when the client process died.
+*/
+#include "fmi_wrapper.h"
+#include "host_protocol.h"
+#include "system_functions.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*! Check the liveness of the client in this interval while waiting for a request. */
+#define CLIENT_POLL_INTERVAL_MS 1000
+
+/*! The host serves a single instance, so the log callback finds the channel here. */
+static host_channel channel;
+static unsigned long client_id;
+
+/*! Wait for the next message of the client. \return false if the client died. */
+static bool wait_for_client_message(void)
+{
+    while (!wait_for_client(&channel, CLIENT_POLL_INTERVAL_MS))
+    {
+        if (!isProcessIdRunning(client_id))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*! Send the log message to the client and wait until it has been processed. */
+static void host_log(fmi2String instance_name, fmi2Status status, fmi2String category, fmi2String message)
+{
+    host_message *callback = channel.callback;
+    begin_message(callback, HOST_LOG);
+    callback->arguments[0] = (uint64_t)status;
+    // Truncate messages that do not fit into the callback area
+    add_string(callback, HOST_CALLBACK_AREA_SIZE, instance_name);
+    add_string(callback, HOST_CALLBACK_AREA_SIZE, category);
+    size_t length = message != NULL ? strlen(message) : 0;
+    if (length >= HOST_CALLBACK_AREA_SIZE / 2)
+    {
+        length = HOST_CALLBACK_AREA_SIZE / 2 - 1;
+    }
+    char *text = add_buffer(callback, HOST_CALLBACK_AREA_SIZE, message, length + 1);
+    if (text != NULL)
+    {
+        text[length] = '\0';
+    }
+    send_to_client(&channel, true);
+    if (!wait_for_client_message())
+    {
+        exit(EXIT_FAILURE);
+    }
+}
+
+/*! Get a buffer of the request. */
+static void *request_buffer(uint32_t index, size_t *size)
+{
+    return get_buffer(channel.request, HOST_MESSAGE_AREA_SIZE, index, size);
+}
+
+/*! Get a buffer of the request and check that it contains n elements. */
+static void *request_array(uint32_t index, size_t n, size_t element_size)
+{
+    size_t size;
+    void *buffer = request_buffer(index, &size);
+    return buffer != NULL && size == n * element_size ? buffer : NULL;
+}
+
+/*! Split a buffer of concatenated strings, the result must be freed. */
+static fmi2String *request_strings(uint32_t index, size_t n)
+{
+    size_t size;
+    const char *buffer = request_buffer(index, &size);
+    fmi2String *strings = malloc((n > 0 ? n : 1) * sizeof(fmi2String));
+    if (buffer == NULL || strings == NULL)
+    {
+        free(strings);
+        return NULL;
+    }
+    const char *end = buffer + size;
+    for (size_t i = 0; i < n; i++)
+    {
+        const char *terminator = memchr(buffer, '\0', (size_t)(end - buffer));
+        if (terminator == NULL)
+        {
+            free(strings);
+            return NULL;
+        }
+        strings[i] = buffer;
+        buffer = terminator + 1;
+    }
+    return strings;
+}
+
+/*! Reserve a buffer for the values of the response. */
+static void *response_buffer(size_t size)
+{
+    return add_buffer(channel.response, HOST_MESSAGE_AREA_SIZE, NULL, size);
+}
+
+static wrapped_fmu *instantiate_request(void)
+{
+    host_message *request = channel.request;
+    const char *binary_path = get_string_buffer(request, HOST_MESSAGE_AREA_SIZE, 0);
+    if (binary_path == NULL)
+    {
+        return NULL;
+    }
+    return instantiate(binary_path, host_log, NULL, get_string_buffer(request, HOST_MESSAGE_AREA_SIZE, 1), (fmi2Type)request->arguments[0],
+                       get_string_buffer(request, HOST_MESSAGE_AREA_SIZE, 2), get_string_buffer(request, HOST_MESSAGE_AREA_SIZE, 3),
+                       request->arguments[1] != 0, request->arguments[2] != 0);
+}
+
+/*! Call get_string and concatenate the strings into the response. */
+static fmi2Status get_strings(wrapped_fmu *instance, const fmi2ValueReference vr[], size_t nvr)
+{
+    fmi2String *values = malloc((nvr > 0 ? nvr : 1) * sizeof(fmi2String));
+    if (values == NULL)
+    {
+        return fmi2Error;
+    }
+    fmi2Status status = get_string(instance, vr, nvr, values);
+    if (status <= fmi2Error)
+    {
+        size_t size = 0;
+        for (size_t i = 0; i < nvr; i++)
+        {
+            size += (values[i] != NULL ? strlen(values[i]) : 0) + 1;
+        }
+        char *buffer = response_buffer(size);
+        for (size_t i = 0; i < nvr && buffer != NULL; i++)
+        {
+            size_t length = values[i] != NULL ? strlen(values[i]) : 0;
+            memcpy(buffer, values[i] != NULL ? values[i] : "", length + 1);
+            buffer += length + 1;
+        }
+        if (buffer == NULL && status < fmi2Error)
+        {
+            status = fmi2Error;
+        }
+    }
+    free(values);
+    return status;
+}
+
+/*! Execute the request on the instance and write the results into the response. */
+static fmi2Status dispatch(wrapped_fmu *instance)
+{
+    host_message *request = channel.request;
+    host_message *response = channel.response;
+    size_t n = 0;
+    request_buffer(0, &n);
+    size_t nvr = n / sizeof(fmi2ValueReference);
+    const fmi2ValueReference *vr = request_array(0, nvr, sizeof(fmi2ValueReference));
+    switch (request->function)
+    {
+    case HOST_SET_DEBUG_LOGGING:
+    {
+        fmi2String *categories = request_strings(0, (size_t)request->arguments[1]);
+        if (categories == NULL)
+        {
+            return fmi2Error;
+        }
+        fmi2Status status = set_debug_logging(instance, request->arguments[0] != 0, (size_t)request->arguments[1], categories);
+        free(categories);
+        return status;
+    }
+    case HOST_SETUP_EXPERIMENT:
+        return setup_experiment(instance, request->arguments[0] != 0, request->real_arguments[0], request->real_arguments[1],
+                                request->arguments[1] != 0, request->real_arguments[2]);
+    case HOST_ENTER_INITIALIZATION_MODE:
+        return enter_initialization_mode(instance);
+    case HOST_EXIT_INITIALIZATION_MODE:
+        return exit_initialization_mode(instance);
+    case HOST_TERMINATE:
+        return terminate(instance);
+    case HOST_RESET:
+        return reset(instance);
+    case HOST_GET_REAL:
+    {
+        fmi2Real *values = response_buffer(nvr * sizeof(fmi2Real));
+        return values != NULL ? get_real(instance, vr, nvr, values) : fmi2Error;
+    }
+    case HOST_GET_INTEGER:
+    {
+        fmi2Integer *values = response_buffer(nvr * sizeof(fmi2Integer));
+        return values != NULL ? get_integer(instance, vr, nvr, values) : fmi2Error;
+    }
+    case HOST_GET_BOOLEAN:
+    {
+        fmi2Boolean *values = response_buffer(nvr * sizeof(fmi2Boolean));
+        return values != NULL ? get_boolean(instance, vr, nvr, values) : fmi2Error;
+    }
+    case HOST_GET_STRING:
+        return get_strings(instance, vr, nvr);
+    case HOST_SET_REAL:
+    {
+        const fmi2Real *values = request_array(1, nvr, sizeof(fmi2Real));
+        return values != NULL ? set_real(instance, vr, nvr, values) : fmi2Error;
+    }
+    case HOST_SET_INTEGER:
+    {
+        const fmi2Integer *values = request_array(1, nvr, sizeof(fmi2Integer));
+        return values != NULL ? set_integer(instance, vr, nvr, values) : fmi2Error;
+    }
+    case HOST_SET_BOOLEAN:
+    {
+        const fmi2Boolean *values = request_array(1, nvr, sizeof(fmi2Boolean));
+        return values != NULL ? set_boolean(instance, vr, nvr, values) : fmi2Error;
+    }
+    case HOST_SET_STRING:
+    {
+        fmi2String *values = request_strings(1, nvr);
+        if (values == NULL)
+        {
+            return fmi2Error;
+        }
+        fmi2Status status = set_string(instance, vr, nvr, values);
+        free(values);
+        return status;
+    }
+    case HOST_GET_FMU_STATE:
+    {
+        fmi2FMUstate state = (fmi2FMUstate)(uintptr_t)request->arguments[0];
+        fmi2Status status = get_fmu_state(instance, &state);
+        response->arguments[0] = (uint64_t)(uintptr_t)state;
+        return status;
+    }
+    case HOST_SET_FMU_STATE:
+        return set_fmu_state(instance, (fmi2FMUstate)(uintptr_t)request->arguments[0]);
+    case HOST_FREE_FMU_STATE:
+    {
+        fmi2FMUstate state = (fmi2FMUstate)(uintptr_t)request->arguments[0];
+        return free_fmu_state(instance, &state);
+    }
+    case HOST_SERIALIZED_FMU_STATE_SIZE:
+    {
+        size_t size = 0;
+        fmi2Status status = serialized_fmu_state_size(instance, (fmi2FMUstate)(uintptr_t)request->arguments[0], &size);
+        response->arguments[0] = size;
+        return status;
+    }
+    case HOST_SERIALIZE_FMU_STATE:
+    {
+        fmi2Byte *serialized_state = response_buffer((size_t)request->arguments[1]);
+        return serialized_state != NULL
+                   ? serialize_fmu_state(instance, (fmi2FMUstate)(uintptr_t)request->arguments[0], serialized_state, (size_t)request->arguments[1])
+                   : fmi2Error;
+    }
+    case HOST_DESERIALIZE_FMU_STATE:
+    {
+        fmi2FMUstate state = (fmi2FMUstate)(uintptr_t)request->arguments[0];
+        fmi2Status status = deserialize_fmu_state(instance, request_buffer(0, &n), n, &state);
+        response->arguments[0] = (uint64_t)(uintptr_t)state;
+        return status;
+    }
+    case HOST_GET_DIRECTIONAL_DERIVATIVE:
+    {
+        size_t n_known = 0;
+        request_buffer(1, &n_known);
+        n_known /= sizeof(fmi2ValueReference);
+        const fmi2ValueReference *known_vr = request_array(1, n_known, sizeof(fmi2ValueReference));
+        const fmi2Real *dv_known = request_array(2, n_known, sizeof(fmi2Real));
+        fmi2Real *dv_unknown = response_buffer(nvr * sizeof(fmi2Real));
+        if (known_vr == NULL || dv_known == NULL || dv_unknown == NULL)
+        {
+            return fmi2Error;
+        }
+        return get_directional_derivative(instance, vr, nvr, known_vr, n_known, dv_known, dv_unknown);
+    }
+    case HOST_ENTER_EVENT_MODE:
+        return enter_event_mode(instance);
+    case HOST_NEW_DISCRETE_STATES:
+    {
+        fmi2EventInfo event_info = {0};
+        fmi2Status status = new_discrete_states(instance, &event_info);
+        response->arguments[0] = (event_info.newDiscreteStatesNeeded ? 1 : 0) | (event_info.terminateSimulation ? 2 : 0) |
+                                 (event_info.nominalsOfContinuousStatesChanged ? 4 : 0) | (event_info.valuesOfContinuousStatesChanged ? 8 : 0) |
+                                 (event_info.nextEventTimeDefined ? 16 : 0);
+        response->real_arguments[0] = event_info.nextEventTime;
+        return status;
+    }
+    case HOST_ENTER_CONTINUOUS_TIME_MODE:
+        return enter_continuous_time_mode(instance);
+    case HOST_COMPLETED_INTEGRATOR_STEP:
+    {
+        fmi2Boolean enter_event = fmi2False;
+        fmi2Boolean terminate_simulation = fmi2False;
+        fmi2Status status = completed_integrator_step(instance, request->arguments[0] != 0, &enter_event, &terminate_simulation);
+        response->arguments[0] = enter_event ? 1 : 0;
+        response->arguments[1] = terminate_simulation ? 1 : 0;
+        return status;
+    }
+    case HOST_SET_TIME:
+        return set_time(instance, request->real_arguments[0]);
+    case HOST_SET_CONTINUOUS_STATES:
+    {
+        const fmi2Real *x = request_buffer(0, &n);
+        return x != NULL ? set_continuous_states(instance, x, n / sizeof(fmi2Real)) : fmi2Error;
+    }
+    case HOST_GET_DERIVATIVES:
+    case HOST_GET_EVENT_INDICATORS:
+    case HOST_GET_CONTINUOUS_STATES:
+    case HOST_GET_NOMINALS_OF_CONTINUOUS_STATES:
+    {
+        size_t n_values = (size_t)request->arguments[0];
+        fmi2Real *values = n_values <= HOST_MESSAGE_AREA_SIZE / sizeof(fmi2Real) ? response_buffer(n_values * sizeof(fmi2Real)) : NULL;
+        if (values == NULL)
+        {
+            return fmi2Error;
+        }
+        switch (request->function)
+        {
+        case HOST_GET_DERIVATIVES:
+            return get_derivatives(instance, values, n_values);
+        case HOST_GET_EVENT_INDICATORS:
+            return get_event_indicators(instance, values, n_values);
+        case HOST_GET_CONTINUOUS_STATES:
+            return get_continuous_states(instance, values, n_values);
+        default:
+            return get_nominals_of_continuous_states(instance, values, n_values);
+        }
+    }
+    case HOST_SET_REAL_INPUT_DERIVATIVES:
+    {
+        const fmi2Integer *order = request_array(1, nvr, sizeof(fmi2Integer));
+        const fmi2Real *values = request_array(2, nvr, sizeof(fmi2Real));
+        return order != NULL && values != NULL ? set_real_input_derivatives(instance, vr, nvr, order, values) : fmi2Error;
+    }
+    case HOST_GET_REAL_OUTPUT_DERIVATIVES:
+    {
+        const fmi2Integer *order = request_array(1, nvr, sizeof(fmi2Integer));
+        fmi2Real *values = response_buffer(nvr * sizeof(fmi2Real));
+        return order != NULL && values != NULL ? get_real_output_derivatives(instance, vr, nvr, order, values) : fmi2Error;
+    }
+    case HOST_DO_STEP:
+        return do_step(instance, request->real_arguments[0], request->real_arguments[1], request->arguments[0] != 0);
+    case HOST_CANCEL_STEP:
+        return cancel_step(instance);
+    case HOST_GET_STATUS:
+    {
+        fmi2Status value = fmi2OK;
+        fmi2Status status = get_status(instance, (fmi2StatusKind)request->arguments[0], &value);
+        response->arguments[0] = (uint64_t)value;
+        return status;
+    }
+    case HOST_GET_REAL_STATUS:
+        return get_real_status(instance, (fmi2StatusKind)request->arguments[0], &response->real_arguments[0]);
+    case HOST_GET_INTEGER_STATUS:
+    {
+        fmi2Integer value = 0;
+        fmi2Status status = get_integer_status(instance, (fmi2StatusKind)request->arguments[0], &value);
+        response->arguments[0] = (uint64_t)(int64_t)value;
+        return status;
+    }
+    case HOST_GET_BOOLEAN_STATUS:
+    {
+        fmi2Boolean value = fmi2False;
+        fmi2Status status = get_boolean_status(instance, (fmi2StatusKind)request->arguments[0], &value);
+        response->arguments[0] = value ? 1 : 0;
+        return status;
+    }
+    case HOST_GET_STRING_STATUS:
+    {
+        fmi2String value = NULL;
+        fmi2Status status = get_string_status(instance, (fmi2StatusKind)request->arguments[0], &value);
+        add_string(response, HOST_MESSAGE_AREA_SIZE, value);
+        return status;
+    }
+    default:
+        return fmi2Error;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "Usage: %s <channel name> <client process id>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    client_id = strtoul(argv[2], NULL, 10);
+    if (!open_host_channel(&channel, argv[1]))
+    {
+        fprintf(stderr, "Failed to open the channel %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    wrapped_fmu *instance = NULL;
+    bool running = true;
+    while (running && wait_for_client_message())
+    {
+        uint32_t function = channel.request->function;
+        fmi2Status status;
+        begin_message(channel.response, (host_function)function);
+        if (function == HOST_INSTANTIATE)
+        {
+            if (instance == NULL)
+            {
+                instance = instantiate_request();
+            }
+            status = instance != NULL ? fmi2OK : fmi2Error;
+        }
+        else if (function == HOST_FREE_INSTANCE)
+        {
+            if (instance != NULL)
+            {
+                free_instance(instance);
+                instance = NULL;
+            }
+            status = fmi2OK;
+            running = false;
+        }
+        else
+        {
+            status = instance != NULL ? dispatch(instance) : fmi2Error;
+        }
+        channel.response->status = status;
+        send_to_client(&channel, false);
+    }
+    // The client died, the fmu may still release its resources
+    if (instance != NULL)
+    {
+        free_instance(instance);
+    }
+    close_host_channel(&channel);
+    return EXIT_SUCCESS;
+}
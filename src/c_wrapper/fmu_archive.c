@@ -0,0 +1,537 @@
+#include "fmu_archive.h"
+#include "sha256.h"
+#include "system_functions.h"
+#include "unzip.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The binaries directory and file extension of the current platform as defined by the fmi2 standard. */
+#if defined(_WIN64)
+#define FMU_PLATFORM "win64"
+#define FMU_BINARY_EXTENSION ".dll"
+#elif defined(_WIN32)
+#define FMU_PLATFORM "win32"
+#define FMU_BINARY_EXTENSION ".dll"
+#elif defined(__APPLE__)
+#define FMU_PLATFORM "darwin64"
+#define FMU_BINARY_EXTENSION ".dylib"
+#elif defined(__LP64__) || defined(_LP64)
+#define FMU_PLATFORM "linux64"
+#define FMU_BINARY_EXTENSION ".so"
+#else
+#define FMU_PLATFORM "linux32"
+#define FMU_BINARY_EXTENSION ".so"
+#endif
+
+/*! The number of digest bytes used to name the entries of the extraction cache. */
+#define CACHE_HASH_SIZE 16
+
+/*! The file in the extraction directory that stores the variable index. */
+#define VARIABLE_INDEX_FILE "/variable_index.bin"
+
+/*! The extension of the files in the cache directory that map the size and modification time of an archive to its entry. */
+#define IDENTITY_EXTENSION ".identity"
+
+/*! Concatenate the strings into a string allocated with malloc. */
+static char *concat(const char *first, const char *second, const char *third)
+{
+    size_t first_length = strlen(first);
+    size_t second_length = strlen(second);
+    size_t third_length = strlen(third);
+    char *result = malloc(first_length + second_length + third_length + 1);
+    if (result != NULL)
+    {
+        memcpy(result, first, first_length);
+        memcpy(result + first_length, second, second_length);
+        memcpy(result + first_length + second_length, third, third_length + 1);
+    }
+    return result;
+}
+
+/*!
+    Read the whole file into memory.
+    \return The content allocated with malloc or NULL if it could not be read.
+*/
+static unsigned char *read_file(const char *file_name, size_t *size)
+{
+    FILE *file = fopen(file_name, "rb");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+    unsigned char *content = NULL;
+    long length;
+    if (fseek(file, 0, SEEK_END) == 0 && (length = ftell(file)) >= 0 && fseek(file, 0, SEEK_SET) == 0)
+    {
+        // Allocate at least one byte so empty files are not reported as failure
+        content = malloc((size_t)length + 1);
+        if (content != NULL && fread(content, 1, (size_t)length, file) != (size_t)length)
+        {
+            free(content);
+            content = NULL;
+        }
+        *size = (size_t)length;
+    }
+    fclose(file);
+    return content;
+}
+
+/*! Create the directory and all of its parents. */
+static bool create_directories(const char *path)
+{
+    char *copy = concat(path, "", "");
+    if (copy == NULL)
+    {
+        return false;
+    }
+    bool success = true;
+    // Skip the first char so absolute paths do not create the root
+    for (char *current = copy + 1; *current != '\0' && success; current++)
+    {
+        if ((*current == '/' || *current == '\\') && current[-1] != ':')
+        {
+            char separator = *current;
+            *current = '\0';
+            success = createDirectory(copy) == 0;
+            *current = separator;
+        }
+    }
+    free(copy);
+    return success && createDirectory(path) == 0;
+}
+
+/*! The number of temporary files and directories created by this process, keeps their names unique between threads. */
+static volatile size_t extraction_count = 0;
+
+/*! Name a cache file after the first 128 bits of the SHA-256 of the data, short enough for the Windows path limit. */
+static void hash_name(const unsigned char *data, size_t size, char name[2 * CACHE_HASH_SIZE + 1])
+{
+    static const char hex[] = "0123456789abcdef";
+    unsigned char digest[SHA256_DIGEST_SIZE];
+    sha256(data, size, digest);
+    for (size_t i = 0; i < CACHE_HASH_SIZE; i++)
+    {
+        name[2 * i] = hex[digest[i] >> 4];
+        name[2 * i + 1] = hex[digest[i] & 0x0f];
+    }
+    name[2 * CACHE_HASH_SIZE] = '\0';
+}
+
+/*!
+    Extract into a private temporary directory next to the cache entry and rename it into place.
+    The rename is atomic so other processes see either no entry or a complete one.
+*/
+static bool extract_into_cache(const unsigned char *archive, size_t archive_size, const char *entry)
+{
+    char suffix[64];
+    snprintf(suffix, sizeof(suffix), ".tmp-%lu-%lu", getProcessId(), (unsigned long)atomicIncrement(&extraction_count));
+    char *temp = concat(entry, suffix, "");
+    if (temp == NULL)
+    {
+        return false;
+    }
+    bool success = create_directories(temp) && extract_zip(archive, archive_size, temp);
+    // If another thread or process won the race its entry is used instead
+    if (!success || renamePath(temp, entry) != 0)
+    {
+        removeDirectory(temp);
+    }
+    free(temp);
+    return success;
+}
+
+/*! Convert the absolute directory into a file URI of its resources subdirectory. */
+static char *resource_uri(const char *directory)
+{
+    // Windows paths start with the drive letter and need an additional slash
+    char *uri = concat(directory[0] == '/' ? "file://" : "file:///", directory, "/resources");
+    if (uri != NULL)
+    {
+        for (char *current = uri; *current != '\0'; current++)
+        {
+            if (*current == '\\')
+            {
+                *current = '/';
+            }
+        }
+    }
+    return uri;
+}
+
+/*!
+    Create the archive for the extracted files in the directory.
+    \param directory Allocated with malloc, the archive takes ownership.
+*/
+static fmu_archive *open_extracted(char *directory)
+{
+    fmu_archive *fmu = calloc(1, sizeof(fmu_archive));
+    if (fmu == NULL)
+    {
+        free(directory);
+        return NULL;
+    }
+    // Resolve the directory so the resource location and binary paths are absolute
+    fmu->directory = resolvePath(directory);
+    free(directory);
+    if (fmu->directory != NULL)
+    {
+        fmu->resource_location = resource_uri(fmu->directory);
+        char *description_path = concat(fmu->directory, "/modelDescription.xml", "");
+        if (description_path != NULL)
+        {
+            fmu->description = load_model_description(description_path);
+            free(description_path);
+        }
+    }
+    if (fmu->directory == NULL || fmu->resource_location == NULL || fmu->description == NULL)
+    {
+        free_fmu(fmu);
+        return NULL;
+    }
+    return fmu;
+}
+
+PUBLIC_EXPORT fmu_archive *load_fmu(const char *file_name, const char *extract_directory)
+{
+    if (extract_directory == NULL)
+    {
+        return load_fmu_cached(file_name, NULL);
+    }
+    size_t archive_size = 0;
+    unsigned char *archive = read_file(file_name, &archive_size);
+    bool success = archive != NULL &&
+                   create_directories(extract_directory) &&
+                   extract_zip(archive, archive_size, extract_directory);
+    free(archive);
+    return success ? open_extracted(concat(extract_directory, "", "")) : NULL;
+}
+
+/*!
+    Remove the staging directory or file of the cache if the process that created it does not exist anymore.
+    \param context The cache directory.
+*/
+static void remove_stale_extraction(const char *name, void *context)
+{
+    const char *suffix = strstr(name, ".tmp-");
+    unsigned long process_id;
+    unsigned long count;
+    if (suffix == NULL || sscanf(suffix, ".tmp-%lu-%lu", &process_id, &count) != 2)
+    {
+        return;
+    }
+    // A crashed process never renames or removes its staging directory
+    if (process_id != getProcessId() && !isProcessIdRunning(process_id))
+    {
+        char *path = concat(context, "/", name);
+        // The staging files of the identity records are no directories
+        if (path != NULL && removeDirectory(path) != 0)
+        {
+            remove(path);
+        }
+        free(path);
+    }
+}
+
+/*!
+    Open the cache directory and remove the staging directories left behind by crashed processes.
+    \return The path allocated with malloc or NULL if it could not be allocated.
+*/
+static char *open_cache(const char *cache_directory)
+{
+    char *cache = NULL;
+    if (cache_directory != NULL)
+    {
+        cache = concat(cache_directory, "", "");
+    }
+    else
+    {
+        char *temp = getTempDirectory();
+        cache = temp != NULL ? concat(temp, "/fmi_wrapper", "") : NULL;
+        free(temp);
+    }
+    if (cache != NULL)
+    {
+        // Fails if the cache does not exist yet, then there is nothing to remove
+        listDirectory(cache, remove_stale_extraction, cache);
+    }
+    return cache;
+}
+
+/*!
+    Build the path of the identity record of the archive, which is named after the hash of its absolute path.
+    \return The path allocated with malloc or NULL if the file does not exist.
+*/
+static char *identity_path(const char *file_name, const char *cache)
+{
+    char *resolved = resolvePath(file_name);
+    if (resolved == NULL)
+    {
+        return NULL;
+    }
+    char name[2 * CACHE_HASH_SIZE + 1 + sizeof(IDENTITY_EXTENSION)];
+    hash_name((const unsigned char *)resolved, strlen(resolved), name);
+    free(resolved);
+    memcpy(name + 2 * CACHE_HASH_SIZE, IDENTITY_EXTENSION, sizeof(IDENTITY_EXTENSION));
+    return concat(cache, "/", name);
+}
+
+/*!
+    Find the cache entry via the identity record of the archive, without reading the archive.
+    \return The path of the entry allocated with malloc or NULL if the archive has changed since the record was written.
+*/
+static char *find_entry_by_identity(const char *file_name, const char *cache)
+{
+    uint64_t size;
+    int64_t modification_time;
+    if (getFileStatus(file_name, &size, &modification_time) != 0)
+    {
+        return NULL;
+    }
+    char *path = identity_path(file_name, cache);
+    FILE *file = path != NULL ? fopen(path, "rb") : NULL;
+    free(path);
+    if (file == NULL)
+    {
+        return NULL;
+    }
+    unsigned long long recorded_size;
+    long long recorded_time;
+    char name[2 * CACHE_HASH_SIZE + 1];
+    bool matches = fscanf(file, "%llu %lld %32s", &recorded_size, &recorded_time, name) == 3 &&
+                   strlen(name) == 2 * CACHE_HASH_SIZE && recorded_size == size && recorded_time == modification_time;
+    fclose(file);
+    return matches ? concat(cache, "/", name) : NULL;
+}
+
+/*! Record the size and modification time of the archive with the name of its entry, so the next load does not hash it. */
+static void store_identity(const char *file_name, const char *cache, uint64_t size, int64_t modification_time,
+                           const char name[2 * CACHE_HASH_SIZE + 1])
+{
+    char *path = identity_path(file_name, cache);
+    if (path == NULL)
+    {
+        return;
+    }
+    // Write a private file and rename it so concurrent loads never read a partial record
+    char suffix[64];
+    snprintf(suffix, sizeof(suffix), ".tmp-%lu-%lu", getProcessId(), (unsigned long)atomicIncrement(&extraction_count));
+    char *temp = concat(path, suffix, "");
+    FILE *file = temp != NULL ? fopen(temp, "wb") : NULL;
+    bool success = file != NULL && fprintf(file, "%llu %lld %s\n", (unsigned long long)size, (long long)modification_time, name) > 0;
+    success = file != NULL && fclose(file) == 0 && success;
+    // An outdated record is replaced, renaming onto an existing file fails on Windows
+    if (success && renamePath(temp, path) != 0)
+    {
+        remove(path);
+        success = renamePath(temp, path) == 0;
+    }
+    if (!success && temp != NULL)
+    {
+        // Caching is optional, the next load hashes the archive again
+        remove(temp);
+    }
+    free(temp);
+    free(path);
+}
+
+/*! Check if the cache entry is complete. */
+static bool entry_exists(const char *entry)
+{
+    // Entries only appear complete via rename, an existing model description means the files can be reused
+    char *description_path = concat(entry, "/modelDescription.xml", "");
+    FILE *description = description_path != NULL ? fopen(description_path, "rb") : NULL;
+    free(description_path);
+    if (description != NULL)
+    {
+        fclose(description);
+    }
+    return description != NULL;
+}
+
+/*!
+    Read and hash the archive to find its cache entry, extract it unless the entry exists and record the identity of the archive.
+    \return The path of the entry allocated with malloc or NULL if the archive could not be read or extracted.
+*/
+static char *fill_cache_entry(const char *file_name, const char *cache)
+{
+    // Get the identity before reading, a modification while reading changes it and invalidates the record
+    uint64_t size;
+    int64_t modification_time;
+    bool identified = getFileStatus(file_name, &size, &modification_time) == 0;
+    size_t archive_size = 0;
+    unsigned char *archive = read_file(file_name, &archive_size);
+    if (archive == NULL)
+    {
+        return NULL;
+    }
+    char name[2 * CACHE_HASH_SIZE + 1];
+    hash_name(archive, archive_size, name);
+    char *entry = concat(cache, "/", name);
+    bool success = entry != NULL && (entry_exists(entry) || extract_into_cache(archive, archive_size, entry));
+    free(archive);
+    if (!success)
+    {
+        free(entry);
+        return NULL;
+    }
+    if (identified)
+    {
+        store_identity(file_name, cache, size, modification_time, name);
+    }
+    return entry;
+}
+
+PUBLIC_EXPORT fmu_archive *load_fmu_cached(const char *file_name, const char *cache_directory)
+{
+    char *cache = open_cache(cache_directory);
+    if (cache == NULL)
+    {
+        return NULL;
+    }
+    char *entry = find_entry_by_identity(file_name, cache);
+    if (entry != NULL && !entry_exists(entry))
+    {
+        // The entry was deleted since the identity was recorded
+        free(entry);
+        entry = NULL;
+    }
+    if (entry == NULL)
+    {
+        entry = fill_cache_entry(file_name, cache);
+    }
+    free(cache);
+    return entry != NULL ? open_extracted(entry) : NULL;
+}
+
+/*! Load the variable index stored in the cache entry. */
+static variable_index *load_entry_variable_index(const char *entry, fmi2String guid)
+{
+    char *path = concat(entry, VARIABLE_INDEX_FILE, "");
+    variable_index *index = path != NULL ? load_variable_index(path, guid) : NULL;
+    free(path);
+    return index;
+}
+
+PUBLIC_EXPORT variable_index *load_cached_variable_index(const char *file_name, const char *cache_directory, fmi2String guid)
+{
+    char *cache = open_cache(cache_directory);
+    if (cache == NULL)
+    {
+        return NULL;
+    }
+    // Warm start: the unchanged archive is neither read nor hashed
+    char *entry = find_entry_by_identity(file_name, cache);
+    variable_index *index = entry != NULL ? load_entry_variable_index(entry, guid) : NULL;
+    if (index == NULL)
+    {
+        free(entry);
+        entry = fill_cache_entry(file_name, cache);
+        // The entry is named after the content, so an index stored in it belongs to this archive
+        index = entry != NULL ? load_entry_variable_index(entry, guid) : NULL;
+        if (index == NULL && entry != NULL)
+        {
+            // Cold start: parse the model description once and store the index for the next load
+            fmu_archive *fmu = open_extracted(entry);
+            entry = NULL;
+            if (fmu != NULL && (guid == NULL || strcmp(guid, fmu->description->guid) == 0))
+            {
+                index = load_fmu_variable_index(fmu);
+            }
+            free_fmu(fmu);
+        }
+    }
+    free(entry);
+    free(cache);
+    return index;
+}
+
+PUBLIC_EXPORT void free_fmu(fmu_archive *fmu)
+{
+    if (fmu == NULL)
+    {
+        return;
+    }
+    free((char *)fmu->directory);
+    free((char *)fmu->resource_location);
+    free_model_description(fmu->description);
+    free(fmu);
+}
+
+PUBLIC_EXPORT char *get_fmu_binary_path(const fmu_archive *fmu, fmi2Type fmu_type)
+{
+    const fmu_interface *fmu_interface = fmu_type == fmi2CoSimulation ? &fmu->description->co_simulation : &fmu->description->model_exchange;
+    if (!fmu_interface->available || fmu_interface->model_identifier == NULL)
+    {
+        return NULL;
+    }
+    char *directory = concat(fmu->directory, "/binaries/" FMU_PLATFORM "/", "");
+    if (directory == NULL)
+    {
+        return NULL;
+    }
+    char *path = concat(directory, fmu_interface->model_identifier, FMU_BINARY_EXTENSION);
+    free(directory);
+    return path;
+}
+
+PUBLIC_EXPORT void free_fmu_string(char *string)
+{
+    free(string);
+}
+
+PUBLIC_EXPORT variable_index *load_fmu_variable_index(const fmu_archive *fmu)
+{
+    char *path = concat(fmu->directory, VARIABLE_INDEX_FILE, "");
+    if (path == NULL)
+    {
+        return NULL;
+    }
+    variable_index *index = load_variable_index(path, fmu->description->guid);
+    if (index == NULL)
+    {
+        index = create_variable_index(fmu->description);
+        if (index != NULL)
+        {
+            // Write a private file and rename it so concurrent loads never read a partial index
+            char suffix[64];
+            snprintf(suffix, sizeof(suffix), ".tmp-%lu-%lu", getProcessId(), (unsigned long)atomicIncrement(&extraction_count));
+            char *temp = concat(path, suffix, "");
+            if (temp != NULL && (save_variable_index(index, temp) != fmi2OK || renamePath(temp, path) != 0))
+            {
+                // Caching is optional, the index is valid anyway
+                remove(temp);
+            }
+            free(temp);
+        }
+    }
+    free(path);
+    return index;
+}
+
+PUBLIC_EXPORT fmu_binary *load_fmu_binary(const fmu_archive *fmu, fmi2Type fmu_type)
+{
+    char *path = get_fmu_binary_path(fmu, fmu_type);
+    if (path == NULL)
+    {
+        return NULL;
+    }
+    fmu_binary *binary = load_binary(path);
+    free(path);
+    return binary;
+}
+
+PUBLIC_EXPORT wrapped_fmu *instantiate_fmu(const fmu_archive *fmu, log_t log, step_finished_t step_finished,
+                                           fmi2String instance_name, fmi2Type fmu_type, fmi2Boolean visible, fmi2Boolean logging_on)
+{
+    fmu_binary *binary = load_fmu_binary(fmu, fmu_type);
+    if (binary == NULL)
+    {
+        return NULL;
+    }
+    wrapped_fmu *wrapper = instantiate_binary(binary, log, step_finished, instance_name, fmu_type,
+                                              fmu->description->guid, fmu->resource_location, visible, logging_on);
+    // The instance holds its own reference
+    free_binary(binary);
+    return wrapper;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "fmi_wrapper.h"
+#include "model_description.h"
+#include "variable_index.h"
+
+/*!
+    \brief Load .fmu archives natively: extract them, parse the model description and locate the binary of the current platform.
+*/
+
+/*! An extracted fmu. */
+typedef struct fmu_archive
+{
+    /*! The directory that contains the extracted files. */
+    fmi2String directory;
+    /*! The file URI of the resources directory, pass it as resource_location when instantiating. */
+    fmi2String resource_location;
+    /*! The parsed modelDescription.xml. */
+    model_description *description;
+} fmu_archive;
+
+/*!
+    \brief Extract the fmu archive and parse its model description.
+    \param file_name The path of the .fmu file.
+    \param extract_directory The directory to extract the files to, it is created if necessary.
+    Pass NULL to use the extraction cache in the temporary directory, see load_fmu_cached.
+    \return NULL if the archive could not be extracted or the model description is invalid.
+*/
+PUBLIC_EXPORT fmu_archive *load_fmu(const char *file_name, const char *extract_directory);
+/*!
+    \brief Load the fmu from a content addressed extraction cache.
+    The files are extracted into a subdirectory named after the SHA-256 hash of the archive.
+    If that subdirectory exists the archive is not extracted again. The size and modification time of the file are recorded in
+    the cache directory, so repeated loads of an unchanged file neither read nor hash it.
+    Extraction happens in a temporary directory that is renamed into place, concurrent threads and processes never see partial files.
+    Temporary directories left behind by processes that crashed while extracting are removed when the cache is opened.
+    \param cache_directory The directory that contains the cache entries, it is created if necessary.
+    Pass NULL to use the fmi_wrapper subdirectory of the temporary directory.
+    \return NULL if the archive could not be extracted or the model description is invalid.
+*/
+PUBLIC_EXPORT fmu_archive *load_fmu_cached(const char *file_name, const char *cache_directory);
+/*!
+    \brief Release the memory of the archive. The extracted files are kept.
+*/
+PUBLIC_EXPORT void free_fmu(fmu_archive *fmu);
+/*!
+    \brief Get the path of the binary for the current platform.
+    \return A string allocated with malloc, release it via free_fmu_string. NULL if the fmu does not support the type.
+*/
+PUBLIC_EXPORT char *get_fmu_binary_path(const fmu_archive *fmu, fmi2Type fmu_type);
+/*! \brief Release a string returned by the functions of the archive. */
+PUBLIC_EXPORT void free_fmu_string(char *string);
+/*!
+    \brief Get the variable index of the fmu.
+    The index is stored in the extraction directory, so on warm starts it is loaded from there instead of being built.
+    Use load_cached_variable_index to skip parsing the model description as well.
+    \return NULL if the index could neither be loaded nor built. Release it via free_variable_index.
+*/
+PUBLIC_EXPORT variable_index *load_fmu_variable_index(const fmu_archive *fmu);
+/*!
+    \brief Get the variable index of a fmu in the extraction cache without parsing its model description.
+    On warm starts the index that load_fmu_variable_index stored in the cache entry is loaded directly, the archive is only
+    read and hashed if its size or modification time changed. Otherwise the archive is extracted and its model description
+    parsed once to build and store the index.
+    \param cache_directory See load_fmu_cached.
+    \param guid If not NULL the index is only returned if it was built for a model description with this guid.
+    \return NULL if the index could neither be loaded nor built or does not match the guid. Release it via free_variable_index.
+*/
+PUBLIC_EXPORT variable_index *load_cached_variable_index(const char *file_name, const char *cache_directory, fmi2String guid);
+/*!
+    \brief Load the binary for the current platform via load_binary.
+    \return NULL if the fmu does not support the type or the binary could not be loaded.
+*/
+PUBLIC_EXPORT fmu_binary *load_fmu_binary(const fmu_archive *fmu, fmi2Type fmu_type);
+/*!
+    \brief Create a instance using the guid and resource location of the archive.
+    \param other The other parameters match the ones of instantiate.
+    \return NULL if the instantiation failed.
+*/
+PUBLIC_EXPORT wrapped_fmu *instantiate_fmu(const fmu_archive *fmu, log_t log, step_finished_t step_finished,
+                                           fmi2String instance_name, fmi2Type fmu_type, fmi2Boolean visible, fmi2Boolean logging_on);
@@ -0,0 +1,166 @@
+#include "host_protocol.h"
+#include <string.h>
+
+/*! Keep the areas aligned to cache lines. */
+#define HOST_HEADER_SIZE 64
+#define HOST_CHANNEL_SIZE (HOST_HEADER_SIZE + 2 * HOST_MESSAGE_AREA_SIZE + HOST_CALLBACK_AREA_SIZE)
+
+/*! Round up to the alignment of the buffers. */
+static uint64_t align_buffer_size(uint64_t size)
+{
+    return (size + 7) & ~(uint64_t)7;
+}
+
+/*! Point the channel to the areas of the mapped memory. */
+static void map_areas(host_channel *channel)
+{
+    char *data = channel->memory.data;
+    channel->header = (host_channel_header *)data;
+    channel->request = (host_message *)(data + HOST_HEADER_SIZE);
+    channel->response = (host_message *)(data + HOST_HEADER_SIZE + HOST_MESSAGE_AREA_SIZE);
+    channel->callback = (host_message *)(data + HOST_HEADER_SIZE + 2 * HOST_MESSAGE_AREA_SIZE);
+    channel->received = 0;
+}
+
+bool create_host_channel(host_channel *channel, const char *name)
+{
+    if (createSharedMemory(&channel->memory, name, HOST_CHANNEL_SIZE) == NULL)
+    {
+        return false;
+    }
+    map_areas(channel);
+    channel->header->magic = HOST_CHANNEL_MAGIC;
+    channel->host_event = createSharedEvent(name, "_host");
+    channel->client_event = createSharedEvent(name, "_client");
+    return true;
+}
+
+bool open_host_channel(host_channel *channel, const char *name)
+{
+    if (openSharedMemory(&channel->memory, name, HOST_CHANNEL_SIZE) == NULL)
+    {
+        return false;
+    }
+    map_areas(channel);
+    if (channel->header->magic != HOST_CHANNEL_MAGIC)
+    {
+        closeSharedMemory(&channel->memory);
+        return false;
+    }
+    channel->host_event = openSharedEvent(name, "_host");
+    channel->client_event = openSharedEvent(name, "_client");
+    return true;
+}
+
+void close_host_channel(host_channel *channel)
+{
+    closeSharedEvent(channel->host_event);
+    closeSharedEvent(channel->client_event);
+    closeSharedMemory(&channel->memory);
+}
+
+void unlink_host_channel(const char *name)
+{
+    unlinkSharedMemory(name);
+}
+
+void send_to_host(host_channel *channel)
+{
+    // Only the client writes to_host, so the increment does not race
+    signalCounter(&channel->header->to_host, channel->header->to_host + 1, channel->host_event);
+}
+
+void send_to_client(host_channel *channel, bool is_callback)
+{
+    channel->header->is_callback = is_callback;
+    signalCounter(&channel->header->to_client, channel->header->to_client + 1, channel->client_event);
+}
+
+bool wait_for_host(host_channel *channel, unsigned int timeout_ms)
+{
+    if (!waitForCounter(&channel->header->to_client, channel->received + 1, timeout_ms, channel->client_event))
+    {
+        return false;
+    }
+    channel->received++;
+    return true;
+}
+
+bool wait_for_client(host_channel *channel, unsigned int timeout_ms)
+{
+    if (!waitForCounter(&channel->header->to_host, channel->received + 1, timeout_ms, channel->host_event))
+    {
+        return false;
+    }
+    channel->received++;
+    return true;
+}
+
+void begin_message(host_message *message, host_function function)
+{
+    memset(message, 0, sizeof(host_message));
+    message->function = function;
+}
+
+/*! The offset of the next buffer and whether the existing ones fit into the area. */
+static bool end_of_buffers(const host_message *message, size_t area_size, uint32_t n_buffers, uint64_t *offset)
+{
+    *offset = align_buffer_size(sizeof(host_message));
+    for (uint32_t i = 0; i < n_buffers; i++)
+    {
+        if (message->sizes[i] > area_size)
+        {
+            return false;
+        }
+        *offset += align_buffer_size(message->sizes[i]);
+    }
+    return *offset <= area_size;
+}
+
+void *add_buffer(host_message *message, size_t area_size, const void *data, size_t size)
+{
+    uint64_t offset;
+    if (message->n_buffers >= HOST_MAX_BUFFERS || !end_of_buffers(message, area_size, message->n_buffers, &offset) ||
+        size > area_size - offset)
+    {
+        return NULL;
+    }
+    char *buffer = (char *)message + offset;
+    if (data != NULL && size > 0)
+    {
+        memcpy(buffer, data, size);
+    }
+    message->sizes[message->n_buffers++] = size;
+    return buffer;
+}
+
+bool add_string(host_message *message, size_t area_size, const char *string)
+{
+    // The empty buffer is returned as the end of the area, so check the count instead of the pointer
+    uint32_t n_buffers = message->n_buffers;
+    add_buffer(message, area_size, string, string != NULL ? strlen(string) + 1 : 0);
+    return message->n_buffers > n_buffers;
+}
+
+void *get_buffer(host_message *message, size_t area_size, uint32_t index, size_t *size)
+{
+    uint64_t offset;
+    if (index >= message->n_buffers || message->n_buffers > HOST_MAX_BUFFERS ||
+        !end_of_buffers(message, area_size, index + 1, &offset))
+    {
+        return NULL;
+    }
+    *size = (size_t)message->sizes[index];
+    return (char *)message + offset - align_buffer_size(message->sizes[index]);
+}
+
+const char *get_string_buffer(host_message *message, size_t area_size, uint32_t index)
+{
+    size_t size;
+    const char *string = get_buffer(message, area_size, index, &size);
+    if (string == NULL || size == 0 || string[size - 1] != '\0')
+    {
+        return NULL;
+    }
+    return string;
+}
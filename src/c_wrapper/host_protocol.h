@@ -0,0 +1,143 @@
+#pragma once
+#include "system_functions.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*!
+    \brief The shared memory channel between a client and the fmi_wrapper_host process.
+    The memory contains a header with two counters followed by the request, response and callback areas.
+    Each area holds one host_message followed by its buffers. The calls are synchronous, so the client writes a request,
+    increments to_host and waits until to_client is incremented. While the host executes the call it can send log messages
+    through the callback area, the client acknowledges them by incrementing to_host without touching the request area.
+    Only fixed size types are used, so the client and the host may be compiled for different architectures.
+*/
+
+#define HOST_CHANNEL_MAGIC 0x484D4946u
+#define HOST_MAX_BUFFERS 8
+#define HOST_MAX_ARGUMENTS 4
+#define HOST_MESSAGE_AREA_SIZE (4u << 20)
+#define HOST_CALLBACK_AREA_SIZE (64u << 10)
+
+/*! The functions that can be called on the host and the callbacks of the host. */
+typedef enum host_function
+{
+    HOST_INSTANTIATE,
+    HOST_FREE_INSTANCE,
+    HOST_SET_DEBUG_LOGGING,
+    HOST_SETUP_EXPERIMENT,
+    HOST_ENTER_INITIALIZATION_MODE,
+    HOST_EXIT_INITIALIZATION_MODE,
+    HOST_TERMINATE,
+    HOST_RESET,
+    HOST_GET_REAL,
+    HOST_GET_INTEGER,
+    HOST_GET_BOOLEAN,
+    HOST_GET_STRING,
+    HOST_SET_REAL,
+    HOST_SET_INTEGER,
+    HOST_SET_BOOLEAN,
+    HOST_SET_STRING,
+    HOST_GET_FMU_STATE,
+    HOST_SET_FMU_STATE,
+    HOST_FREE_FMU_STATE,
+    HOST_SERIALIZED_FMU_STATE_SIZE,
+    HOST_SERIALIZE_FMU_STATE,
+    HOST_DESERIALIZE_FMU_STATE,
+    HOST_GET_DIRECTIONAL_DERIVATIVE,
+    HOST_ENTER_EVENT_MODE,
+    HOST_NEW_DISCRETE_STATES,
+    HOST_ENTER_CONTINUOUS_TIME_MODE,
+    HOST_COMPLETED_INTEGRATOR_STEP,
+    HOST_SET_TIME,
+    HOST_SET_CONTINUOUS_STATES,
+    HOST_GET_DERIVATIVES,
+    HOST_GET_EVENT_INDICATORS,
+    HOST_GET_CONTINUOUS_STATES,
+    HOST_GET_NOMINALS_OF_CONTINUOUS_STATES,
+    HOST_SET_REAL_INPUT_DERIVATIVES,
+    HOST_GET_REAL_OUTPUT_DERIVATIVES,
+    HOST_DO_STEP,
+    HOST_CANCEL_STEP,
+    HOST_GET_STATUS,
+    HOST_GET_REAL_STATUS,
+    HOST_GET_INTEGER_STATUS,
+    HOST_GET_BOOLEAN_STATUS,
+    HOST_GET_STRING_STATUS,
+    /*! Callback: buffers are the instance name, category and message, arguments[0] is the status. */
+    HOST_LOG
+} host_function;
+
+/*! A request, response or callback. The buffers follow the message, each aligned to 8 bytes. */
+typedef struct host_message
+{
+    uint32_t function;
+    int32_t status;
+    uint32_t n_buffers;
+    uint32_t reserved;
+    /*! Scalar arguments or results like booleans, sizes and fmu state handles. */
+    uint64_t arguments[HOST_MAX_ARGUMENTS];
+    double real_arguments[HOST_MAX_ARGUMENTS];
+    uint64_t sizes[HOST_MAX_BUFFERS];
+} host_message;
+
+typedef struct host_channel_header
+{
+    uint32_t magic;
+    /*! Incremented by the client for each request and callback acknowledgement. */
+    volatile uint32_t to_host;
+    /*! Incremented by the host for each response and callback. */
+    volatile uint32_t to_client;
+    /*! Set if the message for the client is in the callback area instead of the response area. */
+    volatile uint32_t is_callback;
+} host_channel_header;
+
+/*! One end of the channel. */
+typedef struct host_channel
+{
+    system_shared_memory memory;
+    host_channel_header *header;
+    host_message *request;
+    host_message *response;
+    host_message *callback;
+    /*! Wakes the host when to_host changes. */
+    system_event host_event;
+    /*! Wakes the client when to_client changes. */
+    system_event client_event;
+    /*! The number of messages this end has received. */
+    uint32_t received;
+} host_channel;
+
+/*! Create the shared memory of a new channel. Called by the client. */
+bool create_host_channel(host_channel *channel, const char *name);
+/*! Open the channel created by the client. Called by the host. */
+bool open_host_channel(host_channel *channel, const char *name);
+void close_host_channel(host_channel *channel);
+/*! Remove the name of the channel after the host opened it, so it is not left behind if both processes crash. */
+void unlink_host_channel(const char *name);
+
+/*! Notify the other end that a message has been written. */
+void send_to_host(host_channel *channel);
+void send_to_client(host_channel *channel, bool is_callback);
+/*! Wait for the next message of the other end. \return false if the timeout expired. */
+bool wait_for_host(host_channel *channel, unsigned int timeout_ms);
+bool wait_for_client(host_channel *channel, unsigned int timeout_ms);
+
+/*! Clear the message before adding the buffers. */
+void begin_message(host_message *message, host_function function);
+/*!
+    Append a buffer to the message.
+    \param area_size The size of the area that holds the message.
+    \param data Copied into the buffer. May be NULL to only reserve the buffer.
+    \return The buffer or NULL if the area is too small.
+*/
+void *add_buffer(host_message *message, size_t area_size, const void *data, size_t size);
+/*! Append the string including its terminator, a NULL string is stored as an empty buffer. */
+bool add_string(host_message *message, size_t area_size, const char *string);
+/*!
+    Get a buffer of a received message. The sizes are checked against the area.
+    \return NULL if the message does not have the buffer.
+*/
+void *get_buffer(host_message *message, size_t area_size, uint32_t index, size_t *size);
+/*! Get a string added by add_string. \return NULL for NULL strings or invalid buffers. */
+const char *get_string_buffer(host_message *message, size_t area_size, uint32_t index);
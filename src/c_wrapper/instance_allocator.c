@@ -0,0 +1,238 @@
+#include "instance_allocator.h"
+#include "system_functions.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*! The smallest size class, blocks of up to 2^MIN_CLASS_SHIFT bytes. */
+#define MIN_CLASS_SHIFT 4
+/*! The largest size class, larger blocks are allocated from the heap individually. */
+#define MAX_CLASS_SHIFT 12
+#define N_SIZE_CLASSES (MAX_CLASS_SHIFT - MIN_CLASS_SHIFT + 1)
+/*! The size of the chunks that the small blocks are carved from. */
+#define CHUNK_SIZE (64 * 1024)
+
+/*! Precedes every block, the size of two pointers keeps the alignment of malloc on common platforms. */
+typedef struct block_header
+{
+    /*! NULL for blocks allocated from the heap because no pool was active. */
+    instance_allocator *allocator;
+    /*! The requested size. */
+    size_t size;
+} block_header;
+
+/*! Blocks beyond the largest size class are linked, so they can be released in bulk. */
+typedef struct large_block
+{
+    struct large_block *previous;
+    struct large_block *next;
+    block_header header;
+} large_block;
+
+typedef struct chunk
+{
+    struct chunk *next;
+    /*! Pads the header to the alignment of the blocks. */
+    void *reserved;
+} chunk;
+
+struct instance_allocator
+{
+    /*! The most recent chunk, the next small block is carved from its unused end. */
+    chunk *chunks;
+    unsigned char *chunk_position;
+    unsigned char *chunk_end;
+    /*! The freed blocks of each size class, linked through their first bytes. */
+    void *free_lists[N_SIZE_CLASSES];
+    large_block *large_blocks;
+    allocation_statistics statistics;
+};
+
+/*! The pool of the instance that is currently called on this thread. */
+static SYSTEM_THREAD_LOCAL instance_allocator *active_allocator = NULL;
+
+static size_t size_class(size_t size)
+{
+    size_t class_index = 0;
+    while (((size_t)1 << (class_index + MIN_CLASS_SHIFT)) < size)
+    {
+        class_index++;
+    }
+    return class_index;
+}
+
+static void *allocate_small(instance_allocator *allocator, size_t size)
+{
+    size_t class_index = size_class(size);
+    block_header *header;
+    void *free_block = allocator->free_lists[class_index];
+    if (free_block != NULL)
+    {
+        memcpy(&allocator->free_lists[class_index], free_block, sizeof(void *));
+        header = (block_header *)free_block - 1;
+    }
+    else
+    {
+        size_t block_size = sizeof(block_header) + ((size_t)1 << (class_index + MIN_CLASS_SHIFT));
+        if ((size_t)(allocator->chunk_end - allocator->chunk_position) < block_size)
+        {
+            // The rest of the previous chunk stays unused
+            chunk *new_chunk = malloc(CHUNK_SIZE);
+            if (new_chunk == NULL)
+            {
+                return NULL;
+            }
+            new_chunk->next = allocator->chunks;
+            allocator->chunks = new_chunk;
+            allocator->chunk_position = (unsigned char *)(new_chunk + 1);
+            allocator->chunk_end = (unsigned char *)new_chunk + CHUNK_SIZE;
+            allocator->statistics.bytes_reserved += CHUNK_SIZE;
+        }
+        header = (block_header *)allocator->chunk_position;
+        allocator->chunk_position += block_size;
+        header->allocator = allocator;
+    }
+    header->size = size;
+    memset(header + 1, 0, size);
+    return header + 1;
+}
+
+static void *allocate_large(instance_allocator *allocator, size_t size)
+{
+    if (size > SIZE_MAX - sizeof(large_block))
+    {
+        return NULL;
+    }
+    large_block *block = calloc(1, sizeof(large_block) + size);
+    if (block == NULL)
+    {
+        return NULL;
+    }
+    block->next = allocator->large_blocks;
+    if (block->next != NULL)
+    {
+        block->next->previous = block;
+    }
+    allocator->large_blocks = block;
+    block->header.allocator = allocator;
+    block->header.size = size;
+    allocator->statistics.bytes_reserved += sizeof(large_block) + size;
+    return &block->header + 1;
+}
+
+instance_allocator *create_instance_allocator(void)
+{
+    return calloc(1, sizeof(instance_allocator));
+}
+
+void free_instance_allocator(instance_allocator *allocator)
+{
+    if (allocator == NULL)
+    {
+        return;
+    }
+    while (allocator->chunks != NULL)
+    {
+        chunk *next = allocator->chunks->next;
+        free(allocator->chunks);
+        allocator->chunks = next;
+    }
+    while (allocator->large_blocks != NULL)
+    {
+        large_block *next = allocator->large_blocks->next;
+        free(allocator->large_blocks);
+        allocator->large_blocks = next;
+    }
+    free(allocator);
+}
+
+instance_allocator *activate_instance_allocator(instance_allocator *allocator)
+{
+    instance_allocator *previous = active_allocator;
+    active_allocator = allocator;
+    return previous;
+}
+
+void *pool_allocate(size_t n_objects, size_t size)
+{
+    if (size != 0 && n_objects > SIZE_MAX / size)
+    {
+        return NULL;
+    }
+    size_t bytes = n_objects * size;
+    instance_allocator *allocator = active_allocator;
+    if (allocator == NULL)
+    {
+        // Called outside of a call into the fmu, e.g. from a thread of the fmu
+        if (bytes > SIZE_MAX - sizeof(block_header))
+        {
+            return NULL;
+        }
+        block_header *header = calloc(1, sizeof(block_header) + bytes);
+        if (header == NULL)
+        {
+            return NULL;
+        }
+        header->allocator = NULL;
+        header->size = bytes;
+        return header + 1;
+    }
+    void *object = bytes <= ((size_t)1 << MAX_CLASS_SHIFT) ? allocate_small(allocator, bytes) : allocate_large(allocator, bytes);
+    if (object != NULL)
+    {
+        allocation_statistics *statistics = &allocator->statistics;
+        statistics->n_allocations++;
+        statistics->bytes_allocated += bytes;
+        statistics->bytes_in_use += bytes;
+        if (statistics->bytes_in_use > statistics->peak_bytes_in_use)
+        {
+            statistics->peak_bytes_in_use = statistics->bytes_in_use;
+        }
+    }
+    return object;
+}
+
+void pool_free(void *object)
+{
+    if (object == NULL)
+    {
+        return;
+    }
+    block_header *header = (block_header *)object - 1;
+    instance_allocator *allocator = header->allocator;
+    if (allocator == NULL)
+    {
+        free(header);
+        return;
+    }
+    allocator->statistics.n_frees++;
+    allocator->statistics.bytes_in_use -= header->size;
+    if (header->size <= ((size_t)1 << MAX_CLASS_SHIFT))
+    {
+        size_t class_index = size_class(header->size);
+        memcpy(object, &allocator->free_lists[class_index], sizeof(void *));
+        allocator->free_lists[class_index] = object;
+        return;
+    }
+    large_block *block = (large_block *)((unsigned char *)header - offsetof(large_block, header));
+    if (block->previous != NULL)
+    {
+        block->previous->next = block->next;
+    }
+    else
+    {
+        allocator->large_blocks = block->next;
+    }
+    if (block->next != NULL)
+    {
+        block->next->previous = block->previous;
+    }
+    allocator->statistics.bytes_reserved -= sizeof(large_block) + header->size;
+    free(block);
+}
+
+void get_instance_allocator_statistics(const instance_allocator *allocator, allocation_statistics *statistics)
+{
+    *statistics = allocator->statistics;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "fmi_wrapper.h"
+
+/*!
+    \brief A memory pool for the allocateMemory and freeMemory callbacks of one instance.
+    Small blocks are recycled via free lists per size class and carved from large chunks, so the fmus that allocate in
+    every step do not contend for the lock of the heap. All memory is released at once when the pool is freed.
+    The fmi2 callbacks do not pass the instance, so the wrapper activates the pool of the instance on the calling thread
+    for the duration of each call. No locks are involved, the standard forbids concurrent calls of an instance.
+*/
+typedef struct instance_allocator instance_allocator;
+
+/*! \return NULL if the memory could not be allocated. */
+instance_allocator *create_instance_allocator(void);
+/*! Release all chunks and large blocks, including the ones that the fmu did not free. */
+void free_instance_allocator(instance_allocator *allocator);
+/*!
+    Make the pool the target of pool_allocate on this thread.
+    \param allocator NULL deactivates the pools.
+    \return The previously active pool, activate it again when the call into the fmu returns.
+*/
+instance_allocator *activate_instance_allocator(instance_allocator *allocator);
+/*! Matches fmi2CallbackAllocateMemory. Allocates from the heap if no pool is active on this thread. */
+void *pool_allocate(size_t n_objects, size_t size);
+/*! Matches fmi2CallbackFreeMemory. Blocks are returned to the pool that allocated them. */
+void pool_free(void *object);
+void get_instance_allocator_statistics(const instance_allocator *allocator, allocation_statistics *statistics);
@@ -0,0 +1,236 @@
+#include "instance_pool.h"
+#include "system_functions.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct instance_pool
+{
+    /*! Copy of the spec that owns its strings. */
+    instance_pool_spec spec;
+    system_mutex mutex;
+    /*! Signaled when an instance becomes available, is released or the pool stops. */
+    system_condition condition;
+    system_thread thread;
+    bool thread_started;
+    bool stopping;
+    /*! Set when an instantiation failed, the pool is not topped up until acquire_instance retries. */
+    bool failed;
+    /*! The instances that are ready, used as stack so the most recently recycled instance is handed out first. */
+    wrapped_fmu **available;
+    size_t n_available;
+    /*! The instances that have been acquired and not released yet, they count towards the size. */
+    size_t n_acquired;
+    /*! The instances waiting for recycling. */
+    wrapped_fmu **released;
+    size_t n_released;
+    size_t released_capacity;
+    instance_pool_statistics statistics;
+};
+
+/*! Copy the string into memory allocated with malloc. NULL is kept. */
+static char *copy_string(const char *source, bool *failed)
+{
+    if (source == NULL)
+    {
+        return NULL;
+    }
+    char *copy = malloc(strlen(source) + 1);
+    if (copy == NULL)
+    {
+        *failed = true;
+        return NULL;
+    }
+    strcpy(copy, source);
+    return copy;
+}
+
+static wrapped_fmu *instantiate_instance(const instance_pool_spec *spec)
+{
+    if (spec->pooled_memory)
+    {
+        return instantiate_pooled(spec->binary, spec->log, spec->step_finished, spec->instance_name, spec->fmu_type, spec->guid,
+                                  spec->resource_location, spec->visible, spec->logging_on);
+    }
+    return instantiate_binary(spec->binary, spec->log, spec->step_finished, spec->instance_name, spec->fmu_type, spec->guid,
+                              spec->resource_location, spec->visible, spec->logging_on);
+}
+
+/*!
+    Recycle the released instances and top up the available ones. The fmu functions are called without holding the mutex,
+    so acquire_instance and release_instance never wait for them.
+*/
+static void run_pool(void *argument)
+{
+    instance_pool *pool = argument;
+    lockMutex(&pool->mutex);
+    while (!pool->stopping)
+    {
+        if (pool->n_released > 0)
+        {
+            wrapped_fmu *instance = pool->released[--pool->n_released];
+            unlockMutex(&pool->mutex);
+            bool recycled = pool->spec.reset_instances && reset(instance) <= fmi2Warning;
+            if (!recycled)
+            {
+                free_instance(instance);
+            }
+            lockMutex(&pool->mutex);
+            if (!recycled)
+            {
+                // Replaced by the top up, which is not blocked by a failed reset
+                pool->statistics.n_failed += pool->spec.reset_instances ? 1 : 0;
+            }
+            else if (pool->n_available < pool->spec.size)
+            {
+                pool->available[pool->n_available++] = instance;
+                pool->statistics.n_reset++;
+                broadcastCondition(&pool->condition);
+            }
+            else
+            {
+                // Only if instances that were freed by the caller are released
+                unlockMutex(&pool->mutex);
+                free_instance(instance);
+                lockMutex(&pool->mutex);
+            }
+        }
+        else if (pool->n_available + pool->n_acquired < pool->spec.size && !pool->failed)
+        {
+            unlockMutex(&pool->mutex);
+            wrapped_fmu *instance = instantiate_instance(&pool->spec);
+            lockMutex(&pool->mutex);
+            if (instance == NULL)
+            {
+                pool->failed = true;
+                pool->statistics.n_failed++;
+            }
+            else
+            {
+                pool->available[pool->n_available++] = instance;
+                pool->statistics.n_instantiated++;
+            }
+            broadcastCondition(&pool->condition);
+        }
+        else
+        {
+            waitCondition(&pool->condition, &pool->mutex);
+        }
+    }
+    unlockMutex(&pool->mutex);
+}
+
+PUBLIC_EXPORT instance_pool *create_instance_pool(const instance_pool_spec *spec)
+{
+    if (spec->binary == NULL || spec->size == 0)
+    {
+        return NULL;
+    }
+    instance_pool *pool = calloc(1, sizeof(instance_pool));
+    if (pool == NULL)
+    {
+        return NULL;
+    }
+    pool->spec = *spec;
+    bool failed = false;
+    pool->spec.instance_name = copy_string(spec->instance_name, &failed);
+    pool->spec.guid = copy_string(spec->guid, &failed);
+    pool->spec.resource_location = copy_string(spec->resource_location, &failed);
+    pool->available = calloc(spec->size, sizeof(wrapped_fmu *));
+    initMutex(&pool->mutex);
+    initCondition(&pool->condition);
+    if (failed || pool->available == NULL || createThread(&pool->thread, run_pool, pool) != 0)
+    {
+        free_instance_pool(pool);
+        return NULL;
+    }
+    pool->thread_started = true;
+    return pool;
+}
+
+PUBLIC_EXPORT void free_instance_pool(instance_pool *pool)
+{
+    if (pool->thread_started)
+    {
+        lockMutex(&pool->mutex);
+        pool->stopping = true;
+        broadcastCondition(&pool->condition);
+        unlockMutex(&pool->mutex);
+        joinThread(pool->thread);
+    }
+    for (size_t i = 0; i < pool->n_available; i++)
+    {
+        free_instance(pool->available[i]);
+    }
+    for (size_t i = 0; i < pool->n_released; i++)
+    {
+        free_instance(pool->released[i]);
+    }
+    destroyCondition(&pool->condition);
+    destroyMutex(&pool->mutex);
+    free((char *)pool->spec.instance_name);
+    free((char *)pool->spec.guid);
+    free((char *)pool->spec.resource_location);
+    free(pool->available);
+    free(pool->released);
+    free(pool);
+}
+
+PUBLIC_EXPORT wrapped_fmu *acquire_instance(instance_pool *pool)
+{
+    lockMutex(&pool->mutex);
+    if (pool->n_available == 0)
+    {
+        pool->statistics.n_waited++;
+    }
+    while (pool->n_available == 0 && !pool->failed)
+    {
+        waitCondition(&pool->condition, &pool->mutex);
+    }
+    wrapped_fmu *instance = NULL;
+    if (pool->n_available > 0)
+    {
+        instance = pool->available[--pool->n_available];
+        pool->n_acquired++;
+        pool->statistics.n_acquired++;
+    }
+    else
+    {
+        // Let the background thread try again
+        pool->failed = false;
+        broadcastCondition(&pool->condition);
+    }
+    unlockMutex(&pool->mutex);
+    return instance;
+}
+
+PUBLIC_EXPORT void release_instance(instance_pool *pool, wrapped_fmu *instance)
+{
+    lockMutex(&pool->mutex);
+    pool->n_acquired -= pool->n_acquired > 0 ? 1 : 0;
+    if (pool->n_released == pool->released_capacity)
+    {
+        size_t capacity = pool->released_capacity > 0 ? 2 * pool->released_capacity : pool->spec.size;
+        wrapped_fmu **released = realloc(pool->released, capacity * sizeof(wrapped_fmu *));
+        if (released == NULL)
+        {
+            // Not recycled, the pool is topped up instead
+            broadcastCondition(&pool->condition);
+            unlockMutex(&pool->mutex);
+            free_instance(instance);
+            return;
+        }
+        pool->released = released;
+        pool->released_capacity = capacity;
+    }
+    pool->released[pool->n_released++] = instance;
+    broadcastCondition(&pool->condition);
+    unlockMutex(&pool->mutex);
+}
+
+PUBLIC_EXPORT void get_instance_pool_statistics(instance_pool *pool, instance_pool_statistics *statistics)
+{
+    lockMutex(&pool->mutex);
+    *statistics = pool->statistics;
+    statistics->n_available = pool->n_available;
+    unlockMutex(&pool->mutex);
+}
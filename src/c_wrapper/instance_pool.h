@@ -0,0 +1,68 @@
+#pragma once
+#include "fmi_wrapper.h"
+
+/*!
+    \brief Keep instances of a fmu instantiated in the background, so acquiring one does not wait for fmi2Instantiate.
+    The pool owns up to size instances, available and acquired ones. A background thread instantiates them ahead of time and
+    recycles the released instances: via reset if the spec allows it, otherwise they are freed and replaced by new instances.
+*/
+
+typedef struct instance_pool instance_pool;
+
+/*! Describes the instances of a pool. The strings are copied. */
+typedef struct instance_pool_spec
+{
+    /*! The binary must stay loaded until the pool is freed. */
+    fmu_binary *binary;
+    /*! Also called from the background thread, so it must be thread-safe. May be NULL. */
+    log_t log;
+    step_finished_t step_finished;
+    fmi2String instance_name;
+    fmi2Type fmu_type;
+    fmi2String guid;
+    fmi2String resource_location;
+    fmi2Boolean visible;
+    fmi2Boolean logging_on;
+    /*! The number of instances of the pool, including the acquired ones. */
+    size_t size;
+    /*! Recycle released instances via reset. Only for fmus that support reset, others are instantiated again. */
+    fmi2Boolean reset_instances;
+    /*! Allocate the memory of each instance from its own pool, see instantiate_pooled. */
+    fmi2Boolean pooled_memory;
+} instance_pool_spec;
+
+typedef struct instance_pool_statistics
+{
+    /*! The instances that are ready to be acquired. */
+    size_t n_available;
+    uint64_t n_acquired;
+    /*! The acquisitions that had to wait for an instance. */
+    uint64_t n_waited;
+    uint64_t n_instantiated;
+    uint64_t n_reset;
+    /*! Failed instantiations and resets. */
+    uint64_t n_failed;
+} instance_pool_statistics;
+
+/*!
+    \brief Create the pool and start instantiating its instances in the background.
+    \return NULL if the size is 0 or the pool could not be allocated.
+*/
+PUBLIC_EXPORT instance_pool *create_instance_pool(const instance_pool_spec *spec);
+/*!
+    \brief Free the available and released instances. Instances that are still acquired must be freed via free_instance.
+    Waits until the background thread finished the instance it is working on.
+*/
+PUBLIC_EXPORT void free_instance_pool(instance_pool *pool);
+/*!
+    \brief Take an instantiated instance, waits if none is available. Hand it back via release_instance, not free_instance.
+    The instance is in the state after fmi2Instantiate, the settings of the wrapper such as log filters are kept by a reset.
+    \return NULL if the background thread failed to instantiate. The next call retries.
+*/
+PUBLIC_EXPORT wrapped_fmu *acquire_instance(instance_pool *pool);
+/*!
+    \brief Hand an acquired instance back for recycling. Returns immediately, the instance is reset or freed in the background.
+    Recordings of the instance should be stopped before.
+*/
+PUBLIC_EXPORT void release_instance(instance_pool *pool, wrapped_fmu *instance);
+PUBLIC_EXPORT void get_instance_pool_statistics(instance_pool *pool, instance_pool_statistics *statistics);
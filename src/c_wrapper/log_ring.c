@@ -0,0 +1,150 @@
+#include "log_ring.h"
+#include "system_functions.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/*! Records must at least hold three truncated strings. */
+#define LOG_RECORD_MIN_SIZE 16
+
+/*! The metadata of a record, the strings are stored in the text of the ring. */
+typedef struct log_slot
+{
+    fmi2Status status;
+    size_t category_offset;
+    size_t message_offset;
+} log_slot;
+
+struct log_ring
+{
+    /*! The number of slots, always a power of two. */
+    size_t capacity;
+    /*! The chars of text per slot. */
+    size_t record_size;
+    log_slot *slots;
+    /*! capacity * record_size chars for the strings of the records. */
+    char *text;
+    /*! Index of the next slot to be written. Only written by the producer. */
+    volatile size_t head;
+    /*! Index of the first slot that has not been released by the consumer. Only written by the consumer. */
+    volatile size_t tail;
+    /*! End of the records handed out by the last drain. Only used by the consumer. */
+    size_t drained;
+    /*! Total number of dropped messages. Only written by the producer. */
+    volatile size_t dropped;
+    /*! Number of dropped messages already reported. Only used by the consumer. */
+    size_t dropped_reported;
+};
+
+log_ring *create_log_ring(size_t capacity, size_t record_size)
+{
+    size_t rounded_capacity = 1;
+    while (rounded_capacity < capacity)
+    {
+        rounded_capacity *= 2;
+    }
+    if (record_size < LOG_RECORD_MIN_SIZE)
+    {
+        record_size = LOG_RECORD_MIN_SIZE;
+    }
+    log_ring *ring = calloc(1, sizeof(log_ring));
+    if (ring == NULL)
+    {
+        return NULL;
+    }
+    ring->capacity = rounded_capacity;
+    ring->record_size = record_size;
+    ring->slots = calloc(rounded_capacity, sizeof(log_slot));
+    ring->text = malloc(rounded_capacity * record_size);
+    if (ring->slots == NULL || ring->text == NULL)
+    {
+        free_log_ring(ring);
+        return NULL;
+    }
+    return ring;
+}
+
+void free_log_ring(log_ring *ring)
+{
+    if (ring == NULL)
+    {
+        return;
+    }
+    free(ring->slots);
+    free(ring->text);
+    free(ring);
+}
+
+/*!
+    Copy the string including the \0 char, truncating it if it does not fit.
+    \return The number of chars written.
+*/
+static size_t copy_string(char *target, size_t size, const char *source)
+{
+    if (source == NULL)
+    {
+        source = "";
+    }
+    size_t length = strlen(source);
+    if (length >= size)
+    {
+        length = size - 1;
+    }
+    memcpy(target, source, length);
+    target[length] = '\0';
+    return length + 1;
+}
+
+bool push_log(log_ring *ring, fmi2String instance_name, fmi2Status status, fmi2String category, fmi2String message, va_list args)
+{
+    size_t head = ring->head;
+    if (head - atomicLoad(&ring->tail) >= ring->capacity)
+    {
+        atomicStore(&ring->dropped, ring->dropped + 1);
+        return false;
+    }
+    size_t index = head & (ring->capacity - 1);
+    log_slot *slot = &ring->slots[index];
+    char *text = ring->text + index * ring->record_size;
+    // Reserve at least one third of the record for the message
+    size_t name_size = ring->record_size / 3;
+    size_t used = copy_string(text, name_size, instance_name);
+    slot->category_offset = used;
+    used += copy_string(text + used, name_size, category);
+    slot->message_offset = used;
+    if (vsnprintf(text + used, ring->record_size - used, message, args) < 0)
+    {
+        // Invalid format string, store it unformatted
+        copy_string(text + used, ring->record_size - used, message);
+    }
+    slot->status = status;
+    // Publish the record
+    atomicStore(&ring->head, head + 1);
+    return true;
+}
+
+size_t drain_log_ring(log_ring *ring, log_record records[], size_t max_records, size_t *n_dropped)
+{
+    // Release the records of the last call
+    atomicStore(&ring->tail, ring->drained);
+    size_t available = atomicLoad(&ring->head) - ring->drained;
+    size_t count = available < max_records ? available : max_records;
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t index = (ring->drained + i) & (ring->capacity - 1);
+        const log_slot *slot = &ring->slots[index];
+        const char *text = ring->text + index * ring->record_size;
+        records[i].instance_name = text;
+        records[i].status = slot->status;
+        records[i].category = text + slot->category_offset;
+        records[i].message = text + slot->message_offset;
+    }
+    ring->drained += count;
+    if (n_dropped != NULL)
+    {
+        size_t dropped = atomicLoad(&ring->dropped);
+        *n_dropped = dropped - ring->dropped_reported;
+        ring->dropped_reported = dropped;
+    }
+    return count;
+}
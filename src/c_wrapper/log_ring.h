@@ -0,0 +1,32 @@
+#pragma once
+#include "fmi_wrapper.h"
+#include <stdarg.h>
+
+/*!
+    \brief A bounded ring buffer for log messages with a single producer and a single consumer.
+    The fmu thread pushes the messages and the calling enviroment drains them at its own pace, no locks are involved.
+*/
+typedef struct log_ring log_ring;
+
+/*!
+    Create a ring buffer.
+    \param capacity The number of records, rounded up to the next power of two.
+    \param record_size The number of chars available for instance name, category and message of one record.
+    \return NULL if the memory could not be allocated.
+*/
+log_ring *create_log_ring(size_t capacity, size_t record_size);
+/*! Release the memory of the ring buffer. */
+void free_log_ring(log_ring *ring);
+/*!
+    Format the message into the next free record. Called by the producer.
+    Strings that do not fit into the record are truncated.
+    \return false if the ring is full and the message has been dropped.
+*/
+bool push_log(log_ring *ring, fmi2String instance_name, fmi2Status status, fmi2String category, fmi2String message, va_list args);
+/*!
+    Fetch the oldest records. Called by the consumer.
+    The records returned by the previous call are released at the beginning of this call.
+    \param n_dropped Receives the number of messages dropped since the last call because the ring was full. May be NULL.
+    \return The number of records written to records.
+*/
+size_t drain_log_ring(log_ring *ring, log_record records[], size_t max_records, size_t *n_dropped);
@@ -0,0 +1,884 @@
+#include "me_solver.h"
+#include "sparse_jacobian.h"
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*! The number of stage vectors of the largest method: five Dormand-Prince stages and the stage input. */
+#define N_STAGES 6
+/*! The Newton iterations of a bdf step before the Jacobian is updated or the step size halved. */
+#define MAX_NEWTON_ITERATIONS 4
+
+struct me_solver
+{
+    wrapped_fmu *instance;
+    me_solver_options options;
+    size_t nx;
+    size_t nz;
+    fmi2Real time;
+    /*! The most severe status of the current call. */
+    fmi2Status status;
+    bool terminated;
+    bool next_event_time_defined;
+    fmi2Real next_event_time;
+    /*! The adaptive step size of dormand_prince. 0 until the first step. */
+    fmi2Real step_size;
+    /*! Set if dx contains the derivatives at time and x. */
+    bool derivatives_valid;
+    /*! The previous point of bdf, invalid after events. */
+    bool has_history;
+    fmi2Real previous_step_size;
+    /*! The Jacobian is reused until Newton fails to converge. */
+    bool jacobian_valid;
+    /*! The sparsity pattern of bdf, NULL for the dense Jacobian. */
+    sparse_jacobian *sparse_jacobian;
+    fmi2Boolean use_directional_derivatives;
+    /*! The factor of the Jacobian in the factorized iteration matrix, 0 if the matrix needs to be built. */
+    fmi2Real matrix_factor;
+    me_solver_statistics statistics;
+    /*! The block that contains all vectors, they are swapped when a step is accepted. */
+    fmi2Real *values;
+    /* Vectors of nx values */
+    fmi2Real *x;
+    fmi2Real *x_new;
+    fmi2Real *dx;
+    fmi2Real *dx_new;
+    fmi2Real *nominals;
+    fmi2Real *x_previous;
+    fmi2Real *x_interpolated;
+    fmi2Real *residual;
+    fmi2Real *stages;
+    /* Matrices of nx * nx values */
+    fmi2Real *jacobian;
+    fmi2Real *matrix;
+    size_t *pivots;
+    /* Vectors of nz values */
+    fmi2Real *z;
+    fmi2Real *z_new;
+    fmi2Real *z_left;
+    fmi2Real *z_middle;
+};
+
+/*! Dormand-Prince coefficients, the last row contains the weights of the 5th order solution. */
+static const fmi2Real dp_c[7] = {0, 1.0 / 5, 3.0 / 10, 4.0 / 5, 8.0 / 9, 1, 1};
+static const fmi2Real dp_a[7][6] = {
+    {0},
+    {1.0 / 5},
+    {3.0 / 40, 9.0 / 40},
+    {44.0 / 45, -56.0 / 15, 32.0 / 9},
+    {19372.0 / 6561, -25360.0 / 2187, 64448.0 / 6561, -212.0 / 729},
+    {9017.0 / 3168, -355.0 / 33, 46732.0 / 5247, 49.0 / 176, -5103.0 / 18656},
+    {35.0 / 384, 0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784, 11.0 / 84}};
+/*! Difference between the 5th and 4th order weights, the last entry belongs to the derivative at the new point. */
+static const fmi2Real dp_e[7] = {71.0 / 57600, 0, -71.0 / 16695, 71.0 / 1920, -17253.0 / 339200, 22.0 / 525, -1.0 / 40};
+
+/*! Accumulate the status of a call. \return false if the solver can not continue. */
+static bool check(me_solver *solver, fmi2Status status)
+{
+    if (status > solver->status)
+    {
+        solver->status = status;
+    }
+    return status == fmi2OK || status == fmi2Warning;
+}
+
+/*! Set the time and states of the instance. */
+static fmi2Status set_point(me_solver *solver, fmi2Real time, const fmi2Real x[])
+{
+    fmi2Status status = set_time(solver->instance, time);
+    if ((status == fmi2OK || status == fmi2Warning) && solver->nx > 0)
+    {
+        fmi2Status states_status = set_continuous_states(solver->instance, x, solver->nx);
+        status = states_status > status ? states_status : status;
+    }
+    return status;
+}
+
+/*! Evaluate the derivatives of the model at the point. */
+static fmi2Status evaluate(me_solver *solver, fmi2Real time, const fmi2Real x[], fmi2Real dx[])
+{
+    fmi2Status status = set_point(solver, time, x);
+    if ((status == fmi2OK || status == fmi2Warning) && solver->nx > 0)
+    {
+        fmi2Status derivatives_status = get_derivatives(solver->instance, dx, solver->nx);
+        status = derivatives_status > status ? derivatives_status : status;
+        solver->statistics.n_derivative_evaluations++;
+    }
+    return status;
+}
+
+/*! Root mean square of the values weighted by the tolerances of the states. */
+static fmi2Real weighted_norm(const me_solver *solver, const fmi2Real values[], const fmi2Real x0[], const fmi2Real x1[])
+{
+    if (solver->nx == 0)
+    {
+        return 0;
+    }
+    fmi2Real sum = 0;
+    for (size_t i = 0; i < solver->nx; i++)
+    {
+        fmi2Real scale = solver->options.absolute_tolerance * solver->nominals[i] +
+                         solver->options.relative_tolerance * fmax(fabs(x0[i]), fabs(x1[i]));
+        fmi2Real scaled = values[i] / scale;
+        sum += scaled * scaled;
+    }
+    return sqrt(sum / solver->nx);
+}
+
+/*! Classic Runge-Kutta step from x to x_new, also evaluates dx_new. */
+static fmi2Status rk4_step(me_solver *solver, fmi2Real h)
+{
+    size_t n = solver->nx;
+    fmi2Real t = solver->time;
+    fmi2Real *k2 = solver->stages;
+    fmi2Real *k3 = solver->stages + n;
+    fmi2Real *k4 = solver->stages + 2 * n;
+    fmi2Real *input = solver->stages + 3 * n;
+    for (size_t i = 0; i < n; i++)
+    {
+        input[i] = solver->x[i] + h / 2 * solver->dx[i];
+    }
+    fmi2Status status = evaluate(solver, t + h / 2, input, k2);
+    if (status > fmi2Warning)
+    {
+        return status;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        input[i] = solver->x[i] + h / 2 * k2[i];
+    }
+    status = evaluate(solver, t + h / 2, input, k3);
+    if (status > fmi2Warning)
+    {
+        return status;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        input[i] = solver->x[i] + h * k3[i];
+    }
+    status = evaluate(solver, t + h, input, k4);
+    if (status > fmi2Warning)
+    {
+        return status;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        solver->x_new[i] = solver->x[i] + h / 6 * (solver->dx[i] + 2 * k2[i] + 2 * k3[i] + k4[i]);
+    }
+    // The derivatives at the new point are the first stage of the next step
+    return evaluate(solver, t + h, solver->x_new, solver->dx_new);
+}
+
+/*! Dormand-Prince step from x to x_new, also evaluates dx_new and estimates the error relative to the tolerances. */
+static fmi2Status dormand_prince_step(me_solver *solver, fmi2Real h, fmi2Real *error)
+{
+    size_t n = solver->nx;
+    fmi2Real t = solver->time;
+    const fmi2Real *k[7];
+    k[0] = solver->dx;
+    for (int stage = 1; stage < 6; stage++)
+    {
+        k[stage] = solver->stages + (stage - 1) * n;
+    }
+    k[6] = solver->dx_new;
+    fmi2Real *input = solver->stages + 5 * n;
+    fmi2Status status = fmi2OK;
+    for (int stage = 1; stage < 7; stage++)
+    {
+        // The last stage evaluates the derivatives at the 5th order solution
+        fmi2Real *target = stage < 6 ? input : solver->x_new;
+        for (size_t i = 0; i < n; i++)
+        {
+            fmi2Real sum = 0;
+            for (int j = 0; j < stage; j++)
+            {
+                sum += dp_a[stage][j] * k[j][i];
+            }
+            target[i] = solver->x[i] + h * sum;
+        }
+        status = evaluate(solver, t + dp_c[stage] * h, target, (fmi2Real *)k[stage]);
+        if (status > fmi2Warning)
+        {
+            return status;
+        }
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        fmi2Real sum = 0;
+        for (int j = 0; j < 7; j++)
+        {
+            sum += dp_e[j] * k[j][i];
+        }
+        input[i] = h * sum;
+    }
+    *error = weighted_norm(solver, input, solver->x, solver->x_new);
+    return status;
+}
+
+/*! LU decomposition with partial pivoting of the iteration matrix. \return false if it is singular. */
+static bool factorize(me_solver *solver)
+{
+    size_t n = solver->nx;
+    fmi2Real *a = solver->matrix;
+    for (size_t column = 0; column < n; column++)
+    {
+        size_t pivot = column;
+        for (size_t row = column + 1; row < n; row++)
+        {
+            if (fabs(a[row * n + column]) > fabs(a[pivot * n + column]))
+            {
+                pivot = row;
+            }
+        }
+        if (a[pivot * n + column] == 0)
+        {
+            return false;
+        }
+        solver->pivots[column] = pivot;
+        if (pivot != column)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                fmi2Real swap = a[column * n + i];
+                a[column * n + i] = a[pivot * n + i];
+                a[pivot * n + i] = swap;
+            }
+        }
+        for (size_t row = column + 1; row < n; row++)
+        {
+            fmi2Real factor = a[row * n + column] / a[column * n + column];
+            a[row * n + column] = factor;
+            for (size_t i = column + 1; i < n; i++)
+            {
+                a[row * n + i] -= factor * a[column * n + i];
+            }
+        }
+    }
+    return true;
+}
+
+/*! Solve the factorized system in place. */
+static void solve(const me_solver *solver, fmi2Real b[])
+{
+    size_t n = solver->nx;
+    const fmi2Real *a = solver->matrix;
+    for (size_t row = 0; row < n; row++)
+    {
+        size_t pivot = solver->pivots[row];
+        if (pivot != row)
+        {
+            fmi2Real swap = b[row];
+            b[row] = b[pivot];
+            b[pivot] = swap;
+        }
+        for (size_t i = 0; i < row; i++)
+        {
+            b[row] -= a[row * n + i] * b[i];
+        }
+    }
+    for (size_t row = n; row-- > 0;)
+    {
+        for (size_t i = row + 1; i < n; i++)
+        {
+            b[row] -= a[row * n + i] * b[i];
+        }
+        b[row] /= a[row * n + row];
+    }
+}
+
+/*! Evaluate the colored columns of the sparse Jacobian at time and x and scatter them into the dense matrix. */
+static fmi2Status evaluate_sparse(me_solver *solver)
+{
+    size_t n = solver->nx;
+    sparse_jacobian *sparse = solver->sparse_jacobian;
+    fmi2Status status = set_point(solver, solver->time, solver->x);
+    if (status <= fmi2Warning)
+    {
+        fmi2Status jacobian_status = evaluate_sparse_jacobian(sparse, solver->instance, solver->use_directional_derivatives, solver->x,
+                                                              solver->dx, solver->nominals);
+        status = jacobian_status > status ? jacobian_status : status;
+    }
+    if (!solver->use_directional_derivatives)
+    {
+        solver->statistics.n_derivative_evaluations += sparse->n_colors;
+    }
+    memset(solver->jacobian, 0, n * n * sizeof(fmi2Real));
+    for (size_t row = 0; row < n; row++)
+    {
+        for (size_t i = sparse->row_offsets[row]; i < sparse->row_offsets[row + 1]; i++)
+        {
+            solver->jacobian[row * n + sparse->columns[i]] = sparse->values[i];
+        }
+    }
+    return status;
+}
+
+/*! Approximate the Jacobian at time and x by forward differences, one column per evaluation. */
+static fmi2Status evaluate_dense(me_solver *solver)
+{
+    size_t n = solver->nx;
+    fmi2Real *perturbed = solver->x_interpolated;
+    fmi2Real *derivatives = solver->residual;
+    memcpy(perturbed, solver->x, n * sizeof(fmi2Real));
+    fmi2Status status = fmi2OK;
+    for (size_t column = 0; column < n && status <= fmi2Warning; column++)
+    {
+        fmi2Real delta = sqrt(DBL_EPSILON) * fmax(fabs(solver->x[column]), solver->nominals[column]);
+        perturbed[column] = solver->x[column] + delta;
+        status = evaluate(solver, solver->time, perturbed, derivatives);
+        perturbed[column] = solver->x[column];
+        for (size_t row = 0; row < n; row++)
+        {
+            solver->jacobian[row * n + column] = (derivatives[row] - solver->dx[row]) / delta;
+        }
+    }
+    return status;
+}
+
+/*! Update the Jacobian at time and x, stored row-major. */
+static fmi2Status update_jacobian(me_solver *solver)
+{
+    fmi2Status status = solver->sparse_jacobian != NULL ? evaluate_sparse(solver) : evaluate_dense(solver);
+    solver->statistics.n_jacobian_evaluations++;
+    solver->jacobian_valid = status <= fmi2Warning;
+    solver->matrix_factor = 0;
+    return status;
+}
+
+/*!
+    Variable step BDF2 from x to x_new, the first step after an event uses the implicit Euler.
+    \param converged False if the Newton iteration failed, the caller updates the Jacobian or reduces the step.
+*/
+static fmi2Status bdf_step(me_solver *solver, fmi2Real h, bool *converged)
+{
+    size_t n = solver->nx;
+    fmi2Real t = solver->time;
+    fmi2Real a0 = 1;
+    fmi2Real a1 = 0;
+    fmi2Real beta = 1;
+    if (solver->has_history)
+    {
+        fmi2Real ratio = h / solver->previous_step_size;
+        a0 = (1 + ratio) * (1 + ratio) / (1 + 2 * ratio);
+        a1 = -ratio * ratio / (1 + 2 * ratio);
+        beta = (1 + ratio) / (1 + 2 * ratio);
+    }
+    fmi2Real gamma = beta * h;
+    *converged = false;
+    if (!solver->jacobian_valid)
+    {
+        fmi2Status status = update_jacobian(solver);
+        if (status > fmi2Warning)
+        {
+            return status;
+        }
+    }
+    if (solver->matrix_factor != gamma)
+    {
+        // Iteration matrix I - gamma * J
+        for (size_t i = 0; i < n * n; i++)
+        {
+            solver->matrix[i] = -gamma * solver->jacobian[i];
+        }
+        for (size_t i = 0; i < n; i++)
+        {
+            solver->matrix[i * n + i] += 1;
+        }
+        if (!factorize(solver))
+        {
+            solver->matrix_factor = 0;
+            return fmi2OK;
+        }
+        solver->matrix_factor = gamma;
+    }
+    // Explicit Euler predictor
+    for (size_t i = 0; i < n; i++)
+    {
+        solver->x_new[i] = solver->x[i] + h * solver->dx[i];
+    }
+    fmi2Status status = fmi2OK;
+    for (int iteration = 0; iteration < MAX_NEWTON_ITERATIONS && !*converged; iteration++)
+    {
+        status = evaluate(solver, t + h, solver->x_new, solver->dx_new);
+        if (status > fmi2Warning)
+        {
+            return status;
+        }
+        for (size_t i = 0; i < n; i++)
+        {
+            solver->residual[i] = solver->x_new[i] - a0 * solver->x[i] - a1 * solver->x_previous[i] - gamma * solver->dx_new[i];
+        }
+        solve(solver, solver->residual);
+        for (size_t i = 0; i < n; i++)
+        {
+            solver->x_new[i] -= solver->residual[i];
+        }
+        *converged = weighted_norm(solver, solver->residual, solver->x, solver->x_new) <= 0.1;
+    }
+    if (*converged)
+    {
+        status = evaluate(solver, t + h, solver->x_new, solver->dx_new);
+    }
+    return status;
+}
+
+/*! Cubic Hermite interpolation between the points of the last step. */
+static void interpolate(me_solver *solver, fmi2Real t0, fmi2Real h, fmi2Real time, fmi2Real x[])
+{
+    fmi2Real theta = (time - t0) / h;
+    fmi2Real theta2 = theta * theta;
+    fmi2Real theta3 = theta2 * theta;
+    fmi2Real h00 = 2 * theta3 - 3 * theta2 + 1;
+    fmi2Real h10 = theta3 - 2 * theta2 + theta;
+    fmi2Real h01 = -2 * theta3 + 3 * theta2;
+    fmi2Real h11 = theta3 - theta2;
+    for (size_t i = 0; i < solver->nx; i++)
+    {
+        x[i] = h00 * solver->x[i] + h10 * h * solver->dx[i] + h01 * solver->x_new[i] + h11 * h * solver->dx_new[i];
+    }
+}
+
+/*! Check if any event indicator changed its sign. Leaving zero, e.g. right after an event, is not a crossing. */
+static bool has_crossing(const me_solver *solver, const fmi2Real z0[], const fmi2Real z1[])
+{
+    for (size_t i = 0; i < solver->nz; i++)
+    {
+        if ((z0[i] > 0 && z1[i] <= 0) || (z0[i] < 0 && z1[i] >= 0))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*!
+    Bracket the first zero crossing within the last step by regula falsi, falling back to bisection if one side is retained.
+    Afterwards x_new and z_new are the point right after the crossing and the instance is set to it.
+    \return The time of the event.
+*/
+static fmi2Real locate_event(me_solver *solver, fmi2Real t1)
+{
+    fmi2Real t0 = solver->time;
+    fmi2Real h = t1 - t0;
+    fmi2Real left = t0;
+    fmi2Real right = t1;
+    memcpy(solver->z_left, solver->z, solver->nz * sizeof(fmi2Real));
+    // Switch to bisection if the same side is moved repeatedly
+    int last_side = 0;
+    int repeats = 0;
+    while (right - left > solver->options.event_tolerance)
+    {
+        // The earliest crossing of the linear approximations
+        fmi2Real theta = 1;
+        for (size_t i = 0; i < solver->nz; i++)
+        {
+            if ((solver->z_left[i] > 0 && solver->z_new[i] <= 0) || (solver->z_left[i] < 0 && solver->z_new[i] >= 0))
+            {
+                fmi2Real estimate = solver->z_left[i] / (solver->z_left[i] - solver->z_new[i]);
+                theta = fmin(theta, estimate);
+            }
+        }
+        theta = repeats >= 2 ? 0.5 : fmin(fmax(theta, 0.01), 0.99);
+        fmi2Real middle = left + theta * (right - left);
+        interpolate(solver, t0, h, middle, solver->x_interpolated);
+        if (!check(solver, set_point(solver, middle, solver->x_interpolated)) ||
+            !check(solver, get_event_indicators(solver->instance, solver->z_middle, solver->nz)))
+        {
+            return right;
+        }
+        int side = has_crossing(solver, solver->z_left, solver->z_middle) ? 1 : -1;
+        if (side > 0)
+        {
+            right = middle;
+            memcpy(solver->z_new, solver->z_middle, solver->nz * sizeof(fmi2Real));
+        }
+        else
+        {
+            left = middle;
+            memcpy(solver->z_left, solver->z_middle, solver->nz * sizeof(fmi2Real));
+        }
+        repeats = side == last_side ? repeats + 1 : 0;
+        last_side = side;
+    }
+    interpolate(solver, t0, h, right, solver->x_interpolated);
+    memcpy(solver->x_new, solver->x_interpolated, solver->nx * sizeof(fmi2Real));
+    check(solver, set_point(solver, right, solver->x_new));
+    return right;
+}
+
+/*! Run the event iteration and return to the continuous time mode, the instance must be in the event mode. */
+static void iterate_events(me_solver *solver)
+{
+    fmi2EventInfo event_info = {0};
+    event_info.newDiscreteStatesNeeded = fmi2True;
+    size_t iteration = 0;
+    while (event_info.newDiscreteStatesNeeded && !event_info.terminateSimulation)
+    {
+        if (iteration++ == solver->options.max_event_iterations)
+        {
+            check(solver, fmi2Error);
+            return;
+        }
+        if (!check(solver, new_discrete_states(solver->instance, &event_info)))
+        {
+            return;
+        }
+    }
+    if (event_info.terminateSimulation)
+    {
+        solver->terminated = true;
+        return;
+    }
+    if (!check(solver, enter_continuous_time_mode(solver->instance)))
+    {
+        return;
+    }
+    solver->next_event_time_defined = event_info.nextEventTimeDefined;
+    solver->next_event_time = event_info.nextEventTime;
+    // Refresh everything the event may have changed
+    if (solver->nx > 0 && !check(solver, get_continuous_states(solver->instance, solver->x, solver->nx)))
+    {
+        return;
+    }
+    if (solver->nx > 0 && event_info.nominalsOfContinuousStatesChanged &&
+        !check(solver, get_nominals_of_continuous_states(solver->instance, solver->nominals, solver->nx)))
+    {
+        return;
+    }
+    if (solver->nz > 0)
+    {
+        check(solver, get_event_indicators(solver->instance, solver->z, solver->nz));
+    }
+    solver->derivatives_valid = false;
+    solver->has_history = false;
+}
+
+/*! Handle an event at the current time. */
+static void handle_event(me_solver *solver)
+{
+    if (check(solver, enter_event_mode(solver->instance)))
+    {
+        solver->derivatives_valid = false;
+        iterate_events(solver);
+        solver->jacobian_valid = false;
+    }
+}
+
+/*! Perform one accepted step of the method that ends at most at t_stop. \return The end of the step. */
+static fmi2Real integrate_step(me_solver *solver, fmi2Real t_stop, fmi2Real h)
+{
+    fmi2Real t = solver->time;
+    for (;;)
+    {
+        bool hits_stop = t + h >= t_stop - 1e-12 * fmax(1, fabs(t_stop));
+        if (hits_stop)
+        {
+            h = t_stop - t;
+        }
+        fmi2Real t_new = hits_stop ? t_stop : t + h;
+        switch (solver->options.method)
+        {
+        case me_solver_rk4:
+            check(solver, rk4_step(solver, h));
+            return t_new;
+        case me_solver_dormand_prince:
+        {
+            fmi2Real error = 0;
+            fmi2Status status = dormand_prince_step(solver, h, &error);
+            // Models may discard evaluations outside of their domain, retry with a smaller step
+            if (status == fmi2Discard)
+            {
+                error = HUGE_VAL;
+            }
+            else if (!check(solver, status))
+            {
+                return t_new;
+            }
+            fmi2Real factor = error > 0 ? fmin(5, fmax(0.2, 0.9 * pow(error, -0.2))) : 5;
+            if (error <= 1)
+            {
+                // Do not let clamped steps shrink the step size of the following steps
+                solver->step_size = fmax(h * factor, hits_stop ? solver->step_size : 0);
+                if (solver->options.max_step_size > 0)
+                {
+                    solver->step_size = fmin(solver->step_size, solver->options.max_step_size);
+                }
+                return t_new;
+            }
+            solver->statistics.n_rejected_steps++;
+            h *= factor;
+            if (h < solver->options.min_step_size)
+            {
+                check(solver, fmi2Error);
+                return t;
+            }
+            break;
+        }
+        case me_solver_bdf:
+        {
+            bool converged;
+            bool fresh_jacobian = !solver->jacobian_valid;
+            if (!check(solver, bdf_step(solver, h, &converged)))
+            {
+                return t_new;
+            }
+            if (converged)
+            {
+                memcpy(solver->x_previous, solver->x, solver->nx * sizeof(fmi2Real));
+                solver->previous_step_size = h;
+                solver->has_history = true;
+                return t_new;
+            }
+            solver->statistics.n_rejected_steps++;
+            if (fresh_jacobian)
+            {
+                h /= 2;
+                if (h < solver->options.min_step_size)
+                {
+                    check(solver, fmi2Error);
+                    return t;
+                }
+            }
+            solver->jacobian_valid = false;
+            break;
+        }
+        }
+    }
+}
+
+PUBLIC_EXPORT me_solver *create_me_solver(wrapped_fmu *instance, size_t n_states, size_t n_event_indicators, const me_solver_options *options)
+{
+    me_solver *solver = calloc(1, sizeof(me_solver));
+    if (solver == NULL)
+    {
+        return NULL;
+    }
+    solver->instance = instance;
+    if (options != NULL)
+    {
+        solver->options = *options;
+    }
+    if (solver->options.min_step_size <= 0)
+    {
+        solver->options.min_step_size = 1e-12;
+    }
+    if (solver->options.relative_tolerance <= 0)
+    {
+        solver->options.relative_tolerance = 1e-6;
+    }
+    if (solver->options.absolute_tolerance <= 0)
+    {
+        solver->options.absolute_tolerance = 1e-8;
+    }
+    if (solver->options.event_tolerance <= 0)
+    {
+        solver->options.event_tolerance = 1e-10;
+    }
+    if (solver->options.max_event_iterations == 0)
+    {
+        solver->options.max_event_iterations = 100;
+    }
+    solver->nx = n_states;
+    solver->nz = n_event_indicators;
+    size_t nx = n_states;
+    size_t nz = n_event_indicators;
+    bool implicit = solver->options.method == me_solver_bdf;
+    // All vectors in one block
+    size_t n_values = (8 + N_STAGES) * nx + 4 * nz + (implicit ? 2 * nx * nx : 0);
+    fmi2Real *values = calloc(n_values > 0 ? n_values : 1, sizeof(fmi2Real));
+    solver->pivots = implicit ? calloc(nx > 0 ? nx : 1, sizeof(size_t)) : NULL;
+    if (values == NULL || (implicit && solver->pivots == NULL))
+    {
+        free(values);
+        free(solver->pivots);
+        free(solver);
+        return NULL;
+    }
+    solver->values = values;
+    fmi2Real **vectors[] = {&solver->x, &solver->x_new, &solver->dx, &solver->dx_new, &solver->nominals,
+                            &solver->x_previous, &solver->x_interpolated, &solver->residual};
+    for (size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++)
+    {
+        *vectors[i] = values + i * nx;
+    }
+    solver->stages = values + 8 * nx;
+    solver->z = values + (8 + N_STAGES) * nx;
+    solver->z_new = solver->z + nz;
+    solver->z_left = solver->z + 2 * nz;
+    solver->z_middle = solver->z + 3 * nz;
+    if (implicit)
+    {
+        solver->jacobian = solver->z + 4 * nz;
+        solver->matrix = solver->jacobian + nx * nx;
+    }
+    for (size_t i = 0; i < nx; i++)
+    {
+        solver->nominals[i] = 1;
+    }
+    const model_description *description = solver->options.model_description;
+    if (implicit && description != NULL && description->number_of_continuous_states == nx)
+    {
+        // Without a usable pattern the dense Jacobian is used
+        solver->sparse_jacobian = create_sparse_jacobian(description);
+        solver->use_directional_derivatives = description->model_exchange.provides_directional_derivative;
+    }
+    solver->options.model_description = NULL;
+    return solver;
+}
+
+PUBLIC_EXPORT void free_me_solver(me_solver *solver)
+{
+    if (solver == NULL)
+    {
+        return;
+    }
+    free(solver->values);
+    free(solver->pivots);
+    free_sparse_jacobian(solver->sparse_jacobian);
+    free(solver);
+}
+
+PUBLIC_EXPORT fmi2Status me_solver_initialize(me_solver *solver, fmi2Real start_time)
+{
+    solver->status = fmi2OK;
+    solver->time = start_time;
+    solver->terminated = false;
+    solver->step_size = 0;
+    solver->derivatives_valid = false;
+    solver->jacobian_valid = false;
+    if (solver->nx > 0 && !check(solver, get_nominals_of_continuous_states(solver->instance, solver->nominals, solver->nx)))
+    {
+        return solver->status;
+    }
+    iterate_events(solver);
+    return solver->terminated && solver->status <= fmi2Warning ? fmi2Discard : solver->status;
+}
+
+PUBLIC_EXPORT fmi2Status me_solver_do_step(me_solver *solver, fmi2Real current_communication_point, fmi2Real communication_step_size)
+{
+    fmi2Real t_end = current_communication_point + communication_step_size;
+    fmi2Real time_tolerance = 1e-12 * fmax(1, fabs(t_end));
+    if (fabs(current_communication_point - solver->time) > time_tolerance || communication_step_size < 0)
+    {
+        return fmi2Error;
+    }
+    if (solver->terminated)
+    {
+        return fmi2Discard;
+    }
+    solver->status = fmi2OK;
+    while (solver->time < t_end - time_tolerance && !solver->terminated && solver->status <= fmi2Warning)
+    {
+        if (!solver->derivatives_valid)
+        {
+            if (!check(solver, evaluate(solver, solver->time, solver->x, solver->dx)))
+            {
+                break;
+            }
+            solver->derivatives_valid = true;
+        }
+        fmi2Real t_stop = t_end;
+        bool time_event = solver->next_event_time_defined && solver->next_event_time <= t_end + time_tolerance;
+        if (time_event)
+        {
+            t_stop = fmax(solver->next_event_time, solver->time);
+        }
+        fmi2Real h = solver->options.step_size > 0 ? solver->options.step_size : communication_step_size;
+        if (solver->options.method == me_solver_dormand_prince)
+        {
+            if (solver->step_size <= 0)
+            {
+                solver->step_size = h;
+                if (solver->options.max_step_size > 0)
+                {
+                    solver->step_size = fmin(solver->step_size, solver->options.max_step_size);
+                }
+            }
+            h = solver->step_size;
+        }
+        fmi2Real t_new = t_stop > solver->time ? integrate_step(solver, t_stop, h) : solver->time;
+        if (solver->status > fmi2Warning)
+        {
+            break;
+        }
+        bool state_event = false;
+        if (t_new > solver->time)
+        {
+            if (solver->nz > 0)
+            {
+                if (!check(solver, get_event_indicators(solver->instance, solver->z_new, solver->nz)))
+                {
+                    break;
+                }
+                state_event = has_crossing(solver, solver->z, solver->z_new);
+                if (state_event)
+                {
+                    t_new = locate_event(solver, t_new);
+                }
+            }
+            // Accept the step, the buffers of the old point are reused for the next step
+            fmi2Real *swap = solver->x;
+            solver->x = solver->x_new;
+            solver->x_new = swap;
+            swap = solver->dx;
+            solver->dx = solver->dx_new;
+            solver->dx_new = swap;
+            swap = solver->z;
+            solver->z = solver->z_new;
+            solver->z_new = swap;
+            // The derivatives of the interpolated point have not been evaluated
+            solver->derivatives_valid = !state_event;
+            solver->time = t_new;
+            solver->statistics.n_steps++;
+            if (solver->options.method == me_solver_bdf)
+            {
+                solver->jacobian_valid = solver->jacobian_valid && !state_event;
+            }
+        }
+        time_event = time_event && !state_event && t_new >= t_stop;
+        fmi2Boolean step_event = fmi2False;
+        fmi2Boolean terminate_simulation = fmi2False;
+        if (!check(solver, completed_integrator_step(solver->instance, fmi2True, &step_event, &terminate_simulation)))
+        {
+            break;
+        }
+        if (terminate_simulation)
+        {
+            solver->terminated = true;
+            break;
+        }
+        if (state_event || time_event || step_event)
+        {
+            solver->statistics.n_state_events += state_event;
+            solver->statistics.n_time_events += time_event;
+            solver->statistics.n_step_events += step_event && !state_event && !time_event;
+            handle_event(solver);
+        }
+    }
+    if (solver->terminated && solver->status <= fmi2Warning)
+    {
+        return fmi2Discard;
+    }
+    return solver->status;
+}
+
+PUBLIC_EXPORT fmi2Real me_solver_get_time(const me_solver *solver)
+{
+    return solver->time;
+}
+
+PUBLIC_EXPORT fmi2Status me_solver_get_states(const me_solver *solver, fmi2Real x[], size_t nx)
+{
+    if (nx != solver->nx)
+    {
+        return fmi2Error;
+    }
+    memcpy(x, solver->x, nx * sizeof(fmi2Real));
+    return fmi2OK;
+}
+
+PUBLIC_EXPORT void me_solver_get_statistics(const me_solver *solver, me_solver_statistics *statistics)
+{
+    *statistics = solver->statistics;
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "fmi_wrapper.h"
+#include "model_description.h"
+
+/*!
+    \brief Native integration of Model Exchange fmus, so they can be stepped like co-simulation slaves.
+    The solver owns the continuous states, evaluates the derivatives of the fmu, locates state events by bracketing the roots
+    of the event indicators and runs the event iteration via new_discrete_states.
+*/
+
+typedef enum me_solver_method
+{
+    /*! Classic explicit Runge-Kutta of order 4 with a fixed step size. */
+    me_solver_rk4,
+    /*! Explicit Runge-Kutta 5(4) of Dormand and Prince with step size control. */
+    me_solver_dormand_prince,
+    /*!
+        Implicit BDF of order 2 with a fixed step size for stiff models. The Jacobian is approximated by finite differences
+        unless a model description with the sparsity pattern is given.
+    */
+    me_solver_bdf
+} me_solver_method;
+
+/*! Zero selects the default of a value. */
+typedef struct me_solver_options
+{
+    me_solver_method method;
+    /*! The step size of rk4 and bdf, the initial step size of dormand_prince. Defaults to the communication step size. */
+    fmi2Real step_size;
+    /*! Limits the step size of dormand_prince. Unlimited by default. */
+    fmi2Real max_step_size;
+    /*! dormand_prince fails if the step size has to be reduced below this size. Defaults to 1e-12. */
+    fmi2Real min_step_size;
+    /*! Defaults to 1e-6. */
+    fmi2Real relative_tolerance;
+    /*! Scaled by the nominal values of the states. Defaults to 1e-8. */
+    fmi2Real absolute_tolerance;
+    /*! State events are located within this time interval. Defaults to 1e-10. */
+    fmi2Real event_tolerance;
+    /*! The maximum number of new_discrete_states calls per event. Defaults to 100. */
+    size_t max_event_iterations;
+    /*!
+        Lets bdf evaluate the Jacobian with a sparse_jacobian, using directional derivatives if the fmu provides them.
+        Only needed during create_me_solver. NULL approximates the Jacobian column by column.
+    */
+    const model_description *model_description;
+} me_solver_options;
+
+typedef struct me_solver_statistics
+{
+    size_t n_steps;
+    size_t n_rejected_steps;
+    size_t n_derivative_evaluations;
+    size_t n_jacobian_evaluations;
+    size_t n_state_events;
+    size_t n_time_events;
+    /*! Events requested by completed_integrator_step. */
+    size_t n_step_events;
+} me_solver_statistics;
+
+typedef struct me_solver me_solver;
+
+/*!
+    \brief Create a solver for a Model Exchange instance.
+    \param instance The solver does not take the ownership of the instance.
+    \param n_states The number of continuous states, see model_description.number_of_continuous_states.
+    \param n_event_indicators See model_description.number_of_event_indicators.
+    \param options May be NULL to use the defaults.
+    \return NULL if the memory could not be allocated.
+*/
+PUBLIC_EXPORT me_solver *create_me_solver(wrapped_fmu *instance, size_t n_states, size_t n_event_indicators, const me_solver_options *options);
+PUBLIC_EXPORT void free_me_solver(me_solver *solver);
+/*!
+    \brief Runs the initial event iteration and enters the continuous time mode.
+    Call it after exit_initialization_mode, the instance is in the event mode then.
+*/
+PUBLIC_EXPORT fmi2Status me_solver_initialize(me_solver *solver, fmi2Real start_time);
+/*!
+    \brief Integrate until the next communication point, handling all events on the way.
+    Afterwards the instance is at the communication point, so the outputs can be read via get_real etc.
+    \param current_communication_point Must match the time of the solver.
+    \return fmi2Discard if the fmu requested to terminate the simulation, me_solver_get_time returns the time of the request.
+*/
+PUBLIC_EXPORT fmi2Status me_solver_do_step(me_solver *solver, fmi2Real current_communication_point, fmi2Real communication_step_size);
+PUBLIC_EXPORT fmi2Real me_solver_get_time(const me_solver *solver);
+/*! \brief Copy the continuous states of the solver. \param nx Must match the number of states. */
+PUBLIC_EXPORT fmi2Status me_solver_get_states(const me_solver *solver, fmi2Real x[], size_t nx);
+PUBLIC_EXPORT void me_solver_get_statistics(const me_solver *solver, me_solver_statistics *statistics);
@@ -0,0 +1,598 @@
+#include "model_description.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*! Attributes beyond this number are ignored. */
+#define MAX_XML_ATTRIBUTES 32
+/*! Elements nested deeper are parsed but not interpreted. */
+#define MAX_XML_DEPTH 16
+
+typedef struct xml_attribute
+{
+    const char *name;
+    const char *value;
+} xml_attribute;
+
+/*! The state while walking through the xml elements. */
+typedef struct parser_context
+{
+    model_description *description;
+    /*! The names of the open elements. */
+    const char *path[MAX_XML_DEPTH];
+    int depth;
+    size_t variables_capacity;
+    size_t derivatives_capacity;
+    size_t dependencies_defined_capacity;
+    size_t dependency_offsets_capacity;
+    size_t dependencies_capacity;
+    bool failed;
+} parser_context;
+
+static bool is_whitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static char *skip_whitespace(char *text)
+{
+    while (is_whitespace(*text))
+    {
+        text++;
+    }
+    return text;
+}
+
+/*! Replace the predefined entities and character references in place. */
+static void decode_entities(char *text)
+{
+    char *target = text;
+    for (const char *source = text; *source != '\0';)
+    {
+        if (*source != '&')
+        {
+            *target++ = *source++;
+            continue;
+        }
+        const char *end = strchr(source, ';');
+        if (end == NULL)
+        {
+            *target++ = *source++;
+            continue;
+        }
+        size_t length = (size_t)(end - source) + 1;
+        if (length == 5 && strncmp(source, "&amp;", 5) == 0)
+        {
+            *target++ = '&';
+        }
+        else if (length == 4 && strncmp(source, "&lt;", 4) == 0)
+        {
+            *target++ = '<';
+        }
+        else if (length == 4 && strncmp(source, "&gt;", 4) == 0)
+        {
+            *target++ = '>';
+        }
+        else if (length == 6 && strncmp(source, "&quot;", 6) == 0)
+        {
+            *target++ = '"';
+        }
+        else if (length == 6 && strncmp(source, "&apos;", 6) == 0)
+        {
+            *target++ = '\'';
+        }
+        else if (length > 3 && source[1] == '#')
+        {
+            unsigned long code = source[2] == 'x' ? strtoul(source + 3, NULL, 16) : strtoul(source + 2, NULL, 10);
+            // Encode as UTF-8, the encoding is never longer than the reference
+            if (code < 0x80)
+            {
+                *target++ = (char)code;
+            }
+            else if (code < 0x800)
+            {
+                *target++ = (char)(0xc0 | (code >> 6));
+                *target++ = (char)(0x80 | (code & 0x3f));
+            }
+            else if (code < 0x10000)
+            {
+                *target++ = (char)(0xe0 | (code >> 12));
+                *target++ = (char)(0x80 | ((code >> 6) & 0x3f));
+                *target++ = (char)(0x80 | (code & 0x3f));
+            }
+            else
+            {
+                *target++ = (char)(0xf0 | (code >> 18));
+                *target++ = (char)(0x80 | ((code >> 12) & 0x3f));
+                *target++ = (char)(0x80 | ((code >> 6) & 0x3f));
+                *target++ = (char)(0x80 | (code & 0x3f));
+            }
+        }
+        else
+        {
+            // Unknown entity, keep it
+            memmove(target, source, length);
+            target += length;
+        }
+        source = end + 1;
+    }
+    *target = '\0';
+}
+
+static const char *find_attribute(const xml_attribute attributes[], int n_attributes, const char *name)
+{
+    for (int i = 0; i < n_attributes; i++)
+    {
+        if (strcmp(attributes[i].name, name) == 0)
+        {
+            return attributes[i].value;
+        }
+    }
+    return NULL;
+}
+
+static fmi2Boolean parse_boolean(const char *value)
+{
+    return value != NULL && (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+}
+
+static bool is_element(const parser_context *context, int depth, const char *name)
+{
+    return context->depth > depth && depth < MAX_XML_DEPTH && strcmp(context->path[depth], name) == 0;
+}
+
+/*! Grow the array geometrically so it can hold at least one more element. */
+static bool reserve_one(void **array, size_t *capacity, size_t count, size_t element_size)
+{
+    if (count < *capacity)
+    {
+        return true;
+    }
+    size_t new_capacity = *capacity > 0 ? *capacity * 2 : 64;
+    void *new_array = realloc(*array, new_capacity * element_size);
+    if (new_array == NULL)
+    {
+        return false;
+    }
+    *array = new_array;
+    *capacity = new_capacity;
+    return true;
+}
+
+static void parse_interface(fmu_interface *fmu_interface, const xml_attribute attributes[], int n_attributes)
+{
+    fmu_interface->available = fmi2True;
+    fmu_interface->model_identifier = find_attribute(attributes, n_attributes, "modelIdentifier");
+    fmu_interface->needs_execution_tool = parse_boolean(find_attribute(attributes, n_attributes, "needsExecutionTool"));
+    fmu_interface->can_be_instantiated_only_once_per_process = parse_boolean(find_attribute(attributes, n_attributes, "canBeInstantiatedOnlyOncePerProcess"));
+    fmu_interface->can_not_use_memory_management_functions = parse_boolean(find_attribute(attributes, n_attributes, "canNotUseMemoryManagementFunctions"));
+    fmu_interface->can_get_and_set_fmu_state = parse_boolean(find_attribute(attributes, n_attributes, "canGetAndSetFMUstate"));
+    fmu_interface->can_serialize_fmu_state = parse_boolean(find_attribute(attributes, n_attributes, "canSerializeFMUstate"));
+    fmu_interface->provides_directional_derivative = parse_boolean(find_attribute(attributes, n_attributes, "providesDirectionalDerivative"));
+    fmu_interface->can_handle_variable_communication_step_size = parse_boolean(find_attribute(attributes, n_attributes, "canHandleVariableCommunicationStepSize"));
+    fmu_interface->completed_integrator_step_not_needed = parse_boolean(find_attribute(attributes, n_attributes, "completedIntegratorStepNotNeeded"));
+}
+
+static void parse_real_attribute(const xml_attribute attributes[], int n_attributes, const char *name, fmi2Boolean *defined, fmi2Real *value)
+{
+    const char *text = find_attribute(attributes, n_attributes, name);
+    *defined = text != NULL;
+    if (text != NULL)
+    {
+        *value = strtod(text, NULL);
+    }
+}
+
+static void parse_default_experiment(default_experiment *experiment, const xml_attribute attributes[], int n_attributes)
+{
+    parse_real_attribute(attributes, n_attributes, "startTime", &experiment->start_time_defined, &experiment->start_time);
+    parse_real_attribute(attributes, n_attributes, "stopTime", &experiment->stop_time_defined, &experiment->stop_time);
+    parse_real_attribute(attributes, n_attributes, "tolerance", &experiment->tolerance_defined, &experiment->tolerance);
+    parse_real_attribute(attributes, n_attributes, "stepSize", &experiment->step_size_defined, &experiment->step_size);
+}
+
+static variable_causality parse_causality(const char *value)
+{
+    static const char *names[] = {"parameter", "calculatedParameter", "input", "output", "local", "independent"};
+    for (int i = 0; value != NULL && i < (int)(sizeof(names) / sizeof(names[0])); i++)
+    {
+        if (strcmp(value, names[i]) == 0)
+        {
+            return (variable_causality)i;
+        }
+    }
+    // Default of the standard
+    return causality_local;
+}
+
+static variable_variability parse_variability(const char *value)
+{
+    static const char *names[] = {"constant", "fixed", "tunable", "discrete", "continuous"};
+    for (int i = 0; value != NULL && i < (int)(sizeof(names) / sizeof(names[0])); i++)
+    {
+        if (strcmp(value, names[i]) == 0)
+        {
+            return (variable_variability)i;
+        }
+    }
+    // Default of the standard
+    return variability_continuous;
+}
+
+static void parse_scalar_variable(parser_context *context, const xml_attribute attributes[], int n_attributes)
+{
+    model_description *description = context->description;
+    const char *name = find_attribute(attributes, n_attributes, "name");
+    const char *value_reference = find_attribute(attributes, n_attributes, "valueReference");
+    if (name == NULL || value_reference == NULL ||
+        !reserve_one((void **)&description->variables, &context->variables_capacity, description->n_variables, sizeof(model_variable)))
+    {
+        context->failed = true;
+        return;
+    }
+    model_variable *variable = &description->variables[description->n_variables++];
+    variable->name = name;
+    variable->value_reference = (fmi2ValueReference)strtoul(value_reference, NULL, 10);
+    variable->type = variable_real;
+    variable->causality = parse_causality(find_attribute(attributes, n_attributes, "causality"));
+    variable->variability = parse_variability(find_attribute(attributes, n_attributes, "variability"));
+    variable->description = find_attribute(attributes, n_attributes, "description");
+    variable->start = NULL;
+    variable->derivative_of = SIZE_MAX;
+}
+
+static void parse_variable_type(parser_context *context, const char *element, const xml_attribute attributes[], int n_attributes)
+{
+    static const char *names[] = {"Real", "Integer", "Boolean", "String", "Enumeration"};
+    model_description *description = context->description;
+    if (description->n_variables == 0)
+    {
+        return;
+    }
+    model_variable *variable = &description->variables[description->n_variables - 1];
+    for (int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++)
+    {
+        if (strcmp(element, names[i]) == 0)
+        {
+            variable->type = (variable_type)i;
+            variable->start = find_attribute(attributes, n_attributes, "start");
+            const char *derivative = find_attribute(attributes, n_attributes, "derivative");
+            // The index in the xml is 1-based
+            unsigned long state = derivative != NULL ? strtoul(derivative, NULL, 10) : 0;
+            variable->derivative_of = state > 0 ? state - 1 : SIZE_MAX;
+            return;
+        }
+    }
+}
+
+static void parse_derivative(parser_context *context, const xml_attribute attributes[], int n_attributes)
+{
+    model_description *description = context->description;
+    size_t n = description->number_of_continuous_states;
+    const char *index = find_attribute(attributes, n_attributes, "index");
+    const char *dependencies = find_attribute(attributes, n_attributes, "dependencies");
+    if (index == NULL ||
+        !reserve_one((void **)&description->derivative_indices, &context->derivatives_capacity, n, sizeof(size_t)) ||
+        !reserve_one((void **)&description->derivative_dependencies_defined, &context->dependencies_defined_capacity, n, sizeof(fmi2Boolean)) ||
+        !reserve_one((void **)&description->derivative_dependency_offsets, &context->dependency_offsets_capacity, n + 1, sizeof(size_t)))
+    {
+        context->failed = true;
+        return;
+    }
+    // The indices in the xml are 1-based
+    description->derivative_indices[n] = strtoul(index, NULL, 10) - 1;
+    description->derivative_dependencies_defined[n] = dependencies != NULL;
+    if (n == 0)
+    {
+        description->derivative_dependency_offsets[0] = 0;
+    }
+    size_t count = description->derivative_dependency_offsets[n];
+    const char *text = dependencies;
+    while (text != NULL)
+    {
+        char *end;
+        unsigned long dependency = strtoul(text, &end, 10);
+        if (end == text)
+        {
+            break;
+        }
+        if (!reserve_one((void **)&description->derivative_dependencies, &context->dependencies_capacity, count, sizeof(size_t)))
+        {
+            context->failed = true;
+            return;
+        }
+        description->derivative_dependencies[count++] = dependency - 1;
+        text = end;
+    }
+    description->derivative_dependency_offsets[n + 1] = count;
+    description->number_of_continuous_states++;
+}
+
+/*! Interpret the element depending on its position in the document. */
+static void start_element(parser_context *context, const char *element, const xml_attribute attributes[], int n_attributes)
+{
+    model_description *description = context->description;
+    int depth = context->depth;
+    if (depth < MAX_XML_DEPTH)
+    {
+        context->path[depth] = element;
+    }
+    context->depth++;
+    if (depth == 0)
+    {
+        if (strcmp(element, "fmiModelDescription") != 0)
+        {
+            context->failed = true;
+            return;
+        }
+        description->fmi_version = find_attribute(attributes, n_attributes, "fmiVersion");
+        description->model_name = find_attribute(attributes, n_attributes, "modelName");
+        description->guid = find_attribute(attributes, n_attributes, "guid");
+        description->description = find_attribute(attributes, n_attributes, "description");
+        const char *event_indicators = find_attribute(attributes, n_attributes, "numberOfEventIndicators");
+        description->number_of_event_indicators = event_indicators != NULL ? strtoul(event_indicators, NULL, 10) : 0;
+    }
+    else if (depth == 1 && strcmp(element, "CoSimulation") == 0)
+    {
+        parse_interface(&description->co_simulation, attributes, n_attributes);
+    }
+    else if (depth == 1 && strcmp(element, "ModelExchange") == 0)
+    {
+        parse_interface(&description->model_exchange, attributes, n_attributes);
+    }
+    else if (depth == 1 && strcmp(element, "DefaultExperiment") == 0)
+    {
+        parse_default_experiment(&description->default_experiment, attributes, n_attributes);
+    }
+    else if (depth == 2 && is_element(context, 1, "ModelVariables") && strcmp(element, "ScalarVariable") == 0)
+    {
+        parse_scalar_variable(context, attributes, n_attributes);
+    }
+    else if (depth == 3 && is_element(context, 1, "ModelVariables") && is_element(context, 2, "ScalarVariable"))
+    {
+        parse_variable_type(context, element, attributes, n_attributes);
+    }
+    else if (depth == 3 && is_element(context, 1, "ModelStructure") && is_element(context, 2, "Derivatives") && strcmp(element, "Unknown") == 0)
+    {
+        parse_derivative(context, attributes, n_attributes);
+    }
+}
+
+static void end_element(parser_context *context)
+{
+    if (context->depth > 0)
+    {
+        context->depth--;
+    }
+}
+
+/*!
+    Skip to the end of the markup.
+    \return The position after the terminator or NULL if it is missing.
+*/
+static char *skip_past(char *text, const char *terminator)
+{
+    char *end = strstr(text, terminator);
+    return end != NULL ? end + strlen(terminator) : NULL;
+}
+
+/*!
+    Parse the start tag at text, which points to the char after '<'.
+    The names and values are terminated in place.
+    \return The position after the tag or NULL if the tag is malformed.
+*/
+static char *parse_start_tag(parser_context *context, char *text)
+{
+    xml_attribute attributes[MAX_XML_ATTRIBUTES];
+    int n_attributes = 0;
+    char *element = text;
+    while (*text != '\0' && !is_whitespace(*text) && *text != '/' && *text != '>')
+    {
+        text++;
+    }
+    // Terminate the names after parsing the chars that follow them
+    char *element_end = text;
+    bool self_closing = false;
+    for (;;)
+    {
+        text = skip_whitespace(text);
+        if (*text == '>')
+        {
+            text++;
+            break;
+        }
+        if (*text == '/' && text[1] == '>')
+        {
+            self_closing = true;
+            text += 2;
+            break;
+        }
+        char *name = text;
+        while (*text != '\0' && !is_whitespace(*text) && *text != '=' && *text != '>' && *text != '/')
+        {
+            text++;
+        }
+        char *name_end = text;
+        text = skip_whitespace(text);
+        if (*text != '=' || name == name_end)
+        {
+            return NULL;
+        }
+        text = skip_whitespace(text + 1);
+        char quote = *text;
+        if (quote != '"' && quote != '\'')
+        {
+            return NULL;
+        }
+        char *value = text + 1;
+        char *value_end = strchr(value, quote);
+        if (value_end == NULL)
+        {
+            return NULL;
+        }
+        *name_end = '\0';
+        *value_end = '\0';
+        decode_entities(value);
+        if (n_attributes < MAX_XML_ATTRIBUTES)
+        {
+            attributes[n_attributes].name = name;
+            attributes[n_attributes].value = value;
+            n_attributes++;
+        }
+        text = value_end + 1;
+    }
+    *element_end = '\0';
+    start_element(context, element, attributes, n_attributes);
+    if (self_closing)
+    {
+        end_element(context);
+    }
+    return text;
+}
+
+/*! Walk through the elements of the document, ignoring text content. */
+static bool parse_document(parser_context *context, char *text)
+{
+    while (text != NULL && !context->failed)
+    {
+        text = strchr(text, '<');
+        if (text == NULL)
+        {
+            break;
+        }
+        if (strncmp(text, "<?", 2) == 0)
+        {
+            text = skip_past(text, "?>");
+        }
+        else if (strncmp(text, "<!--", 4) == 0)
+        {
+            text = skip_past(text, "-->");
+        }
+        else if (strncmp(text, "<![CDATA[", 9) == 0)
+        {
+            text = skip_past(text, "]]>");
+        }
+        else if (text[1] == '!')
+        {
+            text = skip_past(text, ">");
+        }
+        else if (text[1] == '/')
+        {
+            // An unterminated end tag must not close the element
+            text = skip_past(text, ">");
+            if (text == NULL)
+            {
+                return false;
+            }
+            end_element(context);
+        }
+        else
+        {
+            text = parse_start_tag(context, text + 1);
+            if (text == NULL)
+            {
+                return false;
+            }
+        }
+    }
+    return !context->failed && context->depth == 0;
+}
+
+/*!
+    Parse the zero terminated xml text. The strings are terminated in place.
+    \param xml Allocated with malloc, the model description takes ownership even if parsing fails.
+*/
+static model_description *parse_owned_text(char *xml)
+{
+    model_description *description = calloc(1, sizeof(model_description));
+    if (description == NULL)
+    {
+        free(xml);
+        return NULL;
+    }
+    description->xml = xml;
+    parser_context context = {0};
+    context.description = description;
+    if (!parse_document(&context, description->xml) || description->guid == NULL)
+    {
+        free_model_description(description);
+        return NULL;
+    }
+    // Reject indices that do not refer to a variable
+    bool valid = true;
+    for (size_t i = 0; i < description->number_of_continuous_states; i++)
+    {
+        valid = valid && description->derivative_indices[i] < description->n_variables;
+    }
+    size_t n_dependencies = description->number_of_continuous_states > 0 ? description->derivative_dependency_offsets[description->number_of_continuous_states] : 0;
+    for (size_t i = 0; i < n_dependencies; i++)
+    {
+        valid = valid && description->derivative_dependencies[i] < description->n_variables;
+    }
+    for (size_t i = 0; i < description->n_variables; i++)
+    {
+        size_t state = description->variables[i].derivative_of;
+        valid = valid && (state == SIZE_MAX || state < description->n_variables);
+    }
+    if (!valid)
+    {
+        free_model_description(description);
+        return NULL;
+    }
+    return description;
+}
+
+PUBLIC_EXPORT model_description *parse_model_description(const char *xml, size_t size)
+{
+    char *text = malloc(size + 1);
+    if (text == NULL)
+    {
+        return NULL;
+    }
+    memcpy(text, xml, size);
+    text[size] = '\0';
+    return parse_owned_text(text);
+}
+
+PUBLIC_EXPORT model_description *load_model_description(const char *file_name)
+{
+    FILE *file = fopen(file_name, "rb");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+    char *text = NULL;
+    long size = -1;
+    if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) >= 0 && fseek(file, 0, SEEK_SET) == 0)
+    {
+        text = malloc((size_t)size + 1);
+        if (text != NULL && fread(text, 1, (size_t)size, file) != (size_t)size)
+        {
+            free(text);
+            text = NULL;
+        }
+    }
+    fclose(file);
+    if (text == NULL)
+    {
+        return NULL;
+    }
+    text[size] = '\0';
+    return parse_owned_text(text);
+}
+
+PUBLIC_EXPORT void free_model_description(model_description *description)
+{
+    if (description == NULL)
+    {
+        return;
+    }
+    free(description->variables);
+    free(description->derivative_indices);
+    free(description->derivative_dependencies_defined);
+    free(description->derivative_dependency_offsets);
+    free(description->derivative_dependencies);
+    free(description->xml);
+    free(description);
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include "fmi_wrapper.h"
+
+/*!
+    \brief Native representation of the modelDescription.xml of a fmu.
+    All strings point into memory owned by the model_description and stay valid until free_model_description.
+*/
+
+/*! The type element of a scalar variable. */
+typedef enum variable_type
+{
+    variable_real,
+    variable_integer,
+    variable_boolean,
+    variable_string,
+    variable_enumeration
+} variable_type;
+
+/*! The causality attribute of a scalar variable. */
+typedef enum variable_causality
+{
+    causality_parameter,
+    causality_calculated_parameter,
+    causality_input,
+    causality_output,
+    causality_local,
+    causality_independent
+} variable_causality;
+
+/*! The variability attribute of a scalar variable. */
+typedef enum variable_variability
+{
+    variability_constant,
+    variability_fixed,
+    variability_tunable,
+    variability_discrete,
+    variability_continuous
+} variable_variability;
+
+/*! A ScalarVariable element. */
+typedef struct model_variable
+{
+    fmi2String name;
+    fmi2ValueReference value_reference;
+    variable_type type;
+    variable_causality causality;
+    variable_variability variability;
+    /*! NULL if the attribute is missing. */
+    fmi2String description;
+    /*! The start attribute of the type element as text. NULL if the attribute is missing. */
+    fmi2String start;
+    /*! For the derivative of a state the index into variables of the state, SIZE_MAX otherwise. */
+    size_t derivative_of;
+} model_variable;
+
+/*! The attributes of the CoSimulation or ModelExchange element. */
+typedef struct fmu_interface
+{
+    /*! False if the fmu does not provide this interface. */
+    fmi2Boolean available;
+    fmi2String model_identifier;
+    fmi2Boolean needs_execution_tool;
+    fmi2Boolean can_be_instantiated_only_once_per_process;
+    fmi2Boolean can_not_use_memory_management_functions;
+    fmi2Boolean can_get_and_set_fmu_state;
+    fmi2Boolean can_serialize_fmu_state;
+    fmi2Boolean provides_directional_derivative;
+    /*! Co-Simulation only. */
+    fmi2Boolean can_handle_variable_communication_step_size;
+    /*! Model Exchange only. */
+    fmi2Boolean completed_integrator_step_not_needed;
+} fmu_interface;
+
+/*! The DefaultExperiment element. Only the values with the defined flag set are present in the xml. */
+typedef struct default_experiment
+{
+    fmi2Boolean start_time_defined;
+    fmi2Real start_time;
+    fmi2Boolean stop_time_defined;
+    fmi2Real stop_time;
+    fmi2Boolean tolerance_defined;
+    fmi2Real tolerance;
+    fmi2Boolean step_size_defined;
+    fmi2Real step_size;
+} default_experiment;
+
+typedef struct model_description
+{
+    fmi2String fmi_version;
+    fmi2String model_name;
+    fmi2String guid;
+    /*! NULL if the attribute is missing. */
+    fmi2String description;
+    size_t number_of_event_indicators;
+    fmu_interface co_simulation;
+    fmu_interface model_exchange;
+    default_experiment default_experiment;
+    /*! The ModelVariables in the order of the xml. */
+    size_t n_variables;
+    model_variable *variables;
+    /*! The number of ModelStructure/Derivatives elements. */
+    size_t number_of_continuous_states;
+    /*! For each continuous state the index into variables of its derivative. */
+    size_t *derivative_indices;
+    /*! For each continuous state whether its derivative lists the dependencies. Without the list it depends on all variables. */
+    fmi2Boolean *derivative_dependencies_defined;
+    /*! The dependencies of derivative i are [derivative_dependency_offsets[i], derivative_dependency_offsets[i + 1]). */
+    size_t *derivative_dependency_offsets;
+    /*! The indices into variables that the derivatives depend on. */
+    size_t *derivative_dependencies;
+    /*! The xml text that owns the strings. */
+    char *xml;
+} model_description;
+
+/*!
+    \brief Parse a modelDescription.xml file.
+    \return NULL if the file could not be read or is not a valid model description.
+*/
+PUBLIC_EXPORT model_description *load_model_description(const char *file_name);
+/*!
+    \brief Parse a model description from memory.
+    \param xml The xml text, it is copied.
+    \param size The number of chars of the text.
+    \return NULL if the text is not a valid model description.
+*/
+PUBLIC_EXPORT model_description *parse_model_description(const char *xml, size_t size);
+/*! \brief Releases the model description and all of its strings. */
+PUBLIC_EXPORT void free_model_description(model_description *description);
@@ -0,0 +1,162 @@
+#include "output_watch.h"
+#include <math.h>
+#include <stdlib.h>
+
+struct output_watch
+{
+    signal_group *signals;
+    size_t n_real;
+    size_t n_integer;
+    size_t n_boolean;
+    size_t n_signals;
+    /*! The values of the last read, reals first, then the converted integers and booleans. */
+    fmi2Real *values;
+    fmi2Real *reported;
+    fmi2Real *absolute_deadbands;
+    fmi2Real *relative_deadbands;
+    fmi2Integer *integer_values;
+    fmi2Boolean *boolean_values;
+    /*! 1.0 for each signal that changed in the last read, a double keeps the compare loop at one lane width. */
+    fmi2Real *changed;
+    /*! False until the first read after creating or resetting the watch. */
+    bool primed;
+};
+
+PUBLIC_EXPORT output_watch *create_output_watch(size_t n_real, const fmi2ValueReference real_vr[], size_t n_integer, const fmi2ValueReference integer_vr[],
+                                                size_t n_boolean, const fmi2ValueReference boolean_vr[],
+                                                const fmi2Real absolute_deadbands[], const fmi2Real relative_deadbands[])
+{
+    output_watch *watch = calloc(1, sizeof(output_watch));
+    if (watch == NULL)
+    {
+        return NULL;
+    }
+    watch->n_real = n_real;
+    watch->n_integer = n_integer;
+    watch->n_boolean = n_boolean;
+    watch->n_signals = n_real + n_integer + n_boolean;
+    // Allocate at least one element so NULL always means out of memory
+    size_t n = watch->n_signals + 1;
+    watch->signals = create_signal_group(n_real, real_vr, n_integer, integer_vr, n_boolean, boolean_vr);
+    watch->values = calloc(n, sizeof(fmi2Real));
+    watch->reported = calloc(n, sizeof(fmi2Real));
+    watch->absolute_deadbands = calloc(n, sizeof(fmi2Real));
+    watch->relative_deadbands = calloc(n, sizeof(fmi2Real));
+    watch->integer_values = calloc(n_integer + 1, sizeof(fmi2Integer));
+    watch->boolean_values = calloc(n_boolean + 1, sizeof(fmi2Boolean));
+    watch->changed = calloc(n, sizeof(fmi2Real));
+    bool valid = watch->signals != NULL && watch->values != NULL && watch->reported != NULL && watch->absolute_deadbands != NULL &&
+                 watch->relative_deadbands != NULL && watch->integer_values != NULL && watch->boolean_values != NULL && watch->changed != NULL;
+    for (size_t i = 0; i < watch->n_signals && valid; i++)
+    {
+        watch->absolute_deadbands[i] = absolute_deadbands != NULL ? absolute_deadbands[i] : 0.0;
+        watch->relative_deadbands[i] = relative_deadbands != NULL ? relative_deadbands[i] : 0.0;
+        // Also rejects NaN
+        valid = watch->absolute_deadbands[i] >= 0.0 && watch->relative_deadbands[i] >= 0.0;
+    }
+    if (!valid)
+    {
+        free_output_watch(watch);
+        return NULL;
+    }
+    return watch;
+}
+
+PUBLIC_EXPORT void free_output_watch(output_watch *watch)
+{
+    if (watch == NULL)
+    {
+        return;
+    }
+    free_signal_group(watch->signals);
+    free(watch->values);
+    free(watch->reported);
+    free(watch->absolute_deadbands);
+    free(watch->relative_deadbands);
+    free(watch->integer_values);
+    free(watch->boolean_values);
+    free(watch->changed);
+    free(watch);
+}
+
+PUBLIC_EXPORT size_t get_output_watch_size(const output_watch *watch)
+{
+    return watch->n_signals;
+}
+
+PUBLIC_EXPORT void reset_output_watch(output_watch *watch)
+{
+    watch->primed = false;
+}
+
+/*!
+    Flag the values that left their deadband and take them as reported values.
+    Free of branches, so the compiler can vectorize it.
+*/
+static void compare_values(output_watch *watch)
+{
+    const fmi2Real *values = watch->values;
+    fmi2Real *reported = watch->reported;
+    const fmi2Real *absolute_deadbands = watch->absolute_deadbands;
+    const fmi2Real *relative_deadbands = watch->relative_deadbands;
+    fmi2Real *changed = watch->changed;
+    size_t n = watch->n_signals;
+    for (size_t i = 0; i < n; i++)
+    {
+        fmi2Real value = values[i];
+        fmi2Real previous = reported[i];
+        fmi2Real difference = fabs(value - previous);
+        fmi2Real relative = relative_deadbands[i] * fabs(previous);
+        fmi2Real deadband = absolute_deadbands[i] > relative ? absolute_deadbands[i] : relative;
+        // Equal values are unchanged before the deadband test, infinity minus infinity is NaN.
+        // Written to also flag changes from and to NaN, but not a NaN that stays NaN
+        int is_changed = (value != previous) & !(difference <= deadband) & !((value != value) & (previous != previous));
+        changed[i] = is_changed ? 1.0 : 0.0;
+        reported[i] = is_changed ? value : previous;
+    }
+}
+
+PUBLIC_EXPORT fmi2Status get_changed_outputs(wrapped_fmu *wrapper, output_watch *watch, size_t indices[], fmi2Real values[], size_t *n_changes)
+{
+    *n_changes = 0;
+    fmi2Status status = group_get(wrapper, watch->signals, watch->values, watch->integer_values, watch->boolean_values);
+    if (status != fmi2OK && status != fmi2Warning)
+    {
+        return status;
+    }
+    fmi2Real *integers = watch->values + watch->n_real;
+    for (size_t i = 0; i < watch->n_integer; i++)
+    {
+        integers[i] = watch->integer_values[i];
+    }
+    fmi2Real *booleans = integers + watch->n_integer;
+    for (size_t i = 0; i < watch->n_boolean; i++)
+    {
+        booleans[i] = watch->boolean_values[i] ? 1.0 : 0.0;
+    }
+    size_t n = 0;
+    if (!watch->primed)
+    {
+        for (size_t i = 0; i < watch->n_signals; i++)
+        {
+            watch->reported[i] = watch->values[i];
+            indices[i] = i;
+            values[i] = watch->values[i];
+        }
+        n = watch->n_signals;
+        watch->primed = true;
+    }
+    else
+    {
+        compare_values(watch);
+        // Compact without branches: every slot is written, only the changes advance the position
+        for (size_t i = 0; i < watch->n_signals; i++)
+        {
+            indices[n] = i;
+            values[n] = watch->values[i];
+            n += (size_t)watch->changed[i];
+        }
+    }
+    *n_changes = n;
+    return status;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "fmi_wrapper.h"
+
+/*!
+    \brief Report only the outputs that changed beyond their deadband, e.g. to forward the results of a step.
+    A watch keeps the last reported value of each signal. The signals are read with one batched call per type, the
+    comparison runs over a contiguous block of doubles and the changes are returned as compact list of
+    (index, value) pairs. Like a signal_group a watch is not bound to an instance, but it must only be used with
+    one instance at a time since it keeps the reported values.
+*/
+
+typedef struct output_watch output_watch;
+
+/*!
+    \brief Register the signals and their deadbands. The signals are indexed in the order reals, integers, booleans.
+    A signal is reported if it differs from its last reported value r by more than
+    max(absolute_deadband, relative_deadband * |r|). Integers and booleans are reported as doubles.
+    \param absolute_deadbands One per signal. May be NULL to report every change.
+    \param relative_deadbands One per signal. May be NULL.
+    \return NULL if a deadband is negative or the memory could not be allocated.
+*/
+PUBLIC_EXPORT output_watch *create_output_watch(size_t n_real, const fmi2ValueReference real_vr[], size_t n_integer, const fmi2ValueReference integer_vr[],
+                                                size_t n_boolean, const fmi2ValueReference boolean_vr[],
+                                                const fmi2Real absolute_deadbands[], const fmi2Real relative_deadbands[]);
+PUBLIC_EXPORT void free_output_watch(output_watch *watch);
+/*! \brief The number of watched signals, the capacity that the arrays of get_changed_outputs need. */
+PUBLIC_EXPORT size_t get_output_watch_size(const output_watch *watch);
+/*! \brief Report all signals on the next call of get_changed_outputs, e.g. for a new consumer. */
+PUBLIC_EXPORT void reset_output_watch(output_watch *watch);
+/*!
+    \brief Read the signals and get the ones that changed beyond their deadband since they were reported last.
+    The first call after creating or resetting the watch reports all signals.
+    \param indices Receives the indices of the changed signals in ascending order, needs room for all signals.
+    \param values Receives the new values of the changed signals, needs room for all signals.
+    \param n_changes Receives the number of changed signals.
+    \return The status of reading the signals, nothing is reported if it is worse than fmi2Warning.
+*/
+PUBLIC_EXPORT fmi2Status get_changed_outputs(wrapped_fmu *wrapper, output_watch *watch, size_t indices[], fmi2Real values[], size_t *n_changes);
@@ -0,0 +1,131 @@
+#include "realtime_driver.h"
+#include "call_statistics.h"
+#include "system_functions.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct realtime_driver
+{
+    wrapped_fmu *wrapper;
+    fmi2Real start_time;
+    fmi2Real step_size;
+    uint64_t period_ns;
+    /*! The monotonic time at which the first step started, valid once n_steps > 0. */
+    uint64_t schedule_start_ns;
+    size_t n_steps;
+    bool memory_locked;
+    /*! Guards the statistics, which may be read by another thread. */
+    system_mutex mutex;
+    realtime_statistics statistics;
+};
+
+PUBLIC_EXPORT realtime_driver *create_realtime_driver(wrapped_fmu *wrapper, fmi2Real start_time, fmi2Real step_size,
+                                                      const realtime_options *options, fmi2Status *setup_status)
+{
+    if (setup_status != NULL)
+    {
+        *setup_status = fmi2OK;
+    }
+    // Also rejects NaN
+    if (!(step_size > 0.0))
+    {
+        return NULL;
+    }
+    realtime_driver *driver = calloc(1, sizeof(realtime_driver));
+    if (driver == NULL)
+    {
+        return NULL;
+    }
+    driver->wrapper = wrapper;
+    driver->start_time = start_time;
+    driver->step_size = step_size;
+    driver->period_ns = (uint64_t)(step_size * 1e9 + 0.5);
+    initMutex(&driver->mutex);
+    bool applied = true;
+    if (options != NULL && options->processor >= 0)
+    {
+        applied = pinThreadToProcessor((size_t)options->processor) == 0 && applied;
+    }
+    if (options != NULL && options->fifo_priority > 0)
+    {
+        applied = setRealtimePriority(options->fifo_priority) == 0 && applied;
+    }
+    if (options != NULL && options->lock_memory)
+    {
+        driver->memory_locked = lockProcessMemory() == 0;
+        applied = driver->memory_locked && applied;
+    }
+    if (!applied && setup_status != NULL)
+    {
+        *setup_status = fmi2Warning;
+    }
+    return driver;
+}
+
+PUBLIC_EXPORT void free_realtime_driver(realtime_driver *driver)
+{
+    if (driver->memory_locked)
+    {
+        unlockProcessMemory();
+    }
+    destroyMutex(&driver->mutex);
+    free(driver);
+}
+
+PUBLIC_EXPORT fmi2Status realtime_do_step(realtime_driver *driver)
+{
+    uint64_t now = getMonotonicTime();
+    if (driver->n_steps == 0)
+    {
+        driver->schedule_start_ns = now;
+    }
+    uint64_t due = driver->schedule_start_ns + driver->n_steps * driver->period_ns;
+    bool waited = now < due;
+    if (waited)
+    {
+        sleepUntil(due);
+    }
+    uint64_t begin = getMonotonicTime();
+    // Multiplied instead of accumulated, so rounding errors do not add up over long runs
+    fmi2Real time = driver->start_time + (fmi2Real)driver->n_steps * driver->step_size;
+    fmi2Status status = do_step(driver->wrapper, time, driver->step_size, fmi2True);
+    uint64_t end = getMonotonicTime();
+    uint64_t deadline = due + driver->period_ns;
+    lockMutex(&driver->mutex);
+    record_call(&driver->statistics.execution, end - begin);
+    if (waited)
+    {
+        record_call(&driver->statistics.wakeup, begin > due ? begin - due : 0);
+    }
+    if (end <= deadline)
+    {
+        record_call(&driver->statistics.slack, deadline - end);
+    }
+    else
+    {
+        driver->statistics.n_deadline_misses++;
+        record_call(&driver->statistics.lateness, end - deadline);
+    }
+    unlockMutex(&driver->mutex);
+    if (status == fmi2OK || status == fmi2Warning)
+    {
+        driver->n_steps++;
+    }
+    return status;
+}
+
+PUBLIC_EXPORT fmi2Real get_realtime_time(const realtime_driver *driver)
+{
+    return driver->start_time + (fmi2Real)driver->n_steps * driver->step_size;
+}
+
+PUBLIC_EXPORT void get_realtime_statistics(realtime_driver *driver, realtime_statistics *statistics, fmi2Boolean reset)
+{
+    lockMutex(&driver->mutex);
+    *statistics = driver->statistics;
+    if (reset)
+    {
+        memset(&driver->statistics, 0, sizeof(realtime_statistics));
+    }
+    unlockMutex(&driver->mutex);
+}
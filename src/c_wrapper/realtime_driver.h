@@ -0,0 +1,65 @@
+#pragma once
+#include "fmi_wrapper.h"
+
+/*!
+    \brief Pace the steps of a co-simulation against the wall clock, e.g. for hardware-in-the-loop runs.
+    Step k starts at the absolute monotonic time of the first step plus k periods and must finish before step k + 1
+    is due. After a deadline miss the following steps start immediately until they have caught up with the schedule,
+    so the simulation time does not drift from the wall clock.
+    The driver must be created and stepped on the same thread, the options apply to that thread.
+*/
+
+typedef struct realtime_driver realtime_driver;
+
+typedef struct realtime_options
+{
+    /*! Pin the stepping thread to this logical processor. -1 keeps the affinity. */
+    int processor;
+    /*! Schedule the stepping thread with SCHED_FIFO at this priority, usually 1 to 99. 0 keeps the scheduling policy. */
+    int fifo_priority;
+    /*! Lock the pages of the process into memory via mlockall until the driver is freed. Not supported on Windows. */
+    fmi2Boolean lock_memory;
+} realtime_options;
+
+/*!
+    The timing of the steps in nanoseconds. Each measure uses the histogram of the call statistics,
+    so get_latency_percentile applies to them as well.
+*/
+typedef struct realtime_statistics
+{
+    uint64_t n_deadline_misses;
+    /*! The duration of do_step, counted for every step. */
+    call_statistics execution;
+    /*! The time left until the deadline, counted for the steps that met it. */
+    call_statistics slack;
+    /*! The time past the deadline, counted for the steps that missed it. */
+    call_statistics lateness;
+    /*! How much later than scheduled the thread woke up, counted for the steps that had to wait. */
+    call_statistics wakeup;
+} realtime_statistics;
+
+/*!
+    \brief Create a driver for the instance and apply the options to the calling thread.
+    The thread keeps its affinity and scheduling policy after the driver is freed.
+    \param step_size The communication step size in seconds, which is also the period in wall clock time.
+    \param options May be NULL to use none.
+    \param setup_status Receives fmi2Warning if an option could not be applied, e.g. for lack of privileges. May be NULL.
+    \return NULL if the step size is not positive or the driver could not be allocated.
+*/
+PUBLIC_EXPORT realtime_driver *create_realtime_driver(wrapped_fmu *wrapper, fmi2Real start_time, fmi2Real step_size,
+                                                      const realtime_options *options, fmi2Status *setup_status);
+/*! \brief Free the driver and unlock the memory if it has been locked. The instance is not freed. */
+PUBLIC_EXPORT void free_realtime_driver(realtime_driver *driver);
+/*!
+    \brief Wait until the next step is due and perform it. The first call starts the schedule immediately.
+    Set the inputs and read the outputs between the calls, the time they take counts towards the next step.
+    \return The status of do_step. The schedule only advances if the step succeeded.
+*/
+PUBLIC_EXPORT fmi2Status realtime_do_step(realtime_driver *driver);
+/*! \brief The simulation time of the next step. */
+PUBLIC_EXPORT fmi2Real get_realtime_time(const realtime_driver *driver);
+/*!
+    \brief Copy the statistics. May be called from another thread than the stepping thread.
+    \param reset Start over after copying, so consecutive snapshots do not overlap.
+*/
+PUBLIC_EXPORT void get_realtime_statistics(realtime_driver *driver, realtime_statistics *statistics, fmi2Boolean reset);
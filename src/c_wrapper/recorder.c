@@ -0,0 +1,303 @@
+#include "recorder.h"
+#include "model_description.h"
+#include "system_functions.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_SAMPLES_PER_BLOCK 1024
+/*! The file grows by its size, but at most by this size, to limit the remapping of long recordings. */
+#define MAX_FILE_GROWTH ((size_t)1 << 30)
+/*! The largest xor encoded value: the tag byte and eight bytes. */
+#define MAX_ENCODED_SIZE 9
+
+struct recorder
+{
+    char *file_name;
+    system_mapped_file file;
+    /*! The end of the written blocks. */
+    size_t position;
+    size_t n_columns;
+    size_t decimation;
+    size_t samples_per_block;
+    bool compress;
+    signal_group *signals;
+    size_t n_real;
+    size_t n_integer;
+    size_t n_boolean;
+    fmi2Integer *integer_values;
+    fmi2Boolean *boolean_values;
+    /*! The samples of the block that is not written yet, one row per sample. */
+    double *rows;
+    size_t n_buffered;
+    /*! A column of the rows for encoding. */
+    double *column;
+    size_t n_steps;
+    bool failed;
+};
+
+static size_t align(size_t size)
+{
+    return (size + RECORDING_ALIGNMENT - 1) / RECORDING_ALIGNMENT * RECORDING_ALIGNMENT;
+}
+
+size_t get_recording_data_start(size_t n_columns)
+{
+    return align(sizeof(recording_header) + (n_columns - 1) * sizeof(recording_column));
+}
+
+/*!
+    Store each value as XOR with its predecessor: a tag byte with the number of trailing zero bytes in the upper and
+    the number of remaining bytes in the lower nibble, followed by the remaining bytes. Unchanged values take one byte.
+    \return The size of the encoded values, at most MAX_ENCODED_SIZE per value.
+*/
+static size_t xor_encode(const double values[], size_t n_values, uint8_t *data)
+{
+    uint64_t previous = 0;
+    size_t size = 0;
+    for (size_t i = 0; i < n_values; i++)
+    {
+        uint64_t bits;
+        memcpy(&bits, &values[i], sizeof(bits));
+        uint64_t difference = bits ^ previous;
+        previous = bits;
+        unsigned int n_trailing = 0;
+        unsigned int n_bytes = 0;
+        if (difference != 0)
+        {
+            while ((difference & 0xff) == 0)
+            {
+                difference >>= 8;
+                n_trailing++;
+            }
+            for (uint64_t rest = difference; rest != 0; rest >>= 8)
+            {
+                n_bytes++;
+            }
+        }
+        data[size++] = (uint8_t)(n_trailing << 4 | n_bytes);
+        for (unsigned int j = 0; j < n_bytes; j++)
+        {
+            data[size++] = (uint8_t)(difference >> (8 * j));
+        }
+    }
+    return size;
+}
+
+bool xor_decode(const uint8_t *data, size_t size, size_t n_values, double values[])
+{
+    uint64_t previous = 0;
+    size_t position = 0;
+    for (size_t i = 0; i < n_values; i++)
+    {
+        if (position >= size)
+        {
+            return false;
+        }
+        unsigned int n_trailing = data[position] >> 4;
+        unsigned int n_bytes = data[position] & 0x0f;
+        position++;
+        if (n_trailing + n_bytes > 8 || position + n_bytes > size)
+        {
+            return false;
+        }
+        uint64_t difference = 0;
+        for (unsigned int j = 0; j < n_bytes; j++)
+        {
+            difference |= (uint64_t)data[position++] << (8 * j);
+        }
+        previous ^= difference << (8 * n_trailing);
+        memcpy(&values[i], &previous, sizeof(previous));
+    }
+    return position == size;
+}
+
+/*! Grow the mapping so the bytes fit behind the written blocks. */
+static bool reserve(recorder *recorder, size_t size)
+{
+    size_t required = recorder->position + size;
+    if (recorder->file.data != NULL && required <= recorder->file.size)
+    {
+        return true;
+    }
+    size_t growth = recorder->file.size < MAX_FILE_GROWTH ? recorder->file.size : MAX_FILE_GROWTH;
+    size_t file_size = recorder->file.size + growth > required ? recorder->file.size + growth : required;
+    unmapFile(&recorder->file);
+    return mapFile(&recorder->file, recorder->file_name, file_size, true) != NULL;
+}
+
+/*! Write the buffered samples as block and publish it in the header. */
+static void write_block(recorder *recorder)
+{
+    size_t n = recorder->n_buffered;
+    recorder->n_buffered = 0;
+    if (n == 0)
+    {
+        return;
+    }
+    size_t table_size = align(recorder->n_columns * sizeof(recording_segment));
+    size_t segment_size = recorder->compress ? n * MAX_ENCODED_SIZE : n * sizeof(double);
+    if (!reserve(recorder, sizeof(recording_block) + table_size + recorder->n_columns * align(segment_size)))
+    {
+        recorder->failed = true;
+        return;
+    }
+    uint8_t *block = (uint8_t *)recorder->file.data + recorder->position;
+    recording_segment *segments = (recording_segment *)(block + sizeof(recording_block));
+    size_t offset = sizeof(recording_block) + table_size;
+    for (size_t c = 0; c < recorder->n_columns; c++)
+    {
+        for (size_t k = 0; k < n; k++)
+        {
+            recorder->column[k] = recorder->rows[k * recorder->n_columns + c];
+        }
+        segments[c].offset = offset;
+        segments[c].encoding = SEGMENT_XOR;
+        size_t size = recorder->compress ? xor_encode(recorder->column, n, block + offset) : SIZE_MAX;
+        // Keep the segment raw if it does not shrink, e.g. noise
+        if (size >= n * sizeof(double))
+        {
+            memcpy(block + offset, recorder->column, n * sizeof(double));
+            size = n * sizeof(double);
+            segments[c].encoding = SEGMENT_RAW;
+        }
+        segments[c].size = (uint32_t)size;
+        offset += align(size);
+    }
+    recording_block *header = (recording_block *)block;
+    header->magic = RECORDING_BLOCK_MAGIC;
+    header->n_samples = (uint32_t)n;
+    header->size = offset;
+    recorder->position += offset;
+    // Published after the block is complete
+    recording_header *file_header = recorder->file.data;
+    file_header->n_samples += n;
+    file_header->data_end = recorder->position;
+}
+
+recorder *create_recorder(const char *file_name, size_t n_real, const fmi2ValueReference real_vr[], size_t n_integer, const fmi2ValueReference integer_vr[],
+                          size_t n_boolean, const fmi2ValueReference boolean_vr[], const recorder_options *options)
+{
+    recorder *recorder = calloc(1, sizeof(struct recorder));
+    if (recorder == NULL)
+    {
+        return NULL;
+    }
+    recorder->n_real = n_real;
+    recorder->n_integer = n_integer;
+    recorder->n_boolean = n_boolean;
+    recorder->n_columns = 1 + n_real + n_integer + n_boolean;
+    recorder->decimation = options != NULL && options->decimation > 0 ? options->decimation : 1;
+    recorder->samples_per_block = options != NULL && options->samples_per_block > 0 ? options->samples_per_block : DEFAULT_SAMPLES_PER_BLOCK;
+    recorder->compress = options != NULL && options->compress;
+    recorder->file_name = malloc(strlen(file_name) + 1);
+    recorder->signals = create_signal_group(n_real, real_vr, n_integer, integer_vr, n_boolean, boolean_vr);
+    recorder->integer_values = calloc(n_integer + 1, sizeof(fmi2Integer));
+    recorder->boolean_values = calloc(n_boolean + 1, sizeof(fmi2Boolean));
+    recorder->rows = malloc(recorder->samples_per_block * recorder->n_columns * sizeof(double));
+    recorder->column = malloc(recorder->samples_per_block * sizeof(double));
+    if (recorder->file_name == NULL || recorder->signals == NULL || recorder->integer_values == NULL || recorder->boolean_values == NULL ||
+        recorder->rows == NULL || recorder->column == NULL || recorder->samples_per_block > UINT32_MAX / MAX_ENCODED_SIZE)
+    {
+        close_recorder(recorder);
+        return NULL;
+    }
+    strcpy(recorder->file_name, file_name);
+    // A writable mapping does not shrink an existing file
+    remove(file_name);
+    recorder->position = get_recording_data_start(recorder->n_columns);
+    // Room for the first block of raw samples
+    if (!reserve(recorder, sizeof(recording_block) + recorder->n_columns * (sizeof(recording_segment) + recorder->samples_per_block * sizeof(double))))
+    {
+        close_recorder(recorder);
+        return NULL;
+    }
+    recording_header *header = recorder->file.data;
+    memcpy(header->magic, RECORDING_MAGIC, sizeof(header->magic));
+    header->byte_order = RECORDING_BYTE_ORDER;
+    header->version = RECORDING_VERSION;
+    header->n_columns = (uint32_t)recorder->n_columns;
+    header->decimation = (uint32_t)recorder->decimation;
+    header->data_end = recorder->position;
+    header->n_samples = 0;
+    recording_column *columns = (recording_column *)(header + 1);
+    size_t c = 0;
+    for (size_t i = 0; i < n_real; i++, c++)
+    {
+        columns[c].vr = real_vr[i];
+        columns[c].type = variable_real;
+    }
+    for (size_t i = 0; i < n_integer; i++, c++)
+    {
+        columns[c].vr = integer_vr[i];
+        columns[c].type = variable_integer;
+    }
+    for (size_t i = 0; i < n_boolean; i++, c++)
+    {
+        columns[c].vr = boolean_vr[i];
+        columns[c].type = variable_boolean;
+    }
+    return recorder;
+}
+
+void record_step(recorder *recorder, wrapped_fmu *wrapper, fmi2Real time)
+{
+    if (++recorder->n_steps % recorder->decimation == 0)
+    {
+        record_sample(recorder, wrapper, time);
+    }
+}
+
+void record_sample(recorder *recorder, wrapped_fmu *wrapper, fmi2Real time)
+{
+    // The reals are read straight into the row, the other types are converted
+    double *row = recorder->rows + recorder->n_buffered * recorder->n_columns;
+    fmi2Status status = group_get(wrapper, recorder->signals, row + 1, recorder->integer_values, recorder->boolean_values);
+    if (status != fmi2OK && status != fmi2Warning)
+    {
+        recorder->failed = true;
+        return;
+    }
+    row[0] = time;
+    double *integers = row + 1 + recorder->n_real;
+    for (size_t i = 0; i < recorder->n_integer; i++)
+    {
+        integers[i] = recorder->integer_values[i];
+    }
+    double *booleans = integers + recorder->n_integer;
+    for (size_t i = 0; i < recorder->n_boolean; i++)
+    {
+        booleans[i] = recorder->boolean_values[i] ? 1.0 : 0.0;
+    }
+    if (++recorder->n_buffered == recorder->samples_per_block)
+    {
+        write_block(recorder);
+    }
+}
+
+fmi2Status close_recorder(recorder *recorder)
+{
+    fmi2Status status = fmi2OK;
+    if (recorder->file.data != NULL)
+    {
+        write_block(recorder);
+        unmapFile(&recorder->file);
+        // Cut off the space reserved for the next blocks
+        if (resizeFile(recorder->file_name, recorder->position) != 0)
+        {
+            status = fmi2Error;
+        }
+    }
+    if (recorder->failed)
+    {
+        status = fmi2Error;
+    }
+    free_signal_group(recorder->signals);
+    free(recorder->file_name);
+    free(recorder->integer_values);
+    free(recorder->boolean_values);
+    free(recorder->rows);
+    free(recorder->column);
+    free(recorder);
+    return status;
+}
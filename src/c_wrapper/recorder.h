@@ -0,0 +1,89 @@
+#pragma once
+#include "fmi_wrapper.h"
+#include <stdint.h>
+
+/*!
+    \brief Writing of result files, see start_recording, and their layout which is shared with the reader in recording.c.
+    The file consists of the header, the column table and the blocks. Each block holds a number of samples and stores
+    the samples of each column in its own segment, column 0 holds the times. The segments are either raw doubles or
+    compressed by xor_encode. All parts start at multiples of 8 bytes, so raw segments can be read in place.
+*/
+
+/*! Identifies result files. */
+#define RECORDING_MAGIC "FMIREC\0"
+/*! Increment when the layout of the file changes. */
+#define RECORDING_VERSION 1
+/*! Written in native byte order, files from platforms with another byte order are rejected. */
+#define RECORDING_BYTE_ORDER 0x01020304u
+/*! Marks the start of each block. */
+#define RECORDING_BLOCK_MAGIC 0x4b4c4252u
+#define RECORDING_ALIGNMENT 8
+
+/*! The encodings of the segments. */
+#define SEGMENT_RAW 0
+#define SEGMENT_XOR 1
+
+typedef struct recording_header
+{
+    char magic[8];
+    uint32_t byte_order;
+    uint32_t version;
+    /*! Including the time column. */
+    uint32_t n_columns;
+    uint32_t decimation;
+    /*! The end of the last complete block, updated after each block so the recording of a crashed process stays readable. */
+    uint64_t data_end;
+    uint64_t n_samples;
+} recording_header;
+
+/*! Describes a recorded signal, follows the header for each column except the time. */
+typedef struct recording_column
+{
+    uint32_t vr;
+    /*! The variable_type, integers and booleans are recorded as doubles as well. */
+    uint32_t type;
+} recording_column;
+
+/*! Followed by the segment table with an entry per column and the segments. */
+typedef struct recording_block
+{
+    uint32_t magic;
+    uint32_t n_samples;
+    /*! The size of the block including the header, the table and the padding of the segments. */
+    uint64_t size;
+} recording_block;
+
+typedef struct recording_segment
+{
+    /*! Relative to the start of the block. */
+    uint64_t offset;
+    /*! In bytes, excluding the padding. */
+    uint32_t size;
+    uint32_t encoding;
+} recording_segment;
+
+typedef struct recorder recorder;
+
+/*! The size of the part of the file before the first block. */
+size_t get_recording_data_start(size_t n_columns);
+/*!
+    Decode a segment compressed by the recorder.
+    \return false if the data is corrupt.
+*/
+bool xor_decode(const uint8_t *data, size_t size, size_t n_values, double values[]);
+
+/*!
+    Create the file, it is overwritten if it exists.
+    \return NULL if the file could not be created or the memory could not be allocated.
+*/
+recorder *create_recorder(const char *file_name, size_t n_real, const fmi2ValueReference real_vr[], size_t n_integer, const fmi2ValueReference integer_vr[],
+                          size_t n_boolean, const fmi2ValueReference boolean_vr[], const recorder_options *options);
+/*! Count a completed step and read the signals of the instance if the step is not skipped by the decimation. */
+void record_step(recorder *recorder, wrapped_fmu *wrapper, fmi2Real time);
+/*! Read the signals of the instance regardless of the decimation, e.g. the start values. */
+void record_sample(recorder *recorder, wrapped_fmu *wrapper, fmi2Real time);
+/*!
+    Write the remaining samples, truncate the file to its content and release the recorder.
+    \return fmi2Error if samples have been lost because reading the signals or writing the file failed.
+*/
+fmi2Status close_recorder(recorder *recorder);
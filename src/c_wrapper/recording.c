@@ -0,0 +1,219 @@
+#include "recording.h"
+#include "recorder.h"
+#include "system_functions.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct recording_block_info
+{
+    const recording_block *block;
+    size_t first_sample;
+} recording_block_info;
+
+struct recording
+{
+    system_mapped_file file;
+    const recording_header *header;
+    const recording_column *columns;
+    recording_block_info *blocks;
+    size_t n_blocks;
+    size_t n_samples;
+};
+
+static const recording_segment *get_segment(const recording_block *block, size_t column)
+{
+    return (const recording_segment *)(block + 1) + column;
+}
+
+/*! Check that the block and its segments lie within the data. */
+static bool is_valid_block(const recording *recording, size_t position, size_t end)
+{
+    const recording_block *block = (const recording_block *)((const uint8_t *)recording->file.data + position);
+    size_t n_columns = recording->header->n_columns;
+    if (end - position < sizeof(recording_block) || block->magic != RECORDING_BLOCK_MAGIC || block->size > end - position ||
+        block->size < sizeof(recording_block) + n_columns * sizeof(recording_segment) || block->size % RECORDING_ALIGNMENT != 0)
+    {
+        return false;
+    }
+    for (size_t c = 0; c < n_columns; c++)
+    {
+        const recording_segment *segment = get_segment(block, c);
+        size_t raw_size = (size_t)block->n_samples * sizeof(double);
+        if (segment->offset > block->size || segment->size > block->size - segment->offset || segment->offset % RECORDING_ALIGNMENT != 0 ||
+            (segment->encoding == SEGMENT_RAW && segment->size != raw_size) || segment->encoding > SEGMENT_XOR)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+PUBLIC_EXPORT recording *open_recording(const char *file_name)
+{
+    recording *recording = calloc(1, sizeof(struct recording));
+    if (recording == NULL)
+    {
+        return NULL;
+    }
+    const recording_header *header = mapFile(&recording->file, file_name, 0, false);
+    if (header == NULL || recording->file.size < sizeof(recording_header) || memcmp(header->magic, RECORDING_MAGIC, sizeof(header->magic)) != 0 ||
+        header->byte_order != RECORDING_BYTE_ORDER || header->version != RECORDING_VERSION || header->n_columns == 0 ||
+        header->data_end > recording->file.size || get_recording_data_start(header->n_columns) > header->data_end)
+    {
+        close_recording(recording);
+        return NULL;
+    }
+    recording->header = header;
+    recording->columns = (const recording_column *)(header + 1);
+    // Count the blocks first, the index is allocated once
+    size_t end = (size_t)header->data_end;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        size_t position = get_recording_data_start(header->n_columns);
+        size_t n_blocks = 0;
+        size_t n_samples = 0;
+        while (position < end && is_valid_block(recording, position, end))
+        {
+            const recording_block *block = (const recording_block *)((const uint8_t *)recording->file.data + position);
+            if (recording->blocks != NULL)
+            {
+                recording->blocks[n_blocks].block = block;
+                recording->blocks[n_blocks].first_sample = n_samples;
+            }
+            n_blocks++;
+            n_samples += block->n_samples;
+            position += (size_t)block->size;
+        }
+        if (pass == 0)
+        {
+            recording->blocks = malloc((n_blocks + 1) * sizeof(recording_block_info));
+            if (recording->blocks == NULL)
+            {
+                close_recording(recording);
+                return NULL;
+            }
+        }
+        recording->n_blocks = n_blocks;
+        recording->n_samples = n_samples;
+    }
+    return recording;
+}
+
+PUBLIC_EXPORT void close_recording(recording *recording)
+{
+    unmapFile(&recording->file);
+    free(recording->blocks);
+    free(recording);
+}
+
+PUBLIC_EXPORT size_t get_recording_column_count(const recording *recording)
+{
+    return recording->header->n_columns;
+}
+
+PUBLIC_EXPORT size_t get_recording_sample_count(const recording *recording)
+{
+    return recording->n_samples;
+}
+
+PUBLIC_EXPORT size_t get_recording_decimation(const recording *recording)
+{
+    return recording->header->decimation;
+}
+
+PUBLIC_EXPORT fmi2Status get_recording_signal(const recording *recording, size_t column, fmi2ValueReference *vr, variable_type *type)
+{
+    if (column == 0 || column >= recording->header->n_columns)
+    {
+        return fmi2Error;
+    }
+    *vr = recording->columns[column - 1].vr;
+    *type = (variable_type)recording->columns[column - 1].type;
+    return fmi2OK;
+}
+
+/*! Find the block that contains the sample by bisection. */
+static size_t find_block(const recording *recording, size_t sample)
+{
+    size_t low = 0;
+    size_t high = recording->n_blocks;
+    while (high - low > 1)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (recording->blocks[middle].first_sample <= sample)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+PUBLIC_EXPORT fmi2Status read_recording_column(const recording *recording, size_t column, size_t first_sample, size_t n_samples, fmi2Real values[])
+{
+    if (column >= recording->header->n_columns || first_sample > recording->n_samples || n_samples > recording->n_samples - first_sample)
+    {
+        return fmi2Error;
+    }
+    if (n_samples == 0)
+    {
+        return fmi2OK;
+    }
+    double *decoded = NULL;
+    size_t copied = 0;
+    for (size_t i = find_block(recording, first_sample); copied < n_samples; i++)
+    {
+        const recording_block *block = recording->blocks[i].block;
+        const recording_segment *segment = get_segment(block, column);
+        const double *samples = (const double *)((const uint8_t *)block + segment->offset);
+        if (segment->encoding == SEGMENT_XOR)
+        {
+            // The compressed segments are decoded as a whole
+            double *buffer = realloc(decoded, block->n_samples * sizeof(double));
+            if (buffer == NULL || !xor_decode((const uint8_t *)samples, segment->size, block->n_samples, buffer))
+            {
+                free(buffer != NULL ? buffer : decoded);
+                return fmi2Error;
+            }
+            decoded = buffer;
+            samples = decoded;
+        }
+        size_t begin = first_sample + copied - recording->blocks[i].first_sample;
+        size_t n = block->n_samples - begin < n_samples - copied ? block->n_samples - begin : n_samples - copied;
+        memcpy(values + copied, samples + begin, n * sizeof(double));
+        copied += n;
+    }
+    free(decoded);
+    return fmi2OK;
+}
+
+PUBLIC_EXPORT size_t get_recording_block_count(const recording *recording)
+{
+    return recording->n_blocks;
+}
+
+PUBLIC_EXPORT fmi2Status map_recording_column(const recording *recording, size_t block, size_t column, const fmi2Real **values,
+                                              size_t *n_samples, size_t *first_sample)
+{
+    if (block >= recording->n_blocks || column >= recording->header->n_columns)
+    {
+        return fmi2Error;
+    }
+    const recording_block *header = recording->blocks[block].block;
+    const recording_segment *segment = get_segment(header, column);
+    *n_samples = header->n_samples;
+    if (first_sample != NULL)
+    {
+        *first_sample = recording->blocks[block].first_sample;
+    }
+    if (segment->encoding != SEGMENT_RAW)
+    {
+        *values = NULL;
+        return fmi2Discard;
+    }
+    *values = (const fmi2Real *)((const uint8_t *)header + segment->offset);
+    return fmi2OK;
+}
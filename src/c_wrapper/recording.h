@@ -0,0 +1,45 @@
+#pragma once
+#include "fmi_wrapper.h"
+#include "model_description.h"
+
+/*!
+    \brief Read result files written by start_recording without parsing them.
+    The file is memory mapped and indexed by its blocks. Raw blocks of a column can be used in place via
+    map_recording_column, read_recording_column copies any range and decompresses it if necessary.
+    Column 0 holds the simulation times, the columns 1 to n the recorded signals.
+*/
+
+typedef struct recording recording;
+
+/*!
+    \brief Map the file and index its blocks. Samples written later are visible after opening the file again.
+    The file may be opened while it is recorded, it contains the blocks that have been written until then.
+    \return NULL if the file could not be mapped or has another version or byte order.
+*/
+PUBLIC_EXPORT recording *open_recording(const char *file_name);
+PUBLIC_EXPORT void close_recording(recording *recording);
+/*! \brief The number of columns including the time column. */
+PUBLIC_EXPORT size_t get_recording_column_count(const recording *recording);
+PUBLIC_EXPORT size_t get_recording_sample_count(const recording *recording);
+/*! \brief The number of steps per sample. */
+PUBLIC_EXPORT size_t get_recording_decimation(const recording *recording);
+/*!
+    \brief Get the value reference and type of a recorded signal.
+    \return fmi2Error for the time column and columns out of range.
+*/
+PUBLIC_EXPORT fmi2Status get_recording_signal(const recording *recording, size_t column, fmi2ValueReference *vr, variable_type *type);
+/*!
+    \brief Copy the samples first_sample to first_sample + n_samples - 1 of the column.
+    \return fmi2Error if the range is out of bounds or the file is corrupt.
+*/
+PUBLIC_EXPORT fmi2Status read_recording_column(const recording *recording, size_t column, size_t first_sample, size_t n_samples, fmi2Real values[]);
+/*! \brief The blocks are the units in which the samples are written and compressed. */
+PUBLIC_EXPORT size_t get_recording_block_count(const recording *recording);
+/*!
+    \brief Get the samples of a column in a block straight from the mapped file, they stay valid until close_recording.
+    \param first_sample Receives the index of the first sample of the block. May be NULL.
+    \return fmi2Discard if the column is compressed in this block, use read_recording_column then.
+    fmi2Error if the block or column is out of range.
+*/
+PUBLIC_EXPORT fmi2Status map_recording_column(const recording *recording, size_t block, size_t column, const fmi2Real **values,
+                                              size_t *n_samples, size_t *first_sample);
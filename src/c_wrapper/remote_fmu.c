@@ -0,0 +1,659 @@
+#include "remote_fmu.h"
+#include "host_protocol.h"
+#include "system_functions.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*! Check the liveness of the host in this interval while waiting for a response. */
+#define HOST_POLL_INTERVAL_MS 100
+
+struct remote_instance
+{
+    host_channel channel;
+    system_process host;
+    const fmi2CallbackFunctions *callbacks;
+    /*! Set if the host died or sent an invalid response, all further calls fail. */
+    bool failed;
+    /*! Set if the host process has exited and must not be killed anymore. */
+    bool host_exited;
+};
+
+/*! Makes the channel names of the instances of one process unique. */
+static volatile size_t channel_count = 0;
+
+/*! Forward a log message of the host to the callbacks of the instance. */
+static void forward_log(remote_instance *instance)
+{
+    host_message *message = instance->channel.callback;
+    const char *instance_name = get_string_buffer(message, HOST_CALLBACK_AREA_SIZE, 0);
+    const char *category = get_string_buffer(message, HOST_CALLBACK_AREA_SIZE, 1);
+    const char *text = get_string_buffer(message, HOST_CALLBACK_AREA_SIZE, 2);
+    if (instance->callbacks != NULL && instance->callbacks->logger != NULL && text != NULL)
+    {
+        instance->callbacks->logger(instance->callbacks->componentEnvironment, instance_name, (fmi2Status)message->arguments[0],
+                                    category, "%s", text);
+    }
+}
+
+/*!
+    Send the request and wait for the response, the log callbacks of the host are forwarded in between.
+    \return The status of the response or fmi2Fatal if the host is not running anymore.
+*/
+static fmi2Status call_host(remote_instance *instance)
+{
+    if (instance->failed)
+    {
+        return fmi2Fatal;
+    }
+    send_to_host(&instance->channel);
+    for (;;)
+    {
+        while (!wait_for_host(&instance->channel, HOST_POLL_INTERVAL_MS))
+        {
+            if (!isProcessRunning(instance->host))
+            {
+                instance->failed = true;
+                instance->host_exited = true;
+                return fmi2Fatal;
+            }
+        }
+        if (!instance->channel.header->is_callback)
+        {
+            break;
+        }
+        forward_log(instance);
+        // Acknowledge the callback so the host continues
+        send_to_host(&instance->channel);
+    }
+    host_message *response = instance->channel.response;
+    if (response->function != instance->channel.request->function || response->status < fmi2OK || response->status > fmi2Pending)
+    {
+        instance->failed = true;
+        return fmi2Fatal;
+    }
+    return (fmi2Status)response->status;
+}
+
+/*! Start a request in the request area of the instance. */
+static host_message *begin_request(remote_instance *instance, host_function function)
+{
+    host_message *request = instance->channel.request;
+    begin_message(request, function);
+    return request;
+}
+
+/*! Add an array to the request. \return false if the request area is too small. */
+static bool add_request_buffer(remote_instance *instance, const void *data, size_t size)
+{
+    return add_buffer(instance->channel.request, HOST_MESSAGE_AREA_SIZE, data, size) != NULL;
+}
+
+/*! Copy the array of the response into the values. */
+static fmi2Status copy_response_buffer(remote_instance *instance, fmi2Status status, uint32_t index, void *values, size_t size)
+{
+    if (status > fmi2Error)
+    {
+        return status;
+    }
+    size_t response_size;
+    const void *buffer = get_buffer(instance->channel.response, HOST_MESSAGE_AREA_SIZE, index, &response_size);
+    if (buffer == NULL || response_size != size)
+    {
+        return status > fmi2OK ? status : fmi2Error;
+    }
+    if (size > 0)
+    {
+        memcpy(values, buffer, size);
+    }
+    return status;
+}
+
+/*! Call a function without arguments. */
+static fmi2Status call_simple(fmi2Component c, host_function function)
+{
+    remote_instance *instance = c;
+    begin_request(instance, function);
+    return call_host(instance);
+}
+
+/*! Call a getter that sends the value references and receives the values. */
+static fmi2Status get_values(fmi2Component c, host_function function, const fmi2ValueReference vr[], size_t nvr, void *values, size_t value_size)
+{
+    remote_instance *instance = c;
+    begin_request(instance, function);
+    if (!add_request_buffer(instance, vr, nvr * sizeof(fmi2ValueReference)))
+    {
+        return fmi2Error;
+    }
+    return copy_response_buffer(instance, call_host(instance), 0, values, nvr * value_size);
+}
+
+/*! Call a setter that sends the value references and the values. */
+static fmi2Status set_values(fmi2Component c, host_function function, const fmi2ValueReference vr[], size_t nvr, const void *values, size_t value_size)
+{
+    remote_instance *instance = c;
+    begin_request(instance, function);
+    if (!add_request_buffer(instance, vr, nvr * sizeof(fmi2ValueReference)) || !add_request_buffer(instance, values, nvr * value_size))
+    {
+        return fmi2Error;
+    }
+    return call_host(instance);
+}
+
+/*! Call a function that receives an array of the model like the derivatives. */
+static fmi2Status get_model_values(fmi2Component c, host_function function, fmi2Real values[], size_t n)
+{
+    remote_instance *instance = c;
+    host_message *request = begin_request(instance, function);
+    request->arguments[0] = n;
+    return copy_response_buffer(instance, call_host(instance), 0, values, n * sizeof(fmi2Real));
+}
+
+/*! Send a list of strings as one buffer of concatenated null terminated strings. */
+static bool add_request_strings(remote_instance *instance, const fmi2String strings[], size_t n)
+{
+    size_t size = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        size += (strings[i] != NULL ? strlen(strings[i]) : 0) + 1;
+    }
+    char *buffer = add_buffer(instance->channel.request, HOST_MESSAGE_AREA_SIZE, NULL, size);
+    if (buffer == NULL)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        size_t length = strings[i] != NULL ? strlen(strings[i]) : 0;
+        memcpy(buffer, strings[i] != NULL ? strings[i] : "", length + 1);
+        buffer += length + 1;
+    }
+    return true;
+}
+
+/*! Create a unique channel and start the host process that opens it. */
+static remote_instance *start_host(const char *host_executable, char *name, size_t name_size)
+{
+    remote_instance *instance = calloc(1, sizeof(remote_instance));
+    if (instance == NULL)
+    {
+        return NULL;
+    }
+    char client_id[32];
+    snprintf(name, name_size, "fmi_wrapper_%lu_%lu", getProcessId(), (unsigned long)atomicIncrement(&channel_count));
+    snprintf(client_id, sizeof(client_id), "%lu", getProcessId());
+    if (!create_host_channel(&instance->channel, name))
+    {
+        free(instance);
+        return NULL;
+    }
+    const char *arguments[] = {name, client_id, NULL};
+    if (startProcess(&instance->host, host_executable, arguments) != 0)
+    {
+        unlink_host_channel(name);
+        close_host_channel(&instance->channel);
+        free(instance);
+        return NULL;
+    }
+    return instance;
+}
+
+remote_instance *instantiate_remote(const char *host_executable, const char *binary_path, fmi2String instance_name, fmi2Type fmu_type,
+                                    fmi2String guid, fmi2String resource_location, const fmi2CallbackFunctions *callbacks,
+                                    fmi2Boolean visible, fmi2Boolean logging_on)
+{
+    char name[64];
+    remote_instance *instance = start_host(host_executable, name, sizeof(name));
+    if (instance == NULL)
+    {
+        return NULL;
+    }
+    instance->callbacks = callbacks;
+    host_message *request = begin_request(instance, HOST_INSTANTIATE);
+    request->arguments[0] = (uint64_t)fmu_type;
+    request->arguments[1] = visible ? 1 : 0;
+    request->arguments[2] = logging_on ? 1 : 0;
+    bool added = add_string(request, HOST_MESSAGE_AREA_SIZE, binary_path) && add_string(request, HOST_MESSAGE_AREA_SIZE, instance_name) &&
+                 add_string(request, HOST_MESSAGE_AREA_SIZE, guid) && add_string(request, HOST_MESSAGE_AREA_SIZE, resource_location);
+    fmi2Status status = added ? call_host(instance) : fmi2Error;
+    // The host has opened the channel when it answers or died, so the name is not needed anymore
+    unlink_host_channel(name);
+    if (status > fmi2Warning)
+    {
+        remote_free_instance(instance);
+        return NULL;
+    }
+    return instance;
+}
+
+/* Inquire version numbers of header files */
+
+const char *remote_get_types_platform(void)
+{
+    return fmi2TypesPlatform;
+}
+
+const char *remote_get_version(void)
+{
+    return "2.0";
+}
+
+fmi2Status remote_set_debug_logging(fmi2Component c, fmi2Boolean logging_on, size_t n_categories, const fmi2String categories[])
+{
+    remote_instance *instance = c;
+    host_message *request = begin_request(instance, HOST_SET_DEBUG_LOGGING);
+    request->arguments[0] = logging_on ? 1 : 0;
+    request->arguments[1] = n_categories;
+    if (!add_request_strings(instance, categories, n_categories))
+    {
+        return fmi2Error;
+    }
+    return call_host(instance);
+}
+
+/* Destruction of FMU instances */
+
+void remote_free_instance(fmi2Component c)
+{
+    remote_instance *instance = c;
+    // The host exits after answering, do not wait for a host that is broken
+    if (call_simple(instance, HOST_FREE_INSTANCE) == fmi2Fatal && !instance->host_exited)
+    {
+        killProcess(instance->host);
+    }
+    waitForProcess(instance->host);
+    close_host_channel(&instance->channel);
+    free(instance);
+}
+
+/* Enter and exit initialization mode, terminate and reset */
+
+fmi2Status remote_setup_experiment(fmi2Component c, fmi2Boolean tolerance_defined, fmi2Real tolerance, fmi2Real start_time, fmi2Boolean stop_time_defined, fmi2Real stop_time)
+{
+    remote_instance *instance = c;
+    host_message *request = begin_request(instance, HOST_SETUP_EXPERIMENT);
+    request->arguments[0] = tolerance_defined ? 1 : 0;
+    request->arguments[1] = stop_time_defined ? 1 : 0;
+    request->real_arguments[0] = tolerance;
+    request->real_arguments[1] = start_time;
+    request->real_arguments[2] = stop_time;
+    return call_host(instance);
+}
+
+fmi2Status remote_enter_initialization_mode(fmi2Component c)
+{
+    return call_simple(c, HOST_ENTER_INITIALIZATION_MODE);
+}
+
+fmi2Status remote_exit_initialization_mode(fmi2Component c)
+{
+    return call_simple(c, HOST_EXIT_INITIALIZATION_MODE);
+}
+
+fmi2Status remote_terminate(fmi2Component c)
+{
+    return call_simple(c, HOST_TERMINATE);
+}
+
+fmi2Status remote_reset(fmi2Component c)
+{
+    return call_simple(c, HOST_RESET);
+}
+
+/* Getting and setting variables values */
+
+fmi2Status remote_get_real(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Real value[])
+{
+    return get_values(c, HOST_GET_REAL, vr, nvr, value, sizeof(fmi2Real));
+}
+
+fmi2Status remote_get_integer(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Integer value[])
+{
+    return get_values(c, HOST_GET_INTEGER, vr, nvr, value, sizeof(fmi2Integer));
+}
+
+fmi2Status remote_get_boolean(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Boolean value[])
+{
+    return get_values(c, HOST_GET_BOOLEAN, vr, nvr, value, sizeof(fmi2Boolean));
+}
+
+fmi2Status remote_get_string(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2String value[])
+{
+    remote_instance *instance = c;
+    begin_request(instance, HOST_GET_STRING);
+    if (!add_request_buffer(instance, vr, nvr * sizeof(fmi2ValueReference)))
+    {
+        return fmi2Error;
+    }
+    fmi2Status status = call_host(instance);
+    if (status > fmi2Error)
+    {
+        return status;
+    }
+    // The response contains the concatenated strings, point the values into the response area
+    size_t size;
+    const char *strings = get_buffer(instance->channel.response, HOST_MESSAGE_AREA_SIZE, 0, &size);
+    const char *end = strings != NULL ? strings + size : NULL;
+    for (size_t i = 0; i < nvr; i++)
+    {
+        const char *terminator = strings != NULL ? memchr(strings, '\0', (size_t)(end - strings)) : NULL;
+        if (terminator == NULL)
+        {
+            return status > fmi2OK ? status : fmi2Error;
+        }
+        value[i] = strings;
+        strings = terminator + 1;
+    }
+    return status;
+}
+
+fmi2Status remote_set_real(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Real value[])
+{
+    return set_values(c, HOST_SET_REAL, vr, nvr, value, sizeof(fmi2Real));
+}
+
+fmi2Status remote_set_integer(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Integer value[])
+{
+    return set_values(c, HOST_SET_INTEGER, vr, nvr, value, sizeof(fmi2Integer));
+}
+
+fmi2Status remote_set_boolean(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Boolean value[])
+{
+    return set_values(c, HOST_SET_BOOLEAN, vr, nvr, value, sizeof(fmi2Boolean));
+}
+
+fmi2Status remote_set_string(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2String value[])
+{
+    remote_instance *instance = c;
+    begin_request(instance, HOST_SET_STRING);
+    if (!add_request_buffer(instance, vr, nvr * sizeof(fmi2ValueReference)) || !add_request_strings(instance, value, nvr))
+    {
+        return fmi2Error;
+    }
+    return call_host(instance);
+}
+
+/* Getting and setting the internal FMU state */
+
+fmi2Status remote_get_fmu_state(fmi2Component c, fmi2FMUstate *fmu_state)
+{
+    remote_instance *instance = c;
+    host_message *request = begin_request(instance, HOST_GET_FMU_STATE);
+    // Update an existing state like the fmu would
+    request->arguments[0] = (uint64_t)(uintptr_t)*fmu_state;
+    fmi2Status status = call_host(instance);
+    if (status <= fmi2Warning)
+    {
+        *fmu_state = (fmi2FMUstate)(uintptr_t)instance->channel.response->arguments[0];
+    }
+    return status;
+}
+
+fmi2Status remote_set_fmu_state(fmi2Component c, fmi2FMUstate fmu_state)
+{
+    remote_instance *instance = c;
+    host_message *request = begin_request(instance, HOST_SET_FMU_STATE);
+    request->arguments[0] = (uint64_t)(uintptr_t)fmu_state;
+    return call_host(instance);
+}
+
+fmi2Status remote_free_fmu_state(fmi2Component c, fmi2FMUstate *fmu_state)
+{
+    remote_instance *instance = c;
+    host_message *request = begin_request(instance, HOST_FREE_FMU_STATE);
+    request->arguments[0] = (uint64_t)(uintptr_t)*fmu_state;
+    fmi2Status status = call_host(instance);
+    if (status <= fmi2Warning)
+    {
+        *fmu_state = NULL;
+    }
+    return status;
+}
+
+fmi2Status remote_serialized_fmu_state_size(fmi2Component c, fmi2FMUstate fmu_state, size_t *size)
+{
+    remote_instance *instance = c;
+    host_message *request = begin_request(instance, HOST_SERIALIZED_FMU_STATE_SIZE);
+    request->arguments[0] = (uint64_t)(uintptr_t)fmu_state;
+    fmi2Status status = call_host(instance);
+    if (status <= fmi2Warning)
+    {
+        *size = (size_t)instance->channel.response->arguments[0];
+    }
+    return status;
+}
+
+fmi2Status remote_serialize_fmu_state(fmi2Component c, fmi2FMUstate fmu_state, fmi2Byte serialized_state[], size_t size)
+{
+    remote_instance *instance = c;
+    host_message *request = begin_request(instance, HOST_SERIALIZE_FMU_STATE);
+    request->arguments[0] = (uint64_t)(uintptr_t)fmu_state;
+    request->arguments[1] = size;
+    return copy_response_buffer(instance, call_host(instance), 0, serialized_state, size);
+}
+
+fmi2Status remote_deserialize_fmu_state(fmi2Component c, const fmi2Byte serialized_state[], size_t size, fmi2FMUstate *fmu_state)
+{
+    remote_instance *instance = c;
+    host_message *request = begin_request(instance, HOST_DESERIALIZE_FMU_STATE);
+    request->arguments[0] = (uint64_t)(uintptr_t)*fmu_state;
+    if (!add_request_buffer(instance, serialized_state, size))
+    {
+        return fmi2Error;
+    }
+    fmi2Status status = call_host(instance);
+    if (status <= fmi2Warning)
+    {
+        *fmu_state = (fmi2FMUstate)(uintptr_t)instance->channel.response->arguments[0];
+    }
+    return status;
+}
+
+/* Getting partial derivatives */
+
+fmi2Status remote_get_directional_derivative(fmi2Component c, const fmi2ValueReference v_unknown_ref[], size_t n_unknown,
+                                             const fmi2ValueReference v_known_ref[], size_t n_known,
+                                             const fmi2Real dv_known[], fmi2Real dv_unknown[])
+{
+    remote_instance *instance = c;
+    begin_request(instance, HOST_GET_DIRECTIONAL_DERIVATIVE);
+    if (!add_request_buffer(instance, v_unknown_ref, n_unknown * sizeof(fmi2ValueReference)) ||
+        !add_request_buffer(instance, v_known_ref, n_known * sizeof(fmi2ValueReference)) ||
+        !add_request_buffer(instance, dv_known, n_known * sizeof(fmi2Real)))
+    {
+        return fmi2Error;
+    }
+    return copy_response_buffer(instance, call_host(instance), 0, dv_unknown, n_unknown * sizeof(fmi2Real));
+}
+
+/* Enter and exit the different modes */
+
+fmi2Status remote_enter_event_mode(fmi2Component c)
+{
+    return call_simple(c, HOST_ENTER_EVENT_MODE);
+}
+
+fmi2Status remote_new_discrete_states(fmi2Component c, fmi2EventInfo *event_info)
+{
+    remote_instance *instance = c;
+    begin_request(instance, HOST_NEW_DISCRETE_STATES);
+    fmi2Status status = call_host(instance);
+    if (status <= fmi2Error)
+    {
+        // The flags are packed into the bits of the first argument
+        const host_message *response = instance->channel.response;
+        event_info->newDiscreteStatesNeeded = (response->arguments[0] & 1) != 0;
+        event_info->terminateSimulation = (response->arguments[0] & 2) != 0;
+        event_info->nominalsOfContinuousStatesChanged = (response->arguments[0] & 4) != 0;
+        event_info->valuesOfContinuousStatesChanged = (response->arguments[0] & 8) != 0;
+        event_info->nextEventTimeDefined = (response->arguments[0] & 16) != 0;
+        event_info->nextEventTime = response->real_arguments[0];
+    }
+    return status;
+}
+
+fmi2Status remote_enter_continuous_time_mode(fmi2Component c)
+{
+    return call_simple(c, HOST_ENTER_CONTINUOUS_TIME_MODE);
+}
+
+fmi2Status remote_completed_integrator_step(fmi2Component c, fmi2Boolean no_set_fmu_state_prior_to_current_point, fmi2Boolean *enter_event_mode, fmi2Boolean *terminate_simulation)
+{
+    remote_instance *instance = c;
+    host_message *request = begin_request(instance, HOST_COMPLETED_INTEGRATOR_STEP);
+    request->arguments[0] = no_set_fmu_state_prior_to_current_point ? 1 : 0;
+    fmi2Status status = call_host(instance);
+    if (status <= fmi2Error)
+    {
+        *enter_event_mode = instance->channel.response->arguments[0] != 0;
+        *terminate_simulation = instance->channel.response->arguments[1] != 0;
+    }
+    return status;
+}
+
+/* Providing independent variables and re-initialization of caching */
+
+fmi2Status remote_set_time(fmi2Component c, fmi2Real time)
+{
+    remote_instance *instance = c;
+    host_message *request = begin_request(instance, HOST_SET_TIME);
+    request->real_arguments[0] = time;
+    return call_host(instance);
+}
+
+fmi2Status remote_set_continuous_states(fmi2Component c, const fmi2Real x[], size_t nx)
+{
+    remote_instance *instance = c;
+    begin_request(instance, HOST_SET_CONTINUOUS_STATES);
+    if (!add_request_buffer(instance, x, nx * sizeof(fmi2Real)))
+    {
+        return fmi2Error;
+    }
+    return call_host(instance);
+}
+
+/* Evaluation of the model equations */
+
+fmi2Status remote_get_derivatives(fmi2Component c, fmi2Real derivatives[], size_t nx)
+{
+    return get_model_values(c, HOST_GET_DERIVATIVES, derivatives, nx);
+}
+
+fmi2Status remote_get_event_indicators(fmi2Component c, fmi2Real event_indicators[], size_t ni)
+{
+    return get_model_values(c, HOST_GET_EVENT_INDICATORS, event_indicators, ni);
+}
+
+fmi2Status remote_get_continuous_states(fmi2Component c, fmi2Real x[], size_t nx)
+{
+    return get_model_values(c, HOST_GET_CONTINUOUS_STATES, x, nx);
+}
+
+fmi2Status remote_get_nominals_of_continuous_states(fmi2Component c, fmi2Real x_nominal[], size_t nx)
+{
+    return get_model_values(c, HOST_GET_NOMINALS_OF_CONTINUOUS_STATES, x_nominal, nx);
+}
+
+/* Simulating the slave */
+
+fmi2Status remote_set_real_input_derivatives(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Integer order[], const fmi2Real value[])
+{
+    remote_instance *instance = c;
+    begin_request(instance, HOST_SET_REAL_INPUT_DERIVATIVES);
+    if (!add_request_buffer(instance, vr, nvr * sizeof(fmi2ValueReference)) || !add_request_buffer(instance, order, nvr * sizeof(fmi2Integer)) ||
+        !add_request_buffer(instance, value, nvr * sizeof(fmi2Real)))
+    {
+        return fmi2Error;
+    }
+    return call_host(instance);
+}
+
+fmi2Status remote_get_real_output_derivatives(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Integer order[], fmi2Real value[])
+{
+    remote_instance *instance = c;
+    begin_request(instance, HOST_GET_REAL_OUTPUT_DERIVATIVES);
+    if (!add_request_buffer(instance, vr, nvr * sizeof(fmi2ValueReference)) || !add_request_buffer(instance, order, nvr * sizeof(fmi2Integer)))
+    {
+        return fmi2Error;
+    }
+    return copy_response_buffer(instance, call_host(instance), 0, value, nvr * sizeof(fmi2Real));
+}
+
+fmi2Status remote_do_step(fmi2Component c, fmi2Real current_communication_point, fmi2Real communication_step_size, fmi2Boolean no_set_fmu_state_prior_to_current_point)
+{
+    remote_instance *instance = c;
+    host_message *request = begin_request(instance, HOST_DO_STEP);
+    request->arguments[0] = no_set_fmu_state_prior_to_current_point ? 1 : 0;
+    request->real_arguments[0] = current_communication_point;
+    request->real_arguments[1] = communication_step_size;
+    return call_host(instance);
+}
+
+fmi2Status remote_cancel_step(fmi2Component c)
+{
+    return call_simple(c, HOST_CANCEL_STEP);
+}
+
+/* Inquire slave status */
+
+/*! Request a status value, the response carries it in its arguments. */
+static fmi2Status get_status_value(fmi2Component c, host_function function, fmi2StatusKind status_kind)
+{
+    remote_instance *instance = c;
+    host_message *request = begin_request(instance, function);
+    request->arguments[0] = (uint64_t)status_kind;
+    return call_host(instance);
+}
+
+fmi2Status remote_get_status(fmi2Component c, const fmi2StatusKind status_kind, fmi2Status *value)
+{
+    fmi2Status status = get_status_value(c, HOST_GET_STATUS, status_kind);
+    if (status == fmi2OK)
+    {
+        *value = (fmi2Status)((remote_instance *)c)->channel.response->arguments[0];
+    }
+    return status;
+}
+
+fmi2Status remote_get_real_status(fmi2Component c, const fmi2StatusKind status_kind, fmi2Real *value)
+{
+    fmi2Status status = get_status_value(c, HOST_GET_REAL_STATUS, status_kind);
+    if (status == fmi2OK)
+    {
+        *value = ((remote_instance *)c)->channel.response->real_arguments[0];
+    }
+    return status;
+}
+
+fmi2Status remote_get_integer_status(fmi2Component c, const fmi2StatusKind status_kind, fmi2Integer *value)
+{
+    fmi2Status status = get_status_value(c, HOST_GET_INTEGER_STATUS, status_kind);
+    if (status == fmi2OK)
+    {
+        *value = (fmi2Integer)(int64_t)((remote_instance *)c)->channel.response->arguments[0];
+    }
+    return status;
+}
+
+fmi2Status remote_get_boolean_status(fmi2Component c, const fmi2StatusKind status_kind, fmi2Boolean *value)
+{
+    fmi2Status status = get_status_value(c, HOST_GET_BOOLEAN_STATUS, status_kind);
+    if (status == fmi2OK)
+    {
+        *value = ((remote_instance *)c)->channel.response->arguments[0] != 0;
+    }
+    return status;
+}
+
+fmi2Status remote_get_string_status(fmi2Component c, const fmi2StatusKind status_kind, fmi2String *value)
+{
+    fmi2Status status = get_status_value(c, HOST_GET_STRING_STATUS, status_kind);
+    if (status == fmi2OK)
+    {
+        // Valid until the next call like the strings of get_string
+        *value = get_string_buffer(((remote_instance *)c)->channel.response, HOST_MESSAGE_AREA_SIZE, 0);
+    }
+    return status;
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include "fmi2FunctionTypes.h"
+
+/*!
+    \brief Proxies of the fmi2 functions that forward the calls to an fmi_wrapper_host process.
+    The component of the proxies is a remote_instance. Running the fmu in its own process isolates crashes and allows
+    binaries that can not be loaded into the calling process, e.g. a different architecture.
+    The host runs the fmu with the fmi_wrapper, the asynchronous doStep of co-simulation is not supported.
+*/
+
+typedef struct remote_instance remote_instance;
+
+/*!
+    \brief Start the host process and instantiate the binary in it.
+    \param host_executable The path of the fmi_wrapper_host executable.
+    \param binary_path The path of the fmu binary that the host loads.
+    \param callbacks The logger of the callbacks receives the log messages of the host. Must stay valid until remote_free_instance.
+    \return NULL if the host could not be started or the instantiation failed.
+*/
+remote_instance *instantiate_remote(const char *host_executable, const char *binary_path, fmi2String instance_name, fmi2Type fmu_type,
+                                    fmi2String guid, fmi2String resource_location, const fmi2CallbackFunctions *callbacks,
+                                    fmi2Boolean visible, fmi2Boolean logging_on);
+
+/* Inquire version numbers of header files, answered locally */
+fmi2GetTypesPlatformTYPE remote_get_types_platform;
+fmi2GetVersionTYPE remote_get_version;
+fmi2SetDebugLoggingTYPE remote_set_debug_logging;
+
+/* Destruction of FMU instances, see instantiate_remote for the creation */
+/*! Stops the host process. */
+fmi2FreeInstanceTYPE remote_free_instance;
+
+/* Enter and exit initialization mode, terminate and reset */
+fmi2SetupExperimentTYPE remote_setup_experiment;
+fmi2EnterInitializationModeTYPE remote_enter_initialization_mode;
+fmi2ExitInitializationModeTYPE remote_exit_initialization_mode;
+fmi2TerminateTYPE remote_terminate;
+fmi2ResetTYPE remote_reset;
+
+/* Getting and setting variables values */
+fmi2GetRealTYPE remote_get_real;
+fmi2GetIntegerTYPE remote_get_integer;
+fmi2GetBooleanTYPE remote_get_boolean;
+/*! The strings stay valid until the next call of the instance. */
+fmi2GetStringTYPE remote_get_string;
+
+fmi2SetRealTYPE remote_set_real;
+fmi2SetIntegerTYPE remote_set_integer;
+fmi2SetBooleanTYPE remote_set_boolean;
+fmi2SetStringTYPE remote_set_string;
+
+/* Getting and setting the internal FMU state, the states are handles of the host */
+fmi2GetFMUstateTYPE remote_get_fmu_state;
+fmi2SetFMUstateTYPE remote_set_fmu_state;
+fmi2FreeFMUstateTYPE remote_free_fmu_state;
+fmi2SerializedFMUstateSizeTYPE remote_serialized_fmu_state_size;
+fmi2SerializeFMUstateTYPE remote_serialize_fmu_state;
+fmi2DeSerializeFMUstateTYPE remote_deserialize_fmu_state;
+
+/* Getting partial derivatives */
+fmi2GetDirectionalDerivativeTYPE remote_get_directional_derivative;
+
+/* Enter and exit the different modes */
+fmi2EnterEventModeTYPE remote_enter_event_mode;
+fmi2NewDiscreteStatesTYPE remote_new_discrete_states;
+fmi2EnterContinuousTimeModeTYPE remote_enter_continuous_time_mode;
+fmi2CompletedIntegratorStepTYPE remote_completed_integrator_step;
+
+/* Providing independent variables and re-initialization of caching */
+fmi2SetTimeTYPE remote_set_time;
+fmi2SetContinuousStatesTYPE remote_set_continuous_states;
+
+/* Evaluation of the model equations */
+fmi2GetDerivativesTYPE remote_get_derivatives;
+fmi2GetEventIndicatorsTYPE remote_get_event_indicators;
+fmi2GetContinuousStatesTYPE remote_get_continuous_states;
+fmi2GetNominalsOfContinuousStatesTYPE remote_get_nominals_of_continuous_states;
+
+/* Simulating the slave */
+fmi2SetRealInputDerivativesTYPE remote_set_real_input_derivatives;
+fmi2GetRealOutputDerivativesTYPE remote_get_real_output_derivatives;
+
+fmi2DoStepTYPE remote_do_step;
+fmi2CancelStepTYPE remote_cancel_step;
+
+/* Inquire slave status */
+fmi2GetStatusTYPE remote_get_status;
+fmi2GetRealStatusTYPE remote_get_real_status;
+fmi2GetIntegerStatusTYPE remote_get_integer_status;
+fmi2GetBooleanStatusTYPE remote_get_boolean_status;
+fmi2GetStringStatusTYPE remote_get_string_status;
@@ -0,0 +1,11 @@
+#pragma once
+#include <stddef.h>
+
+/*! The number of bytes of a SHA-256 digest. */
+#define SHA256_DIGEST_SIZE 32
+
+/*!
+    \brief Compute the SHA-256 digest (FIPS 180-4) of the data.
+    \param digest Receives SHA256_DIGEST_SIZE bytes.
+*/
+void sha256(const unsigned char *data, size_t size, unsigned char digest[SHA256_DIGEST_SIZE]);
@@ -0,0 +1,306 @@
+#include "snapshot_store.h"
+#include "system_functions.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*! Identifies snapshot files. */
+static const char SNAPSHOT_MAGIC[8] = {'F', 'M', 'I', 'S', 'N', 'A', 'P', '\0'};
+/*! Increment when the layout of the file changes. */
+#define SNAPSHOT_VERSION 1
+/*! Written in native byte order, files from platforms with another byte order are rejected. */
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+/*! Marks the start of each record. */
+#define RECORD_MAGIC 0x50414e53u
+/*! Records and their parts start at multiples of this size, so the times can be read in place. */
+#define RECORD_ALIGNMENT 8
+
+/*!
+    The layout of the file: header, records.
+    Each record consists of its header, the zero terminated guid and the serialized state, both padded to the alignment.
+*/
+typedef struct snapshot_header
+{
+    char magic[8];
+    uint32_t byte_order;
+    uint32_t version;
+} snapshot_header;
+
+typedef struct record_header
+{
+    uint32_t magic;
+    /*! Including the terminator, excluding the padding. */
+    uint32_t guid_size;
+    uint64_t state_size;
+    double time;
+} record_header;
+
+struct snapshot_store
+{
+    system_mapped_file file;
+    /*! Sorted by guid, time and position in the file. */
+    snapshot_info *snapshots;
+    size_t n_snapshots;
+};
+
+static size_t align(size_t size)
+{
+    return (size + RECORD_ALIGNMENT - 1) / RECORD_ALIGNMENT * RECORD_ALIGNMENT;
+}
+
+static bool is_valid_header(const snapshot_header *header)
+{
+    return memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0 && header->byte_order == SNAPSHOT_BYTE_ORDER &&
+           header->version == SNAPSHOT_VERSION;
+}
+
+/*! Write the header to a new file or check the header of an existing one. */
+static bool prepare_file(FILE *file)
+{
+    snapshot_header header;
+    if (fseek(file, 0, SEEK_END) != 0)
+    {
+        return false;
+    }
+    long size = ftell(file);
+    if (size == 0)
+    {
+        memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        header.byte_order = SNAPSHOT_BYTE_ORDER;
+        header.version = SNAPSHOT_VERSION;
+        return fwrite(&header, sizeof(header), 1, file) == 1;
+    }
+    return size >= (long)sizeof(header) && fseek(file, 0, SEEK_SET) == 0 && fread(&header, sizeof(header), 1, file) == 1 &&
+           is_valid_header(&header);
+}
+
+/*!
+    Walk through the complete records of the mapped file.
+    \param snapshots NULL to count the records only.
+    \param end Receives the end of the last complete record. May be NULL.
+    \return The number of records.
+*/
+static size_t read_records(const system_mapped_file *file, snapshot_info snapshots[], size_t *end)
+{
+    const unsigned char *data = file->data;
+    size_t offset = sizeof(snapshot_header);
+    size_t count = 0;
+    while (file->size - offset >= sizeof(record_header))
+    {
+        record_header header;
+        memcpy(&header, data + offset, sizeof(header));
+        size_t available = file->size - offset - sizeof(header);
+        if (header.magic != RECORD_MAGIC || header.guid_size == 0 || align(header.guid_size) > available ||
+            header.state_size > available - align(header.guid_size))
+        {
+            break;
+        }
+        const char *guid = (const char *)(data + offset + sizeof(header));
+        if (guid[header.guid_size - 1] != '\0')
+        {
+            break;
+        }
+        size_t record_size = sizeof(header) + align(header.guid_size) + align((size_t)header.state_size);
+        if (record_size > file->size - offset)
+        {
+            break;
+        }
+        if (snapshots != NULL)
+        {
+            snapshots[count].guid = guid;
+            snapshots[count].time = header.time;
+            snapshots[count].data = (const fmi2Byte *)(guid + align(header.guid_size));
+            snapshots[count].size = (size_t)header.state_size;
+        }
+        count++;
+        offset += record_size;
+    }
+    if (end != NULL)
+    {
+        *end = offset;
+    }
+    return count;
+}
+
+/*!
+    Cut off an incomplete record at the end of the file, e.g. of a crashed writer.
+    Otherwise the records appended after it would never be read.
+    \return False if the file could not be truncated.
+*/
+static bool truncate_incomplete_record(const char *file_name)
+{
+    system_mapped_file file = {NULL, 0};
+    // New and empty files can not be mapped and have no records
+    if (mapFile(&file, file_name, 0, false) == NULL)
+    {
+        return true;
+    }
+    size_t end = file.size;
+    // Files with another header are rejected by prepare_file
+    if (file.size >= sizeof(snapshot_header) && is_valid_header(file.data))
+    {
+        read_records(&file, NULL, &end);
+    }
+    size_t size = file.size;
+    unmapFile(&file);
+    return end == size || resizeFile(file_name, end) == 0;
+}
+
+PUBLIC_EXPORT fmi2Status save_snapshot(const char *file_name, wrapped_fmu *instance, fmi2String guid, fmi2Real time)
+{
+    fmi2FMUstate state = NULL;
+    fmi2Status status = get_fmu_state(instance, &state);
+    size_t state_size = 0;
+    if (status == fmi2OK || status == fmi2Warning)
+    {
+        fmi2Status size_status = serialized_fmu_state_size(instance, state, &state_size);
+        status = size_status > status ? size_status : status;
+    }
+    // Serialize into the record, so it is appended with a single write
+    size_t guid_size = strlen(guid) + 1;
+    size_t record_size = sizeof(record_header) + align(guid_size) + align(state_size);
+    unsigned char *record = status == fmi2OK || status == fmi2Warning ? calloc(1, record_size) : NULL;
+    if (record != NULL)
+    {
+        record_header header = {RECORD_MAGIC, (uint32_t)guid_size, state_size, time};
+        memcpy(record, &header, sizeof(header));
+        memcpy(record + sizeof(header), guid, guid_size);
+        fmi2Status serialize_status = serialize_fmu_state(instance, state, (fmi2Byte *)(record + sizeof(header) + align(guid_size)), state_size);
+        status = serialize_status > status ? serialize_status : status;
+    }
+    else if (status == fmi2OK || status == fmi2Warning)
+    {
+        status = fmi2Error;
+    }
+    if (state != NULL)
+    {
+        free_fmu_state(instance, &state);
+    }
+    if (status == fmi2OK || status == fmi2Warning)
+    {
+        // Reading is allowed anywhere, writing always appends
+        FILE *file = truncate_incomplete_record(file_name) ? fopen(file_name, "a+b") : NULL;
+        bool success = file != NULL && prepare_file(file) && fseek(file, 0, SEEK_END) == 0 && fwrite(record, 1, record_size, file) == record_size;
+        success = file != NULL && fclose(file) == 0 && success;
+        status = success ? status : fmi2Error;
+    }
+    free(record);
+    return status;
+}
+
+static int compare_snapshots(const void *first, const void *second)
+{
+    const snapshot_info *a = first;
+    const snapshot_info *b = second;
+    int order = strcmp(a->guid, b->guid);
+    if (order != 0)
+    {
+        return order;
+    }
+    if (a->time != b->time)
+    {
+        return a->time < b->time ? -1 : 1;
+    }
+    // Later snapshots of the same time come last
+    return a->data < b->data ? -1 : a->data > b->data;
+}
+
+PUBLIC_EXPORT snapshot_store *open_snapshot_store(const char *file_name)
+{
+    snapshot_store *store = calloc(1, sizeof(snapshot_store));
+    if (store == NULL)
+    {
+        return NULL;
+    }
+    if (mapFile(&store->file, file_name, 0, false) == NULL || store->file.size < sizeof(snapshot_header) ||
+        !is_valid_header(store->file.data))
+    {
+        close_snapshot_store(store);
+        return NULL;
+    }
+    store->n_snapshots = read_records(&store->file, NULL, NULL);
+    store->snapshots = calloc(store->n_snapshots > 0 ? store->n_snapshots : 1, sizeof(snapshot_info));
+    if (store->snapshots == NULL)
+    {
+        close_snapshot_store(store);
+        return NULL;
+    }
+    read_records(&store->file, store->snapshots, NULL);
+    qsort(store->snapshots, store->n_snapshots, sizeof(snapshot_info), compare_snapshots);
+    return store;
+}
+
+PUBLIC_EXPORT void close_snapshot_store(snapshot_store *store)
+{
+    if (store == NULL)
+    {
+        return;
+    }
+    unmapFile(&store->file);
+    free(store->snapshots);
+    free(store);
+}
+
+PUBLIC_EXPORT size_t get_snapshot_count(const snapshot_store *store)
+{
+    return store->n_snapshots;
+}
+
+PUBLIC_EXPORT fmi2Status get_snapshot_info(const snapshot_store *store, size_t index, snapshot_info *info)
+{
+    if (index >= store->n_snapshots)
+    {
+        return fmi2Error;
+    }
+    *info = store->snapshots[index];
+    return fmi2OK;
+}
+
+PUBLIC_EXPORT fmi2Boolean find_snapshot(const snapshot_store *store, fmi2String guid, fmi2Real time, size_t *index)
+{
+    // Binary search for the first snapshot after the time
+    size_t low = 0;
+    size_t high = store->n_snapshots;
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        const snapshot_info *snapshot = &store->snapshots[middle];
+        int order = strcmp(snapshot->guid, guid);
+        if (order < 0 || (order == 0 && snapshot->time <= time))
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    if (low == 0 || strcmp(store->snapshots[low - 1].guid, guid) != 0)
+    {
+        return fmi2False;
+    }
+    *index = low - 1;
+    return fmi2True;
+}
+
+PUBLIC_EXPORT fmi2Status restore_snapshot(const snapshot_store *store, size_t index, wrapped_fmu *instance)
+{
+    if (index >= store->n_snapshots)
+    {
+        return fmi2Error;
+    }
+    const snapshot_info *snapshot = &store->snapshots[index];
+    fmi2FMUstate state = NULL;
+    fmi2Status status = deserialize_fmu_state(instance, snapshot->data, snapshot->size, &state);
+    if (status == fmi2OK || status == fmi2Warning)
+    {
+        fmi2Status set_status = set_fmu_state(instance, state);
+        status = set_status > status ? set_status : status;
+    }
+    if (state != NULL)
+    {
+        free_fmu_state(instance, &state);
+    }
+    return status;
+}
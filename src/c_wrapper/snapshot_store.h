@@ -0,0 +1,53 @@
+#pragma once
+#include "fmi_wrapper.h"
+
+/*!
+    \brief Append-only files of serialized fmu states, so many processes can start from one warmed-up simulation state.
+    The file is memory mapped for reading and the states are deserialized straight from the mapped pages.
+    A file may hold the snapshots of several models, they are indexed by the guid and the simulation time.
+*/
+
+typedef struct snapshot_store snapshot_store;
+
+/*! A snapshot of an opened store. The pointers point into the mapped file and stay valid until close_snapshot_store. */
+typedef struct snapshot_info
+{
+    fmi2String guid;
+    fmi2Real time;
+    /*! The serialized fmu state. */
+    const fmi2Byte *data;
+    size_t size;
+} snapshot_info;
+
+/*!
+    \brief Serialize the current state of the instance and append it to the file, the file is created if it does not exist.
+    The fmu must support canSerializeFMUstate. Appending to the same file from several processes must be serialized by the caller.
+    An incomplete snapshot at the end of the file, e.g. of a crashed writer, is cut off before appending.
+    \param guid The guid of the model description.
+    \param time The simulation time of the state.
+    \return fmi2Error if the file is not a snapshot file or could not be written.
+*/
+PUBLIC_EXPORT fmi2Status save_snapshot(const char *file_name, wrapped_fmu *instance, fmi2String guid, fmi2Real time);
+/*!
+    \brief Map the file and index its snapshots. Snapshots appended later are visible after opening the file again.
+    An incomplete snapshot at the end, e.g. of a crashed writer, is ignored.
+    \return NULL if the file could not be mapped or has another version or byte order.
+*/
+PUBLIC_EXPORT snapshot_store *open_snapshot_store(const char *file_name);
+PUBLIC_EXPORT void close_snapshot_store(snapshot_store *store);
+PUBLIC_EXPORT size_t get_snapshot_count(const snapshot_store *store);
+/*!
+    \brief Get a snapshot by its position in the index, which is sorted by guid and time.
+    \return fmi2Error if the index is out of range.
+*/
+PUBLIC_EXPORT fmi2Status get_snapshot_info(const snapshot_store *store, size_t index, snapshot_info *info);
+/*!
+    \brief Find the latest snapshot of the model at or before the time.
+    \param index Receives the position in the index if a snapshot was found.
+*/
+PUBLIC_EXPORT fmi2Boolean find_snapshot(const snapshot_store *store, fmi2String guid, fmi2Real time, size_t *index);
+/*!
+    \brief Deserialize the snapshot from the mapped file and set it as the state of the instance.
+    The instance must have been instantiated from the model of the snapshot.
+*/
+PUBLIC_EXPORT fmi2Status restore_snapshot(const snapshot_store *store, size_t index, wrapped_fmu *instance);
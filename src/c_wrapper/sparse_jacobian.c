@@ -0,0 +1,392 @@
+#include "sparse_jacobian.h"
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*! The public part comes first, so the pointers convert both ways. */
+typedef struct jacobian_data
+{
+    sparse_jacobian jacobian;
+    /*! Column j contains column_entries[column_offsets[j]] to column_entries[column_offsets[j + 1] - 1], indices into values. */
+    size_t *column_offsets;
+    size_t *column_entries;
+    /*! The row of each element of column_entries. */
+    size_t *column_rows;
+    /*! The columns of color c are color_columns[color_offsets[c]] to color_columns[color_offsets[c + 1] - 1]. */
+    size_t *color_offsets;
+    size_t *color_columns;
+    fmi2ValueReference *state_references;
+    fmi2ValueReference *derivative_references;
+    /*! The states of the current color. */
+    fmi2ValueReference *known_references;
+    /* Vectors of n_states values */
+    fmi2Real *seeds;
+    fmi2Real *results;
+    fmi2Real *perturbed;
+    fmi2Real *deltas;
+} jacobian_data;
+
+static int compare_indices(const void *a, const void *b)
+{
+    size_t left = *(const size_t *)a;
+    size_t right = *(const size_t *)b;
+    return left < right ? -1 : left > right;
+}
+
+/*! calloc that does not return NULL for empty arrays. */
+static void *allocate(size_t count, size_t size)
+{
+    return calloc(count > 0 ? count : 1, size);
+}
+
+/*!
+    Collect the entries of the rows, dependencies on variables that are not states are ignored.
+    \param columns NULL to count the entries only.
+    \param marks n_states elements, remembers the last row of a column to skip duplicates.
+    \return The number of entries.
+*/
+static size_t collect_rows(const model_description *description, const size_t state_of_variable[], size_t marks[], size_t row_offsets[],
+                           size_t columns[])
+{
+    size_t n = description->number_of_continuous_states;
+    size_t count = 0;
+    for (size_t column = 0; column < n; column++)
+    {
+        marks[column] = SIZE_MAX;
+    }
+    for (size_t row = 0; row < n; row++)
+    {
+        size_t row_start = count;
+        if (!description->derivative_dependencies_defined[row])
+        {
+            for (size_t column = 0; column < n; column++)
+            {
+                if (columns != NULL)
+                {
+                    columns[count] = column;
+                }
+                count++;
+            }
+        }
+        else
+        {
+            for (size_t i = description->derivative_dependency_offsets[row]; i < description->derivative_dependency_offsets[row + 1]; i++)
+            {
+                size_t column = state_of_variable[description->derivative_dependencies[i]];
+                if (column != SIZE_MAX && marks[column] != row)
+                {
+                    marks[column] = row;
+                    if (columns != NULL)
+                    {
+                        columns[count] = column;
+                    }
+                    count++;
+                }
+            }
+        }
+        if (columns != NULL)
+        {
+            row_offsets[row] = row_start;
+            qsort(columns + row_start, count - row_start, sizeof(size_t), compare_indices);
+        }
+    }
+    if (row_offsets != NULL)
+    {
+        row_offsets[n] = count;
+    }
+    return count;
+}
+
+/*! Transpose the pattern, so the entries of a color can be scattered column by column. */
+static void build_columns(jacobian_data *data)
+{
+    sparse_jacobian *jacobian = &data->jacobian;
+    size_t n = jacobian->n_states;
+    for (size_t i = 0; i < jacobian->n_nonzeros; i++)
+    {
+        data->column_offsets[jacobian->columns[i] + 1]++;
+    }
+    for (size_t column = 0; column < n; column++)
+    {
+        data->column_offsets[column + 1] += data->column_offsets[column];
+    }
+    // Use the color offsets as insertion positions, they are overwritten by the coloring
+    size_t *positions = data->color_offsets;
+    memcpy(positions, data->column_offsets, n * sizeof(size_t));
+    for (size_t row = 0; row < n; row++)
+    {
+        for (size_t i = jacobian->row_offsets[row]; i < jacobian->row_offsets[row + 1]; i++)
+        {
+            size_t position = positions[jacobian->columns[i]]++;
+            data->column_entries[position] = i;
+            data->column_rows[position] = row;
+        }
+    }
+}
+
+/*!
+    Greedy distance-2 coloring: columns that share a row get different colors.
+    Visiting the largest columns first usually gets close to the minimal number of colors.
+    \param order, forbidden Work arrays of n_states elements.
+*/
+static void color_columns(jacobian_data *data, size_t order[], size_t forbidden[])
+{
+    sparse_jacobian *jacobian = &data->jacobian;
+    size_t n = jacobian->n_states;
+    // Counting sort by descending size, the color offsets are free until the groups are built
+    size_t *starts = data->color_offsets;
+    memset(starts, 0, (n + 1) * sizeof(size_t));
+    for (size_t column = 0; column < n; column++)
+    {
+        starts[n - (data->column_offsets[column + 1] - data->column_offsets[column])]++;
+    }
+    size_t sum = 0;
+    for (size_t key = 0; key <= n; key++)
+    {
+        size_t count = starts[key];
+        starts[key] = sum;
+        sum += count;
+    }
+    for (size_t column = 0; column < n; column++)
+    {
+        order[starts[n - (data->column_offsets[column + 1] - data->column_offsets[column])]++] = column;
+        jacobian->colors[column] = SIZE_MAX;
+        forbidden[column] = SIZE_MAX;
+    }
+    jacobian->n_colors = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        size_t column = order[i];
+        if (data->column_offsets[column + 1] == data->column_offsets[column])
+        {
+            // Empty columns need no evaluation, color 0 is used by any nonempty column
+            jacobian->colors[column] = 0;
+            continue;
+        }
+        for (size_t j = data->column_offsets[column]; j < data->column_offsets[column + 1]; j++)
+        {
+            size_t row = data->column_rows[j];
+            for (size_t k = jacobian->row_offsets[row]; k < jacobian->row_offsets[row + 1]; k++)
+            {
+                size_t color = jacobian->colors[jacobian->columns[k]];
+                if (color != SIZE_MAX)
+                {
+                    forbidden[color] = column;
+                }
+            }
+        }
+        size_t color = 0;
+        while (forbidden[color] == column)
+        {
+            color++;
+        }
+        jacobian->colors[column] = color;
+        if (color + 1 > jacobian->n_colors)
+        {
+            jacobian->n_colors = color + 1;
+        }
+    }
+    // Group the nonempty columns by color
+    memset(data->color_offsets, 0, (n + 1) * sizeof(size_t));
+    for (size_t column = 0; column < n; column++)
+    {
+        if (data->column_offsets[column + 1] > data->column_offsets[column])
+        {
+            data->color_offsets[jacobian->colors[column] + 1]++;
+        }
+    }
+    for (size_t color = 0; color < jacobian->n_colors; color++)
+    {
+        data->color_offsets[color + 1] += data->color_offsets[color];
+    }
+    memcpy(order, data->color_offsets, jacobian->n_colors * sizeof(size_t));
+    for (size_t column = 0; column < n; column++)
+    {
+        if (data->column_offsets[column + 1] > data->column_offsets[column])
+        {
+            data->color_columns[order[jacobian->colors[column]]++] = column;
+        }
+    }
+}
+
+PUBLIC_EXPORT sparse_jacobian *create_sparse_jacobian(const model_description *description)
+{
+    size_t n = description->number_of_continuous_states;
+    if (n == 0)
+    {
+        return NULL;
+    }
+    jacobian_data *data = calloc(1, sizeof(jacobian_data));
+    size_t *state_of_variable = allocate(description->n_variables, sizeof(size_t));
+    size_t *marks = allocate(n, sizeof(size_t));
+    if (data == NULL || state_of_variable == NULL || marks == NULL)
+    {
+        free(data);
+        free(state_of_variable);
+        free(marks);
+        return NULL;
+    }
+    sparse_jacobian *jacobian = &data->jacobian;
+    jacobian->n_states = n;
+    data->state_references = allocate(n, sizeof(fmi2ValueReference));
+    data->derivative_references = allocate(n, sizeof(fmi2ValueReference));
+    bool valid = data->state_references != NULL && data->derivative_references != NULL;
+    // The columns are ordered like the rows, state i is the variable that derivative i belongs to
+    for (size_t i = 0; i < description->n_variables; i++)
+    {
+        state_of_variable[i] = SIZE_MAX;
+    }
+    for (size_t i = 0; valid && i < n; i++)
+    {
+        const model_variable *derivative = &description->variables[description->derivative_indices[i]];
+        valid = derivative->derivative_of != SIZE_MAX;
+        if (valid)
+        {
+            state_of_variable[derivative->derivative_of] = i;
+            data->state_references[i] = description->variables[derivative->derivative_of].value_reference;
+            data->derivative_references[i] = derivative->value_reference;
+        }
+    }
+    if (valid)
+    {
+        jacobian->n_nonzeros = collect_rows(description, state_of_variable, marks, NULL, NULL);
+        jacobian->row_offsets = allocate(n + 1, sizeof(size_t));
+        jacobian->columns = allocate(jacobian->n_nonzeros, sizeof(size_t));
+        jacobian->values = allocate(jacobian->n_nonzeros, sizeof(fmi2Real));
+        jacobian->colors = allocate(n, sizeof(size_t));
+        data->column_offsets = allocate(n + 1, sizeof(size_t));
+        data->column_entries = allocate(jacobian->n_nonzeros, sizeof(size_t));
+        data->column_rows = allocate(jacobian->n_nonzeros, sizeof(size_t));
+        data->color_offsets = allocate(n + 1, sizeof(size_t));
+        data->color_columns = allocate(n, sizeof(size_t));
+        data->known_references = allocate(n, sizeof(fmi2ValueReference));
+        data->seeds = allocate(n, sizeof(fmi2Real));
+        data->results = allocate(n, sizeof(fmi2Real));
+        data->perturbed = allocate(n, sizeof(fmi2Real));
+        data->deltas = allocate(n, sizeof(fmi2Real));
+        valid = jacobian->row_offsets != NULL && jacobian->columns != NULL && jacobian->values != NULL && jacobian->colors != NULL &&
+                data->column_offsets != NULL && data->column_entries != NULL && data->column_rows != NULL &&
+                data->color_offsets != NULL && data->color_columns != NULL && data->known_references != NULL &&
+                data->seeds != NULL && data->results != NULL && data->perturbed != NULL && data->deltas != NULL;
+    }
+    if (valid)
+    {
+        collect_rows(description, state_of_variable, marks, jacobian->row_offsets, jacobian->columns);
+        build_columns(data);
+        // The marks and the lookup table are reused as work arrays of the coloring
+        size_t *forbidden = realloc(state_of_variable, n * sizeof(size_t));
+        if (forbidden != NULL)
+        {
+            state_of_variable = forbidden;
+            color_columns(data, marks, forbidden);
+        }
+        valid = forbidden != NULL;
+        // The seeds of the directional derivatives are the unit vectors of the states
+        for (size_t i = 0; i < n; i++)
+        {
+            data->seeds[i] = 1;
+        }
+    }
+    free(state_of_variable);
+    free(marks);
+    if (!valid)
+    {
+        free_sparse_jacobian(jacobian);
+        return NULL;
+    }
+    return jacobian;
+}
+
+PUBLIC_EXPORT void free_sparse_jacobian(sparse_jacobian *jacobian)
+{
+    if (jacobian == NULL)
+    {
+        return;
+    }
+    jacobian_data *data = (jacobian_data *)jacobian;
+    free(jacobian->row_offsets);
+    free(jacobian->columns);
+    free(jacobian->values);
+    free(jacobian->colors);
+    free(data->column_offsets);
+    free(data->column_entries);
+    free(data->column_rows);
+    free(data->color_offsets);
+    free(data->color_columns);
+    free(data->state_references);
+    free(data->derivative_references);
+    free(data->known_references);
+    free(data->seeds);
+    free(data->results);
+    free(data->perturbed);
+    free(data->deltas);
+    free(data);
+}
+
+PUBLIC_EXPORT fmi2Status evaluate_sparse_jacobian(sparse_jacobian *jacobian, wrapped_fmu *instance, fmi2Boolean use_directional_derivatives,
+                                                  const fmi2Real x[], const fmi2Real dx[], const fmi2Real nominals[])
+{
+    jacobian_data *data = (jacobian_data *)jacobian;
+    size_t n = jacobian->n_states;
+    fmi2Status status = fmi2OK;
+    if (!use_directional_derivatives)
+    {
+        memcpy(data->perturbed, x, n * sizeof(fmi2Real));
+    }
+    for (size_t color = 0; color < jacobian->n_colors && status <= fmi2Warning; color++)
+    {
+        const size_t *group = data->color_columns + data->color_offsets[color];
+        size_t n_group = data->color_offsets[color + 1] - data->color_offsets[color];
+        fmi2Status call_status;
+        if (use_directional_derivatives)
+        {
+            for (size_t i = 0; i < n_group; i++)
+            {
+                data->known_references[i] = data->state_references[group[i]];
+            }
+            call_status = get_directional_derivative(instance, data->derivative_references, n, data->known_references, n_group,
+                                                     data->seeds, data->results);
+        }
+        else
+        {
+            for (size_t i = 0; i < n_group; i++)
+            {
+                size_t column = group[i];
+                fmi2Real nominal = nominals != NULL ? nominals[column] : 1;
+                data->perturbed[column] = x[column] + sqrt(DBL_EPSILON) * fmax(fabs(x[column]), nominal);
+                // The step that is actually representable
+                data->deltas[column] = data->perturbed[column] - x[column];
+            }
+            call_status = set_continuous_states(instance, data->perturbed, n);
+            if (call_status <= fmi2Warning)
+            {
+                fmi2Status derivatives_status = get_derivatives(instance, data->results, n);
+                call_status = derivatives_status > call_status ? derivatives_status : call_status;
+            }
+            for (size_t i = 0; i < n_group; i++)
+            {
+                data->perturbed[group[i]] = x[group[i]];
+            }
+        }
+        status = call_status > status ? call_status : status;
+        // Each row contains at most one column of the color
+        for (size_t i = 0; i < n_group; i++)
+        {
+            size_t column = group[i];
+            for (size_t j = data->column_offsets[column]; j < data->column_offsets[column + 1]; j++)
+            {
+                size_t row = data->column_rows[j];
+                jacobian->values[data->column_entries[j]] = use_directional_derivatives ? data->results[row]
+                                                                                        : (data->results[row] - dx[row]) / data->deltas[column];
+            }
+        }
+    }
+    if (!use_directional_derivatives && jacobian->n_colors > 0 && status <= fmi2Warning)
+    {
+        fmi2Status restore_status = set_continuous_states(instance, x, n);
+        status = restore_status > status ? restore_status : status;
+    }
+    return status;
+}
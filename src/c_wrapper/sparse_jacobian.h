@@ -0,0 +1,46 @@
+#pragma once
+#include "fmi_wrapper.h"
+#include "model_description.h"
+
+/*!
+    \brief The Jacobian of the state derivatives with respect to the continuous states in compressed sparse row format.
+    The sparsity pattern comes from the dependencies of the ModelStructure/Derivatives. Columns that do not share a row
+    get the same color and are evaluated together, so a Jacobian costs one evaluation per color instead of one per state.
+*/
+
+typedef struct sparse_jacobian
+{
+    /*! The Jacobian has n_states rows and columns, ordered like the derivatives of the model description. */
+    size_t n_states;
+    size_t n_nonzeros;
+    /*! Row i contains the entries [row_offsets[i], row_offsets[i + 1]). */
+    size_t *row_offsets;
+    /*! The column of each entry, ascending within a row. */
+    size_t *columns;
+    /*! The value of each entry, written by evaluate_sparse_jacobian. */
+    fmi2Real *values;
+    /*! The number of evaluations per Jacobian. */
+    size_t n_colors;
+    /*! The color of each column. */
+    size_t *colors;
+} sparse_jacobian;
+
+/*!
+    \brief Build the sparsity pattern and color the columns greedily, largest columns first.
+    Derivatives without the dependencies attribute depend on all states, dependencies on inputs are ignored.
+    \return NULL if the model has no continuous states, a derivative does not name its state or the memory could not be allocated.
+*/
+PUBLIC_EXPORT sparse_jacobian *create_sparse_jacobian(const model_description *description);
+PUBLIC_EXPORT void free_sparse_jacobian(sparse_jacobian *jacobian);
+/*!
+    \brief Evaluate the Jacobian at the current time and states of a Model Exchange instance in the continuous time mode.
+    With directional derivatives each color is one get_directional_derivative call, seeded with the states of the color.
+    Otherwise the states of a color are perturbed together and the derivatives are evaluated by forward differences,
+    the states are restored afterwards.
+    \param use_directional_derivatives See fmu_interface.provides_directional_derivative.
+    \param x The current states, only needed for the finite differences.
+    \param dx The derivatives at x, only needed for the finite differences.
+    \param nominals Scale the perturbations, may be NULL.
+*/
+PUBLIC_EXPORT fmi2Status evaluate_sparse_jacobian(sparse_jacobian *jacobian, wrapped_fmu *instance, fmi2Boolean use_directional_derivatives,
+                                                  const fmi2Real x[], const fmi2Real dx[], const fmi2Real nominals[]);
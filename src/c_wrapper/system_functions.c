@@ -1,10 +1,42 @@
+#if !defined(_WIN32) && !defined(_XOPEN_SOURCE)
+// Required for realpath when compiling with -std=c99
+#define _XOPEN_SOURCE 700
+#endif
+#if defined(__linux__) && !defined(_DEFAULT_SOURCE)
+// Required for syscall
+#define _DEFAULT_SOURCE
+#endif
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+// Required for sched_setaffinity
+#define _GNU_SOURCE
+#endif
 #include "system_functions.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #if defined _WIN32
 #include <windows.h>
 #else
 #if __unix__
+#include <dirent.h>
 #include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+extern char **environ;
 #else
 #define PUBLIC_EXPORT
 #endif
@@ -38,3 +70,1010 @@ int freeSharedLibrary(void *handle)
     return dlclose(handle);
 #endif
 }
+
+char *resolvePath(const char *filename)
+{
+#if defined(_WIN32) // Microsoft compiler
+    DWORD size = GetFullPathName(filename, 0, NULL, NULL);
+    if (size == 0)
+    {
+        return NULL;
+    }
+    char *resolved = malloc(size);
+    if (resolved != NULL && GetFullPathName(filename, size, resolved, NULL) == 0)
+    {
+        free(resolved);
+        return NULL;
+    }
+    return resolved;
+#elif defined(__unix__) // GNU compiler
+    return realpath(filename, NULL);
+#endif
+}
+
+int getFileStatus(const char *path, uint64_t *size, int64_t *modification_time)
+{
+#if defined(_WIN32) // Microsoft compiler
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesEx(path, GetFileExInfoStandard, &data))
+    {
+        return -1;
+    }
+    *size = ((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+    // 100 ns intervals
+    *modification_time = (int64_t)(((uint64_t)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime);
+    return 0;
+#elif defined(__unix__) // GNU compiler
+    struct stat status;
+    if (stat(path, &status) != 0)
+    {
+        return -1;
+    }
+    *size = (uint64_t)status.st_size;
+    // Nanoseconds, so a file rewritten within the same second is still detected
+    *modification_time = (int64_t)status.st_mtim.tv_sec * 1000000000 + status.st_mtim.tv_nsec;
+    return 0;
+#endif
+}
+
+int createDirectory(const char *path)
+{
+#if defined(_WIN32) // Microsoft compiler
+    if (CreateDirectory(path, NULL) || GetLastError() == ERROR_ALREADY_EXISTS)
+    {
+        return 0;
+    }
+    return -1;
+#elif defined(__unix__) // GNU compiler
+    if (mkdir(path, 0755) == 0 || errno == EEXIST)
+    {
+        return 0;
+    }
+    return -1;
+#endif
+}
+
+int removeDirectory(const char *path)
+{
+    size_t path_length = strlen(path);
+#if defined(_WIN32) // Microsoft compiler
+    char *pattern = malloc(path_length + 3);
+    if (pattern == NULL)
+    {
+        return -1;
+    }
+    memcpy(pattern, path, path_length);
+    memcpy(pattern + path_length, "/*", 3);
+    WIN32_FIND_DATA entry;
+    HANDLE find = FindFirstFile(pattern, &entry);
+    free(pattern);
+    if (find != INVALID_HANDLE_VALUE)
+    {
+        do
+        {
+            if (strcmp(entry.cFileName, ".") == 0 || strcmp(entry.cFileName, "..") == 0)
+            {
+                continue;
+            }
+            size_t name_length = strlen(entry.cFileName);
+            char *child = malloc(path_length + 1 + name_length + 1);
+            if (child == NULL)
+            {
+                continue;
+            }
+            memcpy(child, path, path_length);
+            child[path_length] = '/';
+            memcpy(child + path_length + 1, entry.cFileName, name_length + 1);
+            if (entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+            {
+                removeDirectory(child);
+            }
+            else
+            {
+                DeleteFile(child);
+            }
+            free(child);
+        } while (FindNextFile(find, &entry));
+        FindClose(find);
+    }
+    return RemoveDirectory(path) ? 0 : -1;
+#elif defined(__unix__) // GNU compiler
+    DIR *directory = opendir(path);
+    if (directory != NULL)
+    {
+        struct dirent *entry;
+        while ((entry = readdir(directory)) != NULL)
+        {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+            {
+                continue;
+            }
+            size_t name_length = strlen(entry->d_name);
+            char *child = malloc(path_length + 1 + name_length + 1);
+            if (child == NULL)
+            {
+                continue;
+            }
+            memcpy(child, path, path_length);
+            child[path_length] = '/';
+            memcpy(child + path_length + 1, entry->d_name, name_length + 1);
+            struct stat status;
+            if (lstat(child, &status) == 0 && S_ISDIR(status.st_mode))
+            {
+                removeDirectory(child);
+            }
+            else
+            {
+                unlink(child);
+            }
+            free(child);
+        }
+        closedir(directory);
+    }
+    return rmdir(path);
+#endif
+}
+
+int listDirectory(const char *path, directory_entry_function function, void *context)
+{
+#if defined(_WIN32) // Microsoft compiler
+    size_t path_length = strlen(path);
+    char *pattern = malloc(path_length + 3);
+    if (pattern == NULL)
+    {
+        return -1;
+    }
+    memcpy(pattern, path, path_length);
+    memcpy(pattern + path_length, "/*", 3);
+    WIN32_FIND_DATA entry;
+    HANDLE find = FindFirstFile(pattern, &entry);
+    free(pattern);
+    if (find == INVALID_HANDLE_VALUE)
+    {
+        return -1;
+    }
+    do
+    {
+        if (strcmp(entry.cFileName, ".") != 0 && strcmp(entry.cFileName, "..") != 0)
+        {
+            function(entry.cFileName, context);
+        }
+    } while (FindNextFile(find, &entry));
+    FindClose(find);
+    return 0;
+#elif defined(__unix__) // GNU compiler
+    DIR *directory = opendir(path);
+    if (directory == NULL)
+    {
+        return -1;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(directory)) != NULL)
+    {
+        if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+        {
+            function(entry->d_name, context);
+        }
+    }
+    closedir(directory);
+    return 0;
+#endif
+}
+
+int renamePath(const char *source, const char *target)
+{
+#if defined(_WIN32) // Microsoft compiler
+    // Without MOVEFILE_REPLACE_EXISTING the call fails if the target exists
+    return MoveFileEx(source, target, 0) ? 0 : -1;
+#elif defined(__unix__) // GNU compiler
+    // rename replaces empty directories only, so a complete target is never replaced
+    return rename(source, target);
+#endif
+}
+
+unsigned long getProcessId(void)
+{
+#if defined(_WIN32) // Microsoft compiler
+    return (unsigned long)GetCurrentProcessId();
+#elif defined(__unix__) // GNU compiler
+    return (unsigned long)getpid();
+#endif
+}
+
+char *getTempDirectory(void)
+{
+#if defined(_WIN32) // Microsoft compiler
+    char path[MAX_PATH + 1];
+    DWORD length = GetTempPath(sizeof(path), path);
+    if (length == 0 || length > sizeof(path))
+    {
+        strcpy(path, ".");
+        length = 1;
+    }
+    // Remove the trailing separator
+    else if (path[length - 1] == '\\' || path[length - 1] == '/')
+    {
+        path[--length] = '\0';
+    }
+#elif defined(__unix__) // GNU compiler
+    const char *path = getenv("TMPDIR");
+    if (path == NULL || path[0] == '\0')
+    {
+        path = "/tmp";
+    }
+    size_t length = strlen(path);
+    // Remove the trailing separator
+    while (length > 1 && path[length - 1] == '/')
+    {
+        length--;
+    }
+#endif
+    char *result = malloc(length + 1);
+    if (result != NULL)
+    {
+        memcpy(result, path, length);
+        result[length] = '\0';
+    }
+    return result;
+}
+
+void initMutex(system_mutex *mutex)
+{
+#if defined(_WIN32) // Microsoft compiler
+    InitializeSRWLock(mutex);
+#elif defined(__unix__) // GNU compiler
+    pthread_mutex_init(mutex, NULL);
+#endif
+}
+
+void lockMutex(system_mutex *mutex)
+{
+#if defined(_WIN32) // Microsoft compiler
+    AcquireSRWLockExclusive(mutex);
+#elif defined(__unix__) // GNU compiler
+    pthread_mutex_lock(mutex);
+#endif
+}
+
+void unlockMutex(system_mutex *mutex)
+{
+#if defined(_WIN32) // Microsoft compiler
+    ReleaseSRWLockExclusive(mutex);
+#elif defined(__unix__) // GNU compiler
+    pthread_mutex_unlock(mutex);
+#endif
+}
+
+void destroyMutex(system_mutex *mutex)
+{
+#if defined(_WIN32) // Microsoft compiler
+    // SRW locks do not need to be destroyed
+    (void)mutex;
+#elif defined(__unix__) // GNU compiler
+    pthread_mutex_destroy(mutex);
+#endif
+}
+
+void initCondition(system_condition *condition)
+{
+#if defined(_WIN32) // Microsoft compiler
+    InitializeConditionVariable(condition);
+#elif defined(__unix__) // GNU compiler
+    pthread_cond_init(condition, NULL);
+#endif
+}
+
+void waitCondition(system_condition *condition, system_mutex *mutex)
+{
+#if defined(_WIN32) // Microsoft compiler
+    SleepConditionVariableSRW(condition, mutex, INFINITE, 0);
+#elif defined(__unix__) // GNU compiler
+    pthread_cond_wait(condition, mutex);
+#endif
+}
+
+void broadcastCondition(system_condition *condition)
+{
+#if defined(_WIN32) // Microsoft compiler
+    WakeAllConditionVariable(condition);
+#elif defined(__unix__) // GNU compiler
+    pthread_cond_broadcast(condition);
+#endif
+}
+
+void destroyCondition(system_condition *condition)
+{
+#if defined(_WIN32) // Microsoft compiler
+    // Condition variables do not need to be destroyed
+    (void)condition;
+#elif defined(__unix__) // GNU compiler
+    pthread_cond_destroy(condition);
+#endif
+}
+
+/*! Passes the function and argument of createThread to the platform specific entry point. */
+typedef struct thread_start
+{
+    thread_function function;
+    void *argument;
+} thread_start;
+
+#if defined(_WIN32) // Microsoft compiler
+static DWORD WINAPI threadEntry(LPVOID parameter)
+#elif defined(__unix__) // GNU compiler
+static void *threadEntry(void *parameter)
+#endif
+{
+    thread_start start = *(thread_start *)parameter;
+    free(parameter);
+    start.function(start.argument);
+    return 0;
+}
+
+int createThread(system_thread *thread, thread_function function, void *argument)
+{
+    thread_start *start = malloc(sizeof(thread_start));
+    if (start == NULL)
+    {
+        return -1;
+    }
+    start->function = function;
+    start->argument = argument;
+#if defined(_WIN32) // Microsoft compiler
+    *thread = CreateThread(NULL, 0, threadEntry, start, 0, NULL);
+    if (*thread == NULL)
+    {
+        free(start);
+        return -1;
+    }
+    return 0;
+#elif defined(__unix__) // GNU compiler
+    int result = pthread_create(thread, NULL, threadEntry, start);
+    if (result != 0)
+    {
+        free(start);
+    }
+    return result;
+#endif
+}
+
+void joinThread(system_thread thread)
+{
+#if defined(_WIN32) // Microsoft compiler
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+#elif defined(__unix__) // GNU compiler
+    pthread_join(thread, NULL);
+#endif
+}
+
+size_t getProcessorCount(void)
+{
+#if defined(_WIN32) // Microsoft compiler
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (size_t)info.dwNumberOfProcessors : 1;
+#elif defined(__unix__) // GNU compiler
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+#endif
+}
+
+uint64_t getMonotonicTime(void)
+{
+#if defined(_WIN32) // Microsoft compiler
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    // Split the conversion so the multiplication does not overflow
+    uint64_t ticks = (uint64_t)counter.QuadPart;
+    uint64_t ticks_per_second = (uint64_t)frequency.QuadPart;
+    return ticks / ticks_per_second * 1000000000u + ticks % ticks_per_second * 1000000000u / ticks_per_second;
+#elif defined(__unix__) // GNU compiler
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+#endif
+}
+
+#if defined(_WIN32) && !defined(CREATE_WAITABLE_TIMER_HIGH_RESOLUTION)
+// Missing in SDKs before Windows 10 1803
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+void sleepUntil(uint64_t monotonic_ns)
+{
+#if defined(_WIN32) // Microsoft compiler
+    uint64_t now = getMonotonicTime();
+    if (monotonic_ns <= now)
+    {
+        return;
+    }
+    // Waitable timers are relative to the system clock, so wait for the remaining time in 100 ns units
+    HANDLE timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    LARGE_INTEGER due;
+    due.QuadPart = -(LONGLONG)((monotonic_ns - now) / 100);
+    if (timer != NULL && SetWaitableTimer(timer, &due, 0, NULL, NULL, FALSE))
+    {
+        WaitForSingleObject(timer, INFINITE);
+    }
+    else
+    {
+        Sleep((DWORD)((monotonic_ns - now) / 1000000));
+    }
+    if (timer != NULL)
+    {
+        CloseHandle(timer);
+    }
+#elif defined(__unix__) // GNU compiler
+    struct timespec deadline;
+    deadline.tv_sec = (time_t)(monotonic_ns / 1000000000u);
+    deadline.tv_nsec = (long)(monotonic_ns % 1000000000u);
+    // An absolute deadline does not drift when a signal interrupts the sleep
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR)
+    {
+    }
+#endif
+}
+
+int pinThreadToProcessor(size_t processor)
+{
+#if defined(_WIN32) // Microsoft compiler
+    if (processor >= sizeof(DWORD_PTR) * 8)
+    {
+        return -1;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << processor) != 0 ? 0 : -1;
+#elif defined(__linux__) // GNU compiler
+    if (processor >= CPU_SETSIZE)
+    {
+        return -1;
+    }
+    cpu_set_t processors;
+    CPU_ZERO(&processors);
+    CPU_SET(processor, &processors);
+    // 0 selects the calling thread
+    return sched_setaffinity(0, sizeof(processors), &processors);
+#else
+    (void)processor;
+    return -1;
+#endif
+}
+
+int setRealtimePriority(int priority)
+{
+#if defined(_WIN32) // Microsoft compiler
+    (void)priority;
+    return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) ? 0 : -1;
+#elif defined(__unix__) // GNU compiler
+    struct sched_param parameters;
+    memset(&parameters, 0, sizeof(parameters));
+    parameters.sched_priority = priority;
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters) == 0 ? 0 : -1;
+#endif
+}
+
+/*! mlockall and munlockall apply to the whole process, so the locks of all callers are counted. */
+static system_mutex memory_lock_mutex = SYSTEM_MUTEX_INITIALIZER;
+static size_t memory_lock_count = 0;
+
+int lockProcessMemory(void)
+{
+#if defined(_WIN32) // Microsoft compiler
+    return -1;
+#elif defined(__unix__) // GNU compiler
+    int result = 0;
+    lockMutex(&memory_lock_mutex);
+    if (memory_lock_count == 0)
+    {
+        result = mlockall(MCL_CURRENT | MCL_FUTURE);
+    }
+    if (result == 0)
+    {
+        memory_lock_count++;
+    }
+    unlockMutex(&memory_lock_mutex);
+    return result;
+#endif
+}
+
+void unlockProcessMemory(void)
+{
+#if defined(__unix__) // GNU compiler
+    lockMutex(&memory_lock_mutex);
+    if (memory_lock_count > 0 && --memory_lock_count == 0)
+    {
+        munlockall();
+    }
+    unlockMutex(&memory_lock_mutex);
+#endif
+}
+
+size_t atomicLoad(const volatile size_t *value)
+{
+#if defined(_WIN32) // Microsoft compiler
+    size_t result = *value;
+    MemoryBarrier();
+    return result;
+#elif defined(__unix__) // GNU compiler
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#endif
+}
+
+void atomicStore(volatile size_t *target, size_t value)
+{
+#if defined(_WIN32) // Microsoft compiler
+    MemoryBarrier();
+    *target = value;
+#elif defined(__unix__) // GNU compiler
+    __atomic_store_n(target, value, __ATOMIC_RELEASE);
+#endif
+}
+
+size_t atomicIncrement(volatile size_t *value)
+{
+#if defined(_WIN64) // Microsoft compiler
+    return (size_t)InterlockedIncrement64((volatile LONG64 *)value);
+#elif defined(_WIN32)
+    return (size_t)InterlockedIncrement((volatile LONG *)value);
+#elif defined(__unix__) // GNU compiler
+    return __atomic_add_fetch(value, 1, __ATOMIC_ACQ_REL);
+#endif
+}
+
+/*! Prefix the name so it is valid for the named objects of the platform. */
+static char *sharedObjectName(const char *name, const char *suffix)
+{
+#if defined(_WIN32) // Microsoft compiler
+    const char *prefix = "Local\\";
+#elif defined(__unix__) // GNU compiler
+    const char *prefix = "/";
+#endif
+    size_t prefix_length = strlen(prefix);
+    size_t name_length = strlen(name);
+    size_t suffix_length = strlen(suffix);
+    char *result = malloc(prefix_length + name_length + suffix_length + 1);
+    if (result != NULL)
+    {
+        memcpy(result, prefix, prefix_length);
+        memcpy(result + prefix_length, name, name_length);
+        memcpy(result + prefix_length + name_length, suffix, suffix_length + 1);
+    }
+    return result;
+}
+
+/*! Map the shared memory, either creating it or opening an existing one. */
+static void *mapSharedMemory(system_shared_memory *memory, const char *name, size_t size, bool create)
+{
+    memory->data = NULL;
+    memory->size = size;
+    char *full_name = sharedObjectName(name, "");
+    if (full_name == NULL)
+    {
+        return NULL;
+    }
+#if defined(_WIN32) // Microsoft compiler
+    if (create)
+    {
+        memory->handle = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                           (DWORD)((unsigned long long)size >> 32), (DWORD)size, full_name);
+        if (memory->handle != NULL && GetLastError() == ERROR_ALREADY_EXISTS)
+        {
+            CloseHandle(memory->handle);
+            memory->handle = NULL;
+        }
+    }
+    else
+    {
+        memory->handle = OpenFileMapping(FILE_MAP_ALL_ACCESS, FALSE, full_name);
+    }
+    if (memory->handle != NULL)
+    {
+        memory->data = MapViewOfFile(memory->handle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+        if (memory->data == NULL)
+        {
+            CloseHandle(memory->handle);
+            memory->handle = NULL;
+        }
+    }
+#elif defined(__unix__) // GNU compiler
+    int descriptor = shm_open(full_name, create ? O_CREAT | O_EXCL | O_RDWR : O_RDWR, 0600);
+    if (descriptor >= 0)
+    {
+        if (!create || ftruncate(descriptor, (off_t)size) == 0)
+        {
+            void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+            memory->data = data != MAP_FAILED ? data : NULL;
+        }
+        // The mapping keeps the memory alive
+        close(descriptor);
+        if (create && memory->data == NULL)
+        {
+            shm_unlink(full_name);
+        }
+    }
+#endif
+    free(full_name);
+    return memory->data;
+}
+
+void *createSharedMemory(system_shared_memory *memory, const char *name, size_t size)
+{
+    return mapSharedMemory(memory, name, size, true);
+}
+
+void *openSharedMemory(system_shared_memory *memory, const char *name, size_t size)
+{
+    return mapSharedMemory(memory, name, size, false);
+}
+
+void closeSharedMemory(system_shared_memory *memory)
+{
+    if (memory->data == NULL)
+    {
+        return;
+    }
+#if defined(_WIN32) // Microsoft compiler
+    UnmapViewOfFile(memory->data);
+    CloseHandle(memory->handle);
+#elif defined(__unix__) // GNU compiler
+    munmap(memory->data, memory->size);
+#endif
+    memory->data = NULL;
+}
+
+void unlinkSharedMemory(const char *name)
+{
+#if defined(_WIN32) // Microsoft compiler
+    // The mapping is released with its last handle
+    (void)name;
+#elif defined(__unix__) // GNU compiler
+    char *full_name = sharedObjectName(name, "");
+    if (full_name != NULL)
+    {
+        shm_unlink(full_name);
+        free(full_name);
+    }
+#endif
+}
+
+void *mapFile(system_mapped_file *file, const char *path, size_t size, bool writable)
+{
+    file->data = NULL;
+    file->size = 0;
+#if defined(_WIN32) // Microsoft compiler
+    // Allow other processes to append while the file is mapped
+    HANDLE handle = CreateFileA(path, writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                                writable ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        return NULL;
+    }
+    LARGE_INTEGER file_size;
+    if (GetFileSizeEx(handle, &file_size))
+    {
+        if (size == 0 || (!writable && (unsigned long long)size > (unsigned long long)file_size.QuadPart))
+        {
+            size = (size_t)file_size.QuadPart;
+        }
+        // The mapping extends a writable file to its size
+        HANDLE mapping = size > 0 ? CreateFileMapping(handle, NULL, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                                      (DWORD)((unsigned long long)size >> 32), (DWORD)size, NULL)
+                                  : NULL;
+        if (mapping != NULL)
+        {
+            file->data = MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+            // The view keeps the mapping alive
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(handle);
+#elif defined(__unix__) // GNU compiler
+    int descriptor = open(path, writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    if (descriptor < 0)
+    {
+        return NULL;
+    }
+    struct stat info;
+    if (fstat(descriptor, &info) == 0)
+    {
+        // Pages beyond the end of a read-only file can not be accessed
+        if (size == 0 || (!writable && (off_t)size > info.st_size))
+        {
+            size = (size_t)info.st_size;
+        }
+        if (writable && (off_t)size > info.st_size && ftruncate(descriptor, (off_t)size) != 0)
+        {
+            size = 0;
+        }
+        void *data = size > 0 ? mmap(NULL, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, descriptor, 0) : MAP_FAILED;
+        file->data = data != MAP_FAILED ? data : NULL;
+    }
+    // The mapping keeps the file alive
+    close(descriptor);
+#endif
+    file->size = file->data != NULL ? size : 0;
+    return file->data;
+}
+
+void unmapFile(system_mapped_file *file)
+{
+    if (file->data == NULL)
+    {
+        return;
+    }
+#if defined(_WIN32) // Microsoft compiler
+    UnmapViewOfFile(file->data);
+#elif defined(__unix__) // GNU compiler
+    munmap(file->data, file->size);
+#endif
+    file->data = NULL;
+    file->size = 0;
+}
+
+int resizeFile(const char *path, size_t size)
+{
+#if defined(_WIN32) // Microsoft compiler
+    HANDLE handle = CreateFileA(path, GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        return -1;
+    }
+    LARGE_INTEGER position;
+    position.QuadPart = (LONGLONG)size;
+    int result = SetFilePointerEx(handle, position, NULL, FILE_BEGIN) && SetEndOfFile(handle) ? 0 : -1;
+    CloseHandle(handle);
+    return result;
+#elif defined(__unix__) // GNU compiler
+    return truncate(path, (off_t)size);
+#endif
+}
+
+system_event createSharedEvent(const char *name, const char *suffix)
+{
+#if defined(_WIN32) // Microsoft compiler
+    char *full_name = sharedObjectName(name, suffix);
+    HANDLE event = full_name != NULL ? CreateEvent(NULL, FALSE, FALSE, full_name) : NULL;
+    free(full_name);
+    return event;
+#elif defined(__unix__) // GNU compiler
+    // Futexes on the shared counter do not need a separate object
+    (void)name;
+    (void)suffix;
+    return 1;
+#endif
+}
+
+system_event openSharedEvent(const char *name, const char *suffix)
+{
+#if defined(_WIN32) // Microsoft compiler
+    char *full_name = sharedObjectName(name, suffix);
+    HANDLE event = full_name != NULL ? OpenEvent(EVENT_MODIFY_STATE | SYNCHRONIZE, FALSE, full_name) : NULL;
+    free(full_name);
+    return event;
+#elif defined(__unix__) // GNU compiler
+    (void)name;
+    (void)suffix;
+    return 1;
+#endif
+}
+
+void closeSharedEvent(system_event event)
+{
+#if defined(_WIN32) // Microsoft compiler
+    if (event != NULL)
+    {
+        CloseHandle(event);
+    }
+#elif defined(__unix__) // GNU compiler
+    (void)event;
+#endif
+}
+
+/*! Spin this many times before blocking, a round trip to another process that is awake takes only a few microseconds. */
+#define COUNTER_SPIN_COUNT 20000
+
+static uint32_t loadCounter(const volatile uint32_t *counter)
+{
+#if defined(_WIN32) // Microsoft compiler
+    uint32_t result = *counter;
+    MemoryBarrier();
+    return result;
+#elif defined(__unix__) // GNU compiler
+    return __atomic_load_n(counter, __ATOMIC_ACQUIRE);
+#endif
+}
+
+void signalCounter(volatile uint32_t *counter, uint32_t value, system_event event)
+{
+#if defined(_WIN32) // Microsoft compiler
+    MemoryBarrier();
+    *counter = value;
+    MemoryBarrier();
+    SetEvent(event);
+#elif defined(__unix__) // GNU compiler
+    (void)event;
+    __atomic_store_n(counter, value, __ATOMIC_RELEASE);
+#if defined(__linux__)
+    syscall(SYS_futex, counter, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+#endif
+}
+
+/*! The number of spins of waitForCounter, 0 until initialized. Spinning only wastes the time slice of the other process on a single processor. */
+static volatile size_t counter_spin_count = 0;
+
+bool waitForCounter(volatile uint32_t *counter, uint32_t expected, unsigned int timeout_ms, system_event event)
+{
+    size_t spin_count = atomicLoad(&counter_spin_count);
+    if (spin_count == 0)
+    {
+        spin_count = getProcessorCount() > 1 ? COUNTER_SPIN_COUNT : 1;
+        atomicStore(&counter_spin_count, spin_count);
+    }
+    for (size_t i = 0; i < spin_count; i++)
+    {
+        if (loadCounter(counter) == expected)
+        {
+            return true;
+        }
+    }
+#if defined(_WIN32) // Microsoft compiler
+    ULONGLONG deadline = GetTickCount64() + timeout_ms;
+    for (;;)
+    {
+        if (loadCounter(counter) == expected)
+        {
+            return true;
+        }
+        ULONGLONG now = GetTickCount64();
+        if (now >= deadline)
+        {
+            return false;
+        }
+        // Auto reset events may wake for earlier signals, so the counter is checked again
+        WaitForSingleObject(event, (DWORD)(deadline - now));
+    }
+#elif defined(__unix__) // GNU compiler
+    (void)event;
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    for (;;)
+    {
+        uint32_t current = loadCounter(counter);
+        if (current == expected)
+        {
+            return true;
+        }
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (now.tv_sec > deadline.tv_sec || (now.tv_sec == deadline.tv_sec && now.tv_nsec >= deadline.tv_nsec))
+        {
+            return false;
+        }
+        struct timespec remaining = {deadline.tv_sec - now.tv_sec, deadline.tv_nsec - now.tv_nsec};
+        if (remaining.tv_nsec < 0)
+        {
+            remaining.tv_sec--;
+            remaining.tv_nsec += 1000000000L;
+        }
+#if defined(__linux__)
+        // Sleeps only while the counter still has the observed value, so no signal is lost
+        syscall(SYS_futex, counter, FUTEX_WAIT, current, &remaining, NULL, 0);
+#else
+        struct timespec pause = {0, 50000};
+        nanosleep(&pause, NULL);
+#endif
+    }
+#endif
+}
+
+int startProcess(system_process *process, const char *executable, const char *const arguments[])
+{
+#if defined(_WIN32) // Microsoft compiler
+    // Build the command line with every argument quoted
+    size_t length = strlen(executable) + 3;
+    for (size_t i = 0; arguments[i] != NULL; i++)
+    {
+        length += strlen(arguments[i]) + 3;
+    }
+    char *command_line = malloc(length + 1);
+    if (command_line == NULL)
+    {
+        return -1;
+    }
+    char *current = command_line;
+    current += sprintf(current, "\"%s\"", executable);
+    for (size_t i = 0; arguments[i] != NULL; i++)
+    {
+        current += sprintf(current, " \"%s\"", arguments[i]);
+    }
+    STARTUPINFO startup_info = {0};
+    startup_info.cb = sizeof(startup_info);
+    PROCESS_INFORMATION process_info;
+    BOOL success = CreateProcess(executable, command_line, NULL, NULL, FALSE, 0, NULL, NULL, &startup_info, &process_info);
+    free(command_line);
+    if (!success)
+    {
+        return -1;
+    }
+    CloseHandle(process_info.hThread);
+    *process = process_info.hProcess;
+    return 0;
+#elif defined(__unix__) // GNU compiler
+    size_t n_arguments = 0;
+    while (arguments[n_arguments] != NULL)
+    {
+        n_arguments++;
+    }
+    char **argv = malloc((n_arguments + 2) * sizeof(char *));
+    if (argv == NULL)
+    {
+        return -1;
+    }
+    argv[0] = (char *)executable;
+    for (size_t i = 0; i < n_arguments; i++)
+    {
+        argv[i + 1] = (char *)arguments[i];
+    }
+    argv[n_arguments + 1] = NULL;
+    int result = posix_spawn(process, executable, NULL, NULL, argv, environ);
+    free(argv);
+    return result;
+#endif
+}
+
+bool isProcessRunning(system_process process)
+{
+#if defined(_WIN32) // Microsoft compiler
+    return WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+#elif defined(__unix__) // GNU compiler
+    int status;
+    return waitpid(process, &status, WNOHANG) == 0;
+#endif
+}
+
+void waitForProcess(system_process process)
+{
+#if defined(_WIN32) // Microsoft compiler
+    WaitForSingleObject(process, INFINITE);
+    CloseHandle(process);
+#elif defined(__unix__) // GNU compiler
+    int status;
+    // Fails if isProcessRunning already reaped the process
+    waitpid(process, &status, 0);
+#endif
+}
+
+void killProcess(system_process process)
+{
+#if defined(_WIN32) // Microsoft compiler
+    TerminateProcess(process, 1);
+#elif defined(__unix__) // GNU compiler
+    kill(process, SIGKILL);
+#endif
+}
+
+bool isProcessIdRunning(unsigned long process_id)
+{
+#if defined(_WIN32) // Microsoft compiler
+    HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, (DWORD)process_id);
+    if (process == NULL)
+    {
+        return false;
+    }
+    bool running = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+    CloseHandle(process);
+    return running;
+#elif defined(__unix__) // GNU compiler
+    return kill((pid_t)process_id, 0) == 0 || errno == EPERM;
+#endif
+}
@@ -4,6 +4,61 @@
     \brief Wrapper for platform specific functions.
 */
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined _WIN32
+#include <windows.h>
+/*! A mutex that can be initialized statically via SYSTEM_MUTEX_INITIALIZER. */
+typedef SRWLOCK system_mutex;
+#define SYSTEM_MUTEX_INITIALIZER SRWLOCK_INIT
+/*! Waits with a system_mutex for a change of shared state. */
+typedef CONDITION_VARIABLE system_condition;
+typedef HANDLE system_thread;
+typedef HANDLE system_process;
+/*! Wakes waiters of a counter in another process. */
+typedef HANDLE system_event;
+/*! Storage class of variables with one instance per thread. */
+#define SYSTEM_THREAD_LOCAL __declspec(thread)
+#else
+#include <pthread.h>
+#include <sys/types.h>
+/*! A mutex that can be initialized statically via SYSTEM_MUTEX_INITIALIZER. */
+typedef pthread_mutex_t system_mutex;
+#define SYSTEM_MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+/*! Waits with a system_mutex for a change of shared state. */
+typedef pthread_cond_t system_condition;
+typedef pthread_t system_thread;
+typedef pid_t system_process;
+/*! Unused, futexes wait on the counter itself. */
+typedef int system_event;
+/*! Storage class of variables with one instance per thread. */
+#define SYSTEM_THREAD_LOCAL __thread
+#endif
+
+/*! Memory mapped into several processes. */
+typedef struct system_shared_memory
+{
+    void *data;
+    size_t size;
+#if defined _WIN32
+    HANDLE handle;
+#endif
+} system_shared_memory;
+
+/*! A file mapped into memory, the mapping stays valid after the file is closed. */
+typedef struct system_mapped_file
+{
+    void *data;
+    size_t size;
+} system_mapped_file;
+
+/*! Called by listDirectory with the name of each entry, without the directory. */
+typedef void (*directory_entry_function)(const char *name, void *context);
+
+/*! The entry point of a thread started by createThread. */
+typedef void (*thread_function)(void *argument);
 
 /*!
     Load the library into the current process. For security reasons a full path is recomended.
@@ -14,3 +69,155 @@ void *loadSharedLibrary(const char *filename);
 void *getFunction(void *handle, const char *function);
 /*! Free the handle to the library. */
 int freeSharedLibrary(void * handle);
+
+/*!
+    Resolve the filename to an absolute path so different spellings of the same file can be compared.
+    \return A string allocated with malloc or NULL if the file does not exist. Free it with free.
+*/
+char *resolvePath(const char *filename);
+
+/*!
+    Get the size and the time of the last modification of the file without opening it.
+    \param modification_time In an unspecified unit, only compare it with other results of this function.
+    \return 0 on success.
+*/
+int getFileStatus(const char *path, uint64_t *size, int64_t *modification_time);
+
+/*!
+    Create the directory if it does not exist yet. The parent directory must exist.
+    \return 0 on success or if the directory already exists.
+*/
+int createDirectory(const char *path);
+/*!
+    Delete the directory including all of its content.
+    \return 0 on success.
+*/
+int removeDirectory(const char *path);
+/*!
+    Call the function for each file and subdirectory of the directory, except . and ..
+    \return 0 on success or -1 if the directory could not be opened.
+*/
+int listDirectory(const char *path, directory_entry_function function, void *context);
+/*!
+    Atomically rename a file or directory. Fails if the target is a directory that is not empty.
+    \return 0 on success.
+*/
+int renamePath(const char *source, const char *target);
+/*! The id of the current process. */
+unsigned long getProcessId(void);
+/*!
+    Get the directory for temporary files without a trailing separator.
+    \return A string allocated with malloc. Free it with free.
+*/
+char *getTempDirectory(void);
+
+/*! Initialize a mutex that has not been initialized statically. */
+void initMutex(system_mutex *mutex);
+/*! Block until the mutex has been acquired. */
+void lockMutex(system_mutex *mutex);
+/*! Release the mutex acquired by lockMutex. */
+void unlockMutex(system_mutex *mutex);
+/*! Release the resources of a mutex initialized by initMutex. */
+void destroyMutex(system_mutex *mutex);
+
+void initCondition(system_condition *condition);
+/*! Release the locked mutex and block until the condition is signaled, the mutex is locked again on return. May wake spuriously. */
+void waitCondition(system_condition *condition, system_mutex *mutex);
+/*! Wake all threads that wait for the condition. */
+void broadcastCondition(system_condition *condition);
+void destroyCondition(system_condition *condition);
+
+/*!
+    Start a thread that runs the function with the argument.
+    \return 0 on success.
+*/
+int createThread(system_thread *thread, thread_function function, void *argument);
+/*! Wait until the thread has finished and release it. */
+void joinThread(system_thread thread);
+/*! The number of logical processors available to the process, at least 1. */
+size_t getProcessorCount(void);
+/*! Nanoseconds of a monotonic clock with an unspecified origin, for measuring durations. */
+uint64_t getMonotonicTime(void);
+
+/*! Block until getMonotonicTime reaches the absolute time in nanoseconds. Returns immediately if it has passed. */
+void sleepUntil(uint64_t monotonic_ns);
+/*!
+    Restrict the calling thread to one logical processor.
+    \return 0 on success.
+*/
+int pinThreadToProcessor(size_t processor);
+/*!
+    Schedule the calling thread with SCHED_FIFO at the priority, which usually requires privileges.
+    On Windows the thread gets THREAD_PRIORITY_TIME_CRITICAL regardless of the priority.
+    \return 0 on success.
+*/
+int setRealtimePriority(int priority);
+/*!
+    Keep all current and future pages of the process in memory, so page faults do not delay time critical threads.
+    The locks are counted process wide, the memory stays locked until each successful call has been undone.
+    \return 0 on success. Not supported on Windows.
+*/
+int lockProcessMemory(void);
+/*! Undo a successful lockProcessMemory, the memory is unlocked by the last one. */
+void unlockProcessMemory(void);
+
+/*! Read a value shared between threads with acquire semantics. */
+size_t atomicLoad(const volatile size_t *value);
+/*! Write a value shared between threads with release semantics. */
+void atomicStore(volatile size_t *target, size_t value);
+/*! Atomically increment the value. \return The incremented value. */
+size_t atomicIncrement(volatile size_t *value);
+
+/*!
+    Create named shared memory that other processes can open. Fails if the name is in use.
+    \return The mapped zero initialized memory or NULL.
+*/
+void *createSharedMemory(system_shared_memory *memory, const char *name, size_t size);
+/*! Map shared memory created by another process. \return NULL if it does not exist. */
+void *openSharedMemory(system_shared_memory *memory, const char *name, size_t size);
+/*! Unmap the memory. */
+void closeSharedMemory(system_shared_memory *memory);
+/*! Remove the name so no other process can open the memory anymore. The mappings stay valid. */
+void unlinkSharedMemory(const char *name);
+
+/*!
+    Map a file into memory, other processes that map the same file share the pages.
+    \param size The number of bytes to map, 0 maps the whole file. Writable files are created or extended to this size.
+    \param writable Map for reading and writing, changes are written back to the file.
+    \return The mapped data or NULL if the file could not be mapped, e.g. a read-only file that is empty.
+*/
+void *mapFile(system_mapped_file *file, const char *path, size_t size, bool writable);
+/*! Unmap the file, unmapping a failed mapping is a no-op. */
+void unmapFile(system_mapped_file *file);
+/*!
+    Truncate or extend the file, e.g. to cut off the space that was reserved for a writable mapping. The file must not be mapped.
+    \return 0 on success.
+*/
+int resizeFile(const char *path, size_t size);
+
+/*! Create the named event that belongs to a counter in shared memory. */
+system_event createSharedEvent(const char *name, const char *suffix);
+/*! Open an event created by another process. */
+system_event openSharedEvent(const char *name, const char *suffix);
+void closeSharedEvent(system_event event);
+/*! Store the value with release semantics and wake a process that waits for it. */
+void signalCounter(volatile uint32_t *counter, uint32_t value, system_event event);
+/*!
+    Wait until the counter has the expected value. Spins briefly before sleeping.
+    \return false if the timeout expired.
+*/
+bool waitForCounter(volatile uint32_t *counter, uint32_t expected, unsigned int timeout_ms, system_event event);
+
+/*!
+    Start the executable with the arguments.
+    \param arguments NULL terminated list of arguments, without the executable.
+    \return 0 on success.
+*/
+int startProcess(system_process *process, const char *executable, const char *const arguments[]);
+/*! False if the process has exited. */
+bool isProcessRunning(system_process process);
+/*! Wait until the process has exited and release it. */
+void waitForProcess(system_process process);
+void killProcess(system_process process);
+/*! Check if the process with the id exists, e.g. to detect that the parent process died. */
+bool isProcessIdRunning(unsigned long process_id);
@@ -0,0 +1,32 @@
+#pragma once
+#include <stdio.h>
+#include <stdlib.h>
+
+/*!
+    \brief Minimal checks for the tests, each test is an executable that is registered with ctest.
+    A failed check is printed and counted, the test continues so one run reports all failures.
+*/
+
+static int n_failures = 0;
+
+#define CHECK(condition)                                                                  \
+    do                                                                                    \
+    {                                                                                     \
+        if (!(condition))                                                                 \
+        {                                                                                 \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            n_failures++;                                                                 \
+        }                                                                                 \
+    } while (0)
+
+/*! \return The exit code of the test. */
+static int report_checks(void)
+{
+    if (n_failures > 0)
+    {
+        fprintf(stderr, "%d checks failed\n", n_failures);
+        return EXIT_FAILURE;
+    }
+    printf("All checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,133 @@
+#include "check.h"
+#include "model_description.h"
+#include <stdint.h>
+#include <string.h>
+
+/*! \brief Parses a valid model description and rejects malformed ones. */
+
+static const char valid_xml[] =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<!-- A comment with <markup> -->\n"
+    "<fmiModelDescription fmiVersion=\"2.0\" modelName=\"Test\" guid=\"{8c4e810f}\" description=\"a &lt; b &amp; c\" "
+    "numberOfEventIndicators=\"1\">\n"
+    "  <CoSimulation modelIdentifier=\"test\" canHandleVariableCommunicationStepSize=\"true\" "
+    "canBeInstantiatedOnlyOncePerProcess=\"true\"/>\n"
+    "  <DefaultExperiment startTime=\"0\" stopTime=\"2.5\"/>\n"
+    "  <ModelVariables>\n"
+    "    <ScalarVariable name=\"x\" valueReference=\"0\" causality=\"output\"><Real start=\"1\"/></ScalarVariable>\n"
+    "    <ScalarVariable name=\"der(x)\" valueReference=\"1\" causality=\"local\"><Real derivative=\"1\"/></ScalarVariable>\n"
+    "    <ScalarVariable name='k' valueReference='2' causality='parameter' variability='fixed'><Integer start='3'/></ScalarVariable>\n"
+    "  </ModelVariables>\n"
+    "  <ModelStructure>\n"
+    "    <Outputs><Unknown index=\"1\"/></Outputs>\n"
+    "    <Derivatives><Unknown index=\"2\" dependencies=\"1 3\"/></Derivatives>\n"
+    "  </ModelStructure>\n"
+    "</fmiModelDescription>\n";
+
+static model_description *parse(const char *xml)
+{
+    return parse_model_description(xml, strlen(xml));
+}
+
+static void test_valid(void)
+{
+    model_description *description = parse(valid_xml);
+    CHECK(description != NULL);
+    if (description == NULL)
+    {
+        return;
+    }
+    CHECK(strcmp(description->guid, "{8c4e810f}") == 0);
+    CHECK(strcmp(description->description, "a < b & c") == 0);
+    CHECK(description->number_of_event_indicators == 1);
+    CHECK(description->co_simulation.available && !description->model_exchange.available);
+    CHECK(description->co_simulation.can_be_instantiated_only_once_per_process);
+    CHECK(description->default_experiment.stop_time_defined && description->default_experiment.stop_time == 2.5);
+    CHECK(!description->default_experiment.tolerance_defined);
+    CHECK(description->n_variables == 3);
+    CHECK(description->variables[0].causality == causality_output && strcmp(description->variables[0].start, "1") == 0);
+    CHECK(description->variables[1].derivative_of == 0);
+    CHECK(description->variables[2].type == variable_integer && description->variables[2].variability == variability_fixed);
+    CHECK(description->number_of_continuous_states == 1);
+    CHECK(description->derivative_indices[0] == 1);
+    CHECK(description->derivative_dependency_offsets[1] == 2);
+    CHECK(description->derivative_dependencies[0] == 0 && description->derivative_dependencies[1] == 2);
+    free_model_description(description);
+}
+
+/*! Each text must be rejected. */
+static void test_malformed(void)
+{
+    static const char *malformed[] = {
+        "",
+        "no markup at all",
+        // Wrong root element
+        "<modelDescription guid=\"1\"/>",
+        // Missing guid
+        "<fmiModelDescription fmiVersion=\"2.0\"/>",
+        // Element that is not closed
+        "<fmiModelDescription guid=\"1\"><ModelVariables></fmiModelDescription>",
+        "<fmiModelDescription guid=\"1\">",
+        // Attribute without value, unquoted value, unterminated value
+        "<fmiModelDescription guid/>",
+        "<fmiModelDescription guid=1/>",
+        "<fmiModelDescription guid=\"1/>",
+        "<fmiModelDescription =\"1\"/>",
+        // Unterminated start and end tags
+        "<fmiModelDescription guid=\"1\"",
+        "<fmiModelDescription guid=\"1\"></fmiModelDescription",
+        // Scalar variable without value reference
+        "<fmiModelDescription guid=\"1\"><ModelVariables><ScalarVariable name=\"x\"/></ModelVariables></fmiModelDescription>",
+        // Derivative index that does not refer to a variable
+        "<fmiModelDescription guid=\"1\"><ModelVariables><ScalarVariable name=\"x\" valueReference=\"0\"/></ModelVariables>"
+        "<ModelStructure><Derivatives><Unknown index=\"2\"/></Derivatives></ModelStructure></fmiModelDescription>",
+        // Dependency that does not refer to a variable
+        "<fmiModelDescription guid=\"1\"><ModelVariables><ScalarVariable name=\"x\" valueReference=\"0\"/></ModelVariables>"
+        "<ModelStructure><Derivatives><Unknown index=\"1\" dependencies=\"5\"/></Derivatives></ModelStructure></fmiModelDescription>",
+        // Derivative attribute that does not refer to a state
+        "<fmiModelDescription guid=\"1\"><ModelVariables><ScalarVariable name=\"x\" valueReference=\"0\"><Real derivative=\"4\"/>"
+        "</ScalarVariable></ModelVariables></fmiModelDescription>",
+    };
+    for (size_t i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++)
+    {
+        model_description *description = parse(malformed[i]);
+        if (description != NULL)
+        {
+            fprintf(stderr, "Accepted malformed model description %zu: %s\n", i, malformed[i]);
+            n_failures++;
+            free_model_description(description);
+        }
+    }
+}
+
+/*! Every prefix of the valid text cuts off the end tag of the root element. */
+static void test_truncated(void)
+{
+    // The last char is a line break after the end tag
+    size_t complete = strlen(valid_xml) - 1;
+    for (size_t length = 0; length < complete; length++)
+    {
+        model_description *description = parse_model_description(valid_xml, length);
+        if (description != NULL)
+        {
+            fprintf(stderr, "Accepted model description truncated to %zu chars\n", length);
+            n_failures++;
+            free_model_description(description);
+        }
+    }
+}
+
+static void test_missing_file(void)
+{
+    CHECK(load_model_description("missing/modelDescription.xml") == NULL);
+    free_model_description(NULL);
+}
+
+int main(void)
+{
+    test_valid();
+    test_malformed();
+    test_truncated();
+    test_missing_file();
+    return report_checks();
+}
@@ -0,0 +1,221 @@
+#include "check.h"
+#include "system_functions.h"
+#include "unzip.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*!
+    \brief Reads and extracts the fixture archives in test/fixtures.
+    fixed.zip and dynamic.zip contain the same 2097 byte text compressed with fixed and dynamic huffman codes.
+    Usage: unzip_test [<fixture directory> [<output directory>]]
+*/
+
+#if !defined(FIXTURE_DIRECTORY)
+#define FIXTURE_DIRECTORY "fixtures"
+#endif
+#if !defined(OUTPUT_DIRECTORY)
+#define OUTPUT_DIRECTORY "."
+#endif
+
+#define STORED_CONTENT "stored content\n"
+#define DEFLATED_SIZE 2097
+
+static const char *fixture_directory = FIXTURE_DIRECTORY;
+static const char *output_directory = OUTPUT_DIRECTORY;
+
+/*! Read the fixture into memory allocated with malloc. */
+static unsigned char *read_fixture(const char *name, size_t *size)
+{
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", fixture_directory, name);
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Could not open %s\n", path);
+        n_failures++;
+        return NULL;
+    }
+    unsigned char *data = NULL;
+    long length = -1;
+    if (fseek(file, 0, SEEK_END) == 0 && (length = ftell(file)) > 0 && fseek(file, 0, SEEK_SET) == 0)
+    {
+        data = malloc((size_t)length);
+        if (data != NULL && fread(data, 1, (size_t)length, file) != (size_t)length)
+        {
+            free(data);
+            data = NULL;
+        }
+    }
+    fclose(file);
+    CHECK(data != NULL);
+    *size = data != NULL ? (size_t)length : 0;
+    return data;
+}
+
+/*! Read the entry from the fixture. \return NULL if the fixture or the entry could not be read. */
+static unsigned char *read_fixture_entry(const char *fixture, const char *name, size_t *size)
+{
+    size_t archive_size;
+    unsigned char *archive = read_fixture(fixture, &archive_size);
+    *size = 0;
+    unsigned char *content = archive != NULL ? read_zip_entry(archive, archive_size, name, size) : NULL;
+    free(archive);
+    return content;
+}
+
+static bool file_exists(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+    return file != NULL;
+}
+
+static void test_stored_entry(void)
+{
+    size_t size;
+    unsigned char *content = read_fixture_entry("stored.zip", "stored.txt", &size);
+    CHECK(content != NULL);
+    CHECK(size == strlen(STORED_CONTENT));
+    CHECK(content != NULL && strcmp((const char *)content, STORED_CONTENT) == 0);
+    free(content);
+}
+
+static void test_fixed_and_dynamic_blocks(void)
+{
+    size_t fixed_size;
+    size_t dynamic_size;
+    // The entries are only returned if their CRC matches
+    unsigned char *fixed = read_fixture_entry("fixed.zip", "fixed.txt", &fixed_size);
+    unsigned char *dynamic = read_fixture_entry("dynamic.zip", "dynamic.txt", &dynamic_size);
+    CHECK(fixed != NULL);
+    CHECK(dynamic != NULL);
+    CHECK(fixed_size == DEFLATED_SIZE && dynamic_size == DEFLATED_SIZE);
+    CHECK(fixed != NULL && dynamic != NULL && memcmp(fixed, dynamic, DEFLATED_SIZE + 1) == 0);
+    free(fixed);
+    free(dynamic);
+}
+
+static void test_missing_entry(void)
+{
+    size_t size;
+    CHECK(read_fixture_entry("stored.zip", "missing.txt", &size) == NULL);
+    CHECK(read_fixture_entry("stored.zip", "stored", &size) == NULL);
+}
+
+static void test_crc_mismatch(void)
+{
+    size_t size;
+    CHECK(read_fixture_entry("crc_mismatch.zip", "stored.txt", &size) == NULL);
+}
+
+static void test_truncated_central_directory(void)
+{
+    size_t size;
+    // The first entry is complete, the second one is cut off
+    unsigned char *first = read_fixture_entry("truncated_directory.zip", "first.txt", &size);
+    CHECK(first != NULL);
+    free(first);
+    CHECK(read_fixture_entry("truncated_directory.zip", "second.txt", &size) == NULL);
+    size_t archive_size;
+    unsigned char *archive = read_fixture("truncated_directory.zip", &archive_size);
+    char directory[1024];
+    snprintf(directory, sizeof(directory), "%s/truncated_directory", output_directory);
+    removeDirectory(directory);
+    CHECK(createDirectory(directory) == 0);
+    CHECK(archive != NULL && !extract_zip(archive, archive_size, directory));
+    free(archive);
+    removeDirectory(directory);
+}
+
+static void test_truncated_archive(void)
+{
+    size_t archive_size;
+    unsigned char *archive = read_fixture("dynamic.zip", &archive_size);
+    size_t size;
+    // Every prefix lacks the end of central directory record or cuts off the data it refers to
+    for (size_t length = 0; archive != NULL && length < archive_size; length++)
+    {
+        unsigned char *content = read_zip_entry(archive, length, "dynamic.txt", &size);
+        CHECK(content == NULL);
+        free(content);
+    }
+    free(archive);
+}
+
+static void test_extract(void)
+{
+    size_t archive_size;
+    unsigned char *archive = read_fixture("dynamic.zip", &archive_size);
+    char directory[1024];
+    snprintf(directory, sizeof(directory), "%s/extracted", output_directory);
+    removeDirectory(directory);
+    CHECK(createDirectory(directory) == 0);
+    CHECK(archive != NULL && extract_zip(archive, archive_size, directory));
+    char path[1100];
+    snprintf(path, sizeof(path), "%s/dynamic.txt", directory);
+    CHECK(file_exists(path));
+    snprintf(path, sizeof(path), "%s/resources/nested.txt", directory);
+    CHECK(file_exists(path));
+    free(archive);
+    removeDirectory(directory);
+}
+
+static void test_parent_directory_entry(void)
+{
+    size_t archive_size;
+    unsigned char *archive = read_fixture("parent_directory.zip", &archive_size);
+    char directory[1024];
+    snprintf(directory, sizeof(directory), "%s/parent_directory", output_directory);
+    removeDirectory(directory);
+    CHECK(createDirectory(directory) == 0);
+    char outside[1100];
+    snprintf(outside, sizeof(outside), "%s/outside.txt", output_directory);
+    remove(outside);
+    CHECK(archive != NULL && !extract_zip(archive, archive_size, directory));
+    CHECK(!file_exists(outside));
+    free(archive);
+    removeDirectory(directory);
+}
+
+static void test_invalid_deflate_streams(void)
+{
+    unsigned char dest[16];
+    // Block type 3 is reserved
+    const unsigned char reserved[] = {0x07};
+    CHECK(!inflate_raw(reserved, sizeof(reserved), dest, sizeof(dest)));
+    // Stored block whose length does not match its complement
+    const unsigned char stored[] = {0x01, 0x04, 0x00, 0x00, 0x00, 'a', 'b', 'c', 'd'};
+    CHECK(!inflate_raw(stored, sizeof(stored), dest, 4));
+    const unsigned char valid[] = {0x01, 0x04, 0x00, 0xfb, 0xff, 'a', 'b', 'c', 'd'};
+    CHECK(inflate_raw(valid, sizeof(valid), dest, 4) && memcmp(dest, "abcd", 4) == 0);
+    // More or less output than expected
+    CHECK(!inflate_raw(valid, sizeof(valid), dest, 3));
+    CHECK(!inflate_raw(valid, sizeof(valid), dest, 5));
+    CHECK(!inflate_raw(valid, sizeof(valid) - 1, dest, 4));
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        fixture_directory = argv[1];
+    }
+    if (argc > 2)
+    {
+        output_directory = argv[2];
+    }
+    test_stored_entry();
+    test_fixed_and_dynamic_blocks();
+    test_missing_entry();
+    test_crc_mismatch();
+    test_truncated_central_directory();
+    test_truncated_archive();
+    test_extract();
+    test_parent_directory_entry();
+    test_invalid_deflate_streams();
+    return report_checks();
+}
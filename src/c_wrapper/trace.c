@@ -0,0 +1,300 @@
+#include "trace.h"
+#include "system_functions.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*! The chars of the copied category of an event, including the \0 char. */
+#define TRACE_CATEGORY_SIZE 32
+/*! The chars of the copied detail of an event, e.g. a log message, including the \0 char. */
+#define TRACE_DETAIL_SIZE 96
+
+typedef struct trace_record
+{
+    uint64_t timestamp_ns;
+    const char *name;
+    const char *instance_name;
+    fmi2Real time;
+    int status;
+    char phase;
+    char category[TRACE_CATEGORY_SIZE];
+    char detail[TRACE_DETAIL_SIZE];
+} trace_record;
+
+/*! The events of one thread, a ring buffer with the thread as producer and flush_trace as consumer. */
+typedef struct trace_buffer
+{
+    /*! The number of records, always a power of two. */
+    size_t capacity;
+    trace_record *records;
+    /*! Index of the next record to be written. Only written by the producer. */
+    volatile size_t head;
+    /*! Index of the first record that has not been flushed. Only written by the consumer. */
+    volatile size_t tail;
+    /*! Total number of dropped events. Only written by the producer. */
+    volatile size_t dropped;
+    /*! The tid of the events, numbered in the order the threads recorded their first event. */
+    size_t thread_index;
+    struct trace_buffer *next;
+} trace_buffer;
+
+/*! Guards the session and the list of buffers. The producers only lock it to register their buffer. */
+static system_mutex trace_mutex = SYSTEM_MUTEX_INITIALIZER;
+/*! The id of the running session, 0 if no session is running. */
+static volatile size_t active_session = 0;
+/*! The id of the last session, the ids are never reused. */
+static size_t last_session = 0;
+static FILE *trace_file = NULL;
+/*! The timestamps are written relative to the start of the session. */
+static uint64_t trace_start_ns = 0;
+static size_t trace_capacity = 0;
+static trace_buffer *trace_buffers = NULL;
+static size_t n_trace_threads = 0;
+/*! Dropped events that have been reported by flush_trace already. */
+static size_t trace_dropped_reported = 0;
+/*! Dropped events of the session until the last flush. */
+static size_t trace_dropped_total = 0;
+
+/*! The buffer of the calling thread and the session it belongs to. */
+static SYSTEM_THREAD_LOCAL trace_buffer *thread_buffer = NULL;
+static SYSTEM_THREAD_LOCAL size_t thread_buffer_session = 0;
+
+bool is_trace_active(void)
+{
+    return atomicLoad(&active_session) != 0;
+}
+
+/*! Get the buffer of the calling thread, it is created for the first event of the thread in a session. */
+static trace_buffer *get_thread_buffer(void)
+{
+    size_t session = atomicLoad(&active_session);
+    if (session == 0)
+    {
+        return NULL;
+    }
+    if (thread_buffer_session == session)
+    {
+        return thread_buffer;
+    }
+    trace_buffer *buffer = calloc(1, sizeof(trace_buffer));
+    trace_record *records = buffer != NULL ? malloc(trace_capacity * sizeof(trace_record)) : NULL;
+    if (records == NULL)
+    {
+        free(buffer);
+        return NULL;
+    }
+    buffer->capacity = trace_capacity;
+    buffer->records = records;
+    lockMutex(&trace_mutex);
+    if (active_session != session)
+    {
+        // Stopped in the meantime
+        unlockMutex(&trace_mutex);
+        free(records);
+        free(buffer);
+        return NULL;
+    }
+    buffer->thread_index = ++n_trace_threads;
+    buffer->next = trace_buffers;
+    trace_buffers = buffer;
+    unlockMutex(&trace_mutex);
+    thread_buffer = buffer;
+    thread_buffer_session = session;
+    return buffer;
+}
+
+/*! Copy the string if it is not NULL, truncating it if it does not fit. */
+static void copy_text(char *target, size_t size, const char *text)
+{
+    target[0] = '\0';
+    if (text != NULL)
+    {
+        strncpy(target, text, size - 1);
+        target[size - 1] = '\0';
+    }
+}
+
+void trace_event(char phase, const char *name, const char *instance_name, fmi2Real time, int status, const char *category, const char *detail)
+{
+    uint64_t now = getMonotonicTime();
+    trace_buffer *buffer = get_thread_buffer();
+    if (buffer == NULL)
+    {
+        return;
+    }
+    size_t head = buffer->head;
+    if (head - atomicLoad(&buffer->tail) >= buffer->capacity)
+    {
+        atomicIncrement(&buffer->dropped);
+        return;
+    }
+    trace_record *record = &buffer->records[head & (buffer->capacity - 1)];
+    record->timestamp_ns = now;
+    record->name = name;
+    record->instance_name = instance_name;
+    record->time = time;
+    record->status = status;
+    record->phase = phase;
+    copy_text(record->category, TRACE_CATEGORY_SIZE, category);
+    copy_text(record->detail, TRACE_DETAIL_SIZE, detail);
+    atomicStore(&buffer->head, head + 1);
+}
+
+/*! Write the string as JSON string literal. */
+static void write_json_string(FILE *file, const char *text)
+{
+    fputc('"', file);
+    for (const unsigned char *c = (const unsigned char *)text; *c != '\0'; c++)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            fputc('\\', file);
+            fputc(*c, file);
+        }
+        else if (*c < 0x20)
+        {
+            fprintf(file, "\\u%04x", *c);
+        }
+        else
+        {
+            fputc(*c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+static const char *status_name(int status)
+{
+    static const char *const names[] = {"fmi2OK", "fmi2Warning", "fmi2Discard", "fmi2Error", "fmi2Fatal", "fmi2Pending"};
+    return status >= 0 && status < (int)(sizeof(names) / sizeof(names[0])) ? names[status] : "unknown";
+}
+
+/*! Write the record as event of the Chrome trace JSON array format, followed by a comma. */
+static void write_record(FILE *file, const trace_record *record, unsigned long process_id, size_t thread_index)
+{
+    fputs("{\"name\":", file);
+    write_json_string(file, record->name);
+    fprintf(file, ",\"cat\":\"fmi\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%lu,\"tid\":%lu", record->phase,
+            (double)(record->timestamp_ns - trace_start_ns) / 1000.0, process_id, (unsigned long)thread_index);
+    if (record->phase == TRACE_INSTANT)
+    {
+        // Scope of the instant event: thread
+        fputs(",\"s\":\"t\"", file);
+    }
+    fputs(",\"args\":{\"instance\":", file);
+    write_json_string(file, record->instance_name != NULL ? record->instance_name : "");
+    fprintf(file, ",\"time\":%.17g", record->time);
+    if (record->status >= 0)
+    {
+        fputs(",\"status\":", file);
+        write_json_string(file, status_name(record->status));
+    }
+    if (record->category[0] != '\0')
+    {
+        fputs(",\"category\":", file);
+        write_json_string(file, record->category);
+    }
+    if (record->detail[0] != '\0')
+    {
+        fputs(",\"detail\":", file);
+        write_json_string(file, record->detail);
+    }
+    fputs("}},\n", file);
+}
+
+/*! Write the buffered events of all threads. Must be called with the trace mutex held. */
+static fmi2Status flush_buffers(void)
+{
+    unsigned long process_id = getProcessId();
+    size_t dropped = 0;
+    for (trace_buffer *buffer = trace_buffers; buffer != NULL; buffer = buffer->next)
+    {
+        size_t head = atomicLoad(&buffer->head);
+        for (size_t i = buffer->tail; i != head; i++)
+        {
+            write_record(trace_file, &buffer->records[i & (buffer->capacity - 1)], process_id, buffer->thread_index);
+        }
+        atomicStore(&buffer->tail, head);
+        dropped += atomicLoad(&buffer->dropped);
+    }
+    trace_dropped_total = dropped;
+    fmi2Status status = fflush(trace_file) == 0 && !ferror(trace_file) ? fmi2OK : fmi2Error;
+    if (status == fmi2OK && dropped > trace_dropped_reported)
+    {
+        // Report each dropped event once
+        trace_dropped_reported = dropped;
+        status = fmi2Warning;
+    }
+    return status;
+}
+
+PUBLIC_EXPORT fmi2Status start_trace(const char *file_name, size_t events_per_thread)
+{
+    size_t capacity = 1;
+    while (capacity < events_per_thread)
+    {
+        capacity *= 2;
+    }
+    lockMutex(&trace_mutex);
+    if (active_session != 0)
+    {
+        unlockMutex(&trace_mutex);
+        return fmi2Error;
+    }
+    trace_file = fopen(file_name, "w");
+    if (trace_file == NULL)
+    {
+        unlockMutex(&trace_mutex);
+        return fmi2Error;
+    }
+    // The closing bracket is optional in the JSON array format, so the file can be loaded after each flush
+    fputs("[\n", trace_file);
+    trace_capacity = capacity;
+    trace_start_ns = getMonotonicTime();
+    n_trace_threads = 0;
+    trace_dropped_reported = 0;
+    trace_dropped_total = 0;
+    atomicStore(&active_session, ++last_session);
+    unlockMutex(&trace_mutex);
+    return fmi2OK;
+}
+
+PUBLIC_EXPORT fmi2Status flush_trace(void)
+{
+    lockMutex(&trace_mutex);
+    fmi2Status status = active_session != 0 ? flush_buffers() : fmi2Error;
+    unlockMutex(&trace_mutex);
+    return status;
+}
+
+PUBLIC_EXPORT fmi2Status stop_trace(void)
+{
+    lockMutex(&trace_mutex);
+    if (active_session == 0)
+    {
+        unlockMutex(&trace_mutex);
+        return fmi2Error;
+    }
+    atomicStore(&active_session, 0);
+    fmi2Status status = flush_buffers();
+    if (status == fmi2OK && trace_dropped_total > 0)
+    {
+        status = fmi2Warning;
+    }
+    // The metadata event closes the array without a trailing comma
+    fprintf(trace_file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%lu,\"args\":{\"name\":\"fmi_wrapper\"}}\n]\n", getProcessId());
+    if (fclose(trace_file) != 0)
+    {
+        status = fmi2Error;
+    }
+    trace_file = NULL;
+    while (trace_buffers != NULL)
+    {
+        trace_buffer *next = trace_buffers->next;
+        free(trace_buffers->records);
+        free(trace_buffers);
+        trace_buffers = next;
+    }
+    unlockMutex(&trace_mutex);
+    return status;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "fmi_wrapper.h"
+
+/*!
+    \brief Recording of the trace events, see start_trace.
+    Each thread writes its events into its own ring buffer without locks, flush_trace is the only consumer.
+    The strings of the events are referenced until they are flushed, except the category and detail which are copied.
+*/
+
+/*! The phases of the Chrome trace event format. */
+#define TRACE_BEGIN 'B'
+#define TRACE_END 'E'
+#define TRACE_INSTANT 'i'
+
+/*! Check if a trace session is running, before preparing the arguments of an event. */
+bool is_trace_active(void);
+/*!
+    Buffer an event of the calling thread. Dropped if the buffer of the thread is full or no session is running.
+    \param name A string that stays valid until the end of the session, e.g. a literal.
+    \param instance_name Must stay valid until the next flush_trace, free_instance flushes before releasing it.
+    \param status Reported in the arguments of the event, pass -1 to omit it.
+    \param category Copied and truncated, e.g. the category of a log message. May be NULL.
+    \param detail Copied and truncated to a short text. May be NULL.
+*/
+void trace_event(char phase, const char *name, const char *instance_name, fmi2Real time, int status, const char *category, const char *detail);
@@ -0,0 +1,664 @@
+#include "unzip.h"
+#include "system_functions.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* **************************************************
+Inflate
+****************************************************/
+
+#define MAX_CODE_BITS 15
+#define MAX_LITERAL_CODES 288
+#define MAX_DISTANCE_CODES 30
+
+/*! Canonical huffman code given by the number of codes per length and the symbols ordered by code. */
+typedef struct huffman
+{
+    unsigned short counts[MAX_CODE_BITS + 1];
+    unsigned short symbols[MAX_LITERAL_CODES];
+} huffman;
+
+typedef struct inflate_state
+{
+    const unsigned char *source;
+    size_t source_size;
+    size_t source_position;
+    /*! Bits that have been read from the source but not consumed yet, LSB first. */
+    uint32_t bit_buffer;
+    int bit_count;
+    unsigned char *dest;
+    size_t dest_size;
+    size_t dest_position;
+    /*! Set when reading beyond the end of the source. */
+    bool overflow;
+} inflate_state;
+
+static const unsigned short length_base[] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                             35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const unsigned short length_extra[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                              3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const unsigned short distance_base[] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                               257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const unsigned short distance_extra[] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                                7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+/*! Order in which the code lengths of the code length code are stored. */
+static const unsigned char code_length_order[] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+/*! Consume count bits from the source, LSB first. */
+static unsigned int read_bits(inflate_state *state, int count)
+{
+    while (state->bit_count < count)
+    {
+        if (state->source_position >= state->source_size)
+        {
+            state->overflow = true;
+            return 0;
+        }
+        state->bit_buffer |= (uint32_t)state->source[state->source_position++] << state->bit_count;
+        state->bit_count += 8;
+    }
+    unsigned int result = state->bit_buffer & ((1u << count) - 1u);
+    state->bit_buffer >>= count;
+    state->bit_count -= count;
+    return result;
+}
+
+/*!
+    Build the canonical huffman code from the code length of each symbol.
+    \return false if the code is over-subscribed.
+*/
+static bool build_huffman(huffman *code, const unsigned char *lengths, int n_symbols)
+{
+    unsigned short offsets[MAX_CODE_BITS + 1];
+    memset(code->counts, 0, sizeof(code->counts));
+    for (int symbol = 0; symbol < n_symbols; symbol++)
+    {
+        code->counts[lengths[symbol]]++;
+    }
+    // Incomplete codes are allowed, e.g. a single distance code
+    int left = 1;
+    for (int length = 1; length <= MAX_CODE_BITS; length++)
+    {
+        left <<= 1;
+        left -= code->counts[length];
+        if (left < 0)
+        {
+            return false;
+        }
+    }
+    offsets[1] = 0;
+    for (int length = 1; length < MAX_CODE_BITS; length++)
+    {
+        offsets[length + 1] = offsets[length] + code->counts[length];
+    }
+    for (int symbol = 0; symbol < n_symbols; symbol++)
+    {
+        if (lengths[symbol] != 0)
+        {
+            code->symbols[offsets[lengths[symbol]]++] = (unsigned short)symbol;
+        }
+    }
+    return true;
+}
+
+/*!
+    Decode one symbol by walking the canonical code one bit at a time.
+    \return The symbol or -1 if the code is invalid.
+*/
+static int decode_symbol(inflate_state *state, const huffman *code)
+{
+    int value = 0;
+    int first = 0;
+    int index = 0;
+    for (int length = 1; length <= MAX_CODE_BITS; length++)
+    {
+        value |= (int)read_bits(state, 1);
+        int count = code->counts[length];
+        if (value - count < first)
+        {
+            return code->symbols[index + (value - first)];
+        }
+        index += count;
+        first += count;
+        first <<= 1;
+        value <<= 1;
+    }
+    return -1;
+}
+
+static bool inflate_stored_block(inflate_state *state)
+{
+    // Stored blocks start at a byte boundary
+    state->bit_buffer = 0;
+    state->bit_count = 0;
+    if (state->source_position + 4 > state->source_size)
+    {
+        return false;
+    }
+    const unsigned char *header = state->source + state->source_position;
+    unsigned int length = header[0] | (header[1] << 8);
+    unsigned int inverted_length = header[2] | (header[3] << 8);
+    state->source_position += 4;
+    if (length != (~inverted_length & 0xffffu) ||
+        state->source_position + length > state->source_size ||
+        state->dest_position + length > state->dest_size)
+    {
+        return false;
+    }
+    memcpy(state->dest + state->dest_position, state->source + state->source_position, length);
+    state->source_position += length;
+    state->dest_position += length;
+    return true;
+}
+
+static bool inflate_codes(inflate_state *state, const huffman *literal_code, const huffman *distance_code)
+{
+    for (;;)
+    {
+        int symbol = decode_symbol(state, literal_code);
+        if (symbol < 0 || state->overflow)
+        {
+            return false;
+        }
+        if (symbol < 256)
+        {
+            if (state->dest_position >= state->dest_size)
+            {
+                return false;
+            }
+            state->dest[state->dest_position++] = (unsigned char)symbol;
+        }
+        else if (symbol == 256)
+        {
+            // End of block
+            return true;
+        }
+        else
+        {
+            symbol -= 257;
+            if (symbol >= (int)(sizeof(length_base) / sizeof(length_base[0])))
+            {
+                return false;
+            }
+            size_t length = length_base[symbol] + read_bits(state, length_extra[symbol]);
+            int distance_symbol = decode_symbol(state, distance_code);
+            if (distance_symbol < 0 || distance_symbol >= MAX_DISTANCE_CODES)
+            {
+                return false;
+            }
+            size_t distance = distance_base[distance_symbol] + read_bits(state, distance_extra[distance_symbol]);
+            if (state->overflow || distance > state->dest_position || state->dest_position + length > state->dest_size)
+            {
+                return false;
+            }
+            // The ranges may overlap, so copy byte by byte
+            unsigned char *target = state->dest + state->dest_position;
+            const unsigned char *source = target - distance;
+            for (size_t i = 0; i < length; i++)
+            {
+                target[i] = source[i];
+            }
+            state->dest_position += length;
+        }
+    }
+}
+
+/*!
+    The fixed codes of RFC 1951 section 3.2.6 as build_huffman would build them. Precomputed so concurrent extractions
+    do not race on building them. Literals 0-143 and 280-287 have 8 bits, 144-255 have 9 bits and 256-279 have 7 bits.
+*/
+static const huffman fixed_literal_code = {
+    {0, 0, 0, 0, 0, 0, 0, 24, 152, 112, 0, 0, 0, 0, 0, 0},
+    {
+        256, 257, 258, 259, 260, 261, 262, 263, 264, 265, 266, 267, 268, 269, 270, 271,
+        272, 273, 274, 275, 276, 277, 278, 279, 0, 1, 2, 3, 4, 5, 6, 7,
+        8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23,
+        24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39,
+        40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55,
+        56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71,
+        72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82, 83, 84, 85, 86, 87,
+        88, 89, 90, 91, 92, 93, 94, 95, 96, 97, 98, 99, 100, 101, 102, 103,
+        104, 105, 106, 107, 108, 109, 110, 111, 112, 113, 114, 115, 116, 117, 118, 119,
+        120, 121, 122, 123, 124, 125, 126, 127, 128, 129, 130, 131, 132, 133, 134, 135,
+        136, 137, 138, 139, 140, 141, 142, 143, 280, 281, 282, 283, 284, 285, 286, 287,
+        144, 145, 146, 147, 148, 149, 150, 151, 152, 153, 154, 155, 156, 157, 158, 159,
+        160, 161, 162, 163, 164, 165, 166, 167, 168, 169, 170, 171, 172, 173, 174, 175,
+        176, 177, 178, 179, 180, 181, 182, 183, 184, 185, 186, 187, 188, 189, 190, 191,
+        192, 193, 194, 195, 196, 197, 198, 199, 200, 201, 202, 203, 204, 205, 206, 207,
+        208, 209, 210, 211, 212, 213, 214, 215, 216, 217, 218, 219, 220, 221, 222, 223,
+        224, 225, 226, 227, 228, 229, 230, 231, 232, 233, 234, 235, 236, 237, 238, 239,
+        240, 241, 242, 243, 244, 245, 246, 247, 248, 249, 250, 251, 252, 253, 254, 255
+    }};
+/*! All 30 distance codes have 5 bits. */
+static const huffman fixed_distance_code = {
+    {0, 0, 0, 0, 0, 30, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29}};
+
+static bool inflate_fixed_block(inflate_state *state)
+{
+    return inflate_codes(state, &fixed_literal_code, &fixed_distance_code);
+}
+
+static bool inflate_dynamic_block(inflate_state *state)
+{
+    unsigned char lengths[MAX_LITERAL_CODES + MAX_DISTANCE_CODES];
+    int n_literal_codes = (int)read_bits(state, 5) + 257;
+    int n_distance_codes = (int)read_bits(state, 5) + 1;
+    int n_code_length_codes = (int)read_bits(state, 4) + 4;
+    if (n_literal_codes > MAX_LITERAL_CODES || n_distance_codes > MAX_DISTANCE_CODES)
+    {
+        return false;
+    }
+    // Read the code that compresses the code lengths
+    memset(lengths, 0, 19);
+    for (int i = 0; i < n_code_length_codes; i++)
+    {
+        lengths[code_length_order[i]] = (unsigned char)read_bits(state, 3);
+    }
+    huffman length_code;
+    if (!build_huffman(&length_code, lengths, 19))
+    {
+        return false;
+    }
+    // Read the code lengths of the literal/length and distance codes
+    int index = 0;
+    while (index < n_literal_codes + n_distance_codes)
+    {
+        int symbol = decode_symbol(state, &length_code);
+        if (symbol < 0 || state->overflow)
+        {
+            return false;
+        }
+        if (symbol < 16)
+        {
+            lengths[index++] = (unsigned char)symbol;
+            continue;
+        }
+        unsigned char repeated = 0;
+        int repeat;
+        if (symbol == 16)
+        {
+            if (index == 0)
+            {
+                return false;
+            }
+            repeated = lengths[index - 1];
+            repeat = 3 + (int)read_bits(state, 2);
+        }
+        else if (symbol == 17)
+        {
+            repeat = 3 + (int)read_bits(state, 3);
+        }
+        else
+        {
+            repeat = 11 + (int)read_bits(state, 7);
+        }
+        if (index + repeat > n_literal_codes + n_distance_codes)
+        {
+            return false;
+        }
+        while (repeat-- > 0)
+        {
+            lengths[index++] = repeated;
+        }
+    }
+    // The end of block code is required
+    if (lengths[256] == 0)
+    {
+        return false;
+    }
+    huffman literal_code;
+    huffman distance_code;
+    if (!build_huffman(&literal_code, lengths, n_literal_codes) ||
+        !build_huffman(&distance_code, lengths + n_literal_codes, n_distance_codes))
+    {
+        return false;
+    }
+    return inflate_codes(state, &literal_code, &distance_code);
+}
+
+bool inflate_raw(const unsigned char *source, size_t source_size, unsigned char *dest, size_t dest_size)
+{
+    inflate_state state = {0};
+    state.source = source;
+    state.source_size = source_size;
+    state.dest = dest;
+    state.dest_size = dest_size;
+    bool last_block = false;
+    while (!last_block)
+    {
+        last_block = read_bits(&state, 1) == 1;
+        unsigned int type = read_bits(&state, 2);
+        bool success;
+        switch (type)
+        {
+        case 0:
+            success = inflate_stored_block(&state);
+            break;
+        case 1:
+            success = inflate_fixed_block(&state);
+            break;
+        case 2:
+            success = inflate_dynamic_block(&state);
+            break;
+        default:
+            success = false;
+            break;
+        }
+        if (!success || state.overflow)
+        {
+            return false;
+        }
+    }
+    return state.dest_position == dest_size;
+}
+
+/* **************************************************
+Zip archive
+****************************************************/
+
+#define END_OF_CENTRAL_DIRECTORY_SIGNATURE 0x06054b50u
+#define END_OF_CENTRAL_DIRECTORY_SIZE 22
+#define CENTRAL_DIRECTORY_SIGNATURE 0x02014b50u
+#define CENTRAL_DIRECTORY_HEADER_SIZE 46
+#define LOCAL_HEADER_SIGNATURE 0x04034b50u
+#define LOCAL_HEADER_SIZE 30
+#define METHOD_STORED 0
+#define METHOD_DEFLATED 8
+#define FLAG_ENCRYPTED 0x0001u
+
+/*! An entry of the central directory. */
+typedef struct zip_entry
+{
+    const char *name;
+    size_t name_length;
+    unsigned int method;
+    unsigned int flags;
+    uint32_t crc;
+    size_t compressed_size;
+    size_t size;
+    size_t local_header_offset;
+} zip_entry;
+
+static uint16_t read_u16(const unsigned char *data)
+{
+    return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+static uint32_t read_u32(const unsigned char *data)
+{
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+/*! The CRC-32 of each byte value for the reflected polynomial 0xedb88320. Precomputed so it is safe to share between threads. */
+static const uint32_t crc32_table[256] = {
+    0x00000000u, 0x77073096u, 0xee0e612cu, 0x990951bau, 0x076dc419u, 0x706af48fu, 0xe963a535u, 0x9e6495a3u,
+    0x0edb8832u, 0x79dcb8a4u, 0xe0d5e91eu, 0x97d2d988u, 0x09b64c2bu, 0x7eb17cbdu, 0xe7b82d07u, 0x90bf1d91u,
+    0x1db71064u, 0x6ab020f2u, 0xf3b97148u, 0x84be41deu, 0x1adad47du, 0x6ddde4ebu, 0xf4d4b551u, 0x83d385c7u,
+    0x136c9856u, 0x646ba8c0u, 0xfd62f97au, 0x8a65c9ecu, 0x14015c4fu, 0x63066cd9u, 0xfa0f3d63u, 0x8d080df5u,
+    0x3b6e20c8u, 0x4c69105eu, 0xd56041e4u, 0xa2677172u, 0x3c03e4d1u, 0x4b04d447u, 0xd20d85fdu, 0xa50ab56bu,
+    0x35b5a8fau, 0x42b2986cu, 0xdbbbc9d6u, 0xacbcf940u, 0x32d86ce3u, 0x45df5c75u, 0xdcd60dcfu, 0xabd13d59u,
+    0x26d930acu, 0x51de003au, 0xc8d75180u, 0xbfd06116u, 0x21b4f4b5u, 0x56b3c423u, 0xcfba9599u, 0xb8bda50fu,
+    0x2802b89eu, 0x5f058808u, 0xc60cd9b2u, 0xb10be924u, 0x2f6f7c87u, 0x58684c11u, 0xc1611dabu, 0xb6662d3du,
+    0x76dc4190u, 0x01db7106u, 0x98d220bcu, 0xefd5102au, 0x71b18589u, 0x06b6b51fu, 0x9fbfe4a5u, 0xe8b8d433u,
+    0x7807c9a2u, 0x0f00f934u, 0x9609a88eu, 0xe10e9818u, 0x7f6a0dbbu, 0x086d3d2du, 0x91646c97u, 0xe6635c01u,
+    0x6b6b51f4u, 0x1c6c6162u, 0x856530d8u, 0xf262004eu, 0x6c0695edu, 0x1b01a57bu, 0x8208f4c1u, 0xf50fc457u,
+    0x65b0d9c6u, 0x12b7e950u, 0x8bbeb8eau, 0xfcb9887cu, 0x62dd1ddfu, 0x15da2d49u, 0x8cd37cf3u, 0xfbd44c65u,
+    0x4db26158u, 0x3ab551ceu, 0xa3bc0074u, 0xd4bb30e2u, 0x4adfa541u, 0x3dd895d7u, 0xa4d1c46du, 0xd3d6f4fbu,
+    0x4369e96au, 0x346ed9fcu, 0xad678846u, 0xda60b8d0u, 0x44042d73u, 0x33031de5u, 0xaa0a4c5fu, 0xdd0d7cc9u,
+    0x5005713cu, 0x270241aau, 0xbe0b1010u, 0xc90c2086u, 0x5768b525u, 0x206f85b3u, 0xb966d409u, 0xce61e49fu,
+    0x5edef90eu, 0x29d9c998u, 0xb0d09822u, 0xc7d7a8b4u, 0x59b33d17u, 0x2eb40d81u, 0xb7bd5c3bu, 0xc0ba6cadu,
+    0xedb88320u, 0x9abfb3b6u, 0x03b6e20cu, 0x74b1d29au, 0xead54739u, 0x9dd277afu, 0x04db2615u, 0x73dc1683u,
+    0xe3630b12u, 0x94643b84u, 0x0d6d6a3eu, 0x7a6a5aa8u, 0xe40ecf0bu, 0x9309ff9du, 0x0a00ae27u, 0x7d079eb1u,
+    0xf00f9344u, 0x8708a3d2u, 0x1e01f268u, 0x6906c2feu, 0xf762575du, 0x806567cbu, 0x196c3671u, 0x6e6b06e7u,
+    0xfed41b76u, 0x89d32be0u, 0x10da7a5au, 0x67dd4accu, 0xf9b9df6fu, 0x8ebeeff9u, 0x17b7be43u, 0x60b08ed5u,
+    0xd6d6a3e8u, 0xa1d1937eu, 0x38d8c2c4u, 0x4fdff252u, 0xd1bb67f1u, 0xa6bc5767u, 0x3fb506ddu, 0x48b2364bu,
+    0xd80d2bdau, 0xaf0a1b4cu, 0x36034af6u, 0x41047a60u, 0xdf60efc3u, 0xa867df55u, 0x316e8eefu, 0x4669be79u,
+    0xcb61b38cu, 0xbc66831au, 0x256fd2a0u, 0x5268e236u, 0xcc0c7795u, 0xbb0b4703u, 0x220216b9u, 0x5505262fu,
+    0xc5ba3bbeu, 0xb2bd0b28u, 0x2bb45a92u, 0x5cb36a04u, 0xc2d7ffa7u, 0xb5d0cf31u, 0x2cd99e8bu, 0x5bdeae1du,
+    0x9b64c2b0u, 0xec63f226u, 0x756aa39cu, 0x026d930au, 0x9c0906a9u, 0xeb0e363fu, 0x72076785u, 0x05005713u,
+    0x95bf4a82u, 0xe2b87a14u, 0x7bb12baeu, 0x0cb61b38u, 0x92d28e9bu, 0xe5d5be0du, 0x7cdcefb7u, 0x0bdbdf21u,
+    0x86d3d2d4u, 0xf1d4e242u, 0x68ddb3f8u, 0x1fda836eu, 0x81be16cdu, 0xf6b9265bu, 0x6fb077e1u, 0x18b74777u,
+    0x88085ae6u, 0xff0f6a70u, 0x66063bcau, 0x11010b5cu, 0x8f659effu, 0xf862ae69u, 0x616bffd3u, 0x166ccf45u,
+    0xa00ae278u, 0xd70dd2eeu, 0x4e048354u, 0x3903b3c2u, 0xa7672661u, 0xd06016f7u, 0x4969474du, 0x3e6e77dbu,
+    0xaed16a4au, 0xd9d65adcu, 0x40df0b66u, 0x37d83bf0u, 0xa9bcae53u, 0xdebb9ec5u, 0x47b2cf7fu, 0x30b5ffe9u,
+    0xbdbdf21cu, 0xcabac28au, 0x53b39330u, 0x24b4a3a6u, 0xbad03605u, 0xcdd70693u, 0x54de5729u, 0x23d967bfu,
+    0xb3667a2eu, 0xc4614ab8u, 0x5d681b02u, 0x2a6f2b94u, 0xb40bbe37u, 0xc30c8ea1u, 0x5a05df1bu, 0x2d02ef8du};
+
+static uint32_t crc32(const unsigned char *data, size_t size)
+{
+    uint32_t crc = 0xffffffffu;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc = crc32_table[(crc ^ data[i]) & 0xffu] ^ (crc >> 8);
+    }
+    return crc ^ 0xffffffffu;
+}
+
+/*!
+    Locate the central directory.
+    \return false if the archive is not a zip file.
+*/
+static bool find_central_directory(const unsigned char *archive, size_t archive_size, size_t *offset, size_t *n_entries)
+{
+    if (archive_size < END_OF_CENTRAL_DIRECTORY_SIZE)
+    {
+        return false;
+    }
+    // The record is followed by a comment of up to 64 kB, so search backwards
+    size_t position = archive_size - END_OF_CENTRAL_DIRECTORY_SIZE;
+    size_t lowest = archive_size > END_OF_CENTRAL_DIRECTORY_SIZE + 0xffffu ? archive_size - END_OF_CENTRAL_DIRECTORY_SIZE - 0xffffu : 0;
+    for (;;)
+    {
+        if (read_u32(archive + position) == END_OF_CENTRAL_DIRECTORY_SIGNATURE)
+        {
+            const unsigned char *record = archive + position;
+            *n_entries = read_u16(record + 10);
+            size_t directory_size = read_u32(record + 12);
+            *offset = read_u32(record + 16);
+            return *offset + directory_size <= position;
+        }
+        if (position == lowest)
+        {
+            return false;
+        }
+        position--;
+    }
+}
+
+/*!
+    Parse the central directory entry at the offset.
+    \return The offset of the next entry or 0 if the entry is corrupt.
+*/
+static size_t read_central_entry(const unsigned char *archive, size_t archive_size, size_t offset, zip_entry *entry)
+{
+    if (offset + CENTRAL_DIRECTORY_HEADER_SIZE > archive_size || read_u32(archive + offset) != CENTRAL_DIRECTORY_SIGNATURE)
+    {
+        return 0;
+    }
+    const unsigned char *header = archive + offset;
+    entry->flags = read_u16(header + 8);
+    entry->method = read_u16(header + 10);
+    entry->crc = read_u32(header + 16);
+    entry->compressed_size = read_u32(header + 20);
+    entry->size = read_u32(header + 24);
+    entry->name_length = read_u16(header + 28);
+    size_t extra_length = read_u16(header + 30);
+    size_t comment_length = read_u16(header + 32);
+    entry->local_header_offset = read_u32(header + 42);
+    entry->name = (const char *)header + CENTRAL_DIRECTORY_HEADER_SIZE;
+    size_t next = offset + CENTRAL_DIRECTORY_HEADER_SIZE + entry->name_length + extra_length + comment_length;
+    return next <= archive_size ? next : 0;
+}
+
+/*!
+    Decompress the entry and verify its checksum.
+    \return The content with an additional \0 char, allocated with malloc. NULL if the entry is corrupt.
+*/
+static unsigned char *read_entry_data(const unsigned char *archive, size_t archive_size, const zip_entry *entry)
+{
+    size_t offset = entry->local_header_offset;
+    if ((entry->flags & FLAG_ENCRYPTED) != 0 ||
+        offset + LOCAL_HEADER_SIZE > archive_size || read_u32(archive + offset) != LOCAL_HEADER_SIGNATURE)
+    {
+        return NULL;
+    }
+    // The local header may have a different extra field than the central directory
+    size_t data_offset = offset + LOCAL_HEADER_SIZE + read_u16(archive + offset + 26) + read_u16(archive + offset + 28);
+    if (data_offset + entry->compressed_size > archive_size)
+    {
+        return NULL;
+    }
+    unsigned char *data = malloc(entry->size + 1);
+    if (data == NULL)
+    {
+        return NULL;
+    }
+    bool success = false;
+    if (entry->method == METHOD_STORED)
+    {
+        success = entry->compressed_size == entry->size;
+        if (success)
+        {
+            memcpy(data, archive + data_offset, entry->size);
+        }
+    }
+    else if (entry->method == METHOD_DEFLATED)
+    {
+        success = inflate_raw(archive + data_offset, entry->compressed_size, data, entry->size);
+    }
+    if (!success || crc32(data, entry->size) != entry->crc)
+    {
+        free(data);
+        return NULL;
+    }
+    data[entry->size] = '\0';
+    return data;
+}
+
+unsigned char *read_zip_entry(const unsigned char *archive, size_t archive_size, const char *name, size_t *size)
+{
+    size_t offset;
+    size_t n_entries;
+    if (!find_central_directory(archive, archive_size, &offset, &n_entries))
+    {
+        return NULL;
+    }
+    size_t name_length = strlen(name);
+    for (size_t i = 0; i < n_entries; i++)
+    {
+        zip_entry entry;
+        offset = read_central_entry(archive, archive_size, offset, &entry);
+        if (offset == 0)
+        {
+            return NULL;
+        }
+        if (entry.name_length == name_length && memcmp(entry.name, name, name_length) == 0)
+        {
+            *size = entry.size;
+            return read_entry_data(archive, archive_size, &entry);
+        }
+    }
+    return NULL;
+}
+
+/*! Reject absolute paths and parent directory references that would write outside of the target directory. */
+static bool is_safe_entry_name(const char *name, size_t length)
+{
+    if (length == 0 || name[0] == '/' || name[0] == '\\' || memchr(name, ':', length) != NULL)
+    {
+        return false;
+    }
+    size_t component_start = 0;
+    for (size_t i = 0; i <= length; i++)
+    {
+        if (i == length || name[i] == '/' || name[i] == '\\')
+        {
+            if (i - component_start == 2 && name[component_start] == '.' && name[component_start + 1] == '.')
+            {
+                return false;
+            }
+            component_start = i + 1;
+        }
+    }
+    return true;
+}
+
+/*! Create all the directories of the path below the first base_length chars. */
+static bool create_parent_directories(char *path, size_t base_length)
+{
+    for (char *current = path + base_length + 1; *current != '\0'; current++)
+    {
+        if (*current == '/')
+        {
+            *current = '\0';
+            int result = createDirectory(path);
+            *current = '/';
+            if (result != 0)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool write_file(const char *path, const unsigned char *data, size_t size)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    bool success = fwrite(data, 1, size, file) == size;
+    return fclose(file) == 0 && success;
+}
+
+bool extract_zip(const unsigned char *archive, size_t archive_size, const char *directory)
+{
+    size_t offset;
+    size_t n_entries;
+    if (!find_central_directory(archive, archive_size, &offset, &n_entries))
+    {
+        return false;
+    }
+    size_t directory_length = strlen(directory);
+    for (size_t i = 0; i < n_entries; i++)
+    {
+        zip_entry entry;
+        offset = read_central_entry(archive, archive_size, offset, &entry);
+        if (offset == 0 || !is_safe_entry_name(entry.name, entry.name_length))
+        {
+            return false;
+        }
+        // Build the target path using / which is accepted by all platforms
+        char *path = malloc(directory_length + 1 + entry.name_length + 1);
+        if (path == NULL)
+        {
+            return false;
+        }
+        memcpy(path, directory, directory_length);
+        path[directory_length] = '/';
+        for (size_t c = 0; c < entry.name_length; c++)
+        {
+            path[directory_length + 1 + c] = entry.name[c] == '\\' ? '/' : entry.name[c];
+        }
+        path[directory_length + 1 + entry.name_length] = '\0';
+        bool success = create_parent_directories(path, directory_length);
+        bool is_directory = entry.name[entry.name_length - 1] == '/' || entry.name[entry.name_length - 1] == '\\';
+        if (success && !is_directory)
+        {
+            unsigned char *data = read_entry_data(archive, archive_size, &entry);
+            success = data != NULL && write_file(path, data, entry.size);
+            free(data);
+        }
+        free(path);
+        if (!success)
+        {
+            return false;
+        }
+    }
+    return true;
+}
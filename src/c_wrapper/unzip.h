@@ -0,0 +1,33 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+
+/*!
+    \brief Minimal reader for zip archives as used by fmus.
+    Supports stored and deflated entries without encryption or zip64 extensions.
+*/
+
+/*!
+    Decompress a raw deflate stream (RFC 1951).
+    \param dest Receives exactly dest_size bytes.
+    \return false if the stream is invalid or does not decompress to dest_size bytes.
+*/
+bool inflate_raw(const unsigned char *source, size_t source_size, unsigned char *dest, size_t dest_size);
+
+/*!
+    Read a file from the archive into memory.
+    \param archive The content of the zip file.
+    \param name The path of the entry inside the archive, e.g. "modelDescription.xml".
+    \param size Receives the size of the returned content.
+    \return The content of the entry with an additional \0 char, allocated with malloc. NULL if the entry does not exist or is corrupt.
+*/
+unsigned char *read_zip_entry(const unsigned char *archive, size_t archive_size, const char *name, size_t *size);
+
+/*!
+    Extract all entries of the archive into the directory, creating subdirectories as needed.
+    Entries with absolute paths or ".." components are rejected.
+    \param archive The content of the zip file.
+    \param directory An existing directory.
+    \return false if the archive is corrupt or a file could not be written.
+*/
+bool extract_zip(const unsigned char *archive, size_t archive_size, const char *directory);
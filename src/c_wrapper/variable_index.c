@@ -0,0 +1,359 @@
+#include "variable_index.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*! Identifies index files. */
+static const char INDEX_MAGIC[8] = {'F', 'M', 'I', 'V', 'I', 'D', 'X', '\0'};
+/*! Increment when the layout of the file changes. */
+#define INDEX_VERSION 1
+/*! Written in native byte order, files from platforms with another byte order are rejected. */
+#define INDEX_BYTE_ORDER 0x01020304u
+/*! Marks an unused slot of the hash table. */
+#define EMPTY_SLOT UINT32_MAX
+
+/*!
+    The layout of the index block and the file:
+    header, entries sorted by name, hash table of entry indices, zero terminated names.
+    All parts are multiples of four bytes except the names at the end.
+*/
+typedef struct index_header
+{
+    char magic[8];
+    uint32_t byte_order;
+    uint32_t version;
+    uint32_t n_entries;
+    /*! A power of two larger than n_entries. */
+    uint32_t table_size;
+    uint32_t names_size;
+    /*! Offset of the guid of the model description in the names. */
+    uint32_t guid_offset;
+} index_header;
+
+typedef struct index_entry
+{
+    uint32_t hash;
+    uint32_t name_offset;
+    uint32_t value_reference;
+    uint8_t type;
+    uint8_t causality;
+    uint8_t variability;
+    uint8_t reserved;
+} index_entry;
+
+struct variable_index
+{
+    /*! The whole block, it starts with the header. */
+    unsigned char *data;
+    size_t size;
+    const index_header *header;
+    const index_entry *entries;
+    const uint32_t *table;
+    const char *names;
+};
+
+/*! FNV-1a, cheap for the short names of variables. */
+static uint32_t hash_name(const char *name)
+{
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *current = (const unsigned char *)name; *current != '\0'; current++)
+    {
+        hash = (hash ^ *current) * 16777619u;
+    }
+    return hash;
+}
+
+/*! Take ownership of the block and set the pointers to its parts. The block must have been validated. */
+static variable_index *wrap_block(unsigned char *data, size_t size)
+{
+    variable_index *index = malloc(sizeof(variable_index));
+    if (index == NULL)
+    {
+        free(data);
+        return NULL;
+    }
+    index->data = data;
+    index->size = size;
+    index->header = (const index_header *)data;
+    index->entries = (const index_entry *)(data + sizeof(index_header));
+    index->table = (const uint32_t *)(index->entries + index->header->n_entries);
+    index->names = (const char *)(index->table + index->header->table_size);
+    return index;
+}
+
+/*! Check that a block read from a file is consistent so lookups never leave it. */
+static bool is_valid_block(const unsigned char *data, size_t size)
+{
+    if (size < sizeof(index_header))
+    {
+        return false;
+    }
+    const index_header *header = (const index_header *)data;
+    if (memcmp(header->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 || header->byte_order != INDEX_BYTE_ORDER ||
+        header->version != INDEX_VERSION || header->table_size <= header->n_entries ||
+        (header->table_size & (header->table_size - 1)) != 0 || header->names_size == 0 ||
+        header->guid_offset >= header->names_size)
+    {
+        return false;
+    }
+    // Compute in 64 bit so corrupt counts can not overflow
+    uint64_t expected_size = sizeof(index_header) + (uint64_t)header->n_entries * sizeof(index_entry) +
+                             (uint64_t)header->table_size * sizeof(uint32_t) + header->names_size;
+    if (expected_size != size)
+    {
+        return false;
+    }
+    const index_entry *entries = (const index_entry *)(data + sizeof(index_header));
+    const uint32_t *table = (const uint32_t *)(entries + header->n_entries);
+    const char *names = (const char *)(table + header->table_size);
+    if (names[header->names_size - 1] != '\0')
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < header->n_entries; i++)
+    {
+        if (entries[i].name_offset >= header->names_size || entries[i].type > variable_enumeration ||
+            entries[i].causality > causality_independent || entries[i].variability > variability_continuous)
+        {
+            return false;
+        }
+    }
+    // Probing stops at an empty slot, so at least one must exist
+    bool has_empty_slot = false;
+    for (uint32_t i = 0; i < header->table_size; i++)
+    {
+        if (table[i] == EMPTY_SLOT)
+        {
+            has_empty_slot = true;
+        }
+        else if (table[i] >= header->n_entries)
+        {
+            return false;
+        }
+    }
+    return has_empty_slot;
+}
+
+/*! A variable while sorting by name. */
+typedef struct sort_item
+{
+    const model_variable *variable;
+    size_t position;
+} sort_item;
+
+static int compare_items(const void *first, const void *second)
+{
+    const sort_item *a = first;
+    const sort_item *b = second;
+    int result = strcmp(a->variable->name, b->variable->name);
+    if (result != 0)
+    {
+        return result;
+    }
+    // Keep the order of the xml for duplicates so the first one wins
+    return a->position < b->position ? -1 : a->position > b->position;
+}
+
+static const index_entry *lookup(const variable_index *index, const char *name)
+{
+    uint32_t hash = hash_name(name);
+    uint32_t mask = index->header->table_size - 1;
+    for (uint32_t slot = hash & mask;; slot = (slot + 1) & mask)
+    {
+        uint32_t entry_index = index->table[slot];
+        if (entry_index == EMPTY_SLOT)
+        {
+            return NULL;
+        }
+        const index_entry *entry = &index->entries[entry_index];
+        if (entry->hash == hash && strcmp(index->names + entry->name_offset, name) == 0)
+        {
+            return entry;
+        }
+    }
+}
+
+PUBLIC_EXPORT variable_index *create_variable_index(const model_description *description)
+{
+    sort_item *items = malloc((description->n_variables + 1) * sizeof(sort_item));
+    if (items == NULL)
+    {
+        return NULL;
+    }
+    for (size_t i = 0; i < description->n_variables; i++)
+    {
+        items[i].variable = &description->variables[i];
+        items[i].position = i;
+    }
+    qsort(items, description->n_variables, sizeof(sort_item), compare_items);
+    // Drop duplicate names and sum up the size of the names
+    size_t n_entries = 0;
+    size_t names_size = strlen(description->guid) + 1;
+    for (size_t i = 0; i < description->n_variables; i++)
+    {
+        if (n_entries == 0 || strcmp(items[n_entries - 1].variable->name, items[i].variable->name) != 0)
+        {
+            items[n_entries++] = items[i];
+            names_size += strlen(items[i].variable->name) + 1;
+        }
+    }
+    // Keep the table at most half full so probe sequences stay short
+    size_t table_size = 2;
+    while (table_size < 2 * n_entries)
+    {
+        table_size *= 2;
+    }
+    size_t size = sizeof(index_header) + n_entries * sizeof(index_entry) + table_size * sizeof(uint32_t) + names_size;
+    unsigned char *data = names_size <= UINT32_MAX && table_size <= UINT32_MAX ? calloc(1, size) : NULL;
+    if (data == NULL)
+    {
+        free(items);
+        return NULL;
+    }
+    index_header *header = (index_header *)data;
+    memcpy(header->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header->byte_order = INDEX_BYTE_ORDER;
+    header->version = INDEX_VERSION;
+    header->n_entries = (uint32_t)n_entries;
+    header->table_size = (uint32_t)table_size;
+    header->names_size = (uint32_t)names_size;
+    index_entry *entries = (index_entry *)(data + sizeof(index_header));
+    uint32_t *table = (uint32_t *)(entries + n_entries);
+    char *names = (char *)(table + table_size);
+    size_t names_offset = 0;
+    for (size_t i = 0; i < n_entries; i++)
+    {
+        const model_variable *variable = items[i].variable;
+        size_t length = strlen(variable->name) + 1;
+        memcpy(names + names_offset, variable->name, length);
+        entries[i].hash = hash_name(variable->name);
+        entries[i].name_offset = (uint32_t)names_offset;
+        entries[i].value_reference = variable->value_reference;
+        entries[i].type = (uint8_t)variable->type;
+        entries[i].causality = (uint8_t)variable->causality;
+        entries[i].variability = (uint8_t)variable->variability;
+        names_offset += length;
+    }
+    memcpy(names + names_offset, description->guid, strlen(description->guid) + 1);
+    header->guid_offset = (uint32_t)names_offset;
+    free(items);
+    for (size_t i = 0; i < table_size; i++)
+    {
+        table[i] = EMPTY_SLOT;
+    }
+    for (uint32_t i = 0; i < n_entries; i++)
+    {
+        uint32_t slot = entries[i].hash & (uint32_t)(table_size - 1);
+        while (table[slot] != EMPTY_SLOT)
+        {
+            slot = (slot + 1) & (uint32_t)(table_size - 1);
+        }
+        table[slot] = i;
+    }
+    return wrap_block(data, size);
+}
+
+PUBLIC_EXPORT void free_variable_index(variable_index *index)
+{
+    if (index == NULL)
+    {
+        return;
+    }
+    free(index->data);
+    free(index);
+}
+
+PUBLIC_EXPORT fmi2Status save_variable_index(const variable_index *index, const char *file_name)
+{
+    FILE *file = fopen(file_name, "wb");
+    if (file == NULL)
+    {
+        return fmi2Error;
+    }
+    bool success = fwrite(index->data, 1, index->size, file) == index->size;
+    success = fclose(file) == 0 && success;
+    return success ? fmi2OK : fmi2Error;
+}
+
+PUBLIC_EXPORT variable_index *load_variable_index(const char *file_name, fmi2String guid)
+{
+    FILE *file = fopen(file_name, "rb");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+    unsigned char *data = NULL;
+    long size = -1;
+    if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) > 0 && fseek(file, 0, SEEK_SET) == 0)
+    {
+        data = malloc((size_t)size);
+        if (data != NULL && fread(data, 1, (size_t)size, file) != (size_t)size)
+        {
+            free(data);
+            data = NULL;
+        }
+    }
+    fclose(file);
+    if (data == NULL || !is_valid_block(data, (size_t)size))
+    {
+        free(data);
+        return NULL;
+    }
+    variable_index *index = wrap_block(data, (size_t)size);
+    if (index != NULL && guid != NULL && strcmp(index->names + index->header->guid_offset, guid) != 0)
+    {
+        free_variable_index(index);
+        return NULL;
+    }
+    return index;
+}
+
+PUBLIC_EXPORT size_t get_variable_index_size(const variable_index *index)
+{
+    return index->header->n_entries;
+}
+
+PUBLIC_EXPORT fmi2Boolean find_variable(const variable_index *index, fmi2String name, indexed_variable *variable)
+{
+    const index_entry *entry = lookup(index, name);
+    if (entry == NULL)
+    {
+        return fmi2False;
+    }
+    variable->value_reference = entry->value_reference;
+    variable->type = (variable_type)entry->type;
+    variable->causality = (variable_causality)entry->causality;
+    variable->variability = (variable_variability)entry->variability;
+    return fmi2True;
+}
+
+PUBLIC_EXPORT size_t resolve_variables(const variable_index *index, size_t n_names, const fmi2String names[],
+                                       fmi2ValueReference value_references[], indexed_variable variables[])
+{
+    size_t n_missing = 0;
+    for (size_t i = 0; i < n_names; i++)
+    {
+        indexed_variable variable;
+        if (find_variable(index, names[i], &variable))
+        {
+            if (value_references != NULL)
+            {
+                value_references[i] = variable.value_reference;
+            }
+            if (variables != NULL)
+            {
+                variables[i] = variable;
+            }
+        }
+        else
+        {
+            if (value_references != NULL)
+            {
+                value_references[i] = INVALID_VALUE_REFERENCE;
+            }
+            n_missing++;
+        }
+    }
+    return n_missing;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "fmi_wrapper.h"
+#include "model_description.h"
+
+/*!
+    \brief Fast lookup of scalar variables by name.
+    The index is a single block of memory that matches its file format, so saving and loading it does not need any parsing.
+*/
+
+/*! A compact name → value reference index built from a model description. */
+typedef struct variable_index variable_index;
+
+/*! The attributes of a variable that are needed to access it. */
+typedef struct indexed_variable
+{
+    fmi2ValueReference value_reference;
+    variable_type type;
+    variable_causality causality;
+    variable_variability variability;
+} indexed_variable;
+
+/*! The value reference reported for names that are not part of the index. */
+#define INVALID_VALUE_REFERENCE ((fmi2ValueReference)-1)
+
+/*!
+    \brief Build the index from the variables of the model description.
+    If a name occurs more than once the first variable is used.
+    \return NULL if the memory could not be allocated.
+*/
+PUBLIC_EXPORT variable_index *create_variable_index(const model_description *description);
+/*! \brief Release the memory of the index. */
+PUBLIC_EXPORT void free_variable_index(variable_index *index);
+/*!
+    \brief Write the index to a file that can be loaded via load_variable_index.
+    The file uses the byte order of the current platform.
+    \return fmi2Error if the file could not be written.
+*/
+PUBLIC_EXPORT fmi2Status save_variable_index(const variable_index *index, const char *file_name);
+/*!
+    \brief Load an index written by save_variable_index.
+    \param guid If not NULL the index is only accepted if it was built for a model description with this guid.
+    \return NULL if the file could not be read, is corrupt or does not match the guid.
+*/
+PUBLIC_EXPORT variable_index *load_variable_index(const char *file_name, fmi2String guid);
+/*! \brief The number of variables in the index. */
+PUBLIC_EXPORT size_t get_variable_index_size(const variable_index *index);
+/*!
+    \brief Look up a single variable.
+    \return fmi2False if the name is not part of the index.
+*/
+PUBLIC_EXPORT fmi2Boolean find_variable(const variable_index *index, fmi2String name, indexed_variable *variable);
+/*!
+    \brief Resolve many names in one call.
+    \param value_references Receives the value reference of each name or INVALID_VALUE_REFERENCE if it is unknown. May be NULL.
+    \param variables Receives the attributes of each name, unknown names are left unchanged. May be NULL.
+    \return The number of names that could not be resolved.
+*/
+PUBLIC_EXPORT size_t resolve_variables(const variable_index *index, size_t n_names, const fmi2String names[],
+                                       fmi2ValueReference value_references[], indexed_variable variables[]);
@@ -1,8 +1,5 @@
 ﻿using System;
 using FmiWrapper_Net;
-using System.IO;
-using System.IO.Compression;
-using System.Xml;
 
 namespace FmiWrapperConsole
 {
@@ -17,35 +14,6 @@ namespace FmiWrapperConsole
         private const double END_TIME = 0.1;
         private const double STEP_SIZE = 0.01;
 
-        private static (string modelIdentifier, string guid) LoadFmu(string fmuPath)
-        {
-            using (var fmuStream = File.OpenRead(fmuPath))
-            {
-                var fmuArchive = new ZipArchive(fmuStream, ZipArchiveMode.Read);
-                var modelDescriptionEntry = fmuArchive.GetEntry("modelDescription.xml");
-                using (var modelDescription = modelDescriptionEntry.Open())
-                {
-                    // Read the xml
-                    var doc = new XmlDocument();
-                    doc.Load(modelDescription);
-                    var modelDescriptionNode = doc.SelectSingleNode("/fmiModelDescription");
-                    var coSimulationNode = doc.SelectSingleNode("/fmiModelDescription/CoSimulation");
-                    var modelIdentifier = coSimulationNode.Attributes["modelIdentifier"].InnerText;
-                    var guid = modelDescriptionNode.Attributes["guid"].InnerText;
-                    // Extract the binary
-                    var binaryEntry = fmuArchive.GetEntry("binaries/win64/" + modelIdentifier + ".dll");
-                    using (var binary = binaryEntry.Open())
-                    {
-                        using (var target = File.Create(modelIdentifier + ".dll"))
-                        {
-                            binary.CopyTo(target);
-                        }
-                    }
-                    return (modelIdentifier, guid);
-                }
-            }
-        }
-
         private static void SetValues(FmuInstance fmu)
         {
             uint[] setRealVr = { 1342177280 };
@@ -95,15 +63,17 @@ namespace FmiWrapperConsole
 
         static void Main(string[] args)
         {
-            // Load model description and extract binary
-            (string modelIdentifier, string guid) = LoadFmu(FMU);
+            // Extract the fmu and parse the model description natively
+            using (var archive = new FmuArchive(FMU))
             // Create the instancr
-            using (var fmu = new FmuInstance(modelIdentifier + ".dll"))
+            using (var fmu = new FmuInstance(archive.GetBinaryPath(Fmi2Type.fmi2CoSimulation)))
             {
+                var modelIdentifier = archive.GetModelIdentifier(Fmi2Type.fmi2CoSimulation);
+                var guid = archive.Guid;
                 // Setup
                 fmu.Log += Fmu_Log;
                 fmu.StepFinished += Fmu_StepFinished;
-                fmu.Instantiate(modelIdentifier + "_Instance", Fmi2Type.fmi2CoSimulation, guid, "", false, true);
+                fmu.Instantiate(modelIdentifier + "_Instance", Fmi2Type.fmi2CoSimulation, guid, archive.ResourceLocation, false, true);
                 Console.WriteLine("Types platform: " + fmu.GetTypesPlatform());
                 Console.WriteLine("Version: " + fmu.GetVersion());
                 fmu.SetupExperiment(false, 0, 0, true,  END_TIME);
@@ -115,7 +85,7 @@ namespace FmiWrapperConsole
                 Simulate(fmu);
                 // Reset crashes the Matlab FMU
                 fmu.FreeInstance();
-                fmu.Instantiate(modelIdentifier + "_Instance", Fmi2Type.fmi2CoSimulation, guid, "", false, true);
+                fmu.Instantiate(modelIdentifier + "_Instance", Fmi2Type.fmi2CoSimulation, guid, archive.ResourceLocation, false, true);
                 //fmu.Reset();
                 fmu.SetupExperiment(false, 0, 0, true, END_TIME);
                 fmu.EnterInitializationMode();
@@ -0,0 +1,38 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace FmiWrapper_Net
+{
+    /// <summary>
+    /// The memory that a pooled instance requested from its pool, see FmuInstance.PooledMemory.
+    /// </summary>
+    public struct AllocationStatistics
+    {
+        public long Allocations;
+        public long Frees;
+        /// <summary>
+        /// The sum of all requested sizes in bytes.
+        /// </summary>
+        public long BytesAllocated;
+        public long BytesInUse;
+        public long PeakBytesInUse;
+        /// <summary>
+        /// The memory that the pool holds, including the free blocks and the bookkeeping.
+        /// </summary>
+        public long BytesReserved;
+    }
+
+    /// <summary>
+    /// Mirrors the native allocation_statistics.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct NativeAllocationStatistics
+    {
+        public UIntPtr nAllocations;
+        public UIntPtr nFrees;
+        public UIntPtr bytesAllocated;
+        public UIntPtr bytesInUse;
+        public UIntPtr peakBytesInUse;
+        public UIntPtr bytesReserved;
+    }
+}
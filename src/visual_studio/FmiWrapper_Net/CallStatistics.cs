@@ -0,0 +1,73 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace FmiWrapper_Net
+{
+    /// <summary>
+    /// The calls of one fmi2 function, see FmuInstance.EnableCallStatistics. The latencies are measured in nanoseconds.
+    /// </summary>
+    public class CallStatistics
+    {
+        private readonly NativeCallStatistics native;
+
+        internal CallStatistics(NativeCallStatistics native)
+        {
+            this.native = native;
+        }
+
+        public long Calls => (long)native.nCalls;
+        public long TotalNanoseconds => (long)native.totalNs;
+        public long MinNanoseconds => (long)native.minNs;
+        public long MaxNanoseconds => (long)native.maxNs;
+
+        /// <summary>
+        /// The number of calls per bucket, see BucketLowerBound.
+        /// </summary>
+        public unsafe long[] Histogram
+        {
+            get
+            {
+                var histogram = new long[NativeCallStatistics.Buckets];
+                fixed (ulong* buckets = native.histogram)
+                {
+                    for (int i = 0; i < histogram.Length; i++)
+                        histogram[i] = (long)buckets[i];
+                }
+                return histogram;
+            }
+        }
+
+        /// <summary>
+        /// Estimates the latency that the percentage of the calls did not exceed, e.g. 99 for the 99th percentile.
+        /// </summary>
+        public long Percentile(double percentile)
+        {
+            var copy = native;
+            return (long)FmiFunctions.GetLatencyPercentile(ref copy, percentile);
+        }
+
+        /// <summary>
+        /// The smallest latency in nanoseconds that is counted in the bucket of the histogram.
+        /// </summary>
+        public static long BucketLowerBound(int bucket) =>
+            (long)FmiFunctions.GetLatencyBucketLowerBound(new UIntPtr((uint)bucket));
+    }
+
+    /// <summary>
+    /// Mirrors the native call_statistics.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal unsafe struct NativeCallStatistics
+    {
+        /// <summary>
+        /// LATENCY_HISTOGRAM_BUCKETS
+        /// </summary>
+        public const int Buckets = 304;
+
+        public ulong nCalls;
+        public ulong totalNs;
+        public ulong minNs;
+        public ulong maxNs;
+        public fixed ulong histogram[Buckets];
+    }
+}
@@ -0,0 +1,148 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace FmiWrapper_Net
+{
+    public enum CosimScheme
+    {
+        /// <summary>
+        /// Steps the instances one after another, each gets the outputs of its predecessors of the same step.
+        /// </summary>
+        GaussSeidel,
+        /// <summary>
+        /// Steps all instances in parallel, each gets the outputs of the previous step.
+        /// </summary>
+        Jacobi
+    }
+
+    /// <summary>
+    /// Connects an output of one instance to an input, the instances are given by their index.
+    /// </summary>
+    public struct CosimConnection
+    {
+        public int SourceInstance;
+        public uint SourceVr;
+        public int TargetInstance;
+        public uint TargetVr;
+        /// <summary>
+        /// Strings are not supported.
+        /// </summary>
+        public VariableType Type;
+
+        public CosimConnection(int sourceInstance, uint sourceVr, int targetInstance, uint targetVr, VariableType type = VariableType.Real)
+        {
+            SourceInstance = sourceInstance;
+            SourceVr = sourceVr;
+            TargetInstance = targetInstance;
+            TargetVr = targetVr;
+            Type = type;
+        }
+    }
+
+    /// <summary>
+    /// Steps coupled co-simulation instances natively and moves the connected values between them.
+    /// </summary>
+    public class CosimMaster : IDisposable
+    {
+        private readonly FmuInstance[] instances;
+        private IntPtr handle;
+
+        /// <summary>
+        /// Creates the master for initialized instances and reads their connected outputs.
+        /// Throws an exception if a connection is invalid or an input is connected twice.
+        /// </summary>
+        /// <param name="instances">They must outlive the master. Jacobi calls their callbacks from its threads.</param>
+        /// <param name="connections"></param>
+        /// <param name="scheme"></param>
+        /// <param name="threads">The threads of Jacobi including the calling thread, 0 uses one per processor.</param>
+        public CosimMaster(FmuInstance[] instances, CosimConnection[] connections, CosimScheme scheme, int threads = 0)
+        {
+            this.instances = instances;
+            var nativeConnections = Array.ConvertAll(connections, (connection) => new NativeCosimConnection
+            {
+                sourceInstance = (UIntPtr)connection.SourceInstance,
+                sourceVr = connection.SourceVr,
+                targetInstance = (UIntPtr)connection.TargetInstance,
+                targetVr = connection.TargetVr,
+                type = connection.Type
+            });
+            var handles = Array.ConvertAll(instances, (instance) => instance.Handle);
+            handle = FmiFunctions.CreateCosimMaster(handles, (UIntPtr)handles.Length, nativeConnections,
+                (UIntPtr)nativeConnections.Length, scheme, (UIntPtr)threads);
+            if (handle == IntPtr.Zero)
+                throw new Exception("Failed to create the co-simulation master");
+        }
+
+        /// <summary>
+        /// Reads the connected outputs again, e.g. after values have been set between the steps.
+        /// </summary>
+        public Fmi2Status ReadOutputs() => FmiFunctions.CosimMasterReadOutputs(handle);
+
+        /// <summary>
+        /// Sets the inputs from the connected outputs and steps all instances once.
+        /// </summary>
+        /// <returns>The most severe status of all calls.</returns>
+        public Fmi2Status DoStep(double currentCommunicationPoint, double communicationStepSize) =>
+            FmiFunctions.CosimMasterDoStep(handle, currentCommunicationPoint, communicationStepSize);
+
+        /// <summary>
+        /// Does several macro steps, stops after the first step that returns an error.
+        /// </summary>
+        public Fmi2Status DoSteps(double startTime, double stepSize, int steps, out int stepsDone)
+        {
+            var result = FmiFunctions.CosimMasterDoSteps(handle, startTime, stepSize, (UIntPtr)steps, out var done);
+            stepsDone = (int)done.ToUInt32();
+            return result;
+        }
+
+        /// <summary>
+        /// The most severe status of the calls of the instance in the last step.
+        /// </summary>
+        public Fmi2Status GetInstanceStatus(int instance) =>
+            FmiFunctions.CosimMasterGetInstanceStatus(handle, (UIntPtr)instance);
+
+        #region IDisposable Support
+        private bool disposedValue = false; // To detect redundant calls
+
+        protected virtual void Dispose(bool disposing)
+        {
+            if (!disposedValue)
+            {
+                // Free unmanaged resources
+                if (handle != IntPtr.Zero)
+                    FmiFunctions.FreeCosimMaster(handle);
+                handle = IntPtr.Zero;
+                // Avoid disposing multiple times
+                disposedValue = true;
+            }
+        }
+
+        ~CosimMaster()
+        {
+            // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
+            Dispose(false);
+        }
+
+        // This code added to correctly implement the disposable pattern.
+        public void Dispose()
+        {
+            // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
+            Dispose(true);
+            GC.SuppressFinalize(this);
+        }
+        #endregion
+    }
+
+    /// <summary>
+    /// Mirrors the native cosim_connection.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct NativeCosimConnection
+    {
+        public UIntPtr sourceInstance;
+        public uint sourceVr;
+        public UIntPtr targetInstance;
+        public uint targetVr;
+        public VariableType type;
+    }
+}
@@ -0,0 +1,174 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace FmiWrapper_Net
+{
+    /// <summary>
+    /// Runs many co-simulations of one fmu on a native worker pool, e.g. for parameter sweeps.
+    /// Each run sets its row of Parameters before the initialization and records the outputs after each step.
+    /// </summary>
+    public class Ensemble
+    {
+        private readonly FmuArchive archive;
+
+        public Ensemble(FmuArchive archive)
+        {
+            this.archive = archive;
+        }
+
+        /// <summary>
+        /// True if the fmu can only be instantiated once per process.
+        /// Run then simulates in host processes if HostExecutable is set, otherwise on a single thread.
+        /// </summary>
+        public bool NeedsProcessSharding => FmiFunctions.EnsembleNeedsProcessSharding(archive.Handle) != 0;
+
+        public string InstanceName { get; set; } = "run";
+        /// <summary>
+        /// Called from the worker threads.
+        /// </summary>
+        public event FmiFunctions.LogCallback Log;
+        public bool LoggingOn { get; set; }
+        public double StartTime { get; set; }
+        public double StepSize { get; set; }
+        /// <summary>
+        /// The number of steps of each run and the number of output rows per run.
+        /// </summary>
+        public int Steps { get; set; }
+        /// <summary>
+        /// Optional individual number of steps for each run, limited to Steps.
+        /// </summary>
+        public int[] RunSteps { get; set; }
+        public int Runs { get; set; }
+        public uint[] ParameterVr { get; set; } = new uint[0];
+        /// <summary>
+        /// Row-major matrix with one row per run and one column per parameter.
+        /// </summary>
+        public double[] Parameters { get; set; } = new double[0];
+        public uint[] OutputVr { get; set; } = new uint[0];
+        /// <summary>
+        /// Keep one instance per worker and reset it between runs.
+        /// </summary>
+        public bool ResetInstances { get; set; }
+        public int ShardIndex { get; set; }
+        /// <summary>
+        /// Only simulate the block ShardIndex of the runs split into Shards blocks. 0 or 1 simulates everything.
+        /// </summary>
+        public int Shards { get; set; }
+        /// <summary>
+        /// Allocate the memory of each instance from its own pool, see FmuInstance.PooledMemory.
+        /// </summary>
+        public bool PooledMemory { get; set; }
+        /// <summary>
+        /// The path of fmi_wrapper_host. If set, fmus that need process sharding run in one host process per instance,
+        /// so Run uses all threads. Set ResetInstances to keep the host of each worker between runs.
+        /// </summary>
+        public string HostExecutable { get; set; }
+
+        /// <summary>
+        /// The outputs of run r and step k start at index (r * Steps + k) * OutputVr.Length.
+        /// </summary>
+        public double[] Outputs { get; private set; }
+        public Fmi2Status[] RunStatus { get; private set; }
+        public int[] RunStepsDone { get; private set; }
+
+        /// <summary>
+        /// Simulates the runs and fills Outputs, RunStatus and RunStepsDone.
+        /// </summary>
+        /// <param name="threads">0 uses one thread per processor.</param>
+        /// <returns>The most severe status of all runs.</returns>
+        public unsafe Fmi2Status Run(int threads = 0)
+        {
+            if (Parameters.Length < Runs * ParameterVr.Length)
+                throw new ArgumentException("The parameter matrix has less than Runs rows");
+            if (RunSteps != null && RunSteps.Length < Runs)
+                throw new ArgumentException("RunSteps has less than Runs entries");
+            Outputs = new double[Runs * Steps * OutputVr.Length];
+            RunStatus = new Fmi2Status[Runs];
+            var runSteps = new UIntPtr[Runs];
+            var stepsDone = new UIntPtr[Runs];
+            for (int i = 0; i < Runs && RunSteps != null; i++)
+                runSteps[i] = (UIntPtr)RunSteps[i];
+            // Keep the delegate alive until the native call returns
+            FmiFunctions.LogCallback logCallback = (instanceName, status, category, message) =>
+                Log?.Invoke(instanceName, status, category, message);
+            var instanceName = Marshal.StringToHGlobalAnsi(InstanceName);
+            var hostExecutable = HostExecutable != null ? Marshal.StringToHGlobalAnsi(HostExecutable) : IntPtr.Zero;
+            try
+            {
+                fixed (uint* parameterVr = ParameterVr)
+                fixed (double* parameters = Parameters)
+                fixed (uint* outputVr = OutputVr)
+                fixed (double* outputs = Outputs)
+                fixed (Fmi2Status* runStatus = RunStatus)
+                fixed (UIntPtr* runStepsPtr = runSteps)
+                fixed (UIntPtr* stepsDonePtr = stepsDone)
+                {
+                    var spec = new NativeEnsembleSpec
+                    {
+                        fmu = archive.Handle,
+                        instanceName = instanceName,
+                        log = Marshal.GetFunctionPointerForDelegate(logCallback),
+                        loggingOn = LoggingOn ? 1 : 0,
+                        startTime = StartTime,
+                        stepSize = StepSize,
+                        nSteps = (UIntPtr)Steps,
+                        runSteps = RunSteps != null ? (IntPtr)runStepsPtr : IntPtr.Zero,
+                        nRuns = (UIntPtr)Runs,
+                        nParameters = (UIntPtr)ParameterVr.Length,
+                        parameterVr = (IntPtr)parameterVr,
+                        parameters = (IntPtr)parameters,
+                        nOutputs = (UIntPtr)OutputVr.Length,
+                        outputVr = (IntPtr)outputVr,
+                        outputs = (IntPtr)outputs,
+                        runStatus = (IntPtr)runStatus,
+                        runStepsDone = (IntPtr)stepsDonePtr,
+                        resetInstances = ResetInstances ? 1 : 0,
+                        shardIndex = (UIntPtr)ShardIndex,
+                        nShards = (UIntPtr)Shards,
+                        pooledMemory = PooledMemory ? 1 : 0,
+                        hostExecutable = hostExecutable
+                    };
+                    var result = FmiFunctions.RunEnsemble(ref spec, (UIntPtr)threads);
+                    GC.KeepAlive(logCallback);
+                    RunStepsDone = Array.ConvertAll(stepsDone, (n) => (int)n.ToUInt32());
+                    return result;
+                }
+            }
+            finally
+            {
+                Marshal.FreeHGlobal(instanceName);
+                Marshal.FreeHGlobal(hostExecutable);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Mirrors the native ensemble_spec.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct NativeEnsembleSpec
+    {
+        public IntPtr fmu;
+        public IntPtr instanceName;
+        public IntPtr log;
+        public int loggingOn;
+        public double startTime;
+        public double stepSize;
+        public UIntPtr nSteps;
+        public IntPtr runSteps;
+        public UIntPtr nRuns;
+        public UIntPtr nParameters;
+        public IntPtr parameterVr;
+        public IntPtr parameters;
+        public UIntPtr nOutputs;
+        public IntPtr outputVr;
+        public IntPtr outputs;
+        public IntPtr runStatus;
+        public IntPtr runStepsDone;
+        public int resetInstances;
+        public UIntPtr shardIndex;
+        public UIntPtr nShards;
+        public int pooledMemory;
+        public IntPtr hostExecutable;
+    }
+}
@@ -23,4 +23,79 @@
         fmi2LastSuccessfulTime,
         fmi2Terminated
     };
+
+    /// <summary>
+    /// The fmi2 functions that the call statistics are recorded for, mirrors the native fmu_function.
+    /// </summary>
+    public enum FmuFunction
+    {
+        SetDebugLogging,
+        SetupExperiment,
+        EnterInitializationMode,
+        ExitInitializationMode,
+        Terminate,
+        Reset,
+        GetReal,
+        GetInteger,
+        GetBoolean,
+        GetString,
+        SetReal,
+        SetInteger,
+        SetBoolean,
+        SetString,
+        GetFmuState,
+        SetFmuState,
+        FreeFmuState,
+        SerializedFmuStateSize,
+        SerializeFmuState,
+        DeserializeFmuState,
+        GetDirectionalDerivative,
+        EnterEventMode,
+        NewDiscreteStates,
+        EnterContinuousTimeMode,
+        CompletedIntegratorStep,
+        SetTime,
+        SetContinuousStates,
+        GetDerivatives,
+        GetEventIndicators,
+        GetContinuousStates,
+        GetNominalsOfContinuousStates,
+        SetRealInputDerivatives,
+        GetRealOutputDerivatives,
+        DoStep,
+        CancelStep,
+        GetStatus,
+        GetRealStatus,
+        GetIntegerStatus,
+        GetBooleanStatus,
+        GetStringStatus
+    };
+
+    public enum VariableType
+    {
+        Real,
+        Integer,
+        Boolean,
+        String,
+        Enumeration
+    };
+
+    public enum VariableCausality
+    {
+        Parameter,
+        CalculatedParameter,
+        Input,
+        Output,
+        Local,
+        Independent
+    };
+
+    public enum VariableVariability
+    {
+        Constant,
+        Fixed,
+        Tunable,
+        Discrete,
+        Continuous
+    };
 }
@@ -25,8 +25,309 @@ namespace FmiWrapper_Net
         /// <param name="status"></param>
         public delegate void StepFinishedCallback(Fmi2Status status);
 
+        #region Loading FMU archives
+
+        /// <summary>
+        /// Extracts the .fmu archive and parses the model description.
+        /// </summary>
+        /// <param name="fileName">The path of the .fmu file.</param>
+        /// <param name="extractDirectory">null uses the extraction cache in the temporary directory.</param>
+        /// <returns>A pointer to the fmu_archive struct. NULL if loading failed.</returns>
+        [DllImport("FmiWrapper.dll", EntryPoint = "load_fmu", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern IntPtr LoadFmu(
+            [MarshalAs(UnmanagedType.LPStr)] string fileName,
+            [MarshalAs(UnmanagedType.LPStr)] string extractDirectory);
+
+        /// <summary>
+        /// Loads the fmu from a cache directory keyed by the SHA-256 hash of the archive.
+        /// Archives that have been extracted before are not extracted again.
+        /// </summary>
+        /// <param name="fileName">The path of the .fmu file.</param>
+        /// <param name="cacheDirectory">null uses the fmi_wrapper subdirectory of the temporary directory.</param>
+        /// <returns>A pointer to the fmu_archive struct. NULL if loading failed.</returns>
+        [DllImport("FmiWrapper.dll", EntryPoint = "load_fmu_cached", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern IntPtr LoadFmuCached(
+            [MarshalAs(UnmanagedType.LPStr)] string fileName,
+            [MarshalAs(UnmanagedType.LPStr)] string cacheDirectory);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "free_fmu", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void FreeFmu(IntPtr fmu);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "load_fmu_variable_index", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern IntPtr LoadFmuVariableIndex(IntPtr fmu);
+
+        /// <summary>
+        /// Loads the variable index from the extraction cache without parsing the model description on warm starts.
+        /// </summary>
+        /// <param name="fileName">The path of the .fmu file.</param>
+        /// <param name="cacheDirectory">null uses the fmi_wrapper subdirectory of the temporary directory.</param>
+        /// <param name="guid">null accepts any guid.</param>
+        /// <returns>A pointer to the variable_index struct. NULL if loading failed.</returns>
+        [DllImport("FmiWrapper.dll", EntryPoint = "load_cached_variable_index", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern IntPtr LoadCachedVariableIndex(
+            [MarshalAs(UnmanagedType.LPStr)] string fileName,
+            [MarshalAs(UnmanagedType.LPStr)] string cacheDirectory,
+            [MarshalAs(UnmanagedType.LPStr)] string guid);
+
+        /// <summary>
+        /// Returns the path of the binary for the current platform.
+        /// </summary>
+        /// <param name="fmu"></param>
+        /// <param name="fmuType"></param>
+        /// <returns>Release the string via FreeFmuString.</returns>
+        [DllImport("FmiWrapper.dll", EntryPoint = "get_fmu_binary_path", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern IntPtr GetFmuBinaryPath(IntPtr fmu, Fmi2Type fmuType);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "free_fmu_string", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void FreeFmuString(IntPtr value);
+
+        #endregion
+
+        #region Variable index
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "free_variable_index", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void FreeVariableIndex(IntPtr index);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "save_variable_index", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status SaveVariableIndex(IntPtr index, [MarshalAs(UnmanagedType.LPStr)] string fileName);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "load_variable_index", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern IntPtr LoadVariableIndex(
+            [MarshalAs(UnmanagedType.LPStr)] string fileName,
+            [MarshalAs(UnmanagedType.LPStr)] string guid);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "get_variable_index_size", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern UIntPtr GetVariableIndexSize(IntPtr index);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "find_variable", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern int FindVariable(IntPtr index, [MarshalAs(UnmanagedType.LPStr)] string name, out IndexedVariable variable);
+
+        /// <summary>
+        /// Resolves many names in one call.
+        /// </summary>
+        /// <returns>The number of names that could not be resolved.</returns>
+        [DllImport("FmiWrapper.dll", EntryPoint = "resolve_variables", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern UIntPtr ResolveVariables(IntPtr index, UIntPtr nNames,
+            [MarshalAs(UnmanagedType.LPArray, ArraySubType = UnmanagedType.LPStr)] string[] names,
+            [Out] uint[] valueReferences, [Out] IndexedVariable[] variables);
+
+        #endregion
+
+        #region Ensembles
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "ensemble_needs_process_sharding", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern int EnsembleNeedsProcessSharding(IntPtr fmu);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "run_ensemble", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status RunEnsemble(ref NativeEnsembleSpec spec, UIntPtr nThreads);
+
+        #endregion
+
+        #region Instance pools
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "create_instance_pool", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern IntPtr CreateInstancePool(ref NativeInstancePoolSpec spec);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "free_instance_pool", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void FreeInstancePool(IntPtr pool);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "acquire_instance", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern IntPtr AcquireInstance(IntPtr pool);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "release_instance", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void ReleaseInstance(IntPtr pool, IntPtr instance);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "get_instance_pool_statistics", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void GetInstancePoolStatistics(IntPtr pool, out NativeInstancePoolStatistics statistics);
+
+        #endregion
+
+        #region Recordings
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "open_recording", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern IntPtr OpenRecording([MarshalAs(UnmanagedType.LPStr)] string fileName);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "close_recording", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void CloseRecording(IntPtr recording);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "get_recording_column_count", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern UIntPtr GetRecordingColumnCount(IntPtr recording);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "get_recording_sample_count", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern UIntPtr GetRecordingSampleCount(IntPtr recording);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "get_recording_decimation", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern UIntPtr GetRecordingDecimation(IntPtr recording);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "get_recording_signal", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status GetRecordingSignal(IntPtr recording, UIntPtr column, out uint vr, out VariableType type);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "read_recording_column", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status ReadRecordingColumn(IntPtr recording, UIntPtr column, UIntPtr firstSample, UIntPtr nSamples, [Out] double[] values);
+
+        #endregion
+
+        #region Output watches
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "create_output_watch", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern IntPtr CreateOutputWatch(UIntPtr nReal, uint[] realVr, UIntPtr nInteger, uint[] integerVr,
+            UIntPtr nBoolean, uint[] booleanVr, double[] absoluteDeadbands, double[] relativeDeadbands);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "free_output_watch", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void FreeOutputWatch(IntPtr watch);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "reset_output_watch", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void ResetOutputWatch(IntPtr watch);
+
+        /// <summary>
+        /// The indices are size_t, so they are marshalled as UIntPtr.
+        /// </summary>
+        [DllImport("FmiWrapper.dll", EntryPoint = "get_changed_outputs", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status GetChangedOutputs(IntPtr wrapper, IntPtr watch, [Out] UIntPtr[] indices, [Out] double[] values,
+            out UIntPtr nChanges);
+
+        #endregion
+
+        #region Co-simulation master
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "create_cosim_master", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern IntPtr CreateCosimMaster(IntPtr[] instances, UIntPtr nInstances, NativeCosimConnection[] connections,
+            UIntPtr nConnections, CosimScheme scheme, UIntPtr nThreads);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "free_cosim_master", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void FreeCosimMaster(IntPtr master);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "cosim_master_read_outputs", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status CosimMasterReadOutputs(IntPtr master);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "cosim_master_do_step", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status CosimMasterDoStep(IntPtr master, double currentCommunicationPoint, double communicationStepSize);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "cosim_master_do_steps", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status CosimMasterDoSteps(IntPtr master, double startTime, double stepSize, UIntPtr nSteps, out UIntPtr nStepsDone);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "cosim_master_get_instance_status", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status CosimMasterGetInstanceStatus(IntPtr master, UIntPtr instance);
+
+        #endregion
+
+        #region Real-time driver
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "create_realtime_driver", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern IntPtr CreateRealtimeDriver(IntPtr wrapper, double startTime, double stepSize, ref NativeRealtimeOptions options,
+            out Fmi2Status setupStatus);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "free_realtime_driver", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void FreeRealtimeDriver(IntPtr driver);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "realtime_do_step", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status RealtimeDoStep(IntPtr driver);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "get_realtime_time", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern double GetRealtimeTime(IntPtr driver);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "get_realtime_statistics", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void GetRealtimeStatistics(IntPtr driver, out NativeRealtimeStatistics statistics,
+            [MarshalAs(UnmanagedType.Bool)] bool reset);
+
+        #endregion
+
+        #region Model Exchange solver
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "create_me_solver", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern IntPtr CreateMeSolver(IntPtr wrapper, UIntPtr nStates, UIntPtr nEventIndicators, ref NativeMeSolverOptions options);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "free_me_solver", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void FreeMeSolver(IntPtr solver);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "me_solver_initialize", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status MeSolverInitialize(IntPtr solver, double startTime);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "me_solver_do_step", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status MeSolverDoStep(IntPtr solver, double currentCommunicationPoint, double communicationStepSize);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "me_solver_get_time", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern double MeSolverGetTime(IntPtr solver);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "me_solver_get_states", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status MeSolverGetStates(IntPtr solver, [Out] double[] x, UIntPtr nx);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "me_solver_get_statistics", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void MeSolverGetStatistics(IntPtr solver, out NativeMeSolverStatistics statistics);
+
+        #endregion
+
+        #region Sparse Jacobian
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "create_sparse_jacobian", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern IntPtr CreateSparseJacobian(IntPtr description);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "free_sparse_jacobian", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void FreeSparseJacobian(IntPtr jacobian);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "evaluate_sparse_jacobian", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status EvaluateSparseJacobian(IntPtr jacobian, IntPtr wrapper,
+            [MarshalAs(UnmanagedType.Bool)] bool useDirectionalDerivatives,
+            double[] x, double[] dx, double[] nominals);
+
+        #endregion
+
+        #region Snapshot store
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "save_snapshot", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status SaveSnapshot([MarshalAs(UnmanagedType.LPStr)] string fileName, IntPtr wrapper,
+            [MarshalAs(UnmanagedType.LPStr)] string guid, double time);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "open_snapshot_store", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern IntPtr OpenSnapshotStore([MarshalAs(UnmanagedType.LPStr)] string fileName);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "close_snapshot_store", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void CloseSnapshotStore(IntPtr store);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "get_snapshot_count", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern UIntPtr GetSnapshotCount(IntPtr store);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "get_snapshot_info", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status GetSnapshotInfo(IntPtr store, UIntPtr index, out NativeSnapshotInfo info);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "find_snapshot", CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        internal static extern bool FindSnapshot(IntPtr store, [MarshalAs(UnmanagedType.LPStr)] string guid, double time, out UIntPtr index);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "restore_snapshot", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status RestoreSnapshot(IntPtr store, UIntPtr index, IntPtr wrapper);
+
+        #endregion
+
         #region Creation and destruction of FMU instances and setting debug status
 
+        /// <summary>
+        /// Loads the binary in a separate host process for each instance, a crashing fmu does not take down the calling process.
+        /// </summary>
+        /// <param name="hostExecutable">The path of the fmi_wrapper_host executable.</param>
+        /// <param name="fileName">The path to the binary.</param>
+        /// <returns>A pointer to the binary. NULL if one of the files does not exist.</returns>
+        [DllImport("FmiWrapper.dll", EntryPoint = "load_binary_out_of_process", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern IntPtr LoadBinaryOutOfProcess(
+            [MarshalAs(UnmanagedType.LPStr)] string hostExecutable,
+            [MarshalAs(UnmanagedType.LPStr)] string fileName);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "free_binary", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void FreeBinary(IntPtr binary);
+
+        /// <summary>
+        /// Creates a new instance of a fmu from a loaded binary. The instance holds its own reference to the binary.
+        /// </summary>
+        /// <returns>A pointer to the instance. NULL if the instantiation failed.</returns>
+        [DllImport("FmiWrapper.dll", EntryPoint = "instantiate_binary", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern IntPtr InstantiateBinary(IntPtr binary,
+            LogCallback logCallback, StepFinishedCallback stepFinishedCallback,
+            [MarshalAs(UnmanagedType.LPStr)] string instanceName, Fmi2Type fmuType,
+            [MarshalAs(UnmanagedType.LPStr)] string guid,
+            [MarshalAs(UnmanagedType.LPStr)] string resourceLocation,
+            [MarshalAs(UnmanagedType.Bool)] bool visible,
+            [MarshalAs(UnmanagedType.Bool)] bool loggingOn);
+
         /// <summary>
         /// Creates a new instance of a fmu.
         /// </summary>
@@ -50,6 +351,61 @@ namespace FmiWrapper_Net
             [MarshalAs(UnmanagedType.Bool)] bool visible,
             [MarshalAs(UnmanagedType.Bool)] bool loggingOn);
 
+        /// <summary>
+        /// Loads the binary in the calling process. The binaries are cached, so loading it again only increments a reference count.
+        /// </summary>
+        /// <returns>A pointer to the binary. NULL if it could not be loaded.</returns>
+        [DllImport("FmiWrapper.dll", EntryPoint = "load_binary", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern IntPtr LoadBinary([MarshalAs(UnmanagedType.LPStr)] string fileName);
+
+        /// <summary>
+        /// Like InstantiateBinary, but the memory of the fmu is allocated from a pool of the instance.
+        /// </summary>
+        /// <returns>A pointer to the instance. NULL if the instantiation failed.</returns>
+        [DllImport("FmiWrapper.dll", EntryPoint = "instantiate_pooled", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern IntPtr InstantiatePooled(IntPtr binary,
+            LogCallback logCallback, StepFinishedCallback stepFinishedCallback,
+            [MarshalAs(UnmanagedType.LPStr)] string instanceName, Fmi2Type fmuType,
+            [MarshalAs(UnmanagedType.LPStr)] string guid,
+            [MarshalAs(UnmanagedType.LPStr)] string resourceLocation,
+            [MarshalAs(UnmanagedType.Bool)] bool visible,
+            [MarshalAs(UnmanagedType.Bool)] bool loggingOn);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "get_allocation_statistics", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status GetAllocationStatistics(IntPtr wrapper, out NativeAllocationStatistics statistics);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "set_call_statistics", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status SetCallStatistics(IntPtr wrapper, [MarshalAs(UnmanagedType.Bool)] bool enabled);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "get_call_statistics", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status GetCallStatistics(IntPtr wrapper, FmuFunction function, out NativeCallStatistics statistics,
+            [MarshalAs(UnmanagedType.Bool)] bool reset);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "get_latency_bucket_lower_bound", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern ulong GetLatencyBucketLowerBound(UIntPtr bucket);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "get_latency_percentile", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern ulong GetLatencyPercentile(ref NativeCallStatistics statistics, double percentile);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "start_trace", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status StartTrace([MarshalAs(UnmanagedType.LPStr)] string fileName, UIntPtr eventsPerThread);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "flush_trace", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status FlushTrace();
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "stop_trace", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status StopTrace();
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "set_tracing", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status SetTracing(IntPtr wrapper, [MarshalAs(UnmanagedType.Bool)] bool enabled);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "start_recording", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status StartRecording(IntPtr wrapper, [MarshalAs(UnmanagedType.LPStr)] string fileName, IntPtr signals,
+            ref NativeRecorderOptions options);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "stop_recording", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status StopRecording(IntPtr wrapper);
+
         /// <summary>
         /// Frees all the resoureces used by this instance.
         /// </summary>
@@ -62,6 +418,41 @@ namespace FmiWrapper_Net
             [MarshalAs(UnmanagedType.Bool)] bool loggingOn, int nCategories,
             [MarshalAs(UnmanagedType.LPArray, ArraySubType = UnmanagedType.LPStr)] string[] categories);
 
+        /// <summary>
+        /// Discards log messages natively before they are formatted.
+        /// </summary>
+        /// <param name="wrapper"></param>
+        /// <param name="minStatus">Messages with a less severe status are discarded.</param>
+        /// <param name="denyCategories">If false only the listed categories are kept, otherwise the listed categories are discarded.</param>
+        /// <param name="nCategories">0 keeps all categories.</param>
+        /// <param name="categories"></param>
+        /// <returns></returns>
+        [DllImport("FmiWrapper.dll", EntryPoint = "set_log_filter", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status SetLogFilter(IntPtr wrapper, Fmi2Status minStatus,
+            [MarshalAs(UnmanagedType.Bool)] bool denyCategories, UIntPtr nCategories,
+            [MarshalAs(UnmanagedType.LPArray, ArraySubType = UnmanagedType.LPStr)] string[] categories);
+
+        /// <summary>
+        /// Buffers the log messages natively instead of calling the log callback during the fmu functions.
+        /// </summary>
+        /// <param name="wrapper"></param>
+        /// <param name="capacity">Maximum number of buffered messages, 0 disables buffering.</param>
+        /// <param name="recordSize">Maximum number of chars per message.</param>
+        /// <returns></returns>
+        [DllImport("FmiWrapper.dll", EntryPoint = "set_log_buffering", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status SetLogBuffering(IntPtr wrapper, UIntPtr capacity, UIntPtr recordSize);
+
+        /// <summary>
+        /// Fetches the oldest buffered log messages.
+        /// </summary>
+        /// <param name="wrapper"></param>
+        /// <param name="records">The strings of the records stay valid until the next call.</param>
+        /// <param name="maxRecords"></param>
+        /// <param name="nDropped">The number of messages dropped since the last call.</param>
+        /// <returns>The number of records written.</returns>
+        [DllImport("FmiWrapper.dll", EntryPoint = "drain_logs", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern UIntPtr DrainLogs(IntPtr wrapper, [Out] LogRecord[] records, UIntPtr maxRecords, out UIntPtr nDropped);
+
         #endregion
 
         #region Inquire version numbers of header files and setting logging status
@@ -146,6 +537,71 @@ namespace FmiWrapper_Net
         internal static extern Fmi2Status SetString(IntPtr wrapper, uint[] vr, UIntPtr nvr,
             [MarshalAs(UnmanagedType.LPArray, ArraySubType = UnmanagedType.LPStr)] string[] value);
 
+        // Pointer overloads for spans, all parameters are blittable so no marshalling code runs
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "get_real", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern unsafe Fmi2Status GetReal(IntPtr wrapper, uint* vr, UIntPtr nvr, double* value);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "get_integer", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern unsafe Fmi2Status GetInteger(IntPtr wrapper, uint* vr, UIntPtr nvr, int* value);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "get_boolean", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern unsafe Fmi2Status GetBoolean(IntPtr wrapper, uint* vr, UIntPtr nvr, int* value);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "get_string", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern unsafe Fmi2Status GetString(IntPtr wrapper, uint* vr, UIntPtr nvr, IntPtr* value);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "set_real", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern unsafe Fmi2Status SetReal(IntPtr wrapper, uint* vr, UIntPtr nvr, double* value);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "set_integer", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern unsafe Fmi2Status SetInteger(IntPtr wrapper, uint* vr, UIntPtr nvr, int* value);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "set_boolean", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern unsafe Fmi2Status SetBoolean(IntPtr wrapper, uint* vr, UIntPtr nvr, int* value);
+
+        /// <summary>
+        /// Copies the value references so the arrays are only marshalled once.
+        /// </summary>
+        /// <returns>A pointer to the signal_group. NULL if the allocation failed.</returns>
+        [DllImport("FmiWrapper.dll", EntryPoint = "create_signal_group", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern IntPtr CreateSignalGroup(UIntPtr nReal, uint[] realVr, UIntPtr nInteger, uint[] integerVr,
+            UIntPtr nBoolean, uint[] booleanVr);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "free_signal_group", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void FreeSignalGroup(IntPtr group);
+
+        /// <summary>
+        /// The arrays are blittable, so they are pinned instead of copied. fmi2Boolean is an int.
+        /// </summary>
+        [DllImport("FmiWrapper.dll", EntryPoint = "group_get", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status GroupGet(IntPtr wrapper, IntPtr group,
+            [Out] double[] realValues, [Out] int[] integerValues, [Out] int[] booleanValues);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "group_set", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status GroupSet(IntPtr wrapper, IntPtr group,
+            double[] realValues, int[] integerValues, int[] booleanValues);
+
+        #endregion
+
+        #region Checkpoints
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "set_checkpoint_capacity", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status SetCheckpointCapacity(IntPtr wrapper, UIntPtr nSlots,
+            [MarshalAs(UnmanagedType.Bool)] bool canGetAndSetFmuState);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "save_checkpoint", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status SaveCheckpoint(IntPtr wrapper, out UIntPtr slot);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "update_checkpoint", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status UpdateCheckpoint(IntPtr wrapper, UIntPtr slot);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "restore_checkpoint", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status RestoreCheckpoint(IntPtr wrapper, UIntPtr slot);
+
+        [DllImport("FmiWrapper.dll", EntryPoint = "release_checkpoint", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status ReleaseCheckpoint(IntPtr wrapper, UIntPtr slot);
+
         #endregion
 
         #region Types for Functions for FMI2 for Model Exchange
@@ -217,6 +673,31 @@ namespace FmiWrapper_Net
         [DllImport("FmiWrapper.dll", EntryPoint = "cancel_step", CallingConvention = CallingConvention.Cdecl)]
         internal static extern Fmi2Status CancelStep(IntPtr wrapper);
 
+        /// <summary>
+        /// Runs multiple communication steps natively.
+        /// </summary>
+        /// <param name="wrapper"></param>
+        /// <param name="startTime">The communication point of the first step.</param>
+        /// <param name="stepSize"></param>
+        /// <param name="nSteps"></param>
+        /// <param name="noSetFmuStatePriorToCurrentPoint">Passed to every step.</param>
+        /// <param name="inputs">The signal_group of the inputs, may be IntPtr.Zero.</param>
+        /// <param name="realInputs">Row-major matrix with nSteps rows and a column per real input. Integers and booleans work the same.</param>
+        /// <param name="integerInputs"></param>
+        /// <param name="booleanInputs"></param>
+        /// <param name="outputs">The signal_group of the outputs, may be IntPtr.Zero.</param>
+        /// <param name="realOutputs">Row-major matrix with nSteps rows and a column per real output. Integers and booleans work the same.</param>
+        /// <param name="integerOutputs"></param>
+        /// <param name="booleanOutputs"></param>
+        /// <param name="nStepsDone">The number of completed steps whose outputs have been read.</param>
+        /// <returns></returns>
+        [DllImport("FmiWrapper.dll", EntryPoint = "do_steps", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern Fmi2Status DoSteps(IntPtr wrapper, double startTime, double stepSize, UIntPtr nSteps,
+            [MarshalAs(UnmanagedType.Bool)] bool noSetFmuStatePriorToCurrentPoint,
+            IntPtr inputs, double[] realInputs, int[] integerInputs, int[] booleanInputs,
+            IntPtr outputs, [Out] double[] realOutputs, [Out] int[] integerOutputs, [Out] int[] booleanOutputs,
+            out UIntPtr nStepsDone);
+
         #endregion
 
         #region Inquire slave status
@@ -0,0 +1,166 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace FmiWrapper_Net
+{
+    /// <summary>
+    /// A .fmu archive that has been extracted and parsed by the native library.
+    /// Disposable pattern ensures that the unmanged resources are freed.
+    /// </summary>
+    public class FmuArchive : IDisposable
+    {
+        private IntPtr archive;
+        private NativeFmuArchive nativeArchive;
+        private NativeModelDescription nativeDescription;
+
+        /// <summary>
+        /// Extracts the archive and parses the model description.
+        /// Throws an exception if the fmu could not be loaded.
+        /// </summary>
+        /// <param name="fileName">The path of the .fmu file.</param>
+        /// <param name="extractDirectory">The target directory, null uses the extraction cache in the temporary directory.</param>
+        public FmuArchive(string fileName, string extractDirectory = null)
+            : this(FmiFunctions.LoadFmu(fileName, extractDirectory), fileName)
+        {
+        }
+
+        /// <summary>
+        /// Loads the fmu from a cache directory keyed by the content hash of the archive.
+        /// Archives that have been extracted before are not extracted again.
+        /// Throws an exception if the fmu could not be loaded.
+        /// </summary>
+        /// <param name="fileName">The path of the .fmu file.</param>
+        /// <param name="cacheDirectory">The cache directory, null uses the temporary directory.</param>
+        public static FmuArchive LoadCached(string fileName, string cacheDirectory = null)
+        {
+            return new FmuArchive(FmiFunctions.LoadFmuCached(fileName, cacheDirectory), fileName);
+        }
+
+        private FmuArchive(IntPtr archive, string fileName)
+        {
+            this.archive = archive;
+            if (archive == IntPtr.Zero)
+                throw new Exception("Failed to load the fmu " + fileName);
+            nativeArchive = Marshal.PtrToStructure<NativeFmuArchive>(archive);
+            nativeDescription = Marshal.PtrToStructure<NativeModelDescription>(nativeArchive.description);
+            Directory = Marshal.PtrToStringAnsi(nativeArchive.directory);
+            ResourceLocation = Marshal.PtrToStringAnsi(nativeArchive.resourceLocation);
+            FmiVersion = Marshal.PtrToStringAnsi(nativeDescription.fmiVersion);
+            ModelName = Marshal.PtrToStringAnsi(nativeDescription.modelName);
+            Guid = Marshal.PtrToStringAnsi(nativeDescription.guid);
+            Variables = ReadVariables();
+        }
+
+        public string Directory { get; }
+        /// <summary>
+        /// The file URI of the resources, pass it to FmuInstance.Instantiate.
+        /// </summary>
+        public string ResourceLocation { get; }
+        public string FmiVersion { get; }
+        public string ModelName { get; }
+        public string Guid { get; }
+        public ModelVariable[] Variables { get; }
+        /// <summary>
+        /// The native model_description, valid until the archive is disposed.
+        /// </summary>
+        internal IntPtr DescriptionHandle => nativeArchive.description;
+
+        /// <summary>
+        /// The modelIdentifier of the interface or null if the fmu does not support the type.
+        /// </summary>
+        /// <param name="fmuType"></param>
+        /// <returns></returns>
+        public string GetModelIdentifier(Fmi2Type fmuType)
+        {
+            var fmuInterface = fmuType == Fmi2Type.fmi2CoSimulation ? nativeDescription.coSimulation : nativeDescription.modelExchange;
+            return fmuInterface.available != 0 ? Marshal.PtrToStringAnsi(fmuInterface.modelIdentifier) : null;
+        }
+
+        /// <summary>
+        /// The path of the binary for the current platform. Pass it to the constructor of FmuInstance.
+        /// </summary>
+        /// <param name="fmuType"></param>
+        /// <returns>null if the fmu does not support the type.</returns>
+        public string GetBinaryPath(Fmi2Type fmuType)
+        {
+            if (archive == IntPtr.Zero)
+                return null;
+            var pathPtr = FmiFunctions.GetFmuBinaryPath(archive, fmuType);
+            if (pathPtr == IntPtr.Zero)
+                return null;
+            var path = Marshal.PtrToStringAnsi(pathPtr);
+            FmiFunctions.FreeFmuString(pathPtr);
+            return path;
+        }
+
+        /// <summary>
+        /// Gets the index to look up value references by name.
+        /// The index is stored next to the extracted files so warm starts only load it.
+        /// </summary>
+        /// <returns></returns>
+        public VariableIndex GetVariableIndex()
+        {
+            return new VariableIndex(this);
+        }
+
+        internal IntPtr Handle => archive;
+
+        internal IntPtr CreateNativeVariableIndex()
+        {
+            return archive != IntPtr.Zero ? FmiFunctions.LoadFmuVariableIndex(archive) : IntPtr.Zero;
+        }
+
+        private ModelVariable[] ReadVariables()
+        {
+            var count = (int)nativeDescription.nVariables.ToUInt32();
+            var variables = new ModelVariable[count];
+            var size = Marshal.SizeOf<NativeModelVariable>();
+            for (int i = 0; i < count; i++)
+            {
+                var native = Marshal.PtrToStructure<NativeModelVariable>(nativeDescription.variables + i * size);
+                variables[i] = new ModelVariable
+                {
+                    Name = Marshal.PtrToStringAnsi(native.name),
+                    ValueReference = native.valueReference,
+                    Type = native.type,
+                    Causality = native.causality,
+                    Variability = native.variability,
+                    Description = native.description != IntPtr.Zero ? Marshal.PtrToStringAnsi(native.description) : null,
+                    Start = native.start != IntPtr.Zero ? Marshal.PtrToStringAnsi(native.start) : null
+                };
+            }
+            return variables;
+        }
+
+        #region IDisposable Support
+        private bool disposedValue = false; // To detect redundant calls
+
+        protected virtual void Dispose(bool disposing)
+        {
+            if (!disposedValue)
+            {
+                // Free unmanaged resources
+                if (archive != IntPtr.Zero)
+                    FmiFunctions.FreeFmu(archive);
+                archive = IntPtr.Zero;
+                // Avoid disposing multiple times
+                disposedValue = true;
+            }
+        }
+
+        ~FmuArchive()
+        {
+            // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
+            Dispose(false);
+        }
+
+        // This code added to correctly implement the disposable pattern.
+        public void Dispose()
+        {
+            // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
+            Dispose(true);
+            GC.SuppressFinalize(this);
+        }
+        #endregion
+    }
+}
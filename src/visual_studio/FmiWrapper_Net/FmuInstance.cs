@@ -11,7 +11,15 @@ namespace FmiWrapper_Net
     public class FmuInstance : IDisposable
     {
         private readonly string fileName;
+        private readonly string hostExecutable;
         private IntPtr wrapper;
+        // The pool that the instance is handed back to, null if it has been instantiated by this object
+        private InstancePool pool;
+
+        /// <summary>
+        /// The native instance, IntPtr.Zero if not instantiated.
+        /// </summary>
+        internal IntPtr Handle => wrapper;
 
         // Log event to wrap callback
         private FmiFunctions.LogCallback logCallback;
@@ -33,6 +41,32 @@ namespace FmiWrapper_Net
             this.fileName = fileName;
         }
 
+        /// <summary>
+        /// Runs the fmu in a separate host process. A crash of the fmu only terminates the host,
+        /// the functions return Fmi2Status.fmi2Fatal afterwards.
+        /// </summary>
+        /// <param name="fileName">The path to the binary of the fmu.</param>
+        /// <param name="hostExecutable">The path of the fmi_wrapper_host executable.</param>
+        public FmuInstance(string fileName, string hostExecutable) : this(fileName)
+        {
+            this.hostExecutable = hostExecutable;
+        }
+
+        /// <summary>
+        /// An instance acquired from the pool, FreeInstance hands it back.
+        /// </summary>
+        internal FmuInstance(string fileName, IntPtr wrapper, InstancePool pool) : this(fileName)
+        {
+            this.wrapper = wrapper;
+            this.pool = pool;
+        }
+
+        /// <summary>
+        /// Allocate the memory of the fmu from a pool of the instance, which is released at once by FreeInstance.
+        /// Must be set before Instantiate. Has no effect for fmus that run in a host process.
+        /// </summary>
+        public bool PooledMemory { get; set; }
+
         #region Creation and destruction of FMU instances and setting debug status
 
         /// <summary>
@@ -54,8 +88,26 @@ namespace FmiWrapper_Net
                 // Load the model instance
                 logCallback = new FmiFunctions.LogCallback(OnLog);
                 stepFinishedCallback = new FmiFunctions.StepFinishedCallback(OnStepFinished);
-                wrapper = FmiFunctions.Instantiate(fileName, logCallback, stepFinishedCallback,
-                    instanceName, fmuType, guid, resourceLocation, visible, loggingOn);
+                if (hostExecutable == null && !PooledMemory)
+                {
+                    wrapper = FmiFunctions.Instantiate(fileName, logCallback, stepFinishedCallback,
+                        instanceName, fmuType, guid, resourceLocation, visible, loggingOn);
+                }
+                else
+                {
+                    var binary = hostExecutable == null ? FmiFunctions.LoadBinary(fileName) :
+                        FmiFunctions.LoadBinaryOutOfProcess(hostExecutable, fileName);
+                    if (binary != IntPtr.Zero)
+                    {
+                        wrapper = PooledMemory ?
+                            FmiFunctions.InstantiatePooled(binary, logCallback, stepFinishedCallback,
+                                instanceName, fmuType, guid, resourceLocation, visible, loggingOn) :
+                            FmiFunctions.InstantiateBinary(binary, logCallback, stepFinishedCallback,
+                                instanceName, fmuType, guid, resourceLocation, visible, loggingOn);
+                        // The instance holds its own reference
+                        FmiFunctions.FreeBinary(binary);
+                    }
+                }
                 if (wrapper == IntPtr.Zero)
                 {
                     // Zero is returned when instantiation failed.
@@ -64,11 +116,170 @@ namespace FmiWrapper_Net
             }
         }
 
+        /// <summary>
+        /// Releases the instance, instances acquired from an InstancePool are handed back to it.
+        /// </summary>
         public void FreeInstance()
         {
-            if (wrapper != IntPtr.Zero)
+            if (wrapper != IntPtr.Zero && pool != null)
+                pool.Release(wrapper);
+            else if (wrapper != IntPtr.Zero)
                 FmiFunctions.FreeInstance(wrapper);
             wrapper = IntPtr.Zero;
+            pool = null;
+        }
+
+        /// <summary>
+        /// Records the number of calls and a latency histogram for each fmi2 function.
+        /// Enabling starts with empty statistics, disabling discards them.
+        /// </summary>
+        public Fmi2Status EnableCallStatistics(bool enabled)
+        {
+            if (wrapper != IntPtr.Zero)
+                return FmiFunctions.SetCallStatistics(wrapper, enabled);
+            else
+                return Fmi2Status.fmi2Fatal;
+        }
+
+        /// <summary>
+        /// Gets a snapshot of the call statistics of the function, see EnableCallStatistics.
+        /// </summary>
+        /// <param name="reset">Start over after the snapshot, so consecutive snapshots do not overlap.</param>
+        /// <returns>Null if the call statistics are not enabled.</returns>
+        public CallStatistics GetCallStatistics(FmuFunction function, bool reset = false)
+        {
+            if (wrapper == IntPtr.Zero || FmiFunctions.GetCallStatistics(wrapper, function, out var native, reset) != Fmi2Status.fmi2OK)
+                return null;
+            return new CallStatistics(native);
+        }
+
+        /// <summary>
+        /// Records trace events of this instance while a trace session is running, see FmuTrace.Start.
+        /// </summary>
+        public Fmi2Status EnableTracing(bool enabled)
+        {
+            if (wrapper != IntPtr.Zero)
+                return FmiFunctions.SetTracing(wrapper, enabled);
+            else
+                return Fmi2Status.fmi2Fatal;
+        }
+
+        /// <summary>
+        /// Records the signals of the group after each step into a columnar memory mapped file, see Recording.
+        /// The current values are recorded immediately.
+        /// </summary>
+        /// <param name="fileName">The file is overwritten.</param>
+        /// <param name="signals">Copied, it may be disposed while recording.</param>
+        /// <param name="decimation">Record every n-th step.</param>
+        /// <param name="samplesPerBlock">The samples that are buffered before they are written, 0 selects the default.</param>
+        /// <param name="compress">Store each value as XOR with its predecessor.</param>
+        public Fmi2Status StartRecording(string fileName, SignalGroup signals, int decimation = 1, int samplesPerBlock = 0, bool compress = false)
+        {
+            var options = new NativeRecorderOptions
+            {
+                decimation = (UIntPtr)decimation,
+                samplesPerBlock = (UIntPtr)samplesPerBlock,
+                compress = compress ? 1 : 0
+            };
+            if (wrapper != IntPtr.Zero)
+                return FmiFunctions.StartRecording(wrapper, fileName, signals.Handle, ref options);
+            else
+                return Fmi2Status.fmi2Fatal;
+        }
+
+        /// <summary>
+        /// Writes the buffered samples and closes the file, disposing the instance stops the recording as well.
+        /// </summary>
+        /// <returns>fmi2Error if samples have been lost.</returns>
+        public Fmi2Status StopRecording()
+        {
+            if (wrapper != IntPtr.Zero)
+                return FmiFunctions.StopRecording(wrapper);
+            else
+                return Fmi2Status.fmi2Fatal;
+        }
+
+        /// <summary>
+        /// Gets the counters of the memory pool, see PooledMemory.
+        /// </summary>
+        /// <returns>Fmi2Status.fmi2Error if the instance does not use a pool.</returns>
+        public Fmi2Status GetAllocationStatistics(out AllocationStatistics statistics)
+        {
+            statistics = new AllocationStatistics();
+            if (wrapper == IntPtr.Zero)
+                return Fmi2Status.fmi2Fatal;
+            var result = FmiFunctions.GetAllocationStatistics(wrapper, out var native);
+            if (result == Fmi2Status.fmi2OK)
+            {
+                statistics.Allocations = (long)native.nAllocations.ToUInt64();
+                statistics.Frees = (long)native.nFrees.ToUInt64();
+                statistics.BytesAllocated = (long)native.bytesAllocated.ToUInt64();
+                statistics.BytesInUse = (long)native.bytesInUse.ToUInt64();
+                statistics.PeakBytesInUse = (long)native.peakBytesInUse.ToUInt64();
+                statistics.BytesReserved = (long)native.bytesReserved.ToUInt64();
+            }
+            return result;
+        }
+
+        /// <summary>
+        /// Discards log messages natively before they are formatted or forwarded to the Log event.
+        /// Must not be called while another thread executes a function of the fmu.
+        /// </summary>
+        /// <param name="minStatus">Messages with a less severe status are discarded.</param>
+        /// <param name="denyCategories">If false only the listed categories are kept, otherwise the listed categories are discarded.</param>
+        /// <param name="categories">An empty array keeps all categories.</param>
+        /// <returns></returns>
+        public Fmi2Status SetLogFilter(Fmi2Status minStatus, bool denyCategories, string[] categories)
+        {
+            if (wrapper != IntPtr.Zero)
+                return FmiFunctions.SetLogFilter(wrapper, minStatus, denyCategories, new UIntPtr((uint)categories.Length), categories);
+            else
+                return Fmi2Status.fmi2Fatal;
+        }
+
+        /// <summary>
+        /// Buffers the log messages natively so the fmu does not call into managed code while simulating.
+        /// Call DrainLogs to raise the Log event for the buffered messages.
+        /// </summary>
+        /// <param name="capacity">Maximum number of buffered messages, 0 disables buffering.</param>
+        /// <param name="recordSize">Maximum number of chars per message, longer messages are truncated.</param>
+        /// <returns></returns>
+        public Fmi2Status SetLogBuffering(int capacity, int recordSize)
+        {
+            if (wrapper != IntPtr.Zero)
+                return FmiFunctions.SetLogBuffering(wrapper, new UIntPtr((uint)capacity), new UIntPtr((uint)recordSize));
+            else
+                return Fmi2Status.fmi2Fatal;
+        }
+
+        private LogRecord[] logRecords;
+
+        /// <summary>
+        /// Raises the Log event for all messages that have been buffered since the last call.
+        /// </summary>
+        /// <param name="nDropped">The number of messages dropped because the buffer was full.</param>
+        /// <returns>The number of processed messages.</returns>
+        public int DrainLogs(out int nDropped)
+        {
+            nDropped = 0;
+            if (wrapper == IntPtr.Zero)
+                return 0;
+            if (logRecords == null)
+                logRecords = new LogRecord[64];
+            int total = 0;
+            int count;
+            do
+            {
+                count = (int)FmiFunctions.DrainLogs(wrapper, logRecords, new UIntPtr((uint)logRecords.Length), out var dropped).ToUInt32();
+                nDropped += (int)dropped.ToUInt32();
+                for (int i = 0; i < count; i++)
+                {
+                    OnLog(Marshal.PtrToStringAnsi(logRecords[i].instanceName), logRecords[i].status,
+                        Marshal.PtrToStringAnsi(logRecords[i].category), Marshal.PtrToStringAnsi(logRecords[i].message));
+                }
+                total += count;
+            } while (count == logRecords.Length);
+            return total;
         }
 
         #endregion
@@ -166,17 +377,7 @@ namespace FmiWrapper_Net
 
         public Fmi2Status GetString(uint[] vr, string[] value)
         {
-            if (wrapper != IntPtr.Zero)
-            {
-                var valuePtrs = new IntPtr[vr.Length];
-                var status = FmiFunctions.GetString(wrapper, vr, new UIntPtr((uint)vr.Length), valuePtrs);
-                value = valuePtrs
-                    .Select((p) => Marshal.PtrToStringAnsi(p))
-                    .ToArray();
-                return status;
-            }
-            else
-                return Fmi2Status.fmi2Fatal;
+            return GetString(new ReadOnlySpan<uint>(vr), new Span<string>(value));
         }
 
 
@@ -212,6 +413,202 @@ namespace FmiWrapper_Net
                 return Fmi2Status.fmi2Fatal;
         }
 
+        // Span overloads: the spans are pinned and passed as pointers, so no managed memory is allocated per call.
+        // Booleans use the 4 byte fmi2Boolean representation: 0 is false, everything else true.
+
+        private static void CheckLength(int nvr, int nValues)
+        {
+            if (nValues < nvr)
+                throw new ArgumentException("The value buffer is shorter than the value references");
+        }
+
+        public unsafe Fmi2Status GetReal(ReadOnlySpan<uint> vr, Span<double> value)
+        {
+            if (wrapper == IntPtr.Zero)
+                return Fmi2Status.fmi2Fatal;
+            CheckLength(vr.Length, value.Length);
+            fixed (uint* vrPtr = vr)
+            fixed (double* valuePtr = value)
+                return FmiFunctions.GetReal(wrapper, vrPtr, new UIntPtr((uint)vr.Length), valuePtr);
+        }
+
+        public unsafe Fmi2Status GetInteger(ReadOnlySpan<uint> vr, Span<int> value)
+        {
+            if (wrapper == IntPtr.Zero)
+                return Fmi2Status.fmi2Fatal;
+            CheckLength(vr.Length, value.Length);
+            fixed (uint* vrPtr = vr)
+            fixed (int* valuePtr = value)
+                return FmiFunctions.GetInteger(wrapper, vrPtr, new UIntPtr((uint)vr.Length), valuePtr);
+        }
+
+        public unsafe Fmi2Status GetBoolean(ReadOnlySpan<uint> vr, Span<int> value)
+        {
+            if (wrapper == IntPtr.Zero)
+                return Fmi2Status.fmi2Fatal;
+            CheckLength(vr.Length, value.Length);
+            fixed (uint* vrPtr = vr)
+            fixed (int* valuePtr = value)
+                return FmiFunctions.GetBoolean(wrapper, vrPtr, new UIntPtr((uint)vr.Length), valuePtr);
+        }
+
+        // Reused for the native string pointers of GetString
+        private IntPtr[] stringPointers = new IntPtr[0];
+        private readonly StringCache stringCache = new StringCache();
+
+        /// <summary>
+        /// Strings are looked up in a per instance cache, so unchanged values do not allocate new strings.
+        /// </summary>
+        public unsafe Fmi2Status GetString(ReadOnlySpan<uint> vr, Span<string> value)
+        {
+            if (wrapper == IntPtr.Zero)
+                return Fmi2Status.fmi2Fatal;
+            CheckLength(vr.Length, value.Length);
+            if (stringPointers.Length < vr.Length)
+                stringPointers = new IntPtr[vr.Length];
+            Fmi2Status status;
+            fixed (uint* vrPtr = vr)
+            fixed (IntPtr* valuePtr = stringPointers)
+                status = FmiFunctions.GetString(wrapper, vrPtr, new UIntPtr((uint)vr.Length), valuePtr);
+            if (status <= Fmi2Status.fmi2Warning)
+            {
+                for (int i = 0; i < vr.Length; i++)
+                    value[i] = stringCache.Get(stringPointers[i]);
+            }
+            return status;
+        }
+
+        public unsafe Fmi2Status SetReal(ReadOnlySpan<uint> vr, ReadOnlySpan<double> value)
+        {
+            if (wrapper == IntPtr.Zero)
+                return Fmi2Status.fmi2Fatal;
+            CheckLength(vr.Length, value.Length);
+            fixed (uint* vrPtr = vr)
+            fixed (double* valuePtr = value)
+                return FmiFunctions.SetReal(wrapper, vrPtr, new UIntPtr((uint)vr.Length), valuePtr);
+        }
+
+        public unsafe Fmi2Status SetInteger(ReadOnlySpan<uint> vr, ReadOnlySpan<int> value)
+        {
+            if (wrapper == IntPtr.Zero)
+                return Fmi2Status.fmi2Fatal;
+            CheckLength(vr.Length, value.Length);
+            fixed (uint* vrPtr = vr)
+            fixed (int* valuePtr = value)
+                return FmiFunctions.SetInteger(wrapper, vrPtr, new UIntPtr((uint)vr.Length), valuePtr);
+        }
+
+        public unsafe Fmi2Status SetBoolean(ReadOnlySpan<uint> vr, ReadOnlySpan<int> value)
+        {
+            if (wrapper == IntPtr.Zero)
+                return Fmi2Status.fmi2Fatal;
+            CheckLength(vr.Length, value.Length);
+            fixed (uint* vrPtr = vr)
+            fixed (int* valuePtr = value)
+                return FmiFunctions.SetBoolean(wrapper, vrPtr, new UIntPtr((uint)vr.Length), valuePtr);
+        }
+
+        /// <summary>
+        /// Reads all values of the group into its RealValues, IntegerValues and BooleanValues.
+        /// Only the value buffers are passed to the native side, the value references are already registered.
+        /// </summary>
+        public Fmi2Status GroupGet(SignalGroup group)
+        {
+            if (wrapper != IntPtr.Zero)
+                return FmiFunctions.GroupGet(wrapper, group.Handle, group.RealValues, group.IntegerValues, group.BooleanValues);
+            else
+                return Fmi2Status.fmi2Fatal;
+        }
+
+        /// <summary>
+        /// Writes the RealValues, IntegerValues and BooleanValues of the group to the fmu.
+        /// </summary>
+        public Fmi2Status GroupSet(SignalGroup group)
+        {
+            if (wrapper != IntPtr.Zero)
+                return FmiFunctions.GroupSet(wrapper, group.Handle, group.RealValues, group.IntegerValues, group.BooleanValues);
+            else
+                return Fmi2Status.fmi2Fatal;
+        }
+
+        /// <summary>
+        /// Reads the signals of the watch and stores the ones that left their deadband in its ChangedIndices and ChangedValues.
+        /// </summary>
+        public Fmi2Status GetChangedOutputs(OutputWatch watch)
+        {
+            if (wrapper != IntPtr.Zero)
+                return watch.Update(wrapper);
+            else
+                return Fmi2Status.fmi2Fatal;
+        }
+
+        #endregion
+
+        #region Checkpoints
+
+        /// <summary>
+        /// Keeps a bounded pool of fmu states for rolling back steps, existing checkpoints are discarded.
+        /// </summary>
+        /// <param name="nSlots">The maximum number of checkpoints, 0 frees all of them.</param>
+        /// <param name="canGetAndSetFmuState">The canGetAndSetFMUstate attribute of the model description.</param>
+        /// <returns>fmi2Error if the fmu can not get and set its state, the reason is logged.</returns>
+        public Fmi2Status SetCheckpointCapacity(int nSlots, bool canGetAndSetFmuState)
+        {
+            if (wrapper != IntPtr.Zero)
+                return FmiFunctions.SetCheckpointCapacity(wrapper, new UIntPtr((uint)nSlots), canGetAndSetFmuState);
+            else
+                return Fmi2Status.fmi2Fatal;
+        }
+
+        /// <summary>
+        /// Saves the current state in a free slot.
+        /// </summary>
+        /// <param name="slot">Stays valid until ReleaseCheckpoint.</param>
+        /// <returns>fmi2Error if all slots are in use.</returns>
+        public Fmi2Status SaveCheckpoint(out int slot)
+        {
+            slot = -1;
+            if (wrapper == IntPtr.Zero)
+                return Fmi2Status.fmi2Fatal;
+            var status = FmiFunctions.SaveCheckpoint(wrapper, out var nativeSlot);
+            if (status == Fmi2Status.fmi2OK || status == Fmi2Status.fmi2Warning)
+                slot = (int)nativeSlot.ToUInt32();
+            return status;
+        }
+
+        /// <summary>
+        /// Overwrites the checkpoint with the current state.
+        /// </summary>
+        public Fmi2Status UpdateCheckpoint(int slot)
+        {
+            if (wrapper != IntPtr.Zero)
+                return FmiFunctions.UpdateCheckpoint(wrapper, new UIntPtr((uint)slot));
+            else
+                return Fmi2Status.fmi2Fatal;
+        }
+
+        /// <summary>
+        /// Rolls the fmu back to the checkpoint, which stays valid.
+        /// </summary>
+        public Fmi2Status RestoreCheckpoint(int slot)
+        {
+            if (wrapper != IntPtr.Zero)
+                return FmiFunctions.RestoreCheckpoint(wrapper, new UIntPtr((uint)slot));
+            else
+                return Fmi2Status.fmi2Fatal;
+        }
+
+        /// <summary>
+        /// Returns the slot to the pool, its fmu state is reused by the next save.
+        /// </summary>
+        public Fmi2Status ReleaseCheckpoint(int slot)
+        {
+            if (wrapper != IntPtr.Zero)
+                return FmiFunctions.ReleaseCheckpoint(wrapper, new UIntPtr((uint)slot));
+            else
+                return Fmi2Status.fmi2Fatal;
+        }
+
         #endregion
 
         #region Types for Functions for FMI2 for Model Exchange
@@ -379,6 +776,61 @@ namespace FmiWrapper_Net
                 return Fmi2Status.fmi2Fatal;
         }
 
+        /// <summary>
+        /// Runs multiple communication steps in a single call into the native library.
+        /// Step k sets the inputs of row k, simulates from startTime + k * stepSize and reads the outputs into row k.
+        /// Each matrix is row-major with nSteps rows and a column for each member of its type in the group.
+        /// Matrices of types without members may be null.
+        /// </summary>
+        /// <param name="startTime">The communication point of the first step.</param>
+        /// <param name="stepSize"></param>
+        /// <param name="nSteps"></param>
+        /// <param name="noSetFmuStatePriorToCurrentPoint"></param>
+        /// <param name="inputs">The signals that are set before each step, may be null.</param>
+        /// <param name="realInputs"></param>
+        /// <param name="integerInputs"></param>
+        /// <param name="booleanInputs"></param>
+        /// <param name="outputs">The signals that are read after each step, may be null.</param>
+        /// <param name="realOutputs"></param>
+        /// <param name="integerOutputs"></param>
+        /// <param name="booleanOutputs"></param>
+        /// <param name="nStepsDone">The number of completed steps whose outputs have been read.</param>
+        /// <returns></returns>
+        public Fmi2Status DoSteps(double startTime, double stepSize, int nSteps, bool noSetFmuStatePriorToCurrentPoint,
+            SignalGroup inputs, double[] realInputs, int[] integerInputs, int[] booleanInputs,
+            SignalGroup outputs, double[] realOutputs, int[] integerOutputs, int[] booleanOutputs, out int nStepsDone)
+        {
+            nStepsDone = 0;
+            if (inputs != null)
+            {
+                CheckRows(nSteps, inputs.RealValues.Length, realInputs);
+                CheckRows(nSteps, inputs.IntegerValues.Length, integerInputs);
+                CheckRows(nSteps, inputs.BooleanValues.Length, booleanInputs);
+            }
+            if (outputs != null)
+            {
+                CheckRows(nSteps, outputs.RealValues.Length, realOutputs);
+                CheckRows(nSteps, outputs.IntegerValues.Length, integerOutputs);
+                CheckRows(nSteps, outputs.BooleanValues.Length, booleanOutputs);
+            }
+            if (wrapper != IntPtr.Zero)
+            {
+                var result = FmiFunctions.DoSteps(wrapper, startTime, stepSize, new UIntPtr((uint)nSteps), noSetFmuStatePriorToCurrentPoint,
+                    inputs?.Handle ?? IntPtr.Zero, realInputs, integerInputs, booleanInputs,
+                    outputs?.Handle ?? IntPtr.Zero, realOutputs, integerOutputs, booleanOutputs, out var done);
+                nStepsDone = (int)done.ToUInt32();
+                return result;
+            }
+            else
+                return Fmi2Status.fmi2Fatal;
+        }
+
+        private static void CheckRows(int nSteps, int nColumns, Array matrix)
+        {
+            if (nColumns > 0 && (matrix == null || matrix.Length < nSteps * nColumns))
+                throw new ArgumentException("The input and output matrices must have nSteps rows.");
+        }
+
         #endregion
 
         #region Inquire slave status
@@ -0,0 +1,27 @@
+﻿namespace FmiWrapper_Net
+{
+    /// <summary>
+    /// A process wide trace session that writes Chrome trace JSON, which also loads in Perfetto.
+    /// The instances enabled by FmuInstance.EnableTracing record their fmi2 calls, log messages and step finished callbacks.
+    /// </summary>
+    public static class FmuTrace
+    {
+        /// <summary>
+        /// Starts the session, the file is overwritten.
+        /// </summary>
+        /// <param name="eventsPerThread">Events are dropped when the buffer of a thread is full.</param>
+        public static Fmi2Status Start(string fileName, int eventsPerThread = 65536) =>
+            FmiFunctions.StartTrace(fileName, new System.UIntPtr((uint)eventsPerThread));
+
+        /// <summary>
+        /// Writes the buffered events to the file.
+        /// </summary>
+        /// <returns>Fmi2Status.fmi2Warning if events have been dropped since the last flush.</returns>
+        public static Fmi2Status Flush() => FmiFunctions.FlushTrace();
+
+        /// <summary>
+        /// Flushes the events and closes the file. Must not be called while a traced instance is executing a function.
+        /// </summary>
+        public static Fmi2Status Stop() => FmiFunctions.StopTrace();
+    }
+}
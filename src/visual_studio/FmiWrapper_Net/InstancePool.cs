@@ -0,0 +1,211 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace FmiWrapper_Net
+{
+    /// <summary>
+    /// Keeps instances of a fmu instantiated in the background, so Acquire does not wait for the instantiation.
+    /// The pool owns up to Size instances, including the acquired ones. FreeInstance or Dispose of an acquired
+    /// instance hands it back, it is recycled via reset or instantiated again in the background.
+    /// </summary>
+    public class InstancePool : IDisposable
+    {
+        private IntPtr handle;
+        private IntPtr binary;
+        private readonly string fileName;
+        // Called from the background thread, kept alive as long as the pool
+        private readonly FmiFunctions.LogCallback logCallback;
+
+        /// <summary>
+        /// Also raised from the background thread, for all instances of the pool.
+        /// </summary>
+        public event FmiFunctions.LogCallback Log;
+
+        /// <summary>
+        /// Starts instantiating the instances in the background.
+        /// Throws an exception if the binary could not be loaded or the pool could not be created.
+        /// </summary>
+        /// <param name="fileName">The path to the binary of the fmu.</param>
+        /// <param name="size">The number of instances of the pool, including the acquired ones.</param>
+        /// <param name="resetInstances">Recycle via Reset, only for fmus that support it. Otherwise the instances are instantiated again.</param>
+        /// <param name="pooledMemory">See FmuInstance.PooledMemory.</param>
+        public InstancePool(string fileName, string instanceName, Fmi2Type fmuType, string guid, string resourceLocation, int size,
+            bool resetInstances = false, bool loggingOn = false, bool pooledMemory = false)
+        {
+            this.fileName = fileName;
+            Size = size;
+            binary = FmiFunctions.LoadBinary(fileName);
+            if (binary == IntPtr.Zero)
+                throw new Exception("Failed to load the binary " + fileName);
+            logCallback = (name, status, category, message) => Log?.Invoke(name, status, category, message);
+            // The strings are copied by the pool
+            var namePtr = Marshal.StringToHGlobalAnsi(instanceName);
+            var guidPtr = Marshal.StringToHGlobalAnsi(guid);
+            var resourcePtr = Marshal.StringToHGlobalAnsi(resourceLocation);
+            try
+            {
+                var spec = new NativeInstancePoolSpec
+                {
+                    binary = binary,
+                    log = Marshal.GetFunctionPointerForDelegate(logCallback),
+                    stepFinished = IntPtr.Zero,
+                    instanceName = namePtr,
+                    fmuType = fmuType,
+                    guid = guidPtr,
+                    resourceLocation = resourcePtr,
+                    visible = 0,
+                    loggingOn = loggingOn ? 1 : 0,
+                    size = (UIntPtr)size,
+                    resetInstances = resetInstances ? 1 : 0,
+                    pooledMemory = pooledMemory ? 1 : 0
+                };
+                handle = FmiFunctions.CreateInstancePool(ref spec);
+            }
+            finally
+            {
+                Marshal.FreeHGlobal(namePtr);
+                Marshal.FreeHGlobal(guidPtr);
+                Marshal.FreeHGlobal(resourcePtr);
+            }
+            if (handle == IntPtr.Zero)
+            {
+                FmiFunctions.FreeBinary(binary);
+                binary = IntPtr.Zero;
+                throw new Exception("Failed to create the instance pool");
+            }
+        }
+
+        public int Size { get; }
+
+        /// <summary>
+        /// Takes an instantiated instance, waits if none is available. Its Log and StepFinished events are not raised,
+        /// use the Log event of the pool instead.
+        /// Throws an exception if the background instantiation failed, the next call retries.
+        /// </summary>
+        public FmuInstance Acquire()
+        {
+            var wrapper = FmiFunctions.AcquireInstance(handle);
+            if (wrapper == IntPtr.Zero)
+                throw new Exception("Failed to instantiate the pooled fmu " + fileName);
+            return new FmuInstance(fileName, wrapper, this);
+        }
+
+        /// <summary>
+        /// Hands the instance back or frees it if the pool has been disposed.
+        /// </summary>
+        internal void Release(IntPtr wrapper)
+        {
+            if (handle != IntPtr.Zero)
+                FmiFunctions.ReleaseInstance(handle, wrapper);
+            else
+                FmiFunctions.FreeInstance(wrapper);
+        }
+
+        public InstancePoolStatistics Statistics
+        {
+            get
+            {
+                FmiFunctions.GetInstancePoolStatistics(handle, out var native);
+                return new InstancePoolStatistics
+                {
+                    Available = (int)native.nAvailable.ToUInt32(),
+                    Acquired = (long)native.nAcquired,
+                    Waited = (long)native.nWaited,
+                    Instantiated = (long)native.nInstantiated,
+                    Reset = (long)native.nReset,
+                    Failed = (long)native.nFailed
+                };
+            }
+        }
+
+        #region IDisposable Support
+        private bool disposedValue = false; // To detect redundant calls
+
+        protected virtual void Dispose(bool disposing)
+        {
+            if (!disposedValue)
+            {
+                // Free unmanaged resources, acquired instances are freed when they are handed back
+                if (handle != IntPtr.Zero)
+                    FmiFunctions.FreeInstancePool(handle);
+                handle = IntPtr.Zero;
+                if (binary != IntPtr.Zero)
+                    FmiFunctions.FreeBinary(binary);
+                binary = IntPtr.Zero;
+                // Avoid disposing multiple times
+                disposedValue = true;
+            }
+        }
+
+        ~InstancePool()
+        {
+            // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
+            Dispose(false);
+        }
+
+        // This code added to correctly implement the disposable pattern.
+        public void Dispose()
+        {
+            // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
+            Dispose(true);
+            GC.SuppressFinalize(this);
+        }
+        #endregion
+    }
+
+    /// <summary>
+    /// The counters of an InstancePool.
+    /// </summary>
+    public struct InstancePoolStatistics
+    {
+        /// <summary>
+        /// The instances that are ready to be acquired.
+        /// </summary>
+        public int Available;
+        public long Acquired;
+        /// <summary>
+        /// The acquisitions that had to wait for an instance.
+        /// </summary>
+        public long Waited;
+        public long Instantiated;
+        public long Reset;
+        /// <summary>
+        /// Failed instantiations and resets.
+        /// </summary>
+        public long Failed;
+    }
+
+    /// <summary>
+    /// Mirrors the native instance_pool_spec.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct NativeInstancePoolSpec
+    {
+        public IntPtr binary;
+        public IntPtr log;
+        public IntPtr stepFinished;
+        public IntPtr instanceName;
+        public Fmi2Type fmuType;
+        public IntPtr guid;
+        public IntPtr resourceLocation;
+        public int visible;
+        public int loggingOn;
+        public UIntPtr size;
+        public int resetInstances;
+        public int pooledMemory;
+    }
+
+    /// <summary>
+    /// Mirrors the native instance_pool_statistics.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct NativeInstancePoolStatistics
+    {
+        public UIntPtr nAvailable;
+        public ulong nAcquired;
+        public ulong nWaited;
+        public ulong nInstantiated;
+        public ulong nReset;
+        public ulong nFailed;
+    }
+}
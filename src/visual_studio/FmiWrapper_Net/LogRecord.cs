@@ -0,0 +1,18 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace FmiWrapper_Net
+{
+    /// <summary>
+    /// A log message buffered by the native wrapper.
+    /// The strings point into the native buffer and stay valid until the next call of drain_logs.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct LogRecord
+    {
+        public IntPtr instanceName;
+        public Fmi2Status status;
+        public IntPtr category;
+        public IntPtr message;
+    }
+}
@@ -0,0 +1,180 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace FmiWrapper_Net
+{
+    public enum MeSolverMethod
+    {
+        /// <summary>
+        /// Classic Runge-Kutta of order 4 with a fixed step size.
+        /// </summary>
+        Rk4,
+        /// <summary>
+        /// Runge-Kutta 5(4) of Dormand and Prince with step size control.
+        /// </summary>
+        DormandPrince,
+        /// <summary>
+        /// Implicit BDF of order 2 with a fixed step size for stiff models.
+        /// </summary>
+        Bdf
+    }
+
+    public struct MeSolverStatistics
+    {
+        public long Steps;
+        public long RejectedSteps;
+        public long DerivativeEvaluations;
+        public long JacobianEvaluations;
+        public long StateEvents;
+        public long TimeEvents;
+        public long StepEvents;
+    }
+
+    /// <summary>
+    /// Integrates a Model Exchange instance natively, so it is stepped like a co-simulation slave
+    /// instead of calling into the fmu for each derivative evaluation.
+    /// </summary>
+    public class MeSolver : IDisposable
+    {
+        private readonly FmuInstance instance;
+        private readonly int nStates;
+        private IntPtr handle;
+
+        /// <summary>
+        /// Creates the solver, 0 selects the default of a value.
+        /// Throws an exception if the native solver could not be created.
+        /// </summary>
+        /// <param name="instance">The instantiated fmu, it must outlive the solver.</param>
+        /// <param name="nStates">The number of continuous states of the model description.</param>
+        /// <param name="nEventIndicators">The number of event indicators of the model description.</param>
+        /// <param name="method"></param>
+        /// <param name="stepSize">The step size of Rk4 and Bdf, the initial step size of DormandPrince. Defaults to the communication step size.</param>
+        /// <param name="relativeTolerance"></param>
+        /// <param name="absoluteTolerance"></param>
+        /// <param name="maxStepSize"></param>
+        /// <param name="archive">Lets Bdf evaluate the Jacobian with the sparsity pattern of the model description.</param>
+        public MeSolver(FmuInstance instance, int nStates, int nEventIndicators, MeSolverMethod method,
+            double stepSize = 0, double relativeTolerance = 0, double absoluteTolerance = 0, double maxStepSize = 0,
+            FmuArchive archive = null)
+        {
+            this.instance = instance;
+            this.nStates = nStates;
+            var options = new NativeMeSolverOptions
+            {
+                method = method,
+                stepSize = stepSize,
+                maxStepSize = maxStepSize,
+                relativeTolerance = relativeTolerance,
+                absoluteTolerance = absoluteTolerance,
+                modelDescription = archive?.DescriptionHandle ?? IntPtr.Zero
+            };
+            handle = FmiFunctions.CreateMeSolver(instance.Handle, (UIntPtr)nStates, (UIntPtr)nEventIndicators, ref options);
+            if (handle == IntPtr.Zero)
+                throw new Exception("Failed to create the model exchange solver");
+        }
+
+        public double Time => FmiFunctions.MeSolverGetTime(handle);
+
+        /// <summary>
+        /// Runs the initial event iteration, call it after ExitInitializationMode.
+        /// </summary>
+        /// <param name="startTime"></param>
+        /// <returns></returns>
+        public Fmi2Status Initialize(double startTime) =>
+            FmiFunctions.MeSolverInitialize(handle, startTime);
+
+        /// <summary>
+        /// Integrates to the next communication point and handles the events on the way.
+        /// </summary>
+        /// <param name="currentCommunicationPoint">Must match Time.</param>
+        /// <param name="communicationStepSize"></param>
+        /// <returns>fmi2Discard if the fmu requested to terminate the simulation at Time.</returns>
+        public Fmi2Status DoStep(double currentCommunicationPoint, double communicationStepSize) =>
+            FmiFunctions.MeSolverDoStep(handle, currentCommunicationPoint, communicationStepSize);
+
+        public double[] GetStates()
+        {
+            var states = new double[nStates];
+            FmiFunctions.MeSolverGetStates(handle, states, (UIntPtr)nStates);
+            return states;
+        }
+
+        public MeSolverStatistics GetStatistics()
+        {
+            FmiFunctions.MeSolverGetStatistics(handle, out var statistics);
+            return new MeSolverStatistics
+            {
+                Steps = (long)statistics.nSteps,
+                RejectedSteps = (long)statistics.nRejectedSteps,
+                DerivativeEvaluations = (long)statistics.nDerivativeEvaluations,
+                JacobianEvaluations = (long)statistics.nJacobianEvaluations,
+                StateEvents = (long)statistics.nStateEvents,
+                TimeEvents = (long)statistics.nTimeEvents,
+                StepEvents = (long)statistics.nStepEvents
+            };
+        }
+
+        #region IDisposable Support
+        private bool disposedValue = false; // To detect redundant calls
+
+        protected virtual void Dispose(bool disposing)
+        {
+            if (!disposedValue)
+            {
+                // Free unmanaged resources
+                if (handle != IntPtr.Zero)
+                    FmiFunctions.FreeMeSolver(handle);
+                handle = IntPtr.Zero;
+                // Avoid disposing multiple times
+                disposedValue = true;
+            }
+        }
+
+        ~MeSolver()
+        {
+            // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
+            Dispose(false);
+        }
+
+        // This code added to correctly implement the disposable pattern.
+        public void Dispose()
+        {
+            // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
+            Dispose(true);
+            GC.SuppressFinalize(this);
+        }
+        #endregion
+    }
+
+    /// <summary>
+    /// Mirrors the native me_solver_options.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct NativeMeSolverOptions
+    {
+        public MeSolverMethod method;
+        public double stepSize;
+        public double maxStepSize;
+        public double minStepSize;
+        public double relativeTolerance;
+        public double absoluteTolerance;
+        public double eventTolerance;
+        public UIntPtr maxEventIterations;
+        public IntPtr modelDescription;
+    }
+
+    /// <summary>
+    /// Mirrors the native me_solver_statistics.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct NativeMeSolverStatistics
+    {
+        public UIntPtr nSteps;
+        public UIntPtr nRejectedSteps;
+        public UIntPtr nDerivativeEvaluations;
+        public UIntPtr nJacobianEvaluations;
+        public UIntPtr nStateEvents;
+        public UIntPtr nTimeEvents;
+        public UIntPtr nStepEvents;
+    }
+}
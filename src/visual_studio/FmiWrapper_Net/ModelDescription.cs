@@ -0,0 +1,91 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace FmiWrapper_Net
+{
+    /// <summary>
+    /// A ScalarVariable of the model description.
+    /// </summary>
+    public class ModelVariable
+    {
+        public string Name { get; internal set; }
+        public uint ValueReference { get; internal set; }
+        public VariableType Type { get; internal set; }
+        public VariableCausality Causality { get; internal set; }
+        public VariableVariability Variability { get; internal set; }
+        public string Description { get; internal set; }
+        public string Start { get; internal set; }
+    }
+
+    // Layouts of the native structs in model_description.h and fmu_archive.h
+
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct NativeModelVariable
+    {
+        public IntPtr name;
+        public uint valueReference;
+        public VariableType type;
+        public VariableCausality causality;
+        public VariableVariability variability;
+        public IntPtr description;
+        public IntPtr start;
+        public UIntPtr derivativeOf;
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct NativeFmuInterface
+    {
+        public int available;
+        public IntPtr modelIdentifier;
+        public int needsExecutionTool;
+        public int canBeInstantiatedOnlyOncePerProcess;
+        public int canNotUseMemoryManagementFunctions;
+        public int canGetAndSetFmuState;
+        public int canSerializeFmuState;
+        public int providesDirectionalDerivative;
+        public int canHandleVariableCommunicationStepSize;
+        public int completedIntegratorStepNotNeeded;
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct NativeDefaultExperiment
+    {
+        public int startTimeDefined;
+        public double startTime;
+        public int stopTimeDefined;
+        public double stopTime;
+        public int toleranceDefined;
+        public double tolerance;
+        public int stepSizeDefined;
+        public double stepSize;
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct NativeModelDescription
+    {
+        public IntPtr fmiVersion;
+        public IntPtr modelName;
+        public IntPtr guid;
+        public IntPtr description;
+        public UIntPtr numberOfEventIndicators;
+        public NativeFmuInterface coSimulation;
+        public NativeFmuInterface modelExchange;
+        public NativeDefaultExperiment defaultExperiment;
+        public UIntPtr nVariables;
+        public IntPtr variables;
+        public UIntPtr numberOfContinuousStates;
+        public IntPtr derivativeIndices;
+        public IntPtr derivativeDependenciesDefined;
+        public IntPtr derivativeDependencyOffsets;
+        public IntPtr derivativeDependencies;
+        public IntPtr xml;
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct NativeFmuArchive
+    {
+        public IntPtr directory;
+        public IntPtr resourceLocation;
+        public IntPtr description;
+    }
+}
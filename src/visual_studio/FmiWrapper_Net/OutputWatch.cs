@@ -0,0 +1,108 @@
+﻿using System;
+
+namespace FmiWrapper_Net
+{
+    /// <summary>
+    /// Signals whose last reported values are kept natively, so only the changes beyond a deadband are marshalled.
+    /// Pass the watch to FmuInstance.GetChangedOutputs after each step. The signals are indexed in the order reals,
+    /// integers, booleans, the integers and booleans are reported as doubles.
+    /// </summary>
+    public class OutputWatch : IDisposable
+    {
+        internal IntPtr Handle { get; private set; }
+        private readonly UIntPtr[] nativeIndices;
+
+        /// <summary>
+        /// Registers the signals, null arrays are treated as empty. A signal is reported if it differs from its last
+        /// reported value r by more than max(absoluteDeadband, relativeDeadband * |r|).
+        /// Throws an exception if a deadband is negative or the native watch could not be created.
+        /// </summary>
+        /// <param name="realVr"></param>
+        /// <param name="integerVr"></param>
+        /// <param name="booleanVr"></param>
+        /// <param name="absoluteDeadbands">One per signal, null reports every change.</param>
+        /// <param name="relativeDeadbands">One per signal, may be null.</param>
+        public OutputWatch(uint[] realVr, uint[] integerVr = null, uint[] booleanVr = null,
+            double[] absoluteDeadbands = null, double[] relativeDeadbands = null)
+        {
+            realVr = realVr ?? new uint[0];
+            integerVr = integerVr ?? new uint[0];
+            booleanVr = booleanVr ?? new uint[0];
+            Size = realVr.Length + integerVr.Length + booleanVr.Length;
+            if ((absoluteDeadbands != null && absoluteDeadbands.Length != Size) || (relativeDeadbands != null && relativeDeadbands.Length != Size))
+                throw new ArgumentException("One deadband per signal is required");
+            Handle = FmiFunctions.CreateOutputWatch((UIntPtr)realVr.Length, realVr, (UIntPtr)integerVr.Length, integerVr,
+                (UIntPtr)booleanVr.Length, booleanVr, absoluteDeadbands, relativeDeadbands);
+            if (Handle == IntPtr.Zero)
+                throw new Exception("Failed to create the output watch");
+            nativeIndices = new UIntPtr[Size];
+            ChangedIndices = new int[Size];
+            ChangedValues = new double[Size];
+        }
+
+        /// <summary>
+        /// The number of watched signals.
+        /// </summary>
+        public int Size { get; }
+        /// <summary>
+        /// The number of valid entries in ChangedIndices and ChangedValues.
+        /// </summary>
+        public int ChangeCount { get; private set; }
+        /// <summary>
+        /// The indices of the signals that changed in the last read, in ascending order.
+        /// </summary>
+        public int[] ChangedIndices { get; }
+        /// <summary>
+        /// The new values of the signals that changed in the last read.
+        /// </summary>
+        public double[] ChangedValues { get; }
+
+        /// <summary>
+        /// Reports all signals on the next read, e.g. for a new consumer.
+        /// </summary>
+        public void Reset()
+        {
+            FmiFunctions.ResetOutputWatch(Handle);
+        }
+
+        internal Fmi2Status Update(IntPtr wrapper)
+        {
+            var status = FmiFunctions.GetChangedOutputs(wrapper, Handle, nativeIndices, ChangedValues, out var nChanges);
+            ChangeCount = (int)nChanges.ToUInt32();
+            for (int i = 0; i < ChangeCount; i++)
+                ChangedIndices[i] = (int)nativeIndices[i].ToUInt32();
+            return status;
+        }
+
+        #region IDisposable Support
+        private bool disposedValue = false; // To detect redundant calls
+
+        protected virtual void Dispose(bool disposing)
+        {
+            if (!disposedValue)
+            {
+                // Free unmanaged resources
+                if (Handle != IntPtr.Zero)
+                    FmiFunctions.FreeOutputWatch(Handle);
+                Handle = IntPtr.Zero;
+                // Avoid disposing multiple times
+                disposedValue = true;
+            }
+        }
+
+        ~OutputWatch()
+        {
+            // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
+            Dispose(false);
+        }
+
+        // This code added to correctly implement the disposable pattern.
+        public void Dispose()
+        {
+            // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
+            Dispose(true);
+            GC.SuppressFinalize(this);
+        }
+        #endregion
+    }
+}
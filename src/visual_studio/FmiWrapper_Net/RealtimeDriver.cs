@@ -0,0 +1,158 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace FmiWrapper_Net
+{
+    /// <summary>
+    /// Paces the steps of an instance against the wall clock with absolute sleeps on the monotonic clock.
+    /// After a deadline miss the following steps start immediately until they caught up with the schedule.
+    /// Create the driver on the thread that calls DoStep, the options apply to that thread.
+    /// </summary>
+    public class RealtimeDriver : IDisposable
+    {
+        private IntPtr handle;
+        // Keeps the instance alive as long as the driver
+        private readonly FmuInstance instance;
+
+        /// <summary>
+        /// Applies the options to the calling thread, see SetupStatus.
+        /// Throws an exception if the step size is not positive or the instance is not instantiated.
+        /// </summary>
+        /// <param name="stepSize">The communication step size in seconds, which is also the period in wall clock time.</param>
+        /// <param name="processor">Pin the thread to this logical processor, -1 keeps the affinity.</param>
+        /// <param name="fifoPriority">Schedule the thread with SCHED_FIFO at this priority, 0 keeps the policy.</param>
+        /// <param name="lockMemory">Lock the pages of the process into memory until the driver is disposed. Not supported on Windows.</param>
+        public RealtimeDriver(FmuInstance instance, double startTime, double stepSize, int processor = -1, int fifoPriority = 0, bool lockMemory = false)
+        {
+            if (instance.Handle == IntPtr.Zero)
+                throw new ArgumentException("The instance is not instantiated", nameof(instance));
+            this.instance = instance;
+            var options = new NativeRealtimeOptions
+            {
+                processor = processor,
+                fifoPriority = fifoPriority,
+                lockMemory = lockMemory ? 1 : 0
+            };
+            handle = FmiFunctions.CreateRealtimeDriver(instance.Handle, startTime, stepSize, ref options, out var setupStatus);
+            if (handle == IntPtr.Zero)
+                throw new ArgumentOutOfRangeException(nameof(stepSize));
+            SetupStatus = setupStatus;
+        }
+
+        /// <summary>
+        /// Fmi2Status.fmi2Warning if an option could not be applied, e.g. for lack of privileges.
+        /// </summary>
+        public Fmi2Status SetupStatus { get; }
+
+        /// <summary>
+        /// The simulation time of the next step.
+        /// </summary>
+        public double Time => FmiFunctions.GetRealtimeTime(handle);
+
+        /// <summary>
+        /// Waits until the next step is due and performs it. The first call starts the schedule.
+        /// </summary>
+        public Fmi2Status DoStep()
+        {
+            return FmiFunctions.RealtimeDoStep(handle);
+        }
+
+        /// <summary>
+        /// Gets a snapshot of the timing, may be called from another thread.
+        /// </summary>
+        /// <param name="reset">Start over after the snapshot, so consecutive snapshots do not overlap.</param>
+        public RealtimeStatistics GetStatistics(bool reset = false)
+        {
+            FmiFunctions.GetRealtimeStatistics(handle, out var native, reset);
+            return new RealtimeStatistics(native);
+        }
+
+        #region IDisposable Support
+        private bool disposedValue = false; // To detect redundant calls
+
+        protected virtual void Dispose(bool disposing)
+        {
+            if (!disposedValue)
+            {
+                // Free unmanaged resources
+                if (handle != IntPtr.Zero)
+                    FmiFunctions.FreeRealtimeDriver(handle);
+                handle = IntPtr.Zero;
+                // Avoid disposing multiple times
+                disposedValue = true;
+            }
+        }
+
+        ~RealtimeDriver()
+        {
+            // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
+            Dispose(false);
+        }
+
+        // This code added to correctly implement the disposable pattern.
+        public void Dispose()
+        {
+            // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
+            Dispose(true);
+            GC.SuppressFinalize(this);
+        }
+        #endregion
+    }
+
+    /// <summary>
+    /// The timing of the steps of a RealtimeDriver in nanoseconds.
+    /// </summary>
+    public class RealtimeStatistics
+    {
+        internal RealtimeStatistics(NativeRealtimeStatistics native)
+        {
+            DeadlineMisses = (long)native.nDeadlineMisses;
+            Execution = new CallStatistics(native.execution);
+            Slack = new CallStatistics(native.slack);
+            Lateness = new CallStatistics(native.lateness);
+            Wakeup = new CallStatistics(native.wakeup);
+        }
+
+        public long DeadlineMisses { get; }
+        /// <summary>
+        /// The duration of each step.
+        /// </summary>
+        public CallStatistics Execution { get; }
+        /// <summary>
+        /// The time left until the deadline, for the steps that met it.
+        /// </summary>
+        public CallStatistics Slack { get; }
+        /// <summary>
+        /// The time past the deadline, for the steps that missed it.
+        /// </summary>
+        public CallStatistics Lateness { get; }
+        /// <summary>
+        /// How much later than scheduled the thread woke up, for the steps that had to wait.
+        /// </summary>
+        public CallStatistics Wakeup { get; }
+    }
+
+    /// <summary>
+    /// Mirrors the native realtime_options.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct NativeRealtimeOptions
+    {
+        public int processor;
+        public int fifoPriority;
+        public int lockMemory;
+    }
+
+    /// <summary>
+    /// Mirrors the native realtime_statistics.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct NativeRealtimeStatistics
+    {
+        public ulong nDeadlineMisses;
+        public NativeCallStatistics execution;
+        public NativeCallStatistics slack;
+        public NativeCallStatistics lateness;
+        public NativeCallStatistics wakeup;
+    }
+}
@@ -0,0 +1,104 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace FmiWrapper_Net
+{
+    /// <summary>
+    /// Reads a result file written by FmuInstance.StartRecording. The file is memory mapped and indexed by its blocks,
+    /// the columns are copied without parsing. Column 0 holds the simulation times, the columns 1 to n the signals.
+    /// </summary>
+    public class Recording : IDisposable
+    {
+        private IntPtr handle;
+
+        /// <summary>
+        /// Maps the file, samples written later are visible after opening it again.
+        /// Throws an exception if the file is not a result file.
+        /// </summary>
+        /// <param name="fileName"></param>
+        public Recording(string fileName)
+        {
+            handle = FmiFunctions.OpenRecording(fileName);
+            if (handle == IntPtr.Zero)
+                throw new Exception("Failed to open the recording " + fileName);
+            Columns = (int)FmiFunctions.GetRecordingColumnCount(handle).ToUInt32();
+            Samples = (long)FmiFunctions.GetRecordingSampleCount(handle).ToUInt64();
+            Decimation = (int)FmiFunctions.GetRecordingDecimation(handle).ToUInt32();
+        }
+
+        /// <summary>
+        /// The number of columns including the time column.
+        /// </summary>
+        public int Columns { get; }
+        public long Samples { get; }
+        /// <summary>
+        /// The number of steps per sample.
+        /// </summary>
+        public int Decimation { get; }
+
+        /// <summary>
+        /// Gets the value reference and type of the signal in the column, which must not be the time column.
+        /// </summary>
+        public uint GetSignal(int column, out VariableType type)
+        {
+            if (FmiFunctions.GetRecordingSignal(handle, (UIntPtr)column, out var vr, out type) != Fmi2Status.fmi2OK)
+                throw new ArgumentOutOfRangeException(nameof(column));
+            return vr;
+        }
+
+        /// <summary>
+        /// Copies a range of samples of the column, integers and booleans are recorded as doubles.
+        /// </summary>
+        public double[] ReadColumn(int column, long firstSample = 0, long count = -1)
+        {
+            if (count < 0)
+                count = Samples - firstSample;
+            var values = new double[count];
+            if (FmiFunctions.ReadRecordingColumn(handle, (UIntPtr)column, (UIntPtr)firstSample, (UIntPtr)count, values) != Fmi2Status.fmi2OK)
+                throw new ArgumentOutOfRangeException(nameof(column));
+            return values;
+        }
+
+        #region IDisposable Support
+        private bool disposedValue = false; // To detect redundant calls
+
+        protected virtual void Dispose(bool disposing)
+        {
+            if (!disposedValue)
+            {
+                // Free unmanaged resources
+                if (handle != IntPtr.Zero)
+                    FmiFunctions.CloseRecording(handle);
+                handle = IntPtr.Zero;
+                // Avoid disposing multiple times
+                disposedValue = true;
+            }
+        }
+
+        ~Recording()
+        {
+            // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
+            Dispose(false);
+        }
+
+        // This code added to correctly implement the disposable pattern.
+        public void Dispose()
+        {
+            // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
+            Dispose(true);
+            GC.SuppressFinalize(this);
+        }
+        #endregion
+    }
+
+    /// <summary>
+    /// Mirrors the native recorder_options.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct NativeRecorderOptions
+    {
+        public UIntPtr decimation;
+        public UIntPtr samplesPerBlock;
+        public int compress;
+    }
+}
@@ -0,0 +1,79 @@
+﻿using System;
+
+namespace FmiWrapper_Net
+{
+    /// <summary>
+    /// Value references of mixed types that are registered natively once.
+    /// Pass the group to FmuInstance.GroupGet and FmuInstance.GroupSet, which only transfer the value buffers.
+    /// The group is not bound to an instance, it stays valid after reinstantiation.
+    /// </summary>
+    public class SignalGroup : IDisposable
+    {
+        internal IntPtr Handle { get; private set; }
+
+        /// <summary>
+        /// Registers the value references, null arrays are treated as empty.
+        /// Throws an exception if the native group could not be created.
+        /// </summary>
+        /// <param name="realVr"></param>
+        /// <param name="integerVr"></param>
+        /// <param name="booleanVr"></param>
+        public SignalGroup(uint[] realVr, uint[] integerVr = null, uint[] booleanVr = null)
+        {
+            realVr = realVr ?? new uint[0];
+            integerVr = integerVr ?? new uint[0];
+            booleanVr = booleanVr ?? new uint[0];
+            Handle = FmiFunctions.CreateSignalGroup((UIntPtr)realVr.Length, realVr, (UIntPtr)integerVr.Length, integerVr,
+                (UIntPtr)booleanVr.Length, booleanVr);
+            if (Handle == IntPtr.Zero)
+                throw new Exception("Failed to create the signal group");
+            RealValues = new double[realVr.Length];
+            IntegerValues = new int[integerVr.Length];
+            BooleanValues = new int[booleanVr.Length];
+        }
+
+        /// <summary>
+        /// The values of the real members in the order of registration.
+        /// </summary>
+        public double[] RealValues { get; }
+        /// <summary>
+        /// The values of the integer members in the order of registration.
+        /// </summary>
+        public int[] IntegerValues { get; }
+        /// <summary>
+        /// The values of the boolean members as fmi2Boolean: 0 is false, everything else true.
+        /// </summary>
+        public int[] BooleanValues { get; }
+
+        #region IDisposable Support
+        private bool disposedValue = false; // To detect redundant calls
+
+        protected virtual void Dispose(bool disposing)
+        {
+            if (!disposedValue)
+            {
+                // Free unmanaged resources
+                if (Handle != IntPtr.Zero)
+                    FmiFunctions.FreeSignalGroup(Handle);
+                Handle = IntPtr.Zero;
+                // Avoid disposing multiple times
+                disposedValue = true;
+            }
+        }
+
+        ~SignalGroup()
+        {
+            // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
+            Dispose(false);
+        }
+
+        // This code added to correctly implement the disposable pattern.
+        public void Dispose()
+        {
+            // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
+            Dispose(true);
+            GC.SuppressFinalize(this);
+        }
+        #endregion
+    }
+}
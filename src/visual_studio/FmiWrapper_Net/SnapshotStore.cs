@@ -0,0 +1,126 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace FmiWrapper_Net
+{
+    public struct SnapshotInfo
+    {
+        public string Guid;
+        public double Time;
+        /// <summary>
+        /// The size of the serialized fmu state in bytes.
+        /// </summary>
+        public long Size;
+    }
+
+    /// <summary>
+    /// An append-only file of serialized fmu states indexed by guid and simulation time.
+    /// The file is memory mapped and the states are deserialized from the mapped pages,
+    /// so many processes can start from the same warmed-up state.
+    /// </summary>
+    public class SnapshotStore : IDisposable
+    {
+        private IntPtr handle;
+
+        /// <summary>
+        /// Serializes the current state of the instance and appends it to the file.
+        /// </summary>
+        /// <param name="fileName">Created if it does not exist.</param>
+        /// <param name="instance">The fmu must support canSerializeFMUstate.</param>
+        /// <param name="guid">The guid of the model description.</param>
+        /// <param name="time">The simulation time of the state.</param>
+        /// <returns></returns>
+        public static Fmi2Status Save(string fileName, FmuInstance instance, string guid, double time) =>
+            FmiFunctions.SaveSnapshot(fileName, instance.Handle, guid, time);
+
+        /// <summary>
+        /// Maps the file and indexes its snapshots, snapshots appended later are visible after opening it again.
+        /// Throws an exception if the file is not a snapshot file.
+        /// </summary>
+        /// <param name="fileName"></param>
+        public SnapshotStore(string fileName)
+        {
+            handle = FmiFunctions.OpenSnapshotStore(fileName);
+            if (handle == IntPtr.Zero)
+                throw new Exception("Failed to open the snapshot file " + fileName);
+            Count = (int)FmiFunctions.GetSnapshotCount(handle).ToUInt32();
+        }
+
+        public int Count { get; }
+
+        /// <summary>
+        /// Gets a snapshot by its position in the index, which is sorted by guid and time.
+        /// </summary>
+        public SnapshotInfo GetInfo(int index)
+        {
+            if (FmiFunctions.GetSnapshotInfo(handle, new UIntPtr((uint)index), out var info) != Fmi2Status.fmi2OK)
+                throw new ArgumentOutOfRangeException(nameof(index));
+            return new SnapshotInfo
+            {
+                Guid = Marshal.PtrToStringAnsi(info.guid),
+                Time = info.time,
+                Size = (long)info.size.ToUInt64()
+            };
+        }
+
+        /// <summary>
+        /// Finds the latest snapshot of the model at or before the time.
+        /// </summary>
+        /// <returns>False if the store has no such snapshot.</returns>
+        public bool Find(string guid, double time, out int index)
+        {
+            var found = FmiFunctions.FindSnapshot(handle, guid, time, out var nativeIndex);
+            index = found ? (int)nativeIndex.ToUInt32() : -1;
+            return found;
+        }
+
+        /// <summary>
+        /// Sets the snapshot as the state of an instance of the same model.
+        /// </summary>
+        public Fmi2Status Restore(int index, FmuInstance instance) =>
+            FmiFunctions.RestoreSnapshot(handle, new UIntPtr((uint)index), instance.Handle);
+
+        #region IDisposable Support
+        private bool disposedValue = false; // To detect redundant calls
+
+        protected virtual void Dispose(bool disposing)
+        {
+            if (!disposedValue)
+            {
+                // Free unmanaged resources
+                if (handle != IntPtr.Zero)
+                    FmiFunctions.CloseSnapshotStore(handle);
+                handle = IntPtr.Zero;
+                // Avoid disposing multiple times
+                disposedValue = true;
+            }
+        }
+
+        ~SnapshotStore()
+        {
+            // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
+            Dispose(false);
+        }
+
+        // This code added to correctly implement the disposable pattern.
+        public void Dispose()
+        {
+            // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
+            Dispose(true);
+            GC.SuppressFinalize(this);
+        }
+        #endregion
+    }
+
+    /// <summary>
+    /// Mirrors the native snapshot_info.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct NativeSnapshotInfo
+    {
+        public IntPtr guid;
+        public double time;
+        public IntPtr data;
+        public UIntPtr size;
+    }
+}
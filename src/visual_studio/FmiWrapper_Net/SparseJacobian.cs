@@ -0,0 +1,122 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace FmiWrapper_Net
+{
+    /// <summary>
+    /// The Jacobian of the state derivatives with respect to the continuous states in compressed sparse row format.
+    /// The columns are colored by the dependencies of the model description, so an evaluation costs one call per color.
+    /// </summary>
+    public class SparseJacobian : IDisposable
+    {
+        private IntPtr handle;
+        private readonly IntPtr values;
+
+        /// <summary>
+        /// Builds the sparsity pattern of the model description.
+        /// Throws an exception if the model has no continuous states or a derivative does not name its state.
+        /// </summary>
+        /// <param name="archive">The pattern is copied, the archive may be disposed before the Jacobian.</param>
+        public SparseJacobian(FmuArchive archive)
+        {
+            handle = FmiFunctions.CreateSparseJacobian(archive.DescriptionHandle);
+            if (handle == IntPtr.Zero)
+                throw new Exception("Failed to create the sparse Jacobian of " + archive.ModelName);
+            var native = Marshal.PtrToStructure<NativeSparseJacobian>(handle);
+            StateCount = (int)native.nStates.ToUInt32();
+            ColorCount = (int)native.nColors.ToUInt32();
+            var nonzeroCount = (int)native.nNonzeros.ToUInt32();
+            RowOffsets = ReadIndices(native.rowOffsets, StateCount + 1);
+            Columns = ReadIndices(native.columns, nonzeroCount);
+            Values = new double[nonzeroCount];
+            values = native.values;
+        }
+
+        public int StateCount { get; }
+        /// <summary>
+        /// The number of evaluations per Jacobian.
+        /// </summary>
+        public int ColorCount { get; }
+        /// <summary>
+        /// Row i contains the entries RowOffsets[i] to RowOffsets[i + 1] - 1.
+        /// </summary>
+        public int[] RowOffsets { get; }
+        public int[] Columns { get; }
+        /// <summary>
+        /// The values of the entries, updated by Evaluate.
+        /// </summary>
+        public double[] Values { get; }
+
+        /// <summary>
+        /// Evaluates the Jacobian at the current time and states of the instance, which must be in the continuous time mode.
+        /// </summary>
+        /// <param name="instance"></param>
+        /// <param name="useDirectionalDerivatives">If the fmu provides directional derivatives, otherwise forward differences are used.</param>
+        /// <param name="x">The current states, only needed for the finite differences.</param>
+        /// <param name="dx">The derivatives at x, only needed for the finite differences.</param>
+        /// <param name="nominals">Scale the perturbations, may be null.</param>
+        /// <returns></returns>
+        public Fmi2Status Evaluate(FmuInstance instance, bool useDirectionalDerivatives, double[] x = null, double[] dx = null, double[] nominals = null)
+        {
+            if (!useDirectionalDerivatives && (x == null || dx == null))
+                throw new ArgumentException("The finite differences need the states and derivatives");
+            var status = FmiFunctions.EvaluateSparseJacobian(handle, instance.Handle, useDirectionalDerivatives, x, dx, nominals);
+            Marshal.Copy(values, Values, 0, Values.Length);
+            return status;
+        }
+
+        private static int[] ReadIndices(IntPtr array, int count)
+        {
+            var indices = new int[count];
+            for (int i = 0; i < count; i++)
+                indices[i] = (int)Marshal.ReadIntPtr(array, i * IntPtr.Size).ToInt64();
+            return indices;
+        }
+
+        #region IDisposable Support
+        private bool disposedValue = false; // To detect redundant calls
+
+        protected virtual void Dispose(bool disposing)
+        {
+            if (!disposedValue)
+            {
+                // Free unmanaged resources
+                if (handle != IntPtr.Zero)
+                    FmiFunctions.FreeSparseJacobian(handle);
+                handle = IntPtr.Zero;
+                // Avoid disposing multiple times
+                disposedValue = true;
+            }
+        }
+
+        ~SparseJacobian()
+        {
+            // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
+            Dispose(false);
+        }
+
+        // This code added to correctly implement the disposable pattern.
+        public void Dispose()
+        {
+            // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
+            Dispose(true);
+            GC.SuppressFinalize(this);
+        }
+        #endregion
+    }
+
+    /// <summary>
+    /// Mirrors the public part of the native sparse_jacobian.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct NativeSparseJacobian
+    {
+        public UIntPtr nStates;
+        public UIntPtr nNonzeros;
+        public IntPtr rowOffsets;
+        public IntPtr columns;
+        public IntPtr values;
+        public UIntPtr nColors;
+        public IntPtr colors;
+    }
+}
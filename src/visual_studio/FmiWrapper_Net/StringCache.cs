@@ -0,0 +1,42 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace FmiWrapper_Net
+{
+    /// <summary>
+    /// Direct mapped cache of strings returned by the fmu.
+    /// Native strings are compared by content, so repeatedly reading an unchanged value returns the same string without allocating.
+    /// </summary>
+    internal sealed class StringCache
+    {
+        // Power of two so the slot is a mask of the hash
+        private const int Size = 256;
+        private readonly byte[][] keys = new byte[Size][];
+        private readonly string[] values = new string[Size];
+
+        /// <summary>
+        /// Returns the managed string of the zero terminated ANSI string.
+        /// </summary>
+        /// <param name="pointer">null is returned for IntPtr.Zero.</param>
+        public unsafe string Get(IntPtr pointer)
+        {
+            if (pointer == IntPtr.Zero)
+                return null;
+            // FNV-1a over the bytes while measuring the length
+            var bytes = (byte*)pointer;
+            uint hash = 2166136261;
+            int length = 0;
+            for (; bytes[length] != 0; length++)
+                hash = (hash ^ bytes[length]) * 16777619;
+            var slot = (int)(hash & (Size - 1));
+            var native = new ReadOnlySpan<byte>(bytes, length);
+            var key = keys[slot];
+            if (key != null && native.SequenceEqual(key))
+                return values[slot];
+            var value = Marshal.PtrToStringAnsi(pointer, length);
+            keys[slot] = native.ToArray();
+            values[slot] = value;
+            return value;
+        }
+    }
+}
@@ -0,0 +1,142 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace FmiWrapper_Net
+{
+    /// <summary>
+    /// The attributes of a variable that are needed to access it.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct IndexedVariable
+    {
+        public uint ValueReference;
+        public VariableType Type;
+        public VariableCausality Causality;
+        public VariableVariability Variability;
+    }
+
+    /// <summary>
+    /// Native lookup of value references by variable name.
+    /// </summary>
+    public class VariableIndex : IDisposable
+    {
+        /// <summary>
+        /// The value reference reported for unknown names.
+        /// </summary>
+        public const uint InvalidValueReference = uint.MaxValue;
+
+        private IntPtr index;
+
+        internal VariableIndex(IntPtr index)
+        {
+            if (index == IntPtr.Zero)
+                throw new Exception("Failed to create the variable index");
+            this.index = index;
+        }
+
+        /// <summary>
+        /// Gets the index of the archive. On warm starts it is loaded from the extraction directory.
+        /// </summary>
+        /// <param name="archive"></param>
+        public VariableIndex(FmuArchive archive) : this(archive.CreateNativeVariableIndex())
+        {
+        }
+
+        /// <summary>
+        /// Loads an index saved via Save.
+        /// Throws an exception if the file could not be loaded or does not match the guid.
+        /// </summary>
+        /// <param name="fileName"></param>
+        /// <param name="guid">null accepts any guid.</param>
+        public VariableIndex(string fileName, string guid = null) : this(FmiFunctions.LoadVariableIndex(fileName, guid))
+        {
+        }
+
+        /// <summary>
+        /// Gets the index of an fmu in the extraction cache, see FmuArchive.LoadCached.
+        /// On warm starts it is loaded without parsing the model description.
+        /// Throws an exception if the index could not be loaded or does not match the guid.
+        /// </summary>
+        /// <param name="fileName">The path of the .fmu file.</param>
+        /// <param name="cacheDirectory">The cache directory, null uses the temporary directory.</param>
+        /// <param name="guid">null accepts any guid.</param>
+        public static VariableIndex LoadCached(string fileName, string cacheDirectory = null, string guid = null)
+        {
+            return new VariableIndex(FmiFunctions.LoadCachedVariableIndex(fileName, cacheDirectory, guid));
+        }
+
+        public int Count => index != IntPtr.Zero ? (int)FmiFunctions.GetVariableIndexSize(index).ToUInt32() : 0;
+
+        public Fmi2Status Save(string fileName)
+        {
+            if (index == IntPtr.Zero)
+                return Fmi2Status.fmi2Fatal;
+            return FmiFunctions.SaveVariableIndex(index, fileName);
+        }
+
+        /// <summary>
+        /// Looks up a single variable.
+        /// </summary>
+        /// <returns>false if the name is unknown.</returns>
+        public bool TryFind(string name, out IndexedVariable variable)
+        {
+            variable = default(IndexedVariable);
+            return index != IntPtr.Zero && FmiFunctions.FindVariable(index, name, out variable) != 0;
+        }
+
+        /// <summary>
+        /// Resolves the value references of many names in one native call.
+        /// </summary>
+        /// <param name="names"></param>
+        /// <param name="valueReferences">Receives InvalidValueReference for unknown names.</param>
+        /// <returns>The number of names that could not be resolved.</returns>
+        public int Resolve(string[] names, uint[] valueReferences)
+        {
+            if (index == IntPtr.Zero)
+                return names.Length;
+            return (int)FmiFunctions.ResolveVariables(index, (UIntPtr)names.Length, names, valueReferences, null).ToUInt32();
+        }
+
+        /// <summary>
+        /// Resolves the value references of many names or throws if one of them is unknown.
+        /// </summary>
+        public uint[] Resolve(params string[] names)
+        {
+            var valueReferences = new uint[names.Length];
+            if (Resolve(names, valueReferences) != 0)
+                throw new ArgumentException("Unknown variable " + names[Array.IndexOf(valueReferences, InvalidValueReference)]);
+            return valueReferences;
+        }
+
+        #region IDisposable Support
+        private bool disposedValue = false; // To detect redundant calls
+
+        protected virtual void Dispose(bool disposing)
+        {
+            if (!disposedValue)
+            {
+                // Free unmanaged resources
+                if (index != IntPtr.Zero)
+                    FmiFunctions.FreeVariableIndex(index);
+                index = IntPtr.Zero;
+                // Avoid disposing multiple times
+                disposedValue = true;
+            }
+        }
+
+        ~VariableIndex()
+        {
+            // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
+            Dispose(false);
+        }
+
+        // This code added to correctly implement the disposable pattern.
+        public void Dispose()
+        {
+            // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
+            Dispose(true);
+            GC.SuppressFinalize(this);
+        }
+        #endregion
+    }
+}